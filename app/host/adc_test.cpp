@@ -0,0 +1,308 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "host.h"
+#include "adc.h"
+
+#include <atomic>
+#include <cmath>
+#include <stdio.h>
+#include <thread>
+
+
+#define NOISE_FRAMES    2000
+#define STRESS_FRAMES   200000u
+#define BENCH_LOOPS     1000000u
+
+/* between steps of the converter, with about 1 LSB rms of noise */
+#define NOISE_LEVEL     2000.25
+#define NOISE_LSB       2.0
+
+
+typedef struct
+{
+  uint32_t conversions;
+  uint32_t rng;
+  double   sum;               ///< raw knob 1, 12 bit LSB
+  double   sum_sq;
+} adc_source_t;
+
+
+static uint16_t noisy   (ADC_ch_e ch, void *ctx);
+static uint16_t perFrame(ADC_ch_e ch, void *ctx);
+
+static bool measureNoise(uint32_t frames, double *raw_rms, double *out_rms, double *out_mean);
+static bool stress      (uint32_t frames);
+
+
+/* decimation, snapshots & noise, pacing is the timer's job on the target */
+bool HTST_adc(void)
+{
+  ADC_snapshot_t snap;
+  double raw_rms, out_rms, mean;
+  uint32_t ch;
+
+  HOST_ADC_attach(NULL, NULL);
+  HTST_check(ADC_init());
+
+  /* nothing until started & nothing published before the first value */
+  HOST_ADC_trigger(ADC_OVERSAMPLE);
+  HTST_check(false == ADC_read(&snap));
+  HTST_check(ADC_start());
+
+  for (ch = ADC_CH_FIRST; ch < ADC_NUM_OF_CH; ch++) {
+    HOST_ADC_set((ADC_ch_e)ch, (uint16_t)((ch * 500) + 7)); }
+
+  HOST_ADC_trigger(ADC_OVERSAMPLE - 1);
+  HTST_check(0 == ADC_seq());
+  HTST_check(false == ADC_read(&snap));
+
+  HOST_ADC_trigger(1);
+  HTST_check(1 == ADC_seq());
+  HTST_check(ADC_read(&snap) && (1 == snap.seq));
+
+  for (ch = ADC_CH_FIRST; ch < ADC_NUM_OF_CH; ch++) {
+    HTST_check(snap.val[ch] == (((ch * 500) + 7) << ADC_1_OVERSAMPLE_BITS)); }
+
+  /* both halves of the buffer, ends of the range */
+  for (ch = ADC_CH_FIRST; ch < ADC_NUM_OF_CH; ch++) {
+    HOST_ADC_set((ADC_ch_e)ch, (ch & 1) ? 4095 : 0); }
+
+  HOST_ADC_trigger(ADC_OVERSAMPLE);
+  HTST_check(ADC_read(&snap) && (2 == snap.seq));
+
+  for (ch = ADC_CH_FIRST; ch < ADC_NUM_OF_CH; ch++) {
+    HTST_check(snap.val[ch] == ((ch & 1) ? ADC_MAX : 0)); }
+
+  /* stopped, the last values stay */
+  HTST_check(ADC_stop());
+  HOST_ADC_trigger(4 * ADC_OVERSAMPLE);
+  HTST_check(2 == ADC_seq());
+  HTST_check(ADC_start());
+
+  /* average lands between steps & the noise drops by sqrt(scans) */
+  HTST_check(measureNoise(NOISE_FRAMES, &raw_rms, &out_rms, &mean));
+  HTST_check(fabs(mean - NOISE_LEVEL) < (1.0 / (1 << ADC_1_OVERSAMPLE_BITS)));
+  HTST_check(out_rms < ((raw_rms * 1.5) / sqrt((double)ADC_OVERSAMPLE)));
+
+  /* a reader racing the writer never sees half of one value & half of the next */
+  HTST_check(stress(STRESS_FRAMES));
+
+  HOST_ADC_attach(NULL, NULL);
+  ADC_stop();
+
+  return true;
+}
+
+
+/* cost of a value in the dma irq & of reading one, noise before & after */
+bool HTST_adcBench(void)
+{
+  static uint16_t raw[ADC_OVERSAMPLE * ADC_NUM_OF_CH];
+  uint16_t out[ADC_NUM_OF_CH];
+  ADC_snapshot_t snap;
+  double raw_rms, out_rms, mean;
+  uint64_t start, ns;
+  uint32_t i, sum = 0;
+
+  for (i = 0; i < SIZEOF(raw); i++) {
+    raw[i] = (uint16_t)((i * 2654435761u) >> 20); }
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    raw[i & (SIZEOF(raw) - 1)] = (uint16_t)(i & 0xFFF);
+    ADC_decimate(raw, out);
+    sum += out[i & (ADC_NUM_OF_CH - 1)];
+  }
+  ns = HTST_nowNs() - start;
+  HTST_report("adc decimate, all channels", (double)ns / BENCH_LOOPS, "ns");
+
+  ADC_init();
+  ADC_start();
+  HOST_ADC_attach(NULL, NULL);
+  HOST_ADC_trigger(ADC_OVERSAMPLE);
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    ADC_read(&snap);
+    sum += snap.val[i & (ADC_NUM_OF_CH - 1)];
+  }
+  ns = HTST_nowNs() - start;
+  HTST_report("adc read snapshot", (double)ns / BENCH_LOOPS, "ns");
+
+  if (false == measureNoise(NOISE_FRAMES * 10, &raw_rms, &out_rms, &mean)) {
+    return false; }
+
+  HTST_report("adc noise, single conversion", raw_rms, "LSB rms");
+  HTST_report("adc noise, decimated", out_rms, "LSB rms");
+  HTST_report("adc effective bits", 12.0 + log2(raw_rms / out_rms), "bits");
+
+  HOST_ADC_attach(NULL, NULL);
+  ADC_stop();
+
+  (void)sum;
+
+  return true;
+}
+
+
+/* knob 1 at a fractional level plus triangular noise, the rest constant */
+static uint16_t noisy(ADC_ch_e ch, void *ctx)
+{
+  adc_source_t *s = (adc_source_t *)ctx;
+  double v;
+  uint32_t a, b;
+
+  if (ADC_CH_KNOB_1 != ch) {
+    return 1000; }
+
+  s->rng = (s->rng * 1664525u) + 1013904223u;
+  a = s->rng >> 16;
+  s->rng = (s->rng * 1664525u) + 1013904223u;
+  b = s->rng >> 16;
+
+  v = NOISE_LEVEL + (((double)a - (double)b) * (NOISE_LSB / 65536.0));
+  v = floor(v + 0.5);
+
+  s->sum += v;
+  s->sum_sq += v * v;
+  s->conversions++;
+
+  return (uint16_t)v;
+}
+
+/* every conversion of a value the same, different from the next value */
+static uint16_t perFrame(ADC_ch_e ch, void *ctx)
+{
+  adc_source_t *s = (adc_source_t *)ctx;
+  uint32_t frame = s->conversions++ / (ADC_OVERSAMPLE * ADC_NUM_OF_CH);
+
+  (void)ch;
+
+  return (uint16_t)((frame * 37) & 0xFFF);
+}
+
+
+/* rms in 12 bit LSB, out_mean too */
+static bool measureNoise(uint32_t frames, double *raw_rms, double *out_rms, double *out_mean)
+{
+  adc_source_t src = {0, 1, 0.0, 0.0};
+  ADC_snapshot_t snap;
+  double v, sum = 0.0, sum_sq = 0.0;
+  double mean;
+  uint32_t i;
+
+  HOST_ADC_attach(noisy, &src);
+
+  for (i = 0; i < frames; i++)
+  {
+    HOST_ADC_trigger(ADC_OVERSAMPLE);
+
+    if (false == ADC_read(&snap)) {
+      return false; }
+
+    v = (double)snap.val[ADC_CH_KNOB_1] / (1 << ADC_1_OVERSAMPLE_BITS);
+    sum += v;
+    sum_sq += v * v;
+  }
+
+  HOST_ADC_attach(NULL, NULL);
+
+  mean = src.sum / src.conversions;
+  *raw_rms = sqrt((src.sum_sq / src.conversions) - (mean * mean));
+
+  *out_mean = sum / frames;
+  *out_rms = sqrt(fmax((sum_sq / frames) - (*out_mean * *out_mean), 0.0));
+
+  return true;
+}
+
+
+static bool stress(uint32_t frames)
+{
+  adc_source_t src = {0, 0, 0.0, 0.0};
+  std::atomic<bool> done(false);
+  uint32_t torn = 0, backwards = 0, reads = 0;
+  uint32_t i;
+
+  ADC_stop();
+  ADC_init();
+  ADC_start();
+  HOST_ADC_attach(perFrame, &src);
+
+  std::thread reader([&]()
+  {
+    ADC_snapshot_t snap;
+    uint32_t last = 0;
+    uint32_t ch;
+
+    while (false == done.load())
+    {
+      if (false == ADC_read(&snap)) {
+        continue; }
+
+      for (ch = 1; ch < ADC_NUM_OF_CH; ch++)
+      {
+        if (snap.val[ch] != snap.val[0]) {
+          torn++; }
+      }
+
+      if (snap.val[0] != ((((snap.seq - 1) * 37) & 0xFFF) << ADC_1_OVERSAMPLE_BITS)) {
+        torn++; }
+
+      if (snap.seq < last) {
+        backwards++; }
+
+      last = snap.seq;
+      reads++;
+    }
+  });
+
+  for (i = 0; i < frames; i++)
+  {
+    HOST_ADC_trigger(ADC_OVERSAMPLE);
+
+    if (0 == (i & 0xFF)) {
+      std::this_thread::yield(); }
+  }
+
+  done.store(true);
+  reader.join();
+
+  HOST_ADC_attach(NULL, NULL);
+
+  if (torn || backwards) {
+    printf("  %u torn, %u out of order in %u reads\n", (unsigned)torn, (unsigned)backwards, (unsigned)reads); }
+
+  return (0 == torn) && (0 == backwards) && (frames == ADC_seq());
+}
@@ -0,0 +1,209 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "arena.hpp"
+#include "pool.hpp"
+
+#include "audio.hpp"
+#include "biquad.hpp"
+#include "resonator.hpp"
+#include "voice_pool.hpp"
+
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* every heap allocation in the host build goes through here */
+static uint32_t heap_allocs;
+
+
+void *operator new(size_t bytes)
+{
+  void *p = malloc(bytes ? bytes : 1);
+
+  heap_allocs++;
+
+  if (NULL == p) {
+    throw std::bad_alloc(); }
+
+  return p;
+}
+
+void *operator new[](size_t bytes)
+{
+  return operator new(bytes);
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t bytes) noexcept
+{
+  (void)bytes;
+  free(p);
+}
+
+void operator delete[](void *p, size_t bytes) noexcept
+{
+  (void)bytes;
+  free(p);
+}
+
+
+class Counted
+{
+  public:
+    Counted(uint32_t value) : value(value) { live++; }
+    ~Counted() { live--; }
+
+    uint32_t value;
+    static int32_t live;
+};
+
+int32_t Counted::live = 0;
+
+
+static_assert(StaticArena<4096>::fits(1024 * sizeof(float)), "compile time check");
+static_assert(false == StaticArena<4096>::fits(1025 * sizeof(float)), "compile time check");
+static_assert(Pool<Counted, 4>::BYTES == (4 * sizeof(Counted)), "compile time check");
+
+
+/* allocators hand out what fits, refuse the rest cleanly & the audio path
+ * never touches the heap */
+bool HTST_allocator(void)
+{
+  static StaticArena<256> arena;
+  static Pool<Counted, 4> pool;
+  static VoicePool voices;
+  static AudioEngine engine(voices);
+  static StaticArena<RESONATOR_ARENA_BYTES> delays;
+  Counted *c[5];
+  Biquad<> biquad;
+  Resonator res;
+  int16_t tx[BLOCK_SIZE * AUDIO_CHANNELS];
+  float block[BLOCK_SIZE] = {0};
+  uint8_t *b;
+  double *d;
+  float *f;
+  size_t mark;
+  uint32_t allocs;
+  uint32_t i;
+
+  /* alignment & exhaustion */
+  b = arena.allocate<uint8_t>(3);
+  d = arena.allocate<double>(2);
+  HTST_check(b && d);
+  HTST_check(0 == ((uintptr_t)d % alignof(double)));
+  HTST_check(((uint8_t *)d - b) >= 3);
+
+  mark = arena.used();
+  HTST_check(NULL == arena.allocate<float>(1000));
+  HTST_check(NULL == arena.allocate<float>(SIZE_MAX / 2));
+  HTST_check(2 == arena.refused());
+  HTST_check(mark == arena.used());
+
+  HTST_check(NULL != arena.create<Counted>(7u));
+  HTST_check(1 == Counted::live);
+
+  /* scratch goes back on the way out, the high water mark stays */
+  mark = arena.used();
+  {
+    ScratchScope scratch(arena);
+
+    f = scratch.allocate<float>(32);
+    HTST_check(NULL != f);
+    HTST_check(arena.used() > mark);
+  }
+  HTST_check(mark == arena.used());
+  HTST_check(arena.highWater() >= (mark + (32 * sizeof(float))));
+
+  arena.reset();
+  HTST_check((0 == arena.used()) && (arena.capacity() == arena.available()));
+
+  /* pool, full then reused */
+  Counted::live = 0;
+  for (i = 0; i < 4; i++)
+  {
+    c[i] = pool.create(i);
+    HTST_check(c[i] && (i == c[i]->value));
+  }
+
+  c[4] = pool.create(4u);
+  HTST_check(NULL == c[4]);
+  HTST_check((1 == pool.refused()) && (4 == pool.inUse()) && (4 == Counted::live));
+
+  HTST_check(pool.destroy(c[1]));
+  HTST_check(false == pool.destroy(c[1]));
+  HTST_check(false == pool.destroy(NULL));
+  HTST_check(false == pool.destroy((Counted *)((uint8_t *)c[2] + 1)));
+  HTST_check(3 == Counted::live);
+
+  c[4] = pool.create(9u);
+  HTST_check(c[4] == c[1]);
+  HTST_check((4 == pool.inUse()) && (4 == pool.highWater()));
+
+  for (i = 0; i < 4; i++)
+  {
+    if (1 != i) {
+      HTST_check(pool.destroy(c[i])); }
+  }
+  HTST_check(pool.destroy(c[4]));
+  HTST_check((0 == pool.inUse()) && (0 == Counted::live));
+
+  /* set up may do as it likes, rendering may not allocate */
+  res.init(delays, Resonator::MODE_MODAL, 100.0f);
+  res.excite(1.0f);
+  biquad.setStage(0, BiquadDesign::lowpass(1000.0f, 0.7f));
+  biquad.commit();
+  voices.noteOn(60, 100);
+  engine.start();
+
+  allocs = heap_allocs;
+
+  for (i = 0; i < 100; i++)
+  {
+    engine.process(tx, NULL);
+    res.generate(block, BLOCK_SIZE);
+    biquad.process(block, BLOCK_SIZE);
+  }
+
+  HTST_check(allocs == heap_allocs);
+
+  return true;
+}
@@ -0,0 +1,155 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "audio.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define BENCH_BLOCKS    20000
+
+
+/* fills each block with a fixed value */
+class ConstVoice : public Voice
+{
+  public:
+    float value = 0.0f;
+    uint32_t calls = 0;
+
+    void render(float *out, size_t frames)
+    {
+      size_t i;
+
+      for (i = 0; i < frames; i++) {
+        out[i] = value; }
+
+      calls++;
+    }
+};
+
+/* something with a realistic per sample cost */
+class SineVoice : public Voice
+{
+  public:
+    void render(float *out, size_t frames)
+    {
+      size_t i;
+
+      for (i = 0; i < frames; i++)
+      {
+        out[i] = 0.5f * sinf(_phase * 6.2831853f);
+        _phase += 440.0f / SAMPLE_RATE;
+        if (_phase >= 1.0f) {
+          _phase -= 1.0f; }
+      }
+    }
+
+  private:
+    float _phase = 0.0f;
+};
+
+
+/* block layout, ping-pong order & conversion to the codec format */
+bool HTST_audio(void)
+{
+  ConstVoice voice;
+  AudioEngine engine(voice);
+  int16_t *buf = engine.txBuffer();
+  int16_t *rx = engine.rxBuffer();
+  size_t half = BLOCK_SIZE * AUDIO_CHANNELS;
+  size_t i;
+
+  HTST_check((2 * half) == engine.bufferLength());
+  HTST_check(engine.load().budget > 0);
+
+  /* first half only */
+  voice.value = 0.5f;
+  engine.process(&buf[0], &rx[0]);
+  for (i = 0; i < half; i++) {
+    HTST_check(16384 == buf[i]); }
+  for (i = half; i < (2 * half); i++) {
+    HTST_check(0 == buf[i]); }
+
+  /* second half only, saturating */
+  voice.value = 2.0f;
+  engine.process(&buf[half], &rx[half]);
+  HTST_check(&rx[half] == engine.input());
+  HTST_check(16384 == buf[0]);
+  for (i = half; i < (2 * half); i++) {
+    HTST_check(INT16_MAX == buf[i]); }
+
+  voice.value = -2.0f;
+  AudioEngine::i2sCallback(&buf[0], &rx[0], half, &engine);
+  HTST_check(INT16_MIN == buf[0]);
+  HTST_check(INT16_MIN == buf[half - 1]);
+
+  HTST_check(3 == voice.calls);
+  HTST_check(3 == engine.load().blocks);
+  HTST_check(engine.load().peak >= engine.load().last);
+
+  engine.start();
+  HTST_check(0 == engine.load().blocks);
+  HTST_check(0 == buf[0]);
+
+  return true;
+}
+
+
+/* load is relative to real time at SAMPLE_RATE, 1.0 = one core's worth */
+bool HTST_audioBench(void)
+{
+  SineVoice voice;
+  AudioEngine engine(voice);
+  int16_t *tx = engine.txBuffer();
+  int16_t *rx = engine.rxBuffer();
+  size_t half = BLOCK_SIZE * AUDIO_CHANNELS;
+  uint64_t ns;
+  uint32_t i;
+
+  ns = HTST_nowNs();
+
+  for (i = 0; i < (BENCH_BLOCKS / 2); i++)
+  {
+    engine.process(&tx[0], &rx[0]);
+    engine.process(&tx[half], &rx[half]);
+  }
+
+  ns = HTST_nowNs() - ns;
+
+  HTST_report("audio block size", BLOCK_SIZE, "frames");
+  HTST_report("audio sample rate", SAMPLE_RATE, "Hz");
+  HTST_report("audio sine voice per block", (double)ns / BENCH_BLOCKS, "ns");
+  HTST_report("audio sine voice load avg", engine.load().average * 100.0, "%");
+  HTST_report("audio sine voice load peak", engine.load().peak * 100.0, "%");
+
+  return true;
+}
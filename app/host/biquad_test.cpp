@@ -0,0 +1,315 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "biquad.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define BENCH_BLOCKS    20000
+#define BENCH_STAGES    4
+
+
+/* direct form 2 transposed in double, coefficients can change under it */
+typedef struct
+{
+  biquad_t c[Biquad<>::MAX_STAGES];
+  double   s[Biquad<>::MAX_STAGES][2];
+  uint8_t  stages;
+} reference_t;
+
+
+static double  tick      (reference_t &r, double x);
+static float   gainAt    (biquad_t const &c, float hz);
+static float   noise     (void);
+static void    fill      (float *buf, size_t frames);
+
+__attribute__((noinline)) static float sampleTick(float *state, biquad_t const *c, float x);
+
+
+bool HTST_biquad(void)
+{
+  static float buf[64 * BLOCK_SIZE];
+  static float chans[4][BLOCK_SIZE];
+  static int32_t q[64 * BLOCK_SIZE];
+  reference_t ref;
+  Biquad<> eq(2);
+  Biquad<Q31> eq31(2);
+  Biquad<Float32, 4> bank(2);
+  Biquad<> single[4] = {Biquad<>(2), Biquad<>(2), Biquad<>(2), Biquad<>(2)};
+  biquad_t lp1k = BiquadDesign::lowpass(1000.0f, 0.707f);
+  biquad_t lp2k = BiquadDesign::lowpass(2000.0f, 0.707f);
+  biquad_t pk = BiquadDesign::peak(5000.0f, 1.0f, 6.0f);
+  biquad_t hs = BiquadDesign::highShelf(8000.0f, -6.0f);
+  float expect[BLOCK_SIZE];
+  double sig, err;
+  uint32_t b, i, ch;
+
+  /* designs */
+  HTST_check(fabsf(gainAt(pk, 5000.0f) - 2.0f) < 0.01f);
+  HTST_check(fabsf(gainAt(pk, 100.0f) - 1.0f) < 0.01f);
+  HTST_check(fabsf(gainAt(BiquadDesign::lowShelf(200.0f, 6.0f), 20.0f) - 2.0f) < 0.02f);
+  HTST_check(fabsf(gainAt(BiquadDesign::lowShelf(200.0f, 6.0f), 20000.0f) - 1.0f) < 0.01f);
+  HTST_check(fabsf(gainAt(hs, 40000.0f) - 0.5f) < 0.01f);
+  HTST_check(fabsf(gainAt(lp1k, 1000.0f) - 0.707f) < 0.01f);
+  HTST_check(fabsf(gainAt(BiquadDesign::bandpass(3000.0f, 4.0f), 3000.0f) - 1.0f) < 0.01f);
+  HTST_check(gainAt(BiquadDesign::highpass(1000.0f, 0.707f), 50.0f) < 0.005f);
+  HTST_check(gainAt(BiquadDesign::dcBlock(10.0f), 0.0f) < 0.001f);
+
+  /* cascade against double, coefficients swapped mid stream */
+  memset(&ref, 0, sizeof(ref));
+  ref.stages = 2;
+  ref.c[0] = lp1k;
+  ref.c[1] = pk;
+  HTST_check(eq.setStage(0, lp1k));
+  HTST_check(eq.setStage(1, pk));
+  eq.commit();
+  HTST_check(eq.pending());
+
+  fill(buf, SIZEOF(buf));
+
+  for (b = 0; b < (SIZEOF(buf) / BLOCK_SIZE); b++)
+  {
+    if (20 == b)
+    {
+      HTST_check(eq.setStage(0, lp2k));
+      eq.commit();
+      HTST_check(false == eq.setStage(1, hs));
+      ref.c[0] = lp2k;
+    }
+
+    /* only the one stage written, the other comes across from the last set */
+    if (40 == b)
+    {
+      HTST_check(eq.setStage(1, hs));
+      eq.commit();
+      ref.c[1] = hs;
+    }
+
+    for (i = 0; i < BLOCK_SIZE; i++) {
+      expect[i] = (float)tick(ref, buf[(b * BLOCK_SIZE) + i]); }
+
+    eq.process(&buf[b * BLOCK_SIZE], BLOCK_SIZE);
+    HTST_check(false == eq.pending());
+
+    for (i = 0; i < BLOCK_SIZE; i++) {
+      HTST_check(fabsf(expect[i] - buf[(b * BLOCK_SIZE) + i]) < 1e-5f); }
+  }
+
+  /* q31 against float */
+  eq.setStage(0, lp1k);
+  eq.setStage(1, pk);
+  eq.commit();
+  eq.reset();
+  eq31.setStage(0, lp1k);
+  eq31.setStage(1, pk);
+  eq31.commit();
+
+  fill(buf, SIZEOF(buf));
+  for (i = 0; i < SIZEOF(buf); i++) {
+    q[i] = Q31::fromFloat(buf[i]); }
+
+  for (b = 0; b < (SIZEOF(buf) / BLOCK_SIZE); b++)
+  {
+    eq.process(&buf[b * BLOCK_SIZE], BLOCK_SIZE);
+    eq31.process(&q[b * BLOCK_SIZE], BLOCK_SIZE);
+  }
+
+  for (i = 0, sig = 0.0, err = 0.0; i < SIZEOF(buf); i++)
+  {
+    sig += (double)buf[i] * buf[i];
+    err += ((double)buf[i] - Q31::toFloat(q[i])) * ((double)buf[i] - Q31::toFloat(q[i]));
+  }
+  HTST_check((10.0 * log10(sig / err)) > 100.0);
+
+  /* every active channel in one call, same as one filter each */
+  for (ch = 0; ch < 4; ch++)
+  {
+    bank.setStage(0, lp1k);
+    single[ch].setStage(0, lp1k);
+    single[ch].setStage(1, pk);
+    single[ch].commit();
+  }
+  bank.setStage(1, pk);
+  bank.commit();
+
+  for (b = 0; b < 8; b++)
+  {
+    for (ch = 0; ch < 4; ch++) {
+      fill(chans[ch], BLOCK_SIZE); }
+    memcpy(buf, chans, sizeof(chans));
+
+    bank.processChannels(&chans[0][0], BLOCK_SIZE, 0x0B, BLOCK_SIZE);
+
+    for (ch = 0; ch < 4; ch++)
+    {
+      if (2 == ch)
+      {
+        HTST_check(0 == memcmp(chans[ch], &buf[ch * BLOCK_SIZE], sizeof(chans[ch])));
+        continue;
+      }
+
+      single[ch].process(&buf[ch * BLOCK_SIZE], BLOCK_SIZE);
+      HTST_check(0 == memcmp(chans[ch], &buf[ch * BLOCK_SIZE], sizeof(chans[ch])));
+    }
+  }
+
+  return true;
+}
+
+
+/* BENCH_STAGES sections on every voice, one cmsis call per voice per block
+ * against a call per section per sample */
+bool HTST_biquadBench(void)
+{
+  static float block[MAX_VOICES][BLOCK_SIZE];
+  static int32_t qblock[MAX_VOICES][BLOCK_SIZE];
+  static Biquad<Float32, MAX_VOICES> bank(BENCH_STAGES);
+  static Biquad<Q31, MAX_VOICES> qbank(BENCH_STAGES);
+  biquad_t c[BENCH_STAGES];
+  float state[MAX_VOICES][BENCH_STAGES][2];
+  uint64_t ns;
+  uint32_t i, v, s, j;
+
+  for (s = 0; s < BENCH_STAGES; s++)
+  {
+    c[s] = BiquadDesign::peak(200.0f * (float)(s + 1), 1.0f, 3.0f);
+    bank.setStage(s, c[s]);
+    qbank.setStage(s, c[s]);
+  }
+  bank.commit();
+  qbank.commit();
+  memset(state, 0, sizeof(state));
+
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    fill(block[v], BLOCK_SIZE);
+    for (j = 0; j < BLOCK_SIZE; j++) {
+      qblock[v][j] = Q31::fromFloat(block[v][j]); }
+  }
+
+  ns = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++) {
+    bank.processChannels(&block[0][0], BLOCK_SIZE, (1u << MAX_VOICES) - 1, BLOCK_SIZE); }
+  ns = HTST_nowNs() - ns;
+
+  HTST_report("biquad stages per voice", BENCH_STAGES, "sections");
+  HTST_report("biquad f32 bank per voice per block", (double)ns / (BENCH_BLOCKS * MAX_VOICES), "ns");
+  HTST_report("biquad f32 bank per section per sample",
+              (double)ns / ((double)BENCH_BLOCKS * MAX_VOICES * BENCH_STAGES * BLOCK_SIZE), "ns");
+
+  ns = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++) {
+    qbank.processChannels(&qblock[0][0], BLOCK_SIZE, (1u << MAX_VOICES) - 1, BLOCK_SIZE); }
+  ns = HTST_nowNs() - ns;
+
+  HTST_report("biquad q31 bank per voice per block", (double)ns / (BENCH_BLOCKS * MAX_VOICES), "ns");
+
+  ns = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    for (v = 0; v < MAX_VOICES; v++)
+    {
+      for (j = 0; j < BLOCK_SIZE; j++)
+      {
+        for (s = 0; s < BENCH_STAGES; s++) {
+          block[v][j] = sampleTick(state[v][s], &c[s], block[v][j]); }
+      }
+    }
+  }
+  ns = HTST_nowNs() - ns;
+
+  HTST_report("biquad per sample calls per voice per block", (double)ns / (BENCH_BLOCKS * MAX_VOICES), "ns");
+
+  return true;
+}
+
+
+static double tick(reference_t &r, double x)
+{
+  double y = x;
+  uint8_t s;
+
+  for (s = 0; s < r.stages; s++)
+  {
+    x = y;
+    y = (r.c[s].b0 * x) + r.s[s][0];
+    r.s[s][0] = (r.c[s].b1 * x) - (r.c[s].a1 * y) + r.s[s][1];
+    r.s[s][1] = (r.c[s].b2 * x) - (r.c[s].a2 * y);
+  }
+
+  return y;
+}
+
+
+/* |H(e^jw)| straight from the coefficients */
+static float gainAt(biquad_t const &c, float hz)
+{
+  double w = (6.283185307179586 * hz) / SAMPLE_RATE;
+  double nr = c.b0 + (c.b1 * cos(w)) + (c.b2 * cos(2.0 * w));
+  double ni = -(c.b1 * sin(w)) - (c.b2 * sin(2.0 * w));
+  double dr = 1.0 + (c.a1 * cos(w)) + (c.a2 * cos(2.0 * w));
+  double di = -(c.a1 * sin(w)) - (c.a2 * sin(2.0 * w));
+
+  return (float)sqrt(((nr * nr) + (ni * ni)) / ((dr * dr) + (di * di)));
+}
+
+
+__attribute__((noinline)) static float sampleTick(float *state, biquad_t const *c, float x)
+{
+  float y = (c->b0 * x) + state[0];
+
+  state[0] = (c->b1 * x) - (c->a1 * y) + state[1];
+  state[1] = (c->b2 * x) - (c->a2 * y);
+
+  return y;
+}
+
+
+static void fill(float *buf, size_t frames)
+{
+  size_t i;
+
+  for (i = 0; i < frames; i++) {
+    buf[i] = 0.5f * noise(); }
+}
+
+
+/* +/-1, repeatable */
+static float noise(void)
+{
+  static uint32_t x = 33333;
+
+  x = (x * 1664525u) + 1013904223u;
+
+  return (float)(int32_t)x * (1.0f / 2147483648.0f);
+}
@@ -0,0 +1,126 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "board.h"
+#include "chips.h"
+#include "config_board.h"
+
+#include "host.h"
+#include "io.h"
+#include "tim.h"
+
+#include <stdio.h>
+
+
+#define GATE_PIN  IO_portPinToNum(IO_PORT_A, 0)
+
+
+static uint16_t pcf8575_value;
+static uint32_t edges;
+static bool     nack_error;
+
+
+static bool pcf8575Model(bool read, uint16_t mem_addr, uint8_t mem_length,
+                         uint8_t *data, uint16_t length, void *ctx)
+{
+  (void)mem_addr;
+  (void)mem_length;
+  (void)ctx;
+
+  if (read || (2 != length)) {
+    return false; }
+
+  pcf8575_value = (uint16_t)(data[0] | (data[1] << 8));
+
+  return true;
+}
+
+static void gateCb(IO_irq_edge_e edge)
+{
+  if (IO_IRQ_EDGE_POS == edge) {
+    edges++; }
+}
+
+static void nackCb(bool error, void *ctx)
+{
+  (void)ctx;
+  nack_error = error;
+}
+
+
+/* the fake mcu layer behaves enough like the real one to run drivers */
+bool HTST_board(void)
+{
+  HOST_bus_stats_t stats;
+  IO_cfg_t cfg = {IO_MODE_IRQ_POS, IO_SPEED_FAST, IO_PULL_NONE, NULL};
+  uint8_t tmp[2] = {0};
+  uint32_t ms;
+
+  /* i2c device model & traffic counting */
+  HOST_I2C_attach(PCF8575_0_CH, PCF8575_0_ADDR, pcf8575Model, NULL);
+  HTST_check(PCF8575_init(0, PCF8575_0_CH, PCF8575_0_ADDR));
+  HTST_settle();
+  HOST_I2C_clearStats(PCF8575_0_CH);
+
+  HTST_check(PCF8575_write16(0, 0xA5A5, NULL));
+  HTST_settle();
+  HTST_check(0xA5A5 == pcf8575_value);
+  HOST_I2C_getStats(PCF8575_0_CH, &stats);
+  HTST_check((1 == stats.xfers) && (3 == stats.bytes) && (0 == stats.errors));
+
+  /* nobody home at this address */
+  HOST_MERR_clear();
+  HTST_check(I2C_write(PCF8575_0_CH, 0x7E, tmp, 2, nackCb, NULL));
+  HTST_check(nack_error);
+  HTST_check(1 == HOST_MERR_count(MERROR_I2C_XFER_ERROR));
+  HOST_I2C_detachAll(PCF8575_0_CH);
+
+  /* outputs & edge interrupts */
+  IO_set(BUILTIN_LED_PIN);
+  HTST_check(IO_isHigh(BUILTIN_LED_PIN));
+  IO_toggle(BUILTIN_LED_PIN);
+  HTST_check(false == IO_isHigh(BUILTIN_LED_PIN));
+
+  IO_configure(GATE_PIN, &cfg);
+  IO_setExtIrqCallback(GATE_PIN, gateCb);
+  IO_enableExtIrq(GATE_PIN);
+  HOST_IO_drive(GATE_PIN, true);
+  HOST_IO_drive(GATE_PIN, false);
+  HOST_IO_drive(GATE_PIN, true);
+  HTST_check(2 == edges);
+
+  /* real time */
+  ms = TIM_millis();
+  TIM_delayMs(3);
+  HTST_check((TIM_millis() - ms) >= 3);
+
+  return true;
+}
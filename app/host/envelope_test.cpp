@@ -0,0 +1,215 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "envelope.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define ATTACK_S        0.01f
+#define DECAY_S         0.1f
+#define SUSTAIN         0.5f
+#define RELEASE_S       0.3f
+
+#define BENCH_BLOCKS    100000u
+
+
+static float out[SAMPLE_RATE];
+
+
+static bool segment(Envelope &env, double from, double end, double target, float seconds, uint32_t *length);
+
+
+/* every segment against the analytic curve & exactly the set length */
+bool HTST_envelope(void)
+{
+  Envelope env(ATTACK_S, DECAY_S, SUSTAIN, RELEASE_S);
+  Envelope block(ATTACK_S, DECAY_S, SUSTAIN, RELEASE_S);
+  double r = Envelope::DECAY_RATIO;
+  uint32_t n, i;
+  float v;
+
+  HTST_check(env.isIdle());
+  env.generate(out, BLOCK_SIZE);
+  HTST_check(0.0f == out[BLOCK_SIZE - 1]);
+
+  env.gate(true);
+  HTST_check(segment(env, 0.0, 1.0, 1.0 + Envelope::ATTACK_RATIO, ATTACK_S, &n));
+  HTST_check(abs((int32_t)n - (int32_t)(ATTACK_S * SAMPLE_RATE)) <= 1);
+  HTST_check(Envelope::STAGE_DECAY == env.stage());
+
+  HTST_check(segment(env, 1.0, SUSTAIN, SUSTAIN - (r * (1.0 - SUSTAIN)), DECAY_S, &n));
+  HTST_check(abs((int32_t)n - (int32_t)(DECAY_S * SAMPLE_RATE)) <= 1);
+
+  /* holds */
+  env.generate(out, SAMPLE_RATE / 10);
+  HTST_check((Envelope::STAGE_SUSTAIN == env.stage()) && (SUSTAIN == out[SAMPLE_RATE / 10 - 1]));
+
+  /* from sustain the release is shorter by the log of the distance */
+  env.gate(false);
+  HTST_check(segment(env, SUSTAIN, 0.0, -r, RELEASE_S, &n));
+  HTST_check(abs((int32_t)n - (int32_t)(RELEASE_S * SAMPLE_RATE * log((SUSTAIN + r) / r) / log((1.0 + r) / r))) <= 1);
+  HTST_check(env.isIdle());
+
+  /* retrigger mid release carries on from where it was */
+  env.gate(true);
+  env.generate(out, SAMPLE_RATE / 50);
+  env.gate(false);
+  env.generate(out, SAMPLE_RATE / 20);
+  v = out[SAMPLE_RATE / 20 - 1];
+  env.gate(true);
+  env.generate(out, 1);
+  HTST_check((out[0] > v) && ((out[0] - v) < 0.005f));
+
+  /* zero length segments */
+  env.setAttack(0.0f);
+  env.setRelease(0.0f);
+  env.reset();
+  env.gate(true);
+  env.generate(out, 1);
+  HTST_check((1.0f == out[0]) && (Envelope::STAGE_DECAY == env.stage()));
+  env.gate(false);
+  env.generate(out, 1);
+  HTST_check((0.0f == out[0]) && env.isIdle());
+
+  /* the block rate path is the same curve, k^32 rounds a little differently */
+  env.setAttack(ATTACK_S);
+  env.setRelease(RELEASE_S);
+  env.gate(true);
+  block.gate(true);
+  for (i = 0; i < (SAMPLE_RATE / BLOCK_SIZE); i++)
+  {
+    if ((SAMPLE_RATE / BLOCK_SIZE / 2) == i)
+    {
+      env.gate(false);
+      block.gate(false);
+    }
+    env.generate(out, BLOCK_SIZE);
+    HTST_check(fabsf(out[BLOCK_SIZE - 1] - block.update(BLOCK_SIZE)) < 1.0e-5f);
+  }
+  HTST_check(env.isIdle() && block.isIdle());
+
+  return true;
+}
+
+
+/* a full set of voices, recurrence against expf per sample */
+bool HTST_envelopeBench(void)
+{
+  static Envelope env[MAX_VOICES];
+  static float buf[BLOCK_SIZE];
+  float y[MAX_VOICES] = {0.0f};
+  float sum = 0.0f;
+  uint64_t start;
+  uint32_t i, j, v, t[MAX_VOICES] = {0};
+
+  /* long enough that every block is spent in decay */
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    env[v].setAttack(0.0f);
+    env[v].setDecay(100.0f);
+    env[v].gate(true);
+  }
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    for (v = 0; v < MAX_VOICES; v++)
+    {
+      env[v].generate(buf, BLOCK_SIZE);
+      sum += buf[BLOCK_SIZE - 1];
+    }
+  }
+  HTST_report("envelope, recurrence", (double)(HTST_nowNs() - start) / (BENCH_BLOCKS * MAX_VOICES), "ns/voice/block");
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    for (v = 0; v < MAX_VOICES; v++)
+    {
+      for (j = 0; j < BLOCK_SIZE; j++)
+      {
+        buf[j] = SUSTAIN + ((1.0f - SUSTAIN) * expf((float)t[v] * (-1.0f / (DECAY_S * SAMPLE_RATE))));
+        t[v]++;
+      }
+      y[v] = buf[BLOCK_SIZE - 1];
+      sum += y[v];
+    }
+  }
+  HTST_report("envelope, expf per sample", (double)(HTST_nowNs() - start) / (BENCH_BLOCKS * MAX_VOICES), "ns/voice/block");
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    env[v].gate(true); }
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    for (v = 0; v < MAX_VOICES; v++) {
+      sum += env[v].update(BLOCK_SIZE); }
+  }
+  HTST_report("envelope, block rate update", (double)(HTST_nowNs() - start) / (BENCH_BLOCKS * MAX_VOICES), "ns/voice/block");
+
+  if (sum == 12345.0f) {
+    printf("  %f\n", sum); }
+
+  return true;
+}
+
+
+/* runs a segment to its end checking each sample against the closed form
+ * target + (from - target) * k^n. k is worked out in double from the full
+ * 0 - 1 span the segment time is set for */
+static bool segment(Envelope &env, double from, double end, double target, float seconds, uint32_t *length)
+{
+  double span = (from < end) ? (target / (target - 1.0)) : ((1.0 - target) / (end - target));
+  double k = exp(-log(span) / (seconds * SAMPLE_RATE));
+  double ref;
+  Envelope::stage_e stage = env.stage();
+  uint32_t n;
+
+  for (n = 0; n < SAMPLE_RATE; n++)
+  {
+    env.generate(&out[n], 1);
+    if (env.stage() != stage) {
+      break; }
+
+    ref = target + ((from - target) * pow(k, n + 1));
+    HTST_check(fabs(ref - out[n]) < 1.0e-4);
+  }
+
+  HTST_check(n < SAMPLE_RATE);
+  HTST_check((float)end == out[n]);
+
+  *length = n + 1;
+
+  return true;
+}
@@ -0,0 +1,272 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "audio.hpp"
+#include "event_bus.hpp"
+#include "voice_pool.hpp"
+
+#include <cmath>
+#include <stdio.h>
+#include <thread>
+
+
+#define TRACE_EVENTS    3000u
+#define TRACE_BLOCKS    4000u
+#define THREAD_EVENTS   2000u
+#define BENCH_BLOCKS    20000u
+
+
+/* where in the rendered stream each event took effect */
+class TraceVoice : public Voice
+{
+  public:
+    void render(float *out, size_t frames)
+    {
+      size_t i;
+
+      for (i = 0; i < frames; i++) {
+        out[i] = 0.0f; }
+
+      rendered += frames;
+      renders++;
+    }
+
+    void handle(event_t const &event)
+    {
+      if (count < TRACE_EVENTS)
+      {
+        at[count] = rendered;
+        got[count] = event;
+      }
+      count++;
+    }
+
+    uint32_t rendered = 0;
+    uint32_t renders = 0;
+    uint32_t count = 0;
+    uint32_t at[TRACE_EVENTS];
+    event_t  got[TRACE_EVENTS];
+};
+
+
+/* the bench replays a longer one */
+static event_t trace[2 * BENCH_BLOCKS];
+static uint8_t trace_src[2 * BENCH_BLOCKS];
+
+
+static void makeTrace (uint32_t events, uint32_t blocks);
+static bool replay    (AudioEngine &engine, EventBus &bus, uint32_t events, uint32_t blocks);
+static int32_t spread (TraceVoice const &voice, uint32_t events);
+
+
+/* replayed trace lands on its exact samples, merged across sources */
+bool HTST_eventBus(void)
+{
+  static TraceVoice voice;
+  static EventBus bus;
+  static EventBus threaded;
+  AudioEngine engine(voice, &bus);
+  AudioEngine engine2(voice, &threaded);
+  event_t e = {0, EVENT_GATE, 0, 1, 1};
+  uint32_t i, t, renders;
+
+  /* trace times against where the voice saw them */
+  makeTrace(TRACE_EVENTS, TRACE_BLOCKS);
+  HTST_check(replay(engine, bus, TRACE_EVENTS, TRACE_BLOCKS));
+  HTST_check((TRACE_EVENTS == voice.count) && (TRACE_EVENTS == bus.delivered()));
+
+  for (i = 1; i < TRACE_EVENTS; i++) {
+    HTST_check(voice.got[i].time >= voice.got[i - 1].time); }
+  HTST_check((0 == spread(voice, TRACE_EVENTS)) && (voice.at[0] == voice.got[0].time));
+  HTST_check((0 == bus.late()) && (0 == bus.dropped()));
+
+  /* blocks with no events are one render */
+  renders = voice.renders;
+  engine.process(engine.txBuffer(), engine.rxBuffer());
+  HTST_check((renders + 1) == voice.renders);
+
+  /* late goes first in the block, early waits its turn */
+  t = bus.now();
+  e.time = t - (3 * BLOCK_SIZE);
+  HTST_check(bus.schedule(EVENT_SRC_GATE, e));
+  e.time = t + (3 * BLOCK_SIZE);
+  HTST_check(bus.schedule(EVENT_SRC_UI, e));
+  voice.count = 0;
+  engine.process(engine.txBuffer(), engine.rxBuffer());
+  HTST_check((1 == voice.count) && (1 == bus.late()));
+  HTST_check(voice.at[0] == (voice.rendered - BLOCK_SIZE));
+  for (i = 0; i < 4; i++) {
+    engine.process(engine.txBuffer(), engine.rxBuffer()); }
+  HTST_check((2 == voice.count) && (voice.at[1] == voice.got[1].time));
+
+  /* a full queue drops & counts */
+  for (i = 0; i <= EVENT_QUEUE_LEN; i++) {
+    bus.post(EVENT_SRC_UI, EVENT_BUTTON, 0, (uint8_t)i, 1); }
+  HTST_check(1 == bus.dropped());
+  engine.process(engine.txBuffer(), engine.rxBuffer());
+  engine.process(engine.txBuffer(), engine.rxBuffer());
+
+  /* stamped from another thread while blocks are rendered */
+  voice.count = 0;
+  std::thread producer([]()
+  {
+    uint32_t n;
+
+    for (n = 0; n < THREAD_EVENTS; )
+    {
+      if (threaded.post(EVENT_SRC_UART_MIDI, EVENT_NOTE_ON, 0, (uint8_t)n, 100)) {
+        n++; }
+      std::this_thread::yield();
+    }
+  });
+
+  for (i = 0; (voice.count < THREAD_EVENTS) && (i < 10000000); i++)
+  {
+    engine2.process(engine2.txBuffer(), engine2.rxBuffer());
+    std::this_thread::yield();
+  }
+  producer.join();
+
+  HTST_check((THREAD_EVENTS == voice.count) && (0 == threaded.dropped()));
+  for (i = 1; i < THREAD_EVENTS; i++)
+  {
+    HTST_check(voice.got[i].a == (uint8_t)i);
+    HTST_check(voice.got[i].time >= voice.got[i - 1].time);
+  }
+
+  return true;
+}
+
+
+/* note on jitter & what splitting the block costs a voice pool */
+bool HTST_eventBusBench(void)
+{
+  static VoicePool pool;
+  static TraceVoice voice;
+  static EventBus bus, trace_bus;
+  AudioEngine engine(pool, &bus);
+  AudioEngine plain(pool);
+  AudioEngine traced(voice, &trace_bus);
+  uint64_t start;
+  double quantised = 0.0;
+  uint32_t i;
+
+  /* spread of arrival to effect, against rounding each to its block */
+  makeTrace(TRACE_EVENTS, TRACE_BLOCKS);
+  replay(traced, trace_bus, TRACE_EVENTS, TRACE_BLOCKS);
+  for (i = 0; i < TRACE_EVENTS; i++) {
+    quantised = fmax(quantised, (double)(trace[i].time % BLOCK_SIZE)); }
+  HTST_report("event jitter, split blocks", spread(voice, TRACE_EVENTS), "samples");
+  HTST_report("event jitter, block quantised", quantised, "samples");
+
+  for (i = 0; i < 4; i++) {
+    pool.noteOn(48 + (12 * i), 100); }
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++) {
+    plain.process(plain.txBuffer(), plain.rxBuffer()); }
+  HTST_report("voice pool block, no events", (double)(HTST_nowNs() - start) / BENCH_BLOCKS, "ns");
+
+  /* a note on & off every block, at random offsets */
+  makeTrace(2 * BENCH_BLOCKS, BENCH_BLOCKS);
+  start = HTST_nowNs();
+  for (i = 0; i < (2 * BENCH_BLOCKS); i += 2)
+  {
+    trace[i].type = EVENT_NOTE_ON;
+    bus.schedule(EVENT_SRC_UART_MIDI, trace[i]);
+    trace[i + 1].type = EVENT_NOTE_OFF;
+    bus.schedule(EVENT_SRC_UART_MIDI, trace[i + 1]);
+    engine.process(engine.txBuffer(), engine.rxBuffer());
+  }
+  HTST_report("voice pool block, 2 events", (double)(HTST_nowNs() - start) / BENCH_BLOCKS, "ns");
+
+  return true;
+}
+
+
+/* random times & sources across the blocks, in time order */
+static void makeTrace(uint32_t events, uint32_t blocks)
+{
+  uint32_t seed = 12345;
+  uint32_t i, last = 0;
+  uint8_t src;
+
+  for (i = 0; i < events; i++)
+  {
+    seed = (seed * 1664525u) + 1013904223u;
+    src = (uint8_t)((seed >> 8) % EVENT_SRC_NUM_OF);
+
+    trace[i].time = (uint32_t)(((uint64_t)i * blocks * BLOCK_SIZE) / events) + ((seed >> 16) % BLOCK_SIZE);
+    if (trace[i].time < last) {
+      trace[i].time = last; }
+    last = trace[i].time;
+
+    trace[i].type = EVENT_NOTE_ON;
+    trace[i].channel = src;
+    trace[i].a = (uint8_t)(i & 0x7F);
+    trace[i].b = 100;
+    trace_src[i] = src;
+  }
+}
+
+
+/* queued the block before they're due, as if they had just arrived */
+static bool replay(AudioEngine &engine, EventBus &bus, uint32_t events, uint32_t blocks)
+{
+  uint32_t block, i = 0;
+
+  for (block = 1; block <= blocks; block++)
+  {
+    for (; (i < events) && (trace[i].time < (block * BLOCK_SIZE)); i++) {
+      HTST_check(bus.schedule((event_src_e)trace_src[i], trace[i])); }
+
+    engine.process(engine.txBuffer(), engine.rxBuffer());
+  }
+
+  return true;
+}
+
+
+/* max - min of when each event took effect against its time */
+static int32_t spread(TraceVoice const &voice, uint32_t events)
+{
+  int32_t error, min = INT32_MAX, max = INT32_MIN;
+  uint32_t i;
+
+  for (i = 0; i < events; i++)
+  {
+    error = (int32_t)(voice.at[i] - voice.got[i].time);
+    min = (error < min) ? error : min;
+    max = (error > max) ? error : max;
+  }
+
+  return max - min;
+}
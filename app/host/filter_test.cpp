@@ -0,0 +1,316 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "ladder.hpp"
+#include "svf.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define BENCH_BLOCKS    20000
+
+
+static float gainAt     (Processor<> &filter, float hz);
+static float peakAt     (Processor<> &filter, float hz);
+static bool  stable     (Processor<> &filter, void (*modulate)(Processor<> &, float), float bound);
+static void  svfCutoff  (Processor<> &filter, float hz);
+static void  ladderCutoff(Processor<> &filter, float hz);
+static float noise      (void);
+
+
+bool HTST_filter(void)
+{
+  static float const fc[] = {0.01f * SAMPLE_RATE, 0.1f * SAMPLE_RATE, 0.3f * SAMPLE_RATE, 0.4f * SAMPLE_RATE};
+  static float ramp[BLOCK_SIZE * 64];
+  static float exact[BLOCK_SIZE * 64];
+  float err, sig;
+  uint32_t i, f;
+
+  /* prewarped, the resonant peak stays on the cutoff right up to nyquist */
+  for (f = 0; f < SIZEOF(fc); f++)
+  {
+    Svf bp(Svf::MODE_BANDPASS);
+    Ladder lp;
+
+    bp.setCutoff(fc[f]);
+    bp.setResonance(0.9f);
+    HTST_check(fabsf(peakAt(bp, fc[f]) - fc[f]) <= (0.02f * fc[f]));
+
+    /* the analog ladder's own peak only reaches the cutoff as k -> 4 */
+    lp.setCutoff(fc[f]);
+    lp.setResonance(1.0f);
+    HTST_check(fabsf(peakAt(lp, fc[f]) - fc[f]) <= (0.02f * fc[f]));
+  }
+
+  /* shapes */
+  {
+    Svf svf(Svf::MODE_LOWPASS);
+    Ladder ladder;
+
+    svf.setCutoff(1000.0f);
+    HTST_check(gainAt(svf, 100.0f) > 0.95f);
+    HTST_check(gainAt(svf, 10000.0f) < 0.02f);
+    svf.setMode(Svf::MODE_HIGHPASS);
+    HTST_check(gainAt(svf, 100.0f) < 0.02f);
+    HTST_check(gainAt(svf, 10000.0f) > 0.95f);
+    svf.setMode(Svf::MODE_NOTCH);
+    HTST_check(gainAt(svf, 1000.0f) < 0.05f);
+
+    ladder.setCutoff(1000.0f);
+    HTST_check(gainAt(ladder, 100.0f) > 0.95f);
+    HTST_check(gainAt(ladder, 10000.0f) < 0.0002f);
+  }
+
+  /* full resonance, cutoff jumping anywhere every block */
+  {
+    Svf svf(Svf::MODE_BANDPASS);
+    Ladder ladder;
+
+    svf.setResonance(1.0f);
+    HTST_check(stable(svf, svfCutoff, 100.0f));
+    ladder.setResonance(1.0f);
+    HTST_check(stable(ladder, ladderCutoff, 100.0f));
+  }
+
+  /* a per block ramp tracks coefficients worked out every sample, even
+   * sweeping ~1 MHz/ s the difference is under -40 dB */
+  {
+    Svf block(Svf::MODE_LOWPASS);
+    Svf sample(Svf::MODE_LOWPASS);
+
+    block.setResonance(0.7f);
+    sample.setResonance(0.7f);
+
+    for (i = 0; i < SIZEOF(ramp); i++) {
+      ramp[i] = exact[i] = noise(); }
+
+    for (i = 0; i < SIZEOF(ramp); i++)
+    {
+      if (0 == (i % BLOCK_SIZE))
+      {
+        block.setCutoff(500.0f + (10.0f * (float)(i + BLOCK_SIZE)));
+        block.process(&ramp[i], BLOCK_SIZE);
+      }
+
+      sample.setCutoff(500.0f + (10.0f * (float)(i + 1)));
+      sample.process(&exact[i], 1);
+    }
+
+    for (i = 0, err = 0.0f, sig = 0.0f; i < SIZEOF(ramp); i++)
+    {
+      err += (ramp[i] - exact[i]) * (ramp[i] - exact[i]);
+      sig += exact[i] * exact[i];
+    }
+    HTST_check((err / sig) < 1e-4f);
+  }
+
+  return true;
+}
+
+
+/* every block has a new cutoff, as under an envelope */
+bool HTST_filterBench(void)
+{
+  float input[BLOCK_SIZE];
+  float block[BLOCK_SIZE];
+  Svf svf;
+  Ladder ladder;
+  uint64_t ns;
+  double svf_ns, ladder_ns;
+  uint32_t i, j;
+
+  /* fresh noise each block, filtering in place decays to denormals */
+  for (i = 0; i < BLOCK_SIZE; i++) {
+    input[i] = noise(); }
+
+  svf.setResonance(0.5f);
+  ns = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    memcpy(block, input, sizeof(block));
+    svf.setCutoff(200.0f + (float)(i & 1023) * 10.0f);
+    svf.process(block, BLOCK_SIZE);
+  }
+  svf_ns = (double)(HTST_nowNs() - ns) / BENCH_BLOCKS;
+
+  ladder.setResonance(0.5f);
+  ns = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    memcpy(block, input, sizeof(block));
+    ladder.setCutoff(200.0f + (float)(i & 1023) * 10.0f);
+    ladder.process(block, BLOCK_SIZE);
+  }
+  ladder_ns = (double)(HTST_nowNs() - ns) / BENCH_BLOCKS;
+
+  HTST_report("svf per voice per block", svf_ns, "ns");
+  HTST_report("ladder per voice per block", ladder_ns, "ns");
+
+  /* what the ramp saves, tan() every sample */
+  ns = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    memcpy(block, input, sizeof(block));
+    for (j = 0; j < BLOCK_SIZE; j++)
+    {
+      svf.setCutoff(200.0f + (float)((i + j) & 1023) * 10.0f);
+      svf.process(&block[j], 1);
+    }
+  }
+  HTST_report("svf per sample coeffs per voice per block", (double)(HTST_nowNs() - ns) / BENCH_BLOCKS, "ns");
+
+  ns = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    memcpy(block, input, sizeof(block));
+    for (j = 0; j < BLOCK_SIZE; j++)
+    {
+      ladder.setCutoff(200.0f + (float)((i + j) & 1023) * 10.0f);
+      ladder.process(&block[j], 1);
+    }
+  }
+  HTST_report("ladder per sample coeffs per voice per block", (double)(HTST_nowNs() - ns) / BENCH_BLOCKS, "ns");
+
+  HTST_report("svf 8 voice load", (svf_ns * 8.0 * SAMPLE_RATE * 100.0) / (BLOCK_SIZE * 1e9), "%");
+  HTST_report("ladder 8 voice load", (ladder_ns * 8.0 * SAMPLE_RATE * 100.0) / (BLOCK_SIZE * 1e9), "%");
+
+  return true;
+}
+
+
+/* steady state sine gain */
+static float gainAt(Processor<> &filter, float hz)
+{
+  float block[BLOCK_SIZE];
+  float phase = 0.0f;
+  float peak = 0.0f;
+  uint32_t b, i;
+
+  for (b = 0; b < (SAMPLE_RATE / BLOCK_SIZE); b++)
+  {
+    for (i = 0; i < BLOCK_SIZE; i++)
+    {
+      block[i] = sinf(6.2831853f * phase);
+      phase += hz / SAMPLE_RATE;
+      if (phase >= 1.0f) {
+        phase -= 1.0f; }
+    }
+
+    filter.process(block, BLOCK_SIZE);
+
+    /* last quarter second */
+    if (b >= ((3 * SAMPLE_RATE) / (4 * BLOCK_SIZE)))
+    {
+      for (i = 0; i < BLOCK_SIZE; i++) {
+        peak = fmaxf(peak, fabsf(block[i])); }
+    }
+  }
+
+  return peak;
+}
+
+
+/* loudest of a sweep across +/-10% */
+static float peakAt(Processor<> &filter, float hz)
+{
+  float best = 0.0f;
+  float best_hz = 0.0f;
+  float f, g;
+
+  for (f = 0.9f * hz; f <= (1.1f * hz); f += (0.005f * hz))
+  {
+    g = gainAt(filter, f);
+    if (g > best)
+    {
+      best = g;
+      best_hz = f;
+    }
+  }
+
+  return best_hz;
+}
+
+
+/* noise in with random cutoffs, bounded & finite, then rings down to silence */
+static bool stable(Processor<> &filter, void (*modulate)(Processor<> &, float), float bound)
+{
+  float block[BLOCK_SIZE];
+  uint32_t b, i;
+
+  for (b = 0; b < 4000; b++)
+  {
+    modulate(filter, 10.0f + ((0.5f * SAMPLE_RATE) * (0.5f + (0.5f * noise()))));
+
+    for (i = 0; i < BLOCK_SIZE; i++) {
+      block[i] = noise(); }
+
+    filter.process(block, BLOCK_SIZE);
+
+    for (i = 0; i < BLOCK_SIZE; i++)
+    {
+      if (!std::isfinite(block[i]) || (fabsf(block[i]) > bound)) {
+        return false; }
+    }
+  }
+
+  modulate(filter, 1000.0f);
+
+  for (b = 0; b < (SAMPLE_RATE / BLOCK_SIZE); b++)
+  {
+    memset(block, 0, sizeof(block));
+    filter.process(block, BLOCK_SIZE);
+  }
+
+  return fabsf(block[BLOCK_SIZE - 1]) < 1e-3f;
+}
+
+
+static void svfCutoff(Processor<> &filter, float hz)
+{
+  static_cast<Svf &>(filter).setCutoff(hz);
+}
+
+static void ladderCutoff(Processor<> &filter, float hz)
+{
+  static_cast<Ladder &>(filter).setCutoff(hz);
+}
+
+
+/* +/-1, repeatable */
+static float noise(void)
+{
+  static uint32_t x = 22222;
+
+  x = (x * 1664525u) + 1013904223u;
+
+  return (float)(int32_t)x * (1.0f / 2147483648.0f);
+}
@@ -0,0 +1,115 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __HOST_TEST_H
+#define __HOST_TEST_H
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/**
+ * @file host_test.h
+ * @brief tests & benchmarks run by the host build (make target=host test)
+ * each returns true on pass, benchmarks report their numbers through
+ * HTST_report so they can be collected and compared between commits
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* helpers */
+extern uint64_t HTST_nowNs  (void);
+extern void     HTST_report (char const *name, double value, char const *unit);
+extern void     HTST_settle (void);
+
+#define HTST_check(cond) \
+  if (!(cond)) { printf("  %s:%d check failed: %s\n", __FILE__, __LINE__, #cond); return false; }
+
+/* tests */
+extern bool HTST_board      (void);
+extern bool HTST_audio      (void);
+extern bool HTST_i2s        (void);
+extern bool HTST_regmap     (void);
+extern bool HTST_voicePool  (void);
+extern bool HTST_wavetable  (void);
+extern bool HTST_polyBlep   (void);
+extern bool HTST_number     (void);
+extern bool HTST_filter     (void);
+extern bool HTST_biquad     (void);
+extern bool HTST_sampler    (void);
+extern bool HTST_sampleCache (void);
+extern bool HTST_resonator  (void);
+extern bool HTST_allocator  (void);
+extern bool HTST_ring       (void);
+extern bool HTST_parameter  (void);
+extern bool HTST_modMatrix  (void);
+extern bool HTST_lfo        (void);
+extern bool HTST_envelope   (void);
+extern bool HTST_eventBus   (void);
+extern bool HTST_usart      (void);
+extern bool HTST_midiParser (void);
+extern bool HTST_midiOut    (void);
+extern bool HTST_usbMidi    (void);
+extern bool HTST_adc        (void);
+
+/* benchmarks */
+extern bool HTST_audioBench (void);
+extern bool HTST_voicePoolBench (void);
+extern bool HTST_wavetableBench (void);
+extern bool HTST_polyBlepBench (void);
+extern bool HTST_numberBench (void);
+extern bool HTST_filterBench (void);
+extern bool HTST_biquadBench (void);
+extern bool HTST_samplerBench (void);
+extern bool HTST_sampleCacheBench (void);
+extern bool HTST_resonatorBench (void);
+extern bool HTST_ringBench (void);
+extern bool HTST_parameterBench (void);
+extern bool HTST_modMatrixBench (void);
+extern bool HTST_lfoBench (void);
+extern bool HTST_envelopeBench (void);
+extern bool HTST_eventBusBench (void);
+extern bool HTST_usartBench (void);
+extern bool HTST_midiParserBench (void);
+extern bool HTST_midiOutBench (void);
+extern bool HTST_usbMidiBench (void);
+extern bool HTST_adcBench   (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
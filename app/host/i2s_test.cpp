@@ -0,0 +1,236 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "audio.hpp"
+
+#include "board.h"
+#include "chips.h"
+#include "config_board.h"
+
+#include "host.h"
+#include "i2s.h"
+
+#include <stdio.h>
+
+
+#define HALF_FRAMES     (32)
+#define HALF_SAMPLES    (HALF_FRAMES * 2)
+#define MAX_CALLS       (16)
+
+
+typedef struct
+{
+  uint32_t calls;
+  int16_t  rx_first[MAX_CALLS];
+  int32_t  found_at;
+} probe_t;
+
+
+static uint16_t codec_reg[16];
+static bool     codec_reset;
+
+static int16_t  tx[2 * HALF_SAMPLES];
+static int16_t  rx[2 * HALF_SAMPLES];
+
+
+/* registers are write only, 7 bit address + 9 bit value */
+static bool codecModel(bool read, uint16_t mem_addr, uint8_t mem_length,
+                       uint8_t *data, uint16_t length, void *ctx)
+{
+  uint8_t reg;
+
+  (void)mem_addr;
+  (void)mem_length;
+  (void)ctx;
+
+  if (read || (2 != length)) {
+    return false; }
+
+  reg = data[0] >> 1;
+  codec_reg[reg] = (uint16_t)(((data[0] & 1) << 8) | data[1]);
+
+  if (0x0F == reg) {
+    codec_reset = true; }
+
+  return true;
+}
+
+/* impulse out on the first call, then look for it coming back */
+static void impulseCb(int16_t *tx_half, int16_t const *rx_half, uint16_t length, void *ctx)
+{
+  probe_t *p = (probe_t*)ctx;
+  uint16_t i;
+
+  memset(tx_half, 0, length * sizeof(int16_t));
+
+  if (0 == p->calls) {
+    tx_half[0] = 1000; }
+
+  for (i = 0; (i < length) && (p->found_at < 0); i += 2)
+  {
+    if (rx_half[i]) {
+      p->found_at = (int32_t)((p->calls * (length / 2)) + (i / 2)); }
+  }
+
+  p->calls++;
+}
+
+/* every half sent holds the number of the call that wrote it */
+static void countCb(int16_t *tx_half, int16_t const *rx_half, uint16_t length, void *ctx)
+{
+  probe_t *p = (probe_t*)ctx;
+  uint16_t i;
+
+  if (p->calls < MAX_CALLS) {
+    p->rx_first[p->calls] = rx_half[0]; }
+
+  p->calls++;
+
+  for (i = 0; i < length; i++) {
+    tx_half[i] = (int16_t)p->calls; }
+}
+
+class RampVoice : public Voice
+{
+  public:
+    void render(float *out, size_t frames)
+    {
+      size_t i;
+
+      for (i = 0; i < frames; i++) {
+        out[i] = (float)i / (float)frames; }
+    }
+};
+
+
+/* codec bring up & the engine running from the dma callbacks */
+static bool codec(void)
+{
+  RampVoice voice;
+  AudioEngine engine(voice);
+
+  memset(codec_reg, 0, sizeof(codec_reg));
+  codec_reset = false;
+
+  HTST_check(HOST_I2C_attach(WM8731_I2C_CH, WM8731_ADDR, codecModel, NULL));
+  HTST_check(BRD_audioStart(SAMPLE_RATE,
+                            engine.txBuffer(),
+                            engine.rxBuffer(),
+                            engine.bufferLength(),
+                            AudioEngine::i2sCallback,
+                            &engine));
+
+  /* the codec is set up from the main loop */
+  HTST_settle();
+  HOST_I2C_detachAll(WM8731_I2C_CH);
+
+  /* reset, i2s 16 bit, codec master, active with outputs powered */
+  HTST_check(codec_reset);
+  HTST_check(0x42 == codec_reg[0x07]);
+  HTST_check(0x01 == codec_reg[0x09]);
+  HTST_check(0 == (codec_reg[0x06] & (1 << 4)));
+
+  HTST_check(HOST_I2S_setLoopback(WM8731_I2S_CH, 0));
+  HOST_I2S_run(WM8731_I2S_CH, 8);
+  HTST_check(8 == engine.load().blocks);
+
+  /* rendered ramp made it back round */
+  HOST_I2S_run(WM8731_I2S_CH, 2);
+  HTST_check(0 == engine.input()[0]);
+  HTST_check(engine.input()[2] > 0);
+  HTST_check(engine.input()[2] == engine.input()[3]);
+
+  HTST_check(I2S_stop(WM8731_I2S_CH));
+
+  return true;
+}
+
+/* round trip is two halves plus whatever the codec adds */
+static bool latency(uint16_t frames)
+{
+  probe_t p;
+
+  memset(&p, 0, sizeof(p));
+  p.found_at = -1;
+
+  HTST_check(HOST_I2S_setLoopback(WM8731_I2S_CH, frames));
+  HTST_check(I2S_start(WM8731_I2S_CH, tx, rx, SIZEOF(tx), impulseCb, &p));
+  HOST_I2S_run(WM8731_I2S_CH, 8 + (2 * frames / HALF_FRAMES));
+  HTST_check(I2S_stop(WM8731_I2S_CH));
+
+  HTST_check((2 * HALF_FRAMES + frames) == p.found_at);
+
+  return true;
+}
+
+/* a late callback means the previous contents of that half go out again */
+static bool dropout(void)
+{
+  probe_t p;
+  HOST_i2s_stats_t before;
+  HOST_i2s_stats_t after;
+
+  memset(&p, 0, sizeof(p));
+  memset(tx, 0, sizeof(tx));
+  HOST_I2S_getStats(WM8731_I2S_CH, &before);
+
+  HTST_check(HOST_I2S_setLoopback(WM8731_I2S_CH, 0));
+  HTST_check(I2S_start(WM8731_I2S_CH, tx, rx, SIZEOF(tx), countCb, &p));
+  HOST_I2S_run(WM8731_I2S_CH, 4);
+  HOST_I2S_dropNext(WM8731_I2S_CH);
+  HOST_I2S_run(WM8731_I2S_CH, 6);
+  HTST_check(I2S_stop(WM8731_I2S_CH));
+
+  HOST_I2S_getStats(WM8731_I2S_CH, &after);
+
+  /* each half is heard 2 calls after it was written */
+  HTST_check(3 == p.rx_first[4]);
+  HTST_check(4 == p.rx_first[5]);
+  /* call 5 was late, so the codec got call 3's block again */
+  HTST_check(3 == p.rx_first[6]);
+  HTST_check(6 == p.rx_first[7]);
+  HTST_check(7 == p.rx_first[8]);
+  HTST_check(1 == (after.dropouts - before.dropouts));
+
+  return true;
+}
+
+
+bool HTST_i2s(void)
+{
+  HTST_check(codec());
+  HTST_check(latency(0));
+  HTST_check(latency(1));
+  HTST_check(latency(100));
+  HTST_check(dropout());
+
+  return true;
+}
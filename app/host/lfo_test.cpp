@@ -0,0 +1,170 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "lfo.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define TWO_PI          6.28318531f
+
+#define BENCH_BLOCKS    200000u
+
+
+/* shapes, rate, random shapes, sync to a clock & retrigger */
+bool HTST_lfo(void)
+{
+  Lfo lfo(Lfo::SHAPE_SINE, 3.0f);
+  Lfo synced(Lfo::SHAPE_SAW);
+  Lfo other(Lfo::SHAPE_SAW);
+  Lfo rnd(Lfo::SHAPE_SAMPLE_HOLD, 50.0f, 1234);
+  Clock clock(120.0f);
+  float t, v, last, hold, err = 0.0f;
+  uint32_t i, changes = 0;
+
+  /* sine against sinf at the end of every block, for a few seconds */
+  for (i = 1; i <= (3 * SAMPLE_RATE) / BLOCK_SIZE; i++)
+  {
+    v = lfo.update(BLOCK_SIZE);
+    t = (float)(i * BLOCK_SIZE) / SAMPLE_RATE;
+    err = fmaxf(err, fabsf(v - sinf(TWO_PI * fmodf(3.0f * t, 1.0f))));
+  }
+  HTST_check(err < 1.0e-3f);
+
+  /* triangle & saw at known points of the cycle, 1 Hz is SAMPLE_RATE long */
+  lfo.setFrequency(1.0f);
+  lfo.setShape(Lfo::SHAPE_TRIANGLE);
+  lfo.trigger();
+  HTST_check(fabsf(lfo.update(SAMPLE_RATE / 4)) > 0.9999f);
+  HTST_check(fabsf(lfo.update(SAMPLE_RATE / 8) - 0.5f) < 1.0e-4f);
+  HTST_check(fabsf(lfo.update(SAMPLE_RATE / 2) + 0.5f) < 1.0e-4f);
+
+  lfo.setShape(Lfo::SHAPE_SAW);
+  lfo.setStart(0.5f);
+  lfo.trigger();
+  HTST_check(fabsf(lfo.update(0)) < 1.0e-6f);
+  HTST_check(fabsf(lfo.update(SAMPLE_RATE / 4) - 0.5f) < 1.0e-4f);
+
+  /* sample & hold only moves when the cycle wraps, 50 Hz is 60 blocks */
+  hold = rnd.update(BLOCK_SIZE);
+  for (i = 0; i < 6000; i++)
+  {
+    v = rnd.update(BLOCK_SIZE);
+    HTST_check((v >= -1.0f) && (v <= 1.0f));
+    if (v != hold) {
+      changes++; }
+    hold = v;
+  }
+  HTST_check((changes >= 99) && (changes <= 101));
+
+  /* smooth random never steps */
+  rnd.setShape(Lfo::SHAPE_SMOOTH_RANDOM);
+  last = rnd.update(BLOCK_SIZE);
+  err = 0.0f;
+  for (i = 0; i < 6000; i++)
+  {
+    v = rnd.update(BLOCK_SIZE);
+    err = fmaxf(err, fabsf(v - last));
+    last = v;
+  }
+  HTST_check(err < (2.0f * 3.1416f / 60.0f));
+
+  /* a cycle a beat & four, 120 bpm is 0.5 s a beat, 9/8 of a beat in */
+  synced.setSync(&clock, 1.0f);
+  other.setSync(&clock, 0.25f);
+  for (i = 0; i < ((SAMPLE_RATE * 9) / 16); i += BLOCK_SIZE) {
+    clock.advance(BLOCK_SIZE); }
+  HTST_check(fabsf(synced.update(0) + 0.75f) < 0.01f);
+  HTST_check(fabsf(other.update(0)) < 0.01f);
+
+  /* tempo follows midi clock, 24 pulses a beat at 100 bpm */
+  for (i = 0; i < (4 * Clock::PPQN); i++)
+  {
+    clock.advance((60 * SAMPLE_RATE) / (100 * Clock::PPQN));
+    clock.pulse();
+  }
+  HTST_check(fabsf(clock.tempo() - 100.0f) < 0.1f);
+
+  /* retrigger puts the synced cycle back at its start */
+  synced.setStart(0.25f);
+  clock.advance(777);
+  synced.trigger();
+  HTST_check(fabsf(synced.update(0) + 0.5f) < 1.0e-4f);
+  clock.advance(SAMPLE_RATE * 60 / 100 / 2);
+  HTST_check(fabsf(synced.update(0) - 0.5f) < 0.01f);
+
+  return true;
+}
+
+
+/* one lookup a block against sinf a sample, for a full set of voices */
+bool HTST_lfoBench(void)
+{
+  static Lfo lfo[MAX_VOICES];
+  static float out[BLOCK_SIZE];
+  float phase[MAX_VOICES] = {0.0f};
+  float sum = 0.0f;
+  uint64_t start;
+  uint32_t i, j, v;
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    lfo[v].setFrequency(0.5f + v); }
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    for (v = 0; v < MAX_VOICES; v++) {
+      sum += lfo[v].update(BLOCK_SIZE); }
+  }
+  HTST_report("lfo x 8 voices, block rate", (double)(HTST_nowNs() - start) / BENCH_BLOCKS, "ns/block");
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    for (v = 0; v < MAX_VOICES; v++)
+    {
+      for (j = 0; j < BLOCK_SIZE; j++)
+      {
+        phase[v] += (0.5f + v) / SAMPLE_RATE;
+        phase[v] -= (phase[v] >= 1.0f) ? 1.0f : 0.0f;
+        out[j] = sinf(TWO_PI * phase[v]);
+      }
+      sum += out[BLOCK_SIZE - 1];
+    }
+  }
+  HTST_report("sinf x 8 voices, per sample", (double)(HTST_nowNs() - start) / BENCH_BLOCKS, "ns/block");
+
+  if (sum == 12345.0f) {
+    printf("  %f\n", sum); }
+
+  return true;
+}
@@ -0,0 +1,180 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+/* clock_gettime is posix, not c99 */
+#define _POSIX_C_SOURCE 200809L
+
+
+#include "host_test.h"
+
+#include "board.h"
+#include "mevent.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+
+typedef struct
+{
+  char const *name;
+  bool (*fn)(void);
+} entry_t;
+
+
+static entry_t const tests[] =
+{
+  {"board",           HTST_board},
+  {"audio",           HTST_audio},
+  {"i2s",             HTST_i2s},
+  {"regmap",          HTST_regmap},
+  {"voice_pool",      HTST_voicePool},
+  {"wavetable",       HTST_wavetable},
+  {"polyblep",        HTST_polyBlep},
+  {"number",          HTST_number},
+  {"filter",          HTST_filter},
+  {"biquad",          HTST_biquad},
+  {"sampler",         HTST_sampler},
+  {"sample_cache",    HTST_sampleCache},
+  {"resonator",       HTST_resonator},
+  {"allocator",       HTST_allocator},
+  {"ring",            HTST_ring},
+  {"parameter",       HTST_parameter},
+  {"mod_matrix",      HTST_modMatrix},
+  {"lfo",             HTST_lfo},
+  {"envelope",        HTST_envelope},
+  {"event_bus",       HTST_eventBus},
+  {"usart",           HTST_usart},
+  {"midi_parser",     HTST_midiParser},
+  {"midi_out",        HTST_midiOut},
+  {"usb_midi",        HTST_usbMidi},
+  {"adc",             HTST_adc},
+  {NULL,              NULL},
+};
+
+static entry_t const benches[] =
+{
+  {"audio",           HTST_audioBench},
+  {"voice_pool",      HTST_voicePoolBench},
+  {"wavetable",       HTST_wavetableBench},
+  {"polyblep",        HTST_polyBlepBench},
+  {"number",          HTST_numberBench},
+  {"filter",          HTST_filterBench},
+  {"biquad",          HTST_biquadBench},
+  {"sampler",         HTST_samplerBench},
+  {"sample_cache",    HTST_sampleCacheBench},
+  {"resonator",       HTST_resonatorBench},
+  {"ring",            HTST_ringBench},
+  {"parameter",       HTST_parameterBench},
+  {"mod_matrix",      HTST_modMatrixBench},
+  {"lfo",             HTST_lfoBench},
+  {"envelope",        HTST_envelopeBench},
+  {"event_bus",       HTST_eventBusBench},
+  {"usart",           HTST_usartBench},
+  {"midi_parser",     HTST_midiParserBench},
+  {"midi_out",        HTST_midiOutBench},
+  {"usb_midi",        HTST_usbMidiBench},
+  {"adc",             HTST_adcBench},
+  {NULL,              NULL},
+};
+
+
+static int run(entry_t const *entries, char const *filter);
+
+
+int main(int argc, char **argv)
+{
+  char const *mode = (argc > 1) ? argv[1] : "test";
+  char const *filter = (argc > 2) ? argv[2] : NULL;
+
+  BRD_init();
+
+  if (0 == strcmp(mode, "test")) {
+    return run(tests, filter); }
+
+  if (0 == strcmp(mode, "bench")) {
+    return run(benches, filter); }
+
+  printf("usage: %s [test|bench] [name filter]\n", argv[0]);
+
+  return 1;
+}
+
+
+uint64_t HTST_nowNs  (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+void     HTST_report (char const *name, double value, char const *unit)
+{
+  printf("  %-40s %12.3f %s\n", name, value, unit);
+}
+
+/* the main loop until the board has nothing left to do */
+void     HTST_settle (void)
+{
+  while (MEVE_isGlobalPending()) {
+    BRD_task(); }
+}
+
+
+static int run(entry_t const *entries, char const *filter)
+{
+  uint32_t passed = 0;
+  uint32_t failed = 0;
+  entry_t const *e;
+
+  for (e = entries; e->name; e++)
+  {
+    if (filter && (NULL == strstr(e->name, filter))) {
+      continue; }
+
+    printf("[ RUN  ] %s\n", e->name);
+
+    if (e->fn())
+    {
+      printf("[ PASS ] %s\n", e->name);
+      passed++;
+    }
+    else
+    {
+      printf("[ FAIL ] %s\n", e->name);
+      failed++;
+    }
+  }
+
+  printf("\n%u passed, %u failed\n", passed, failed);
+
+  return failed ? 1 : 0;
+}
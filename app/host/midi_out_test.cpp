@@ -0,0 +1,320 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "midi_out.hpp"
+
+#include "host.h"
+#include "usart.h"
+
+#include <stdio.h>
+
+
+#define CH              USART_CH_2
+#define MAX_WIRE        64
+#define MAX_CLOCKS      512
+
+/* 120 bpm at 24 ppqn */
+#define CLOCK_NS        (60000000000ull / (120 * 24))
+/* the main loop, once an audio block */
+#define SERVICE_NS      ((1000000000ull * BLOCK_SIZE) / SAMPLE_RATE)
+
+
+typedef struct
+{
+  uint8_t  bytes[MAX_WIRE];
+  uint32_t length;
+  uint64_t clock_ns[MAX_CLOCKS];
+  uint32_t clocks;
+} wire_t;
+
+typedef struct
+{
+  double min_us;              ///< clock() to its stop bit
+  double max_us;
+  uint32_t cc;                ///< controllers sent alongside
+  uint32_t dropped;           ///< clocks that did not fit
+} jitter_t;
+
+
+static wire_t wire;
+
+
+static void reset     (void);
+static void sinkFn    (uint8_t byte, uint64_t ns, void *ctx);
+static bool drain     (MidiOut &out);
+static bool simulate  (bool shaped, uint32_t clocks, jitter_t *j);
+
+
+/* running status, merging, realtime cutting in & what it does to clock timing */
+bool HTST_midiOut(void)
+{
+  uint8_t const thru[] = {0xB0, 7, 100, 8, 0xF8, 101, 9, 102};
+  uint8_t const expect_rs[] = {0x90, 60, 100, 62, 100, 60, 0, 0x80, 62, 10, 0xF3, 1, 0x80, 64, 10};
+  uint8_t const expect_rt[] = {0x90, 60, 0xFA, 0xF8, 100};
+  MidiOut out(CH, 1);
+  MidiParser parser(out);
+  jitter_t j;
+  uint32_t i, note_at = 0;
+
+  /* status once for the run, a plain note off runs as a note on */
+  reset();
+  HTST_check(out.send(MIDI_OUT_SRC_SEQUENCER, 0x90, 60, 100));
+  HTST_check(out.send(MIDI_OUT_SRC_SEQUENCER, 0x90, 62, 100));
+  HTST_check(out.send(MIDI_OUT_SRC_SEQUENCER, 0x80, 60, 64));
+  HTST_check(out.send(MIDI_OUT_SRC_SEQUENCER, 0x80, 62, 10));
+  HTST_check(out.send(MIDI_OUT_SRC_SEQUENCER, 0xF3, 1));
+  HTST_check(out.send(MIDI_OUT_SRC_SEQUENCER, 0x80, 64, 10));
+  HTST_check(drain(out));
+  HTST_check((sizeof(expect_rs) == wire.length) && (0 == memcmp(wire.bytes, expect_rs, sizeof(expect_rs))));
+  HTST_check(2 == out.saved());
+
+  /* realtime goes in between the bytes of a message */
+  reset();
+  out.reset();
+  HTST_check(out.send(MIDI_OUT_SRC_SEQUENCER, 0x90, 60, 100));
+  out.service();
+  HOST_USART_run(CH, 10 * 1000000000ull / USART_MIDI_BAUD);
+  out.service();
+  HTST_check(out.realtime(MIDI_OUT_SRC_SEQUENCER, 0xFA));
+  HTST_check(out.realtime(MIDI_OUT_SRC_THRU, 0xF8));
+  out.service();
+  HTST_check(drain(out));
+  HTST_check((sizeof(expect_rt) == wire.length) && (0 == memcmp(wire.bytes, expect_rt, sizeof(expect_rt))));
+
+  /* thru from the parser & a note from the sequencer take turns */
+  reset();
+  out.reset();
+  parser.parse(thru, sizeof(thru), 0);
+  HTST_check(out.send(MIDI_OUT_SRC_SEQUENCER, 0x91, 36, 90));
+  HTST_check(drain(out));
+
+  for (i = 0; i < wire.length; i++)
+  {
+    if (0x91 == wire.bytes[i]) {
+      note_at = i; }
+  }
+
+  /* status again after the note, then the controllers run */
+  HTST_check((0xF8 == wire.bytes[0]) && (1 == note_at));
+  HTST_check((11 == wire.length) && (0xB0 == wire.bytes[4]) && (102 == wire.bytes[10]));
+
+  /* full queue, nothing waits on the wire for it */
+  reset();
+  out.reset();
+  for (i = 0; i < MIDI_OUT_QUEUE_LEN; i++) {
+    HTST_check(out.send(MIDI_OUT_SRC_UI, 0xB0, 1, (uint8_t)i)); }
+  HTST_check(false == out.send(MIDI_OUT_SRC_UI, 0xB0, 1, 0));
+  HTST_check(1 == out.dropped());
+  HTST_check(false == out.send(MIDI_OUT_SRC_UI, 0x40, 1, 0));
+  HTST_check(drain(out));
+
+  /* sysex start & end are refused, nothing reaches the wire */
+  reset();
+  out.reset();
+  HTST_check(false == out.send(MIDI_OUT_SRC_UI, 0xF0, 0, 0));
+  HTST_check(false == out.send(MIDI_OUT_SRC_SEQUENCER, 0xF7, 0, 0));
+  HTST_check(2 == out.dropped());
+  HTST_check(drain(out));
+  HTST_check(0 == wire.length);
+
+  /* clock against a flood of controllers, within a few bytes of when it was sent */
+  HTST_check(simulate(true, 100, &j));
+  HTST_check(j.max_us <= (3 * 320.0));
+  HTST_check(j.min_us >= 320.0);
+  HTST_check(j.cc > 100 * 20);
+  HTST_check(0 == j.dropped);
+
+  USART_deInit(CH);
+
+  return true;
+}
+
+
+/* clock jitter under full controller load, paced against straight to the usart */
+bool HTST_midiOutBench(void)
+{
+  jitter_t shaped, direct;
+
+  simulate(true, 500, &shaped);
+  simulate(false, 500, &direct);
+
+  HTST_report("midi out clock delay min, paced", shaped.min_us, "us");
+  HTST_report("midi out clock delay max, paced", shaped.max_us, "us");
+  HTST_report("midi out clock jitter, paced", shaped.max_us - shaped.min_us, "us");
+  HTST_report("midi out controllers per clock, paced", (double)shaped.cc / 500, "cc");
+  HTST_report("midi out clock jitter, straight to usart", direct.max_us - direct.min_us, "us");
+  HTST_report("midi out clock delay max, straight to usart", direct.max_us, "us");
+  HTST_report("midi out clocks dropped, straight to usart", direct.dropped, "of 500");
+
+  USART_deInit(CH);
+
+  return true;
+}
+
+
+static void reset(void)
+{
+  USART_cfg_t cfg;
+
+  cfg.baud = USART_MIDI_BAUD;
+
+  USART_deInit(CH);
+  USART_init(CH, &cfg);
+  USART_setRxCallback(CH, NULL, NULL);
+  HOST_USART_setLoopback(CH, false);
+  HOST_USART_attach(CH, sinkFn, &wire);
+
+  memset(&wire, 0, sizeof(wire));
+}
+
+static void sinkFn(uint8_t byte, uint64_t ns, void *ctx)
+{
+  wire_t *w = (wire_t*)ctx;
+
+  if (w->length < MAX_WIRE) {
+    w->bytes[w->length++] = byte; }
+
+  if ((0xF8 == byte) && (w->clocks < MAX_CLOCKS)) {
+    w->clock_ns[w->clocks++] = ns; }
+}
+
+/* service a byte at a time until everything is on the wire */
+static bool drain(MidiOut &out)
+{
+  uint32_t i;
+
+  for (i = 0; i < 1000; i++)
+  {
+    out.service();
+    HOST_USART_run(CH, 10 * 1000000000ull / USART_MIDI_BAUD);
+
+    if (0 == USART_txPending(CH))
+    {
+      out.service();
+
+      if (0 == USART_txPending(CH)) {
+        return true; }
+    }
+  }
+
+  return false;
+}
+
+/* controllers as fast as they will go, a clock every pulse, serviced once a block */
+static bool simulate(bool shaped, uint32_t clocks, jitter_t *j)
+{
+  uint8_t const tick = 0xF8;
+  uint8_t cc[3] = {0xB0, 1, 0};
+  MidiOut out(CH);
+  uint64_t called[MAX_CLOCKS];
+  uint64_t now, next_clock, next_service, to;
+  uint32_t n = 0, queued = 0, i;
+  bool ok;
+  double us;
+
+  reset();
+
+  if (clocks > MAX_CLOCKS) {
+    clocks = MAX_CLOCKS; }
+
+  j->min_us = 1e9;
+  j->max_us = 0.0;
+  j->cc = 0;
+  j->dropped = 0;
+
+  now = HOST_USART_now(CH);
+  next_clock = now + CLOCK_NS;
+  next_service = now;
+
+  while (n < clocks)
+  {
+    to = (next_clock < next_service) ? next_clock : next_service;
+    HOST_USART_run(CH, to - now);
+    now = to;
+
+    if (now == next_clock)
+    {
+      n++;
+      next_clock += CLOCK_NS;
+
+      if (shaped)
+      {
+        ok = out.realtime(MIDI_OUT_SRC_SEQUENCER, tick);
+        out.service();
+      }
+      else {
+        ok = USART_write(CH, &tick, 1); }
+
+      if (ok) {
+        called[queued++] = now; }
+    }
+
+    if (now == next_service)
+    {
+      next_service += SERVICE_NS;
+
+      /* keep the thru queue topped up, or the usart less room for the clock */
+      for (;;)
+      {
+        cc[2] = (uint8_t)(j->cc & 0x7F);
+
+        if (shaped ? (false == out.send(MIDI_OUT_SRC_THRU, cc[0], cc[1], cc[2])) :
+                     ((USART_txFree(CH) < (sizeof(cc) + 1)) || (false == USART_write(CH, cc, sizeof(cc))))) {
+          break; }
+
+        j->cc++;
+      }
+
+      if (shaped) {
+        out.service(); }
+    }
+  }
+
+  /* let the last clocks out */
+  HOST_USART_run(CH, 1000000000ull);
+
+  j->dropped = clocks - queued;
+
+  if (wire.clocks != queued) {
+    return false; }
+
+  for (i = 0; i < queued; i++)
+  {
+    us = (double)(wire.clock_ns[i] - called[i]) / 1e3;
+
+    if (us < j->min_us) {
+      j->min_us = us; }
+    if (us > j->max_us) {
+      j->max_us = us; }
+  }
+
+  return true;
+}
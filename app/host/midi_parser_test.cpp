@@ -0,0 +1,289 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "midi_parser.hpp"
+
+#include <stdio.h>
+
+
+#define MAX_MSGS        32
+#define DUMP_LEN        (16 * 1024)
+#define BENCH_PASSES    200
+
+
+class LogHandler : public MidiParser::Handler
+{
+  public:
+    LogHandler(void) { clear(); }
+
+    void clear(void)
+    {
+      msgs = 0;
+      sysex_bytes = 0;
+      sysex_chunks = 0;
+      sysex_last = 0;
+    }
+
+    void message(midi_msg_t const &msg)
+    {
+      if (msgs < MAX_MSGS) {
+        msg_log[msgs] = msg; }
+
+      msgs++;
+    }
+
+    void sysex(uint8_t const *data, uint16_t length, bool last)
+    {
+      if ((sysex_bytes + length) <= sizeof(sysex_data)) {
+        memcpy(&sysex_data[sysex_bytes], data, length); }
+
+      sysex_bytes += length;
+      sysex_chunks++;
+      sysex_last += last;
+    }
+
+    midi_msg_t msg_log[MAX_MSGS];
+    uint32_t msgs;
+    uint8_t  sysex_data[64];
+    uint32_t sysex_bytes;
+    uint32_t sysex_chunks;
+    uint32_t sysex_last;
+};
+
+/* counts only, what the bench pays for */
+class CountHandler : public MidiParser::Handler
+{
+  public:
+    CountHandler(void) : sum(0), n(0) {}
+
+    void message(midi_msg_t const &msg) { sum += msg.data[1]; n++; }
+
+    uint32_t sum;
+    uint32_t n;
+};
+
+
+static uint8_t dump[DUMP_LEN];
+
+
+static bool     is      (midi_msg_t const &m, uint32_t time, uint8_t status, uint8_t a, uint8_t b);
+static uint32_t record  (uint8_t *out, uint32_t length, uint32_t *messages);
+
+
+/* running status, realtime in the middle, sysex in chunks, timestamps */
+bool HTST_midiParser(void)
+{
+  uint8_t buf[4];
+  LogHandler rec;
+  MidiParser parser(rec, buf, sizeof(buf));
+  EventBus bus;
+  MidiToBus to_bus(bus, EVENT_SRC_UART_MIDI);
+  LogHandler thru;
+  MidiTee din_split(to_bus, thru);
+  MidiParser din(din_split);
+  event_t e;
+  uint32_t i, len, expected, offset;
+
+  uint8_t const running[] = {0x90, 60, 100, 62, 0, 0xB1, 7};
+  uint8_t const rt[] = {0x90, 64, 0xF8, 90, 0xFA};
+  uint8_t const common[] = {0xF3, 5, 60, 100, 0xF6, 0xC2, 9, 10};
+  uint8_t const sx[] = {0xF0, 1, 2, 3, 0xF8, 4, 5, 6, 7, 8, 9, 10, 0xF7, 0xF0, 11, 12, 0x80, 60, 0};
+
+  /* byte by byte, a message is stamped with the time of its first byte */
+  for (i = 0; i < sizeof(running); i++) {
+    parser.parse(running[i], i * 10); }
+
+  HTST_check(2 == rec.msgs);
+  HTST_check(is(rec.msg_log[0], 0, 0x90, 60, 100));
+  HTST_check(is(rec.msg_log[1], 30, 0x90, 62, 0));
+
+  /* new status takes over, half a message waits for the rest */
+  HTST_check(0 == parser.stray());
+  parser.parse(8, 100);
+  HTST_check(is(rec.msg_log[2], 50, 0xB1, 7, 8));
+
+  /* realtime goes straight out without breaking the note on */
+  rec.clear();
+  parser.parse(rt, sizeof(rt), 1000);
+  HTST_check(3 == rec.msgs);
+  HTST_check(is(rec.msg_log[0], 1000, 0xF8, 0, 0));
+  HTST_check(is(rec.msg_log[1], 1000, 0x90, 64, 90));
+  HTST_check(is(rec.msg_log[2], 1000, 0xFA, 0, 0));
+
+  /* no data bytes, so nothing in a/ b once on the bus */
+  HTST_check((0 == rec.msg_log[0].data[0]) && (0 == rec.msg_log[0].data[1]));
+  HTST_check(MidiParser::toEvent(rec.msg_log[0], e));
+  HTST_check((EVENT_CLOCK == e.type) && (0 == e.a) && (0 == e.b));
+
+  /* system common ends running status, data after it is stray */
+  rec.clear();
+  parser.parse(common, sizeof(common), 0);
+  HTST_check(4 == rec.msgs);
+  HTST_check((0xF3 == rec.msg_log[0].status) && (1 == rec.msg_log[0].length) && (5 == rec.msg_log[0].data[0]));
+  HTST_check((0xF6 == rec.msg_log[1].status) && (0 == rec.msg_log[1].length));
+  HTST_check((0xC2 == rec.msg_log[2].status) && (1 == rec.msg_log[2].length) && (9 == rec.msg_log[2].data[0]));
+  HTST_check((0xC2 == rec.msg_log[3].status) && (10 == rec.msg_log[3].data[0]));
+  HTST_check(2 == parser.stray());
+
+  /* 10 byte sysex through a 4 byte buffer, then one cut short by a note off */
+  rec.clear();
+  parser.parse(sx, sizeof(sx), 0);
+  HTST_check((12 == rec.sysex_bytes) && (4 == rec.sysex_chunks) && (2 == rec.sysex_last));
+  for (i = 0; i < 12; i++) {
+    HTST_check((i + 1) == rec.sysex_data[i]); }
+  HTST_check(2 == rec.msgs);
+  HTST_check(0xF8 == rec.msg_log[0].status);
+  HTST_check((0x80 == rec.msg_log[1].status) && (60 == rec.msg_log[1].data[0]));
+
+  /* a dma chunk back dated by its length, din bytes at 96 kHz */
+  rec.clear();
+  parser.reset();
+  parser.parse(running, 5, 0, 7864);
+  HTST_check(is(rec.msg_log[0], 0, 0x90, 60, 100));
+  HTST_check(is(rec.msg_log[1], 92, 0x90, 62, 0));
+
+  /* onto the event bus */
+  HTST_check(MidiParser::toEvent(rec.msg_log[1], e));
+  HTST_check((EVENT_NOTE_OFF == e.type) && (62 == e.a) && (92 == e.time));
+  HTST_check(MidiParser::toEvent(rec.msg_log[0], e) && (EVENT_NOTE_ON == e.type) && (100 == e.b));
+  rec.msg_log[0].status = 0xE3;
+  HTST_check(MidiParser::toEvent(rec.msg_log[0], e) && (EVENT_PITCH_BEND == e.type) && (3 == e.channel));
+  rec.msg_log[0].status = 0xC0;
+  HTST_check(false == MidiParser::toEvent(rec.msg_log[0], e));
+
+  din.parse(running, sizeof(running), 0, 256);
+  bus.beginBlock();
+  HTST_check(bus.next(e, offset) && (EVENT_NOTE_ON == e.type) && (0 == offset));
+  HTST_check(bus.next(e, offset) && (EVENT_NOTE_OFF == e.type) && (3 == offset));
+  HTST_check(false == bus.next(e, offset));
+  HTST_check(2 == thru.msgs);
+
+  /* every message in a recording comes out */
+  len = record(dump, DUMP_LEN, &expected);
+  rec.clear();
+  parser.reset();
+  parser.parse(dump, len, 0);
+  HTST_check(expected == rec.msgs);
+
+  return true;
+}
+
+
+/* parsing a dense recording, against what the wires can carry */
+bool HTST_midiParserBench(void)
+{
+  CountHandler counter;
+  MidiParser parser(counter);
+  uint32_t len, expected, pass;
+  uint64_t ns;
+  double per_sec;
+
+  len = record(dump, DUMP_LEN, &expected);
+
+  ns = HTST_nowNs();
+  for (pass = 0; pass < BENCH_PASSES; pass++) {
+    parser.parse(dump, len, pass); }
+  ns = HTST_nowNs() - ns;
+
+  if (counter.n != (expected * BENCH_PASSES)) {
+    return false; }
+
+  per_sec = (double)counter.n * 1e9 / (double)ns;
+
+  HTST_report("midi parse", (double)ns / ((double)len * BENCH_PASSES), "ns/byte");
+  HTST_report("midi parse", per_sec / 1e6, "M msgs/s");
+  HTST_report("midi din wire, same recording", (double)expected * 3125.0 / len, "msgs/s");
+
+  return true;
+}
+
+
+static bool is(midi_msg_t const &m, uint32_t time, uint8_t status, uint8_t a, uint8_t b)
+{
+  return (m.time == time) && (m.status == status) &&
+         ((m.length < 1) || (m.data[0] == a)) &&
+         ((m.length < 2) || (m.data[1] == b));
+}
+
+/* what a controller sends: 14 bit cc sweeps on two channels with running
+ * status, a note now & then, clock & the odd short sysex */
+static uint32_t record(uint8_t *out, uint32_t length, uint32_t *messages)
+{
+  uint32_t n = 0, msgs = 0, step = 0;
+  uint16_t value;
+  uint8_t ch;
+
+  while ((n + 16) < length)
+  {
+    ch = (step >> 5) & 1;
+    value = (uint16_t)((step * 97) & 0x3FFF);
+
+    /* new status every 32 steps, running status in between */
+    if (0 == (step & 31)) {
+      out[n++] = 0xB0 | ch; }
+
+    out[n++] = 1;
+
+    /* clock lands mid message */
+    if (0 == (step & 7))
+    {
+      out[n++] = 0xF8;
+      msgs++;
+    }
+
+    out[n++] = (uint8_t)(value >> 7);
+    out[n++] = 33;
+    out[n++] = (uint8_t)(value & 0x7F);
+    msgs += 2;
+
+    if (31 == (step & 31))
+    {
+      out[n++] = 0x92;
+      out[n++] = (uint8_t)(36 + (step & 0x3F));
+      out[n++] = 100;
+      msgs++;
+    }
+
+    if (255 == (step & 255))
+    {
+      out[n++] = 0xF0;
+      out[n++] = 0x7D;
+      out[n++] = 1;
+      out[n++] = 0xF7;
+    }
+
+    step++;
+  }
+
+  *messages = msgs;
+
+  return n;
+}
@@ -0,0 +1,256 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "mod_matrix.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define BENCH_BLOCKS    100000u
+
+
+/* holds a value per voice & counts how often it is stepped */
+class Counter : public Modifier
+{
+  public:
+    float update(size_t frames)
+    {
+      (void)frames;
+      updates++;
+      return _value = level;
+    }
+
+    float    level = 0.0f;
+    uint32_t updates = 0;
+};
+
+
+static Counter lfo[MAX_VOICES];
+static Counter env[MAX_VOICES];
+static Counter unused[MAX_VOICES];
+static Parameter<> cutoff[MAX_VOICES];
+static Parameter<> pitch[MAX_VOICES];
+static Parameter<> level[MAX_VOICES];
+
+static Counter bench_src[MOD_SOURCES][MAX_VOICES];
+static Parameter<> bench_dst[MOD_DESTINATIONS][MAX_VOICES];
+
+
+static void registerVoices  (ModMatrix &m, Counter *src, uint8_t &id);
+static void registerVoices  (ModMatrix &m, Parameter<> *dst, float base, uint8_t &id);
+static double blockNs       (ModMatrix &m, uint32_t blocks);
+static float  targetOf      (Parameter<> &p);
+
+
+/* base + depth x source for routed destinations only, sources stepped once */
+bool HTST_modMatrix(void)
+{
+  ModMatrix m, full;
+  ModValue wheel(0.5f);
+  uint8_t s_lfo, s_env, s_unused, s_wheel, s_full;
+  uint8_t d_cutoff, d_pitch, d_level, d_full;
+  uint8_t v, i;
+
+  registerVoices(m, lfo, s_lfo);
+  registerVoices(m, env, s_env);
+  registerVoices(m, unused, s_unused);
+  s_wheel = m.addSource(&wheel);
+  registerVoices(m, cutoff, 0.25f, d_cutoff);
+  registerVoices(m, pitch, 0.0f, d_pitch);
+  registerVoices(m, level, 0.75f, d_level);
+  HTST_check(ModMatrix::NONE != s_wheel);
+
+  HTST_check(m.connect(s_lfo, d_cutoff, 0.5f));
+  HTST_check(m.connect(s_env, d_cutoff, 0.25f));
+  HTST_check(m.connect(s_wheel, d_pitch, 0.1f));
+  HTST_check(m.connect(s_lfo, d_pitch, 0.01f));
+  HTST_check(4 == m.routes());
+
+  /* same pair again is a depth change, not a new route */
+  HTST_check(m.connect(s_lfo, d_cutoff, -0.5f));
+  HTST_check(4 == m.routes());
+
+  HTST_check(false == m.connect(MOD_SOURCES, d_cutoff, 1.0f));
+  HTST_check(false == m.connect(s_lfo, MOD_DESTINATIONS, 1.0f));
+
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    lfo[v].level = (float)v / MAX_VOICES;
+    env[v].level = 1.0f;
+  }
+
+  m.tick(BLOCK_SIZE);
+  for (v = 0; v < MAX_VOICES; v++) {
+    m.process(v, BLOCK_SIZE); }
+
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    HTST_check(fabsf(targetOf(cutoff[v]) - (0.25f - (0.5f * lfo[v].level) + 0.25f)) < 1.0e-6f);
+    HTST_check(fabsf(targetOf(pitch[v]) - ((0.1f * 0.5f) + (0.01f * lfo[v].level))) < 1.0e-6f);
+
+    /* nothing routed, never written */
+    HTST_check(0.0f == targetOf(level[v]));
+
+    /* once per block however many routes use it */
+    HTST_check((1 == lfo[v].updates) && (1 == env[v].updates));
+    HTST_check(0 == unused[v].updates);
+  }
+
+  /* globals are stepped once a block, not once per voice */
+  wheel.set(1.0f);
+  m.tick(BLOCK_SIZE);
+  for (v = 0; v < MAX_VOICES; v++) {
+    m.process(v, BLOCK_SIZE); }
+  HTST_check(fabsf(targetOf(pitch[3]) - (0.1f + (0.01f * lfo[3].level))) < 1.0e-6f);
+  HTST_check(2 == lfo[3].updates);
+
+  /* base moves everything routed to it */
+  m.setBase(d_cutoff, 0.5f);
+  m.process(0, BLOCK_SIZE);
+  HTST_check(fabsf(targetOf(cutoff[0]) - 0.75f) < 1.0e-6f);
+
+  /* no routes, the next process() passes it on. never from setBase() */
+  m.setBase(d_level, 0.4f);
+  HTST_check(0.0f == targetOf(level[0]));
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    m.process(v, BLOCK_SIZE);
+    HTST_check(fabsf(targetOf(level[v]) - 0.4f) < 1.0e-6f);
+  }
+
+  /* last route gone, back to the base */
+  HTST_check(m.disconnect(s_lfo, d_pitch));
+  HTST_check(false == m.disconnect(s_lfo, d_pitch));
+  HTST_check(m.disconnect(s_wheel, d_pitch));
+  HTST_check(2 == m.routes());
+  for (v = 0; v < MAX_VOICES; v++) {
+    HTST_check(0.0f == targetOf(pitch[v])); }
+
+  /* fills up, then refuses */
+  for (i = 0; i < MOD_SOURCES; i++) {
+    registerVoices(full, bench_src[i], s_full); }
+  for (i = 0; i < MOD_DESTINATIONS; i++) {
+    registerVoices(full, bench_dst[i], 0.0f, d_full); }
+  HTST_check(ModMatrix::NONE == full.addSource(&wheel));
+
+  for (i = 0; i < MOD_ROUTES; i++) {
+    HTST_check(full.connect(i % MOD_SOURCES, i, 0.1f)); }
+  HTST_check(false == full.connect(0, MOD_DESTINATIONS - 1, 0.1f));
+  HTST_check(MOD_ROUTES == full.routes());
+
+  full.clear();
+  HTST_check(0 == full.routes());
+
+  return true;
+}
+
+
+/* 32 routes x 8 voices, against a handful to show it scales with routes */
+bool HTST_modMatrixBench(void)
+{
+  ModMatrix m;
+  uint8_t src[MOD_SOURCES];
+  uint8_t dst[MOD_DESTINATIONS];
+  double ns;
+  uint32_t i;
+
+  for (i = 0; i < MOD_SOURCES; i++) {
+    registerVoices(m, bench_src[i], src[i]); }
+  for (i = 0; i < MOD_DESTINATIONS; i++) {
+    registerVoices(m, bench_dst[i], 0.5f, dst[i]); }
+
+  for (i = 0; i < 4; i++) {
+    m.connect(src[i], dst[i], 0.1f); }
+  ns = blockNs(m, BENCH_BLOCKS);
+  HTST_report("mod matrix, 4 routes x 8 voices", ns, "ns/block");
+
+  /* spread so every source & destination is in use */
+  for (i = 0; m.routes() < 32; i++) {
+    m.connect(src[(i * 7) % MOD_SOURCES], dst[(i * 5) % MOD_DESTINATIONS], 0.01f * i); }
+  ns = blockNs(m, BENCH_BLOCKS);
+  HTST_report("mod matrix, 32 routes x 8 voices", ns, "ns/block");
+  HTST_report("mod matrix, per route per voice", ns / (32.0 * MAX_VOICES), "ns");
+  HTST_report("mod matrix, share of a block", (100.0 * ns * SAMPLE_RATE) / (1e9 * BLOCK_SIZE), "% cpu");
+
+  return true;
+}
+
+
+static void registerVoices(ModMatrix &m, Counter *src, uint8_t &id)
+{
+  Modifier *voices[MAX_VOICES];
+  uint8_t v;
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    voices[v] = &src[v]; }
+
+  id = m.addSource(voices);
+}
+
+static void registerVoices(ModMatrix &m, Parameter<> *dst, float base, uint8_t &id)
+{
+  ParameterTarget *voices[MAX_VOICES];
+  uint8_t v;
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    voices[v] = &dst[v]; }
+
+  id = m.addDestination(voices, base);
+}
+
+
+static double blockNs(ModMatrix &m, uint32_t blocks)
+{
+  uint64_t start;
+  uint32_t i;
+  uint8_t v;
+
+  start = HTST_nowNs();
+
+  for (i = 0; i < blocks; i++)
+  {
+    m.tick(BLOCK_SIZE);
+    for (v = 0; v < MAX_VOICES; v++) {
+      m.process(v, BLOCK_SIZE); }
+  }
+
+  return (double)(HTST_nowNs() - start) / blocks;
+}
+
+
+/* what the matrix last set, picked up the way the stage would */
+static float targetOf(Parameter<> &p)
+{
+  p.tick(BLOCK_SIZE);
+
+  return p.target();
+}
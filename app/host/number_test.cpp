@@ -0,0 +1,277 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "number.hpp"
+#include "gain.hpp"
+#include "one_pole.hpp"
+#include "wavetable.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define VOICES          4
+#define FRAMES          (2000 * BLOCK_SIZE)
+
+#define VOICE_GAIN      0.25f
+
+
+/* same patch in every format: per voice lowpass & gain then a mix */
+typedef struct
+{
+  double filter_ns;       ///< per sample, each stage
+  double gain_ns;
+  double mix_ns;
+  double filter_snr;      ///< dB against double precision
+  double gain_snr;
+  double mix_snr;
+} result_t;
+
+static float  input[VOICES][FRAMES];
+static double ref_filter[VOICES][FRAMES];
+static double ref_gain[VOICES][FRAMES];
+static double ref_mix[FRAMES];
+
+static float const cutoff_hz[VOICES] = {300.0f, 1200.0f, 4000.0f, 12000.0f};
+
+
+static void   makeReference (size_t frames);
+static double snr           (double const *ref, float const *out, size_t frames);
+
+template <typename N> static bool   basics  (void);
+template <typename N> static void   patch   (size_t frames, result_t *r);
+template <typename N> static void   report  (void);
+
+
+/* arithmetic & saturation of each policy, accuracy of the patch */
+bool HTST_number(void)
+{
+  result_t f32, q31, q15;
+
+  HTST_check(basics<Float32>());
+  HTST_check(basics<Q31>());
+  HTST_check(basics<Q15>());
+
+  makeReference(FRAMES / 16);
+  patch<Float32>(FRAMES / 16, &f32);
+  patch<Q31>(FRAMES / 16, &q31);
+  patch<Q15>(FRAMES / 16, &q15);
+
+  HTST_check(f32.mix_snr > 100.0);
+  HTST_check(q31.mix_snr > 100.0);
+  HTST_check(q15.mix_snr > 40.0);
+
+  /* fixed point loses resolution at every stage */
+  HTST_check(q15.filter_snr < q31.filter_snr);
+  HTST_check(q15.gain_snr < q15.filter_snr);
+
+  return true;
+}
+
+
+bool HTST_numberBench(void)
+{
+  makeReference(FRAMES);
+
+  report<Float32>();
+  report<Q31>();
+  report<Q15>();
+
+  return true;
+}
+
+
+template <typename N>
+static bool basics(void)
+{
+  typedef typename N::sample_t sample_t;
+  sample_t a[7], b[7];
+  float x;
+  uint32_t i;
+
+  for (x = -1.0f; x < 1.0f; x += 0.125f)
+  {
+    HTST_check(fabsf(N::toFloat(N::fromFloat(x)) - x) < (1.0f / 16384.0f));
+    HTST_check(fabsf(N::toFloat(N::mul(N::fromFloat(x), N::fromFloat(0.5f))) - (x * 0.5f)) < (1.0f / 8192.0f));
+  }
+
+  /* clip instead of wrapping */
+  HTST_check(N::toFloat(N::add(N::fromFloat(0.75f), N::fromFloat(0.75f))) > 0.99f);
+  HTST_check(N::toFloat(N::sub(N::fromFloat(-0.75f), N::fromFloat(0.75f))) < -0.99f);
+  HTST_check(N::toFloat(N::mul(N::fromFloat(-1.0f), N::fromFloat(-1.0f))) > 0.99f);
+
+  /* odd length for the q15 pairs */
+  for (i = 0; i < SIZEOF(a); i++)
+  {
+    a[i] = N::fromFloat(0.1f * i);
+    b[i] = N::fromFloat(0.2f);
+  }
+  N::accumulate(a, b, SIZEOF(a));
+  for (i = 0; i < SIZEOF(a); i++) {
+    HTST_check(a[i] == N::add(N::fromFloat(0.1f * i), N::fromFloat(0.2f))); }
+
+  a[0] = N::fromFloat(0.9f);
+  N::accumulate(a, b, 1);
+  HTST_check(N::toFloat(a[0]) > 0.99f);
+
+  return true;
+}
+
+
+template <typename N>
+static void patch(size_t frames, result_t *r)
+{
+  typedef typename N::sample_t sample_t;
+  static sample_t buf[VOICES][FRAMES];
+  static sample_t mix[FRAMES];
+  static float out[FRAMES];
+  OnePole<N> filter[VOICES];
+  Gain<N> gain[VOICES];
+  uint64_t ns;
+  uint32_t v;
+  size_t i;
+
+  for (v = 0; v < VOICES; v++)
+  {
+    filter[v].setCutoff(cutoff_hz[v]);
+    gain[v].setLevel(VOICE_GAIN);
+
+    for (i = 0; i < frames; i++) {
+      buf[v][i] = N::fromFloat(input[v][i]); }
+  }
+  memset(mix, 0, sizeof(mix));
+
+  ns = HTST_nowNs();
+  for (v = 0; v < VOICES; v++)
+  {
+    for (i = 0; i < frames; i += BLOCK_SIZE) {
+      filter[v].process(&buf[v][i], BLOCK_SIZE); }
+  }
+  r->filter_ns = (double)(HTST_nowNs() - ns) / (VOICES * frames);
+
+  for (i = 0; i < frames; i++) {
+    out[i] = N::toFloat(buf[0][i]); }
+  r->filter_snr = snr(ref_filter[0], out, frames);
+
+  ns = HTST_nowNs();
+  for (v = 0; v < VOICES; v++)
+  {
+    for (i = 0; i < frames; i += BLOCK_SIZE) {
+      gain[v].process(&buf[v][i], BLOCK_SIZE); }
+  }
+  r->gain_ns = (double)(HTST_nowNs() - ns) / (VOICES * frames);
+
+  for (i = 0; i < frames; i++) {
+    out[i] = N::toFloat(buf[0][i]); }
+  r->gain_snr = snr(ref_gain[0], out, frames);
+
+  ns = HTST_nowNs();
+  for (v = 0; v < VOICES; v++)
+  {
+    for (i = 0; i < frames; i += BLOCK_SIZE) {
+      N::accumulate(&mix[i], &buf[v][i], BLOCK_SIZE); }
+  }
+  r->mix_ns = (double)(HTST_nowNs() - ns) / (VOICES * frames);
+
+  for (i = 0; i < frames; i++) {
+    out[i] = N::toFloat(mix[i]); }
+  r->mix_snr = snr(ref_mix, out, frames);
+}
+
+
+template <typename N>
+static void report(void)
+{
+  char name[48];
+  result_t r;
+
+  patch<N>(FRAMES, &r);
+
+  snprintf(name, sizeof(name), "%s lowpass per sample", N::name);
+  HTST_report(name, r.filter_ns, "ns");
+  snprintf(name, sizeof(name), "%s lowpass snr", N::name);
+  HTST_report(name, r.filter_snr, "dB");
+  snprintf(name, sizeof(name), "%s gain per sample", N::name);
+  HTST_report(name, r.gain_ns, "ns");
+  snprintf(name, sizeof(name), "%s gain snr", N::name);
+  HTST_report(name, r.gain_snr, "dB");
+  snprintf(name, sizeof(name), "%s mix per sample", N::name);
+  HTST_report(name, r.mix_ns, "ns");
+  snprintf(name, sizeof(name), "%s mix snr", N::name);
+  HTST_report(name, r.mix_snr, "dB");
+}
+
+
+/* half scale band limited saws, filtered in double with the same coefficients */
+static void makeReference(size_t frames)
+{
+  Wavetable osc(Wavetable::SHAPE_SAW);
+  double a, y;
+  uint32_t v;
+  size_t i;
+
+  memset(ref_mix, 0, sizeof(ref_mix));
+
+  for (v = 0; v < VOICES; v++)
+  {
+    osc.reset();
+    osc.setFrequency(55.0f * (float)(v + 1) * 1.01f);
+    osc.generate(input[v], frames);
+
+    a = 1.0f - expf((-6.2831853f * cutoff_hz[v]) / SAMPLE_RATE);
+    y = 0.0;
+
+    for (i = 0; i < frames; i++)
+    {
+      input[v][i] *= 0.5f;
+      y += a * ((double)input[v][i] - y);
+      ref_filter[v][i] = y;
+      ref_gain[v][i] = y * VOICE_GAIN;
+      ref_mix[i] += ref_gain[v][i];
+    }
+  }
+}
+
+
+static double snr(double const *ref, float const *out, size_t frames)
+{
+  double sig = 0.0;
+  double err = 0.0;
+  size_t i;
+
+  for (i = 0; i < frames; i++)
+  {
+    sig += ref[i] * ref[i];
+    err += (ref[i] - out[i]) * (ref[i] - out[i]);
+  }
+
+  return (err > 0.0) ? (10.0 * log10(sig / err)) : 200.0;
+}
@@ -0,0 +1,251 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "parameter.hpp"
+#include "gain.hpp"
+
+#include <cmath>
+#include <stdio.h>
+#include <thread>
+
+
+#define RAMP_MS         2.0f
+#define RAMP_BLOCKS     ((uint32_t)((RAMP_MS * SAMPLE_RATE) / (1000.0f * BLOCK_SIZE) + 0.5f))
+
+#define RACE_BLOCKS     200000u
+#define BENCH_BLOCKS    1000000u
+
+
+static bool  ramp    (Parameter<> &p, float from, float to, uint32_t blocks, bool linear);
+static float render  (Parameter<> &p, float *out);
+
+
+/* ramps land on the target without steps, updates are lock free */
+bool HTST_parameter(void)
+{
+  Parameter<> lin(0.0f, Parameter<>::RAMP_LINEAR, RAMP_MS);
+  Parameter<> ex(0.0f, Parameter<>::RAMP_EXPONENTIAL, RAMP_MS);
+  Parameter<> race(0.5f);
+  Parameter<Q15> q15(0.0f, Parameter<Q15>::RAMP_LINEAR, RAMP_MS);
+  Gain<> gain(0.0f);
+  float buf[BLOCK_SIZE];
+  float out[BLOCK_SIZE];
+  float lo = 1.0f, hi = 0.0f, jump = 0.0f, last;
+  uint32_t i, j;
+  bool torn = false;
+
+  /* nothing rendered yet, the first tick jumps */
+  lin.set(0.25f);
+  lin.tick(BLOCK_SIZE);
+  HTST_check((0.25f == lin.value()) && lin.isStatic());
+  lin.tick(BLOCK_SIZE);
+  HTST_check(lin.isStatic());
+
+  /* straight line, even steps, exactly on target after the ramp time */
+  HTST_check(ramp(lin, 0.25f, 1.0f, RAMP_BLOCKS, true));
+  HTST_check(ramp(lin, 1.0f, 0.0f, RAMP_BLOCKS, true));
+
+  /* several sets between blocks, the latest wins */
+  lin.set(0.9f);
+  lin.set(0.1f);
+  lin.set(0.5f);
+  HTST_check(ramp(lin, 0.0f, 0.5f, RAMP_BLOCKS, true));
+
+  /* exponential, -60 dB at the ramp time & settles eventually */
+  ex.tick(BLOCK_SIZE);
+  HTST_check(ramp(ex, 0.0f, 1.0f, RAMP_BLOCKS, false));
+
+  /* fixed point lands on the same value */
+  q15.tick(BLOCK_SIZE);
+  q15.set(0.5f);
+  for (i = 0; i <= RAMP_BLOCKS; i++) {
+    q15.tick(BLOCK_SIZE); }
+  HTST_check(q15.isStatic() && (Q15::fromFloat(0.5f) == q15.value()));
+
+  /* a gain change on dc is a smooth fade rather than a step */
+  gain.process(buf, 0);
+  gain.setLevel(1.0f);
+  last = 0.0f;
+  for (i = 0; i < 4 * RAMP_BLOCKS; i++)
+  {
+    for (j = 0; j < BLOCK_SIZE; j++) {
+      buf[j] = 0.5f; }
+    gain.process(buf, BLOCK_SIZE);
+    for (j = 0; j < BLOCK_SIZE; j++)
+    {
+      jump = fmaxf(jump, fabsf(buf[j] - last));
+      last = buf[j];
+    }
+  }
+  HTST_check((last > 0.499f) && (jump < 0.01f));
+
+  /* control thread hammering set() while audio ticks, never a torn value */
+  race.tick(BLOCK_SIZE);
+
+  std::thread control([&race]()
+  {
+    uint32_t n;
+
+    for (n = 0; n < RACE_BLOCKS; n++)
+    {
+      race.set((n & 1) ? 0.75f : 0.25f);
+      if (0 == (n & 63)) {
+        std::this_thread::yield(); }
+    }
+    race.set(0.5f);
+  });
+
+  for (i = 0; i < RACE_BLOCKS; i++)
+  {
+    render(race, out);
+    for (j = 0; j < BLOCK_SIZE; j++)
+    {
+      lo = fminf(lo, out[j]);
+      hi = fmaxf(hi, out[j]);
+      torn |= (out[j] != out[j]);
+    }
+    if (0 == (i & 63)) {
+      std::this_thread::yield(); }
+  }
+
+  control.join();
+
+  for (i = 0; i <= RAMP_BLOCKS * 8; i++) {
+    render(race, out); }
+
+  HTST_check((false == torn) && (lo >= 0.25f) && (hi <= 0.75f));
+  HTST_check(race.isStatic() && (0.5f == race.value()));
+
+  return true;
+}
+
+
+/* per block bookkeeping & what smoothing costs a gain stage */
+bool HTST_parameterBench(void)
+{
+  Parameter<> p(0.0f, Parameter<>::RAMP_LINEAR, 1000.0f);
+  Gain<> gain(0.5f);
+  static float buf[BLOCK_SIZE];
+  uint64_t start;
+  uint32_t i;
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++) {
+    p.tick(BLOCK_SIZE); }
+  HTST_report("parameter tick, static", (double)(HTST_nowNs() - start) / BENCH_BLOCKS, "ns/block");
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    p.set((i & 1) ? 1.0f : 0.0f);
+    p.tick(BLOCK_SIZE);
+  }
+  HTST_report("parameter set & tick, ramping", (double)(HTST_nowNs() - start) / BENCH_BLOCKS, "ns/block");
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++) {
+    gain.process(buf, BLOCK_SIZE); }
+  HTST_report("gain, static level", (double)(HTST_nowNs() - start) / ((double)BENCH_BLOCKS * BLOCK_SIZE), "ns/sample");
+
+  start = HTST_nowNs();
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    gain.setLevel((i & 1) ? 0.25f : 0.75f);
+    gain.process(buf, BLOCK_SIZE);
+  }
+  HTST_report("gain, ramping level", (double)(HTST_nowNs() - start) / ((double)BENCH_BLOCKS * BLOCK_SIZE), "ns/sample");
+
+  return true;
+}
+
+
+/* follows a change from one value to the next, linear or exponential */
+static bool ramp(Parameter<> &p, float from, float to, uint32_t blocks, bool linear)
+{
+  float out[BLOCK_SIZE];
+  float prev = from;
+  float step = fabsf(to - from) / (float)(blocks * BLOCK_SIZE);
+  float dir = (to > from) ? 1.0f : -1.0f;
+  uint32_t i, j;
+
+  if (p.target() != to) {
+    p.set(to); }
+
+  for (i = 0; i < blocks; i++)
+  {
+    render(p, out);
+    HTST_check(false == p.isStatic());
+
+    for (j = 0; j < BLOCK_SIZE; j++)
+    {
+      /* always towards the target, never past it */
+      HTST_check(((out[j] - prev) * dir) >= 0.0f);
+      HTST_check(((to - out[j]) * dir) >= -1.0e-6f);
+
+      if (linear) {
+        HTST_check(fabsf(fabsf(out[j] - prev) - step) < (step * 1.0e-3f)); }
+
+      prev = out[j];
+    }
+  }
+
+  /* summed steps, within rounding of it */
+  if (linear) {
+    HTST_check(fabsf(to - prev) < 1.0e-6f); }
+  else {
+    HTST_check(fabsf(to - prev) < (fabsf(to - from) * 1.1e-3f)); }
+
+  for (i = 0; (i < 1000) && (false == p.isStatic()); i++) {
+    render(p, out); }
+
+  HTST_check(p.isStatic() && (to == p.value()));
+
+  return true;
+}
+
+
+/* a block of the per sample values a stage would see */
+static float render(Parameter<> &p, float *out)
+{
+  float v;
+  uint32_t i;
+
+  p.tick(BLOCK_SIZE);
+  v = p.value();
+
+  for (i = 0; i < BLOCK_SIZE; i++)
+  {
+    v += p.step();
+    out[i] = v;
+  }
+
+  return v;
+}
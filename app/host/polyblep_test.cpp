@@ -0,0 +1,167 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "polyblep.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define BENCH_BLOCKS    20000
+
+/* float phase in the scalar kernel vs exact integer edges in the block one */
+#define TOLERANCE       1e-4f
+
+
+static char const *const shape_names[PolyBlep::SHAPE_NUM_OF] = {"saw", "square", "triangle"};
+
+
+static double bench(PolyBlep::shape_e shape, bool block);
+
+
+/* both kernels render the same samples for any pitch, phase & block size */
+bool HTST_polyBlep(void)
+{
+  static float const hz[] = {0.0f, 20.0f, 55.0f, 440.0f, 1234.5f, 8000.0f, 20000.0f, 96000.0f};
+  static size_t const frames[] = {1, 7, BLOCK_SIZE, 3 * BLOCK_SIZE};
+  float ref[3 * BLOCK_SIZE];
+  float out[3 * BLOCK_SIZE];
+  PolyBlep::state_t a, b;
+  PolyBlep osc;
+  uint32_t s, f, n, blk, i;
+  float sum;
+
+  for (s = 0; s < PolyBlep::SHAPE_NUM_OF; s++)
+  {
+    for (f = 0; f < SIZEOF(hz); f++)
+    {
+      for (n = 0; n < SIZEOF(frames); n++)
+      {
+        osc.setFrequency(hz[f]);
+        a.inc = (hz[f] > 0.0f) ? (uint32_t)(hz[f] * (4294967296.0f / SAMPLE_RATE)) : 0;
+        if (a.inc > PolyBlep::MAX_INC) {
+          a.inc = PolyBlep::MAX_INC; }
+        a.phase = 0x12345678u * (f + 1);
+        a.tri = 0.0f;
+        b = a;
+
+        for (blk = 0; blk < 50; blk++)
+        {
+          PolyBlep::renderScalar(a, (PolyBlep::shape_e)s, ref, frames[n]);
+          PolyBlep::renderBlock(b, (PolyBlep::shape_e)s, out, frames[n]);
+
+          HTST_check(a.phase == b.phase);
+          for (i = 0; i < frames[n]; i++)
+          {
+            if (fabsf(ref[i] - out[i]) > TOLERANCE)
+            {
+              printf("  %s %.1f Hz %u frames, block %u sample %u: %f vs %f\n",
+                     shape_names[s], hz[f], (unsigned)frames[n], blk, i, ref[i], out[i]);
+              return false;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /* sane output through the class, no dc & no step left at the edges */
+  for (s = 0; s < PolyBlep::SHAPE_NUM_OF; s++)
+  {
+    osc.setShape((PolyBlep::shape_e)s);
+    osc.setFrequency(375.0f);
+    osc.reset();
+
+    for (blk = 0, sum = 0.0f; blk < 256; blk++)
+    {
+      osc.generate(out, BLOCK_SIZE);
+
+      for (i = 0; i < BLOCK_SIZE; i++)
+      {
+        HTST_check(fabsf(out[i]) < 1.2f);
+        sum += out[i];
+      }
+    }
+
+    HTST_check(fabsf(sum / (256 * BLOCK_SIZE)) < 0.01f);
+  }
+
+  return true;
+}
+
+
+bool HTST_polyBlepBench(void)
+{
+  char name[48];
+  double scalar, block;
+  uint32_t s;
+
+  for (s = 0; s < PolyBlep::SHAPE_NUM_OF; s++)
+  {
+    scalar = bench((PolyBlep::shape_e)s, false);
+    block = bench((PolyBlep::shape_e)s, true);
+
+    snprintf(name, sizeof(name), "polyblep %s scalar per sample", shape_names[s]);
+    HTST_report(name, scalar, "ns");
+    snprintf(name, sizeof(name), "polyblep %s block per sample", shape_names[s]);
+    HTST_report(name, block, "ns");
+  }
+
+  return true;
+}
+
+
+/* ns per sample */
+static double bench(PolyBlep::shape_e shape, bool block)
+{
+  static volatile float sink;
+  float out[BLOCK_SIZE];
+  PolyBlep::state_t state = {0, (uint32_t)(440.0f * (4294967296.0f / SAMPLE_RATE)), 0.0f};
+  uint64_t ns;
+  uint32_t i;
+
+  ns = HTST_nowNs();
+
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    if (block) {
+      PolyBlep::renderBlock(state, shape, out, BLOCK_SIZE); }
+    else {
+      PolyBlep::renderScalar(state, shape, out, BLOCK_SIZE); }
+
+    sink = out[i % BLOCK_SIZE];
+  }
+
+  ns = HTST_nowNs() - ns;
+  (void)sink;
+
+  return (double)ns / ((double)BENCH_BLOCKS * BLOCK_SIZE);
+}
@@ -0,0 +1,255 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "board.h"
+#include "chips.h"
+#include "config_board.h"
+
+#include "host.h"
+#include "regmap/regmap.h"
+
+#include <stdio.h>
+
+
+#define BURST_ADDR      (0x40)
+
+
+static uint8_t burst_reg[16];
+static uint16_t codec_writes;
+static bool flushed;
+static bool flush_error;
+
+
+/* 8 bit register address then data, address auto increments */
+static bool burstModel(bool read, uint16_t mem_addr, uint8_t mem_length,
+                       uint8_t *data, uint16_t length, void *ctx)
+{
+  uint16_t i;
+
+  (void)mem_addr;
+  (void)mem_length;
+  (void)ctx;
+
+  if (read || (length < 2)) {
+    return false; }
+
+  for (i = 1; i < length; i++) {
+    burst_reg[(data[0] + i - 1) & 0xF] = data[i]; }
+
+  return true;
+}
+
+static bool codecModel(bool read, uint16_t mem_addr, uint8_t mem_length,
+                       uint8_t *data, uint16_t length, void *ctx)
+{
+  (void)mem_addr;
+  (void)mem_length;
+  (void)data;
+  (void)ctx;
+
+  if (read || (2 != length)) {
+    return false; }
+
+  codec_writes++;
+
+  return true;
+}
+
+static void flushCb(bool error, void *ctx)
+{
+  (void)ctx;
+  flushed = true;
+  flush_error = error;
+}
+
+static void codecCb(bool error)
+{
+  flushed = true;
+  flush_error = error;
+}
+
+/* the main loop's part of a flush */
+static void settle(REGMAP_t *map)
+{
+  while (REGMAP_isBusy(map)) {
+    REGMAP_task(map); }
+}
+
+static uint32_t busBytes(I2C_ch_e ch)
+{
+  HOST_bus_stats_t stats;
+
+  HOST_I2C_getStats(ch, &stats);
+  HOST_I2C_clearStats(ch);
+
+  return stats.bytes;
+}
+
+
+/* dirty registers merge into one burst, unchanged ones are dropped */
+static bool burst(void)
+{
+  static uint16_t const zeros[16] = {0};
+  REGMAP_t map;
+  REGMAP_cfg_t cfg = {I2C_CH_1, BURST_ADDR, REGMAP_FORMAT_A8_D8, 16, zeros, 0};
+  HOST_bus_stats_t stats;
+
+  HTST_check(HOST_I2C_attach(I2C_CH_1, BURST_ADDR, burstModel, NULL));
+  REGMAP_init(&map, &cfg);
+  HOST_I2C_clearStats(I2C_CH_1);
+
+  /* 5 & 2..3 with 4 (known, clean) in between */
+  REGMAP_write(&map, 5, 0x55);
+  REGMAP_write(&map, 2, 0x22);
+  REGMAP_update(&map, 3, 0x0F, 0x33);
+  HTST_check(REGMAP_isDirty(&map));
+  HTST_check(REGMAP_flush(&map, flushCb, NULL));
+  settle(&map);
+  HTST_check(flushed && !flush_error);
+  HTST_check((0x22 == burst_reg[2]) && (0x03 == burst_reg[3]) && (0x55 == burst_reg[5]));
+
+  HOST_I2C_getStats(I2C_CH_1, &stats);
+  HTST_check((1 == stats.xfers) && ((1 + 1 + 4) == stats.bytes));
+
+  /* no change, nothing sent */
+  flushed = false;
+  REGMAP_write(&map, 2, 0x22);
+  HTST_check(false == REGMAP_isDirty(&map));
+
+  /* past the end, ignored */
+  REGMAP_write(&map, 16, 0x16);
+  REGMAP_write(&map, 200, 0x20);
+  HTST_check(false == REGMAP_isDirty(&map));
+  HTST_check(REGMAP_flush(&map, flushCb, NULL));
+  settle(&map);
+  HTST_check(flushed && !flush_error);
+  HOST_I2C_getStats(I2C_CH_1, &stats);
+  HTST_check(1 == stats.xfers);
+
+  /* unknown values split the burst */
+  cfg.defaults = NULL;
+  REGMAP_init(&map, &cfg);
+  HOST_I2C_clearStats(I2C_CH_1);
+  REGMAP_write(&map, 1, 0x11);
+  REGMAP_write(&map, 4, 0x44);
+  HTST_check(REGMAP_flush(&map, flushCb, NULL));
+
+  /* the second goes from the task, never from the i2c callback */
+  HOST_I2C_getStats(I2C_CH_1, &stats);
+  HTST_check(1 == stats.xfers);
+  settle(&map);
+  HOST_I2C_getStats(I2C_CH_1, &stats);
+  HTST_check(2 == stats.xfers);
+  HTST_check((0x11 == burst_reg[1]) && (0x44 == burst_reg[4]));
+
+  /* failed registers stay dirty & go next time */
+  HOST_I2C_detachAll(I2C_CH_1);
+  REGMAP_write(&map, 7, 0x77);
+  HTST_check(REGMAP_flush(&map, flushCb, NULL));
+  settle(&map);
+  HTST_check(flush_error);
+  HTST_check(REGMAP_isDirty(&map));
+
+  HTST_check(HOST_I2C_attach(I2C_CH_1, BURST_ADDR, burstModel, NULL));
+  HTST_check(REGMAP_flush(&map, flushCb, NULL));
+  settle(&map);
+  HTST_check(!flush_error && (0x77 == burst_reg[7]));
+  HTST_check(false == REGMAP_isDirty(&map));
+  HOST_I2C_detachAll(I2C_CH_1);
+
+  return true;
+}
+
+/* bus bytes with the cache against sending every write as it's made */
+static bool traffic(void)
+{
+  WM8731_cfg_t cfg = {WM8731_I2C_CH, WM8731_ADDR, 96000, true};
+  uint32_t before = 0;
+  uint32_t after = 0;
+  uint32_t i;
+
+  HTST_check(HOST_I2C_attach(WM8731_I2C_CH, WM8731_ADDR, codecModel, NULL));
+  busBytes(WM8731_I2C_CH);
+
+  /* codec setup, 12 register writes of 3 bytes each before */
+  codec_writes = 0;
+  flushed = false;
+  HTST_check(WM8731_init(&cfg, codecCb));
+  HTST_check(false == flushed);
+  HTST_settle();
+  HTST_check(flushed && !flush_error);
+  before += 12 * 3;
+  after += busBytes(WM8731_I2C_CH);
+  HTST_check(codec_writes < 12);
+
+  /* ui sending the same volume & mute state over and over */
+  for (i = 0; i < 10; i++)
+  {
+    HTST_check(WM8731_setVolume(0x70, NULL));
+    HTST_settle();
+    HTST_check(WM8731_mute(false, NULL));
+    HTST_settle();
+    before += (2 + 1) * 3;
+  }
+  after += busBytes(WM8731_I2C_CH);
+
+  HOST_I2C_detachAll(WM8731_I2C_CH);
+
+  /* expander, same */
+  HTST_check(HOST_I2C_attach(PCF8575_0_CH, PCF8575_0_ADDR, burstModel, NULL));
+  HTST_check(PCF8575_init(0, PCF8575_0_CH, PCF8575_0_ADDR));
+  HTST_settle();
+  busBytes(PCF8575_0_CH);
+  for (i = 0; i < 10; i++)
+  {
+    HTST_check(PCF8575_write(0, 3, true, NULL));
+    HTST_settle();
+    before += 3;
+  }
+  after += busBytes(PCF8575_0_CH);
+  HOST_I2C_detachAll(PCF8575_0_CH);
+
+  HTST_report("i2c bytes, write through", before, "bytes");
+  HTST_report("i2c bytes, regmap", after, "bytes");
+
+  HTST_check(after < (before / 3));
+
+  return true;
+}
+
+
+bool HTST_regmap(void)
+{
+  HTST_check(burst());
+  HTST_check(traffic());
+
+  return true;
+}
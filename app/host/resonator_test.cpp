@@ -0,0 +1,224 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "resonator.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define SETTLE_FRAMES   4096
+#define WINDOW_FRAMES   8192
+
+#define BENCH_BLOCKS    20000
+
+/* 3 cents */
+#define PITCH_TOLERANCE 0.002f
+
+
+static StaticArena<RESONATOR_ARENA_BYTES> arena;
+
+static float buf[SETTLE_FRAMES + WINDOW_FRAMES];
+
+
+static void  render   (Resonator &res, float *out, size_t frames);
+static float pitchOf  (float const *x, size_t frames, float expected_hz);
+static float rms      (float const *x, size_t frames);
+
+
+/* in tune at fractional periods, decays, & the arena runs out cleanly */
+bool HTST_resonator(void)
+{
+  static float const hz[] = {55.0f, 110.0f, 440.0f, 1234.5f, 3000.0f};
+  Arena small(NULL, 0);
+  Resonator res;
+  Resonator modal;
+  Resonator greedy;
+  DelayLine huge;
+  size_t used;
+  uint32_t i;
+
+  arena.reset();
+
+  /* plucked string */
+  HTST_check(res.init(arena, Resonator::MODE_STRING, 50.0f));
+  HTST_check(2048 * sizeof(float) == arena.used());
+  res.setDecay(4.0f);
+  res.setBrightness(0.8f);
+
+  for (i = 0; i < SIZEOF(hz); i++)
+  {
+    res.setFrequency(hz[i]);
+    res.excite(1.0f);
+    render(res, buf, SIZEOF(buf));
+
+    HTST_check(fabsf((pitchOf(&buf[SETTLE_FRAMES], WINDOW_FRAMES, hz[i]) / hz[i]) - 1.0f) < PITCH_TOLERANCE);
+    HTST_check(rms(&buf[SETTLE_FRAMES + (WINDOW_FRAMES / 2)], WINDOW_FRAMES / 2)
+             < rms(&buf[SETTLE_FRAMES], WINDOW_FRAMES / 2));
+  }
+
+  /* a short decay dies away & stays finite */
+  res.setFrequency(220.0f);
+  res.setDecay(0.05f);
+  res.excite(1.0f);
+  render(res, buf, SIZEOF(buf));
+  HTST_check(rms(&buf[SIZEOF(buf) - 1024], 1024) < 1e-4f);
+
+  /* struck bar, the fundamental is still where it should be */
+  HTST_check(modal.init(arena, Resonator::MODE_MODAL, 100.0f));
+  modal.setFrequency(330.0f);
+  modal.setDecay(2.0f);
+  modal.setBrightness(1.0f);
+  modal.excite(1.0f);
+  render(modal, buf, SIZEOF(buf));
+  HTST_check(rms(buf, SIZEOF(buf)) > 1e-3f);
+
+  for (i = 0; i < SIZEOF(buf); i++) {
+    HTST_check(std::isfinite(buf[i]) && (fabsf(buf[i]) < 4.0f)); }
+
+  /* too big for what is left, nothing is taken & it stays quiet */
+  used = arena.used();
+  HTST_check(false == greedy.init(arena, Resonator::MODE_MODAL, 5.0f));
+  HTST_check(used == arena.used());
+  HTST_check(1 == arena.refused());
+  HTST_check(arena.highWater() == used);
+
+  greedy.excite(1.0f);
+  render(greedy, buf, BLOCK_SIZE);
+  HTST_check(0.0f == rms(buf, BLOCK_SIZE));
+
+  HTST_check(false == res.init(small, Resonator::MODE_STRING, 50.0f));
+
+  /* no power of 2 above 2^31 fits in 32 bits, it stops there */
+  HTST_check(0x80000000u == DelayLine::lengthFor(0xFFFFFFFFu));
+  HTST_check(false == huge.init(arena, 0x80000001u));
+  HTST_check(used == arena.used());
+
+  /* a new patch starts over, the high water mark remembers */
+  arena.reset();
+  HTST_check(0 == arena.used());
+  HTST_check(arena.highWater() == used);
+
+  return true;
+}
+
+
+bool HTST_resonatorBench(void)
+{
+  static char const *const names[Resonator::MODE_NUM_OF] = {"string", "modal"};
+  float out[BLOCK_SIZE];
+  Resonator res;
+  uint64_t start;
+  uint32_t m, blk;
+  char name[64];
+
+  for (m = 0; m < Resonator::MODE_NUM_OF; m++)
+  {
+    arena.reset();
+    HTST_check(res.init(arena, (Resonator::mode_e)m, 80.0f));
+    res.setFrequency(110.0f);
+    res.setDecay(10.0f);
+    res.excite(1.0f);
+
+    start = HTST_nowNs();
+
+    for (blk = 0; blk < BENCH_BLOCKS; blk++) {
+      res.generate(out, BLOCK_SIZE); }
+
+    snprintf(name, sizeof(name), "resonator %s", names[m]);
+    HTST_report(name, (double)(HTST_nowNs() - start) / BENCH_BLOCKS, "ns/block");
+    snprintf(name, sizeof(name), "resonator %s arena, 80 Hz lowest", names[m]);
+    HTST_report(name, (double)arena.used(), "bytes");
+  }
+
+  return true;
+}
+
+
+static void render(Resonator &res, float *out, size_t frames)
+{
+  size_t n;
+
+  while (frames)
+  {
+    n = (frames > BLOCK_SIZE) ? BLOCK_SIZE : frames;
+    res.generate(out, n);
+    out += n;
+    frames -= n;
+  }
+}
+
+/* autocorrelation peak near the expected period, parabolic interpolation */
+static float pitchOf(float const *x, size_t frames, float expected_hz)
+{
+  float period = (float)SAMPLE_RATE / expected_hz;
+  uint32_t lo = (uint32_t)(period * 0.8f);
+  uint32_t hi = (uint32_t)(period * 1.2f) + 2;
+  uint32_t best = lo;
+  float c[3];
+  float r, peak = -1e30f;
+  uint32_t lag, i;
+
+  for (lag = lo; lag <= hi; lag++)
+  {
+    r = 0.0f;
+    for (i = 0; (i + lag) < frames; i++) {
+      r += x[i] * x[i + lag]; }
+
+    if (r > peak)
+    {
+      peak = r;
+      best = lag;
+    }
+  }
+
+  for (lag = best - 1; lag <= best + 1; lag++)
+  {
+    c[lag + 1 - best] = 0.0f;
+    for (i = 0; (i + best + 1) < frames; i++) {
+      c[lag + 1 - best] += x[i] * x[i + lag]; }
+  }
+
+  r = (float)best + (0.5f * (c[0] - c[2]) / (c[0] - (2.0f * c[1]) + c[2]));
+
+  return (float)SAMPLE_RATE / r;
+}
+
+static float rms(float const *x, size_t frames)
+{
+  float sum = 0.0f;
+  size_t i;
+
+  for (i = 0; i < frames; i++) {
+    sum += x[i] * x[i]; }
+
+  return sqrtf(sum / (float)frames);
+}
@@ -0,0 +1,223 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "spsc_ring.hpp"
+
+#include <stdio.h>
+#include <thread>
+
+
+#define STRESS_ITEMS    1000000u
+#define BENCH_ITEMS     5000000u
+
+
+typedef struct
+{
+  uint32_t seq;
+  uint32_t check;             ///< ~seq, catches torn or stale slots
+  uint64_t pad;
+} item_t;
+
+
+static SpscRing<item_t, 64> ring;
+static SpscRing<uint32_t, 1024> words;
+
+
+static bool stress(uint32_t items);
+
+
+/* in order, nothing lost, duplicated or torn with the two sides racing */
+bool HTST_ring(void)
+{
+  uint32_t buf[6];
+  RING_t r;
+  item_t item;
+  item_t *slot;
+  uint32_t v, i;
+
+  /* power of 2 only */
+  HTST_check(false == RING_init(&r, buf, sizeof(buf[0]), 6));
+  HTST_check(false == RING_init(&r, buf, sizeof(buf[0]), 0));
+  HTST_check(RING_init(&r, buf, sizeof(buf[0]), 4));
+  HTST_check(4 == RING_capacity(&r));
+
+  /* fill, wrap the indices a few times over */
+  for (i = 0; i < 10; i++)
+  {
+    HTST_check(RING_isEmpty(&r));
+    HTST_check(RING_write(&r, &i) && RING_write(&r, &i));
+    v = i + 1;
+    HTST_check(RING_write(&r, &v) && RING_write(&r, &v));
+    HTST_check(RING_isFull(&r) && (4 == RING_count(&r)));
+    HTST_check(false == RING_write(&r, &v));
+    HTST_check(NULL == RING_head(&r));
+
+    HTST_check(RING_read(&r, &v) && (i == v));
+    HTST_check(RING_read(&r, &v) && (i == v));
+    HTST_check(RING_read(&r, &v) && ((i + 1) == v));
+    HTST_check(RING_read(&r, &v) && ((i + 1) == v));
+    HTST_check(false == RING_read(&r, &v));
+    HTST_check(NULL == RING_tail(&r));
+  }
+
+  /* in place, the tail stays put until popped */
+  slot = ring.head();
+  HTST_check(NULL != slot);
+  slot->seq = 7;
+  HTST_check(ring.isEmpty());
+  ring.push();
+  HTST_check(1 == ring.count());
+  HTST_check((ring.tail() == ring.tail()) && (7 == ring.tail()->seq));
+  ring.pop();
+  HTST_check(false == ring.read(item));
+
+  HTST_check(stress(STRESS_ITEMS));
+
+  return true;
+}
+
+
+/* items per second through the ring, one thread & two */
+bool HTST_ringBench(void)
+{
+  uint64_t start, ns;
+  uint32_t i, v, sum = 0;
+
+  start = HTST_nowNs();
+
+  for (i = 0; i < BENCH_ITEMS; i++)
+  {
+    words.write(i);
+    words.read(v);
+    sum += v;
+  }
+
+  ns = HTST_nowNs() - start;
+  HTST_report("ring write + read, one thread", (double)ns / BENCH_ITEMS, "ns/item");
+
+  start = HTST_nowNs();
+
+  std::thread producer([]()
+  {
+    uint32_t n;
+
+    for (n = 0; n < BENCH_ITEMS; )
+    {
+      if (words.write(n)) {
+        n++; }
+      else {
+        std::this_thread::yield(); }
+    }
+  });
+
+  for (i = 0; i < BENCH_ITEMS; )
+  {
+    if (words.read(v))
+    {
+      sum += v;
+      i++;
+    }
+    else {
+      std::this_thread::yield(); }
+  }
+
+  producer.join();
+
+  ns = HTST_nowNs() - start;
+  HTST_report("ring, producer & consumer threads", (double)BENCH_ITEMS * 1e3 / (double)ns, "M items/s");
+
+  (void)sum;
+
+  return true;
+}
+
+
+static bool stress(uint32_t items)
+{
+  uint32_t expected = 0;
+  uint32_t errors = 0;
+  item_t item;
+
+  std::thread producer([items]()
+  {
+    item_t out = {0, 0, 0};
+    item_t *slot;
+
+    while (out.seq < items)
+    {
+      /* alternate copy & in place so both paths race the consumer */
+      if (out.seq & 1)
+      {
+        if ((slot = ring.head()))
+        {
+          slot->seq = out.seq;
+          slot->check = ~out.seq;
+          slot->pad = out.seq;
+          ring.push();
+          out.seq++;
+        }
+        else {
+          std::this_thread::yield(); }
+      }
+      else
+      {
+        out.check = ~out.seq;
+        out.pad = out.seq;
+        if (ring.write(out)) {
+          out.seq++; }
+        else {
+          std::this_thread::yield(); }
+      }
+    }
+  });
+
+  while (expected < items)
+  {
+    /* one core here, let the producer run */
+    if (false == ring.read(item))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    if ((item.seq != expected) || (item.check != ~expected) || (item.pad != expected)) {
+      errors++; }
+
+    expected = item.seq + 1;
+  }
+
+  producer.join();
+
+  if (errors) {
+    printf("  %u out of order or torn\n", (unsigned)errors); }
+
+  return (0 == errors) && ring.isEmpty();
+}
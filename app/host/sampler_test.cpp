@@ -0,0 +1,537 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "sample_cache.hpp"
+#include "sampler.hpp"
+
+#include "chips.h"
+#include "config_board.h"
+#include "host.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/* 1.5 s of sample data at the bottom of the flash, the rest reads 0xFF */
+#define IMAGE_FRAMES    (3 * SAMPLE_RATE / 2)
+#define IMAGE_ADDR      0x1000
+
+#define BLOCK_NS        ((uint32_t)((BLOCK_SIZE * 1000000000ull) / SAMPLE_RATE))
+
+/* bus time for one full chunk read */
+#define CHUNK_NS(latency) \
+  ((uint32_t)((latency) + (((W25Q_READ_HEADER + (Sampler::CHUNK_FRAMES * 2)) * 8000000000ull) / FLASH_CLK_HZ)))
+
+/* long enough for every ring to have cycled many times */
+#define TRIAL_BLOCKS    2000
+
+#define FLASH_CLK_HZ    W25Q_CLK_SPEED_HZ
+
+
+static int16_t  image[IMAGE_FRAMES];
+static Sampler  voices[MAX_VOICES];
+static SampleCache cache;
+
+
+static bool     flashModel  (IO_num_e cs_pin, uint8_t const *tx, uint8_t *rx, uint16_t len, void *ctx);
+static void     setup       (uint32_t clk_hz, uint32_t latency_ns);
+static void     teardown    (void);
+static float    expected    (uint32_t frame);
+static uint32_t sustained   (uint32_t clk_hz, uint32_t latency_ns, float rate);
+static uint32_t noteOnLatency (uint32_t latency_ns, bool cached, uint32_t phase_ns);
+
+
+/* streams the right frames, never touches the bus while rendering & holds
+ * its place rather than skipping when the reads fall behind */
+bool HTST_sampler(void)
+{
+  Sampler::region_t region = {IMAGE_ADDR, 1000, 440.0f};
+  HOST_bus_stats_t before, after;
+  SampleStreamer streamer;
+  Sampler &voice = voices[0];
+  float out[BLOCK_SIZE];
+  uint32_t played = 0;
+  uint32_t gaps = 0;
+  uint32_t blk, i;
+
+  HTST_check(streamer.attach(voice));
+
+  /* instant bus, the ring is always full so this is bit exact */
+  setup(0, 0);
+  voice.play(region);
+
+  for (blk = 0; blk < 40; blk++)
+  {
+    streamer.service();
+    voice.generate(out, BLOCK_SIZE);
+
+    for (i = 0; i < BLOCK_SIZE; i++, played++) {
+      HTST_check(out[i] == ((played < region.frames) ? expected(played) : 0.0f)); }
+  }
+
+  HTST_check(false == voice.playing());
+  HTST_check(0 == voice.underruns());
+  HTST_check(0 == streamer.errors());
+  HTST_check(((region.frames + Sampler::CHUNK_FRAMES - 1) / Sampler::CHUNK_FRAMES) == streamer.reads());
+
+  /* an octave up takes every other frame */
+  voice.play(region);
+  voice.setFrequency(880.0f);
+  streamer.service();
+  voice.generate(out, BLOCK_SIZE);
+
+  for (i = 0; i < BLOCK_SIZE; i++) {
+    HTST_check(out[i] == expected(2 * i)); }
+
+  /* reads wait on simulated time, rendering must not add to the bus */
+  setup(FLASH_CLK_HZ, 1000);
+  voice.play(region);
+  voice.setFrequency(440.0f);
+  streamer.service();
+  HTST_check(1 == HOST_SPI_pending(W25Q_SPI_CH));
+
+  HOST_SPI_getStats(W25Q_SPI_CH, &before);
+  for (blk = 0; blk < 4; blk++) {
+    voice.generate(out, BLOCK_SIZE); }
+  HOST_SPI_getStats(W25Q_SPI_CH, &after);
+
+  HTST_check(before.xfers == after.xfers);
+  HTST_check(0 == voice.underruns());
+
+  /* retriggered with a read for the old note in flight, which lands but
+   * must not be played. one read's worth of bus time at a time */
+  region.addr = IMAGE_ADDR + 200;
+  voice.play(region);
+  HOST_SPI_run(W25Q_SPI_CH, CHUNK_NS(1000));
+  streamer.service();
+  voice.generate(out, BLOCK_SIZE);
+
+  for (i = 0; i < BLOCK_SIZE; i++) {
+    HTST_check(0.0f == out[i]); }
+
+  HOST_SPI_run(W25Q_SPI_CH, CHUNK_NS(1000));
+  voice.generate(out, BLOCK_SIZE);
+
+  for (i = 0; i < BLOCK_SIZE; i++) {
+    HTST_check(out[i] == expected(100 + i)); }
+
+  HTST_check(0 == voice.underruns());
+
+  /* a bus too slow for even one voice */
+  setup(FLASH_CLK_HZ / 32, 1000);
+  region.addr = IMAGE_ADDR;
+  region.frames = IMAGE_FRAMES;
+  voice.play(region);
+  played = 0;
+
+  for (blk = 0; blk < 200; blk++)
+  {
+    streamer.service();
+    HOST_SPI_run(W25Q_SPI_CH, BLOCK_NS);
+    voice.generate(out, BLOCK_SIZE);
+
+    for (i = 0; i < BLOCK_SIZE; i++)
+    {
+      if (0.0f == out[i])
+      {
+        gaps++;
+        continue;
+      }
+
+      HTST_check(out[i] == expected(played));
+      played++;
+    }
+  }
+
+  HTST_check(voice.underruns() > 0);
+  HTST_check((gaps > 0) && (played > 0));
+
+  teardown();
+
+  /* the default flash clock carries a full pool at the root pitch */
+  HTST_check(MAX_VOICES == sustained(FLASH_CLK_HZ, 2000, 1.0f));
+  HTST_check(0 == sustained(FLASH_CLK_HZ / 32, 2000, 1.0f));
+
+  return true;
+}
+
+
+/* voices the bus keeps fed against per read latency & pitch */
+bool HTST_samplerBench(void)
+{
+  static uint32_t const latency_ns[] = {1000, 10000, 50000, 100000};
+  static float const rates[] = {1.0f, 2.0f, 4.0f};
+  Sampler::region_t region = {IMAGE_ADDR, IMAGE_FRAMES, 440.0f};
+  SampleStreamer streamer;
+  float out[BLOCK_SIZE];
+  char name[64];
+  uint64_t start;
+  uint32_t l, r, blk;
+
+  printf("  %u kHz flash clock, %u frame chunks x %u, max %u voices\n",
+         (unsigned)(FLASH_CLK_HZ / 1000),
+         (unsigned)Sampler::CHUNK_FRAMES,
+         (unsigned)Sampler::CHUNKS,
+         (unsigned)MAX_VOICES);
+
+  for (r = 0; r < SIZEOF(rates); r++)
+  {
+    for (l = 0; l < SIZEOF(latency_ns); l++)
+    {
+      snprintf(name, sizeof(name), "voices x%.0f pitch, %u us latency",
+               (double)rates[r], (unsigned)(latency_ns[l] / 1000));
+      HTST_report(name, sustained(FLASH_CLK_HZ, latency_ns[l], rates[r]), "voices");
+    }
+  }
+
+  /* render cost with the ring always full */
+  setup(0, 0);
+  streamer.attach(voices[0]);
+  voices[0].play(region);
+  start = HTST_nowNs();
+
+  for (blk = 0; blk < TRIAL_BLOCKS; blk++)
+  {
+    streamer.service();
+    voices[0].generate(out, BLOCK_SIZE);
+  }
+
+  HTST_report("sampler generate", (double)(HTST_nowNs() - start) / TRIAL_BLOCKS, "ns/block");
+
+  teardown();
+
+  return true;
+}
+
+
+/* lru keeps the recently played attacks, a hit plays from ram across the
+ * join with the ring & a voice's slot is never reloaded under it */
+bool HTST_sampleCache(void)
+{
+  Sampler::region_t region = {IMAGE_ADDR, 20000, 440.0f};
+  SampleStreamer streamer;
+  Sampler &voice = voices[0];
+  float out[BLOCK_SIZE];
+  uint32_t frames = 0;
+  uint32_t played = 0;
+  uint32_t underruns;
+  uint32_t blk, i;
+
+  cache.clear();
+  streamer.attach(voice);
+  streamer.setCache(cache);
+  setup(0, 0);
+
+  /* fill every slot, the first is played again so the second is oldest */
+  for (i = 0; i < SampleCache::SLOTS; i++)
+  {
+    region.addr = IMAGE_ADDR + (i * 8192);
+    HTST_check(streamer.preload(region));
+    streamer.service();
+  }
+
+  HTST_check(SampleCache::SLOTS == cache.resident());
+  region.addr = IMAGE_ADDR;
+  HTST_check(NULL != cache.find(region, &frames));
+  HTST_check(SampleCache::ATTACK_FRAMES == frames);
+
+  region.addr = IMAGE_ADDR + (SampleCache::SLOTS * 8192);
+  HTST_check(streamer.preload(region));
+  streamer.service();
+  HTST_check(1 == cache.evictions());
+  region.addr = IMAGE_ADDR + 8192;
+  HTST_check(NULL == cache.find(region, &frames));
+  region.addr = IMAGE_ADDR;
+  HTST_check(NULL != cache.find(region, &frames));
+
+  /* a hit under a real bus is bit exact from the first block on */
+  setup(FLASH_CLK_HZ, 10000);
+  streamer.play(voice, region);
+  HTST_check(3 == cache.hits());
+  underruns = voice.underruns();
+
+  for (blk = 0; blk < 100; blk++)
+  {
+    streamer.service();
+    HOST_SPI_run(W25Q_SPI_CH, BLOCK_NS);
+    voice.generate(out, BLOCK_SIZE);
+
+    for (i = 0; i < BLOCK_SIZE; i++, played++) {
+      HTST_check(out[i] == expected(played)); }
+  }
+
+  HTST_check(played > SampleCache::ATTACK_FRAMES);
+  HTST_check(underruns == voice.underruns());
+
+  /* still inside its attack, the playing slot survives a full turnover */
+  streamer.play(voice, region);
+  voice.generate(out, BLOCK_SIZE);
+
+  for (i = 1; i <= SampleCache::SLOTS; i++)
+  {
+    region.addr = IMAGE_ADDR + ((SampleCache::SLOTS + i) * 8192);
+    streamer.preload(region);
+  }
+
+  region.addr = IMAGE_ADDR;
+  HTST_check(NULL != cache.find(region, &frames));
+
+  teardown();
+
+  /* under load a cached note on is instant, an uncached one waits on a read */
+  HTST_check(0 == noteOnLatency(10000, true, BLOCK_NS));
+  HTST_check(noteOnLatency(10000, false, BLOCK_NS) > 0);
+
+  return true;
+}
+
+
+/* note on to first sample with other voices streaming, mean & worst over
+ * where in the block the note arrives */
+bool HTST_sampleCacheBench(void)
+{
+  static uint32_t const latency_ns[] = {1000, 10000, 50000, 100000};
+  static char const *const names[] = {"streamed", "cached"};
+  double sum, worst;
+  uint32_t frames;
+  char name[64];
+  uint32_t l, c, p;
+
+  printf("  %u ms attacks, %u slots, %u bytes\n",
+         (unsigned)SAMPLE_CACHE_ATTACK_MS,
+         (unsigned)SampleCache::SLOTS,
+         (unsigned)sizeof(SampleCache));
+
+  for (l = 0; l < SIZEOF(latency_ns); l++)
+  {
+    for (c = 0; c < 2; c++)
+    {
+      sum = 0.0;
+      worst = 0.0;
+
+      for (p = 0; p <= 8; p++)
+      {
+        frames = noteOnLatency(latency_ns[l], (1 == c), (BLOCK_NS / 8) * p);
+        sum += frames;
+        if (frames > worst) {
+          worst = frames; }
+      }
+
+      snprintf(name, sizeof(name), "note on, %s, %u us latency, mean", names[c], (unsigned)(latency_ns[l] / 1000));
+      HTST_report(name, (sum / 9.0) * (1000000.0 / SAMPLE_RATE), "us");
+      snprintf(name, sizeof(name), "note on, %s, %u us latency, worst", names[c], (unsigned)(latency_ns[l] / 1000));
+      HTST_report(name, worst * (1000000.0 / SAMPLE_RATE), "us");
+    }
+  }
+
+  return true;
+}
+
+
+static bool flashModel(IO_num_e cs_pin, uint8_t const *tx, uint8_t *rx, uint16_t len, void *ctx)
+{
+  uint32_t addr;
+  uint32_t i;
+
+  (void)cs_pin;
+  (void)ctx;
+
+  if ((NULL == tx) || (NULL == rx)) {
+    return true; }
+
+  /* jedec id, capacity byte says 16 MB */
+  if ((0x9F == tx[0]) && (len >= 4)) {
+    rx[3] = 0x18; }
+
+  if ((0x03 == tx[0]) && (len > W25Q_READ_HEADER))
+  {
+    addr = ((uint32_t)tx[1] << 16) | ((uint32_t)tx[2] << 8) | tx[3];
+
+    for (i = 0; i < (uint32_t)(len - W25Q_READ_HEADER); i++, addr++)
+    {
+      if ((addr >= IMAGE_ADDR) && ((addr - IMAGE_ADDR) < sizeof(image))) {
+        rx[W25Q_READ_HEADER + i] = ((uint8_t const *)image)[addr - IMAGE_ADDR]; }
+      else {
+        rx[W25Q_READ_HEADER + i] = 0xFF; }
+    }
+  }
+
+  return true;
+}
+
+static void setup(uint32_t clk_hz, uint32_t latency_ns)
+{
+  uint32_t i;
+
+  for (i = 0; i < IMAGE_FRAMES; i++) {
+    image[i] = (int16_t)(((i * 7919u) & 0x3FFF) + 1); }
+
+  HOST_SPI_attach(W25Q_SPI_CH, flashModel, NULL);
+  HOST_SPI_setTiming(W25Q_SPI_CH, 0, 0);
+  W25Q_init();
+  HOST_SPI_setTiming(W25Q_SPI_CH, clk_hz, latency_ns);
+}
+
+static void teardown(void)
+{
+  HOST_SPI_setTiming(W25Q_SPI_CH, 0, 0);
+  HOST_SPI_attach(W25Q_SPI_CH, NULL, NULL);
+}
+
+static float expected(uint32_t frame)
+{
+  return (float)image[frame] * (1.0f / 32768.0f);
+}
+
+/* most voices that play TRIAL_BLOCKS without a single underrun */
+static uint32_t sustained(uint32_t clk_hz, uint32_t latency_ns, float rate)
+{
+  Sampler::region_t region = {IMAGE_ADDR, IMAGE_FRAMES, 440.0f};
+  float out[BLOCK_SIZE];
+  uint32_t best = 0;
+  uint32_t underruns;
+  uint32_t n, v, blk;
+
+  setup(clk_hz, latency_ns);
+
+  for (n = 1; n <= MAX_VOICES; n++)
+  {
+    SampleStreamer streamer;
+
+    underruns = 0;
+
+    for (v = 0; v < n; v++)
+    {
+      streamer.attach(voices[v]);
+      underruns -= voices[v].underruns();
+      /* spread across the image so no two voices share reads */
+      region.addr = IMAGE_ADDR + (v * 4096);
+      voices[v].play(region);
+      voices[v].setFrequency(440.0f * rate);
+    }
+
+    for (blk = 0; blk < TRIAL_BLOCKS; blk++)
+    {
+      streamer.service();
+      HOST_SPI_run(W25Q_SPI_CH, BLOCK_NS);
+
+      for (v = 0; v < n; v++) {
+        voices[v].generate(out, BLOCK_SIZE); }
+    }
+
+    for (v = 0; v < n; v++)
+    {
+      underruns += voices[v].underruns();
+      voices[v].stop();
+    }
+
+    if (underruns) {
+      break; }
+
+    best = n;
+  }
+
+  teardown();
+
+  return best;
+}
+
+/* frames from note on to the first sound, with half the pool streaming.
+ * the note arrives phase_ns into a block, the block renders at its end */
+static uint32_t noteOnLatency(uint32_t latency_ns, bool cached, uint32_t phase_ns)
+{
+  Sampler::region_t region = {IMAGE_ADDR, IMAGE_FRAMES, 440.0f};
+  Sampler::region_t note = {IMAGE_ADDR + 0x40000, 20000, 440.0f};
+  SampleStreamer streamer;
+  Sampler &voice = voices[MAX_VOICES - 1];
+  float out[BLOCK_SIZE];
+  uint32_t latency = 0;
+  bool sounding = false;
+  uint32_t v, blk, i;
+
+  cache.clear();
+  streamer.setCache(cache);
+  setup(FLASH_CLK_HZ, latency_ns);
+
+  for (v = 0; v < (MAX_VOICES / 2); v++)
+  {
+    streamer.attach(voices[v]);
+    region.addr = IMAGE_ADDR + (v * 4096);
+    voices[v].play(region);
+  }
+
+  streamer.attach(voice);
+
+  if (cached) {
+    streamer.preload(note); }
+
+  for (blk = 0; (blk < 200) && (false == sounding); blk++)
+  {
+    streamer.service();
+
+    /* mid stream, with the other voices' reads going */
+    if (50 == blk)
+    {
+      HOST_SPI_run(W25Q_SPI_CH, phase_ns);
+      streamer.play(voice, note);
+      streamer.service();
+      HOST_SPI_run(W25Q_SPI_CH, BLOCK_NS - phase_ns);
+    }
+    else
+    {
+      HOST_SPI_run(W25Q_SPI_CH, BLOCK_NS);
+    }
+
+    for (v = 0; v < (MAX_VOICES / 2); v++) {
+      voices[v].generate(out, BLOCK_SIZE); }
+
+    voice.generate(out, BLOCK_SIZE);
+
+    if (blk < 50) {
+      continue; }
+
+    for (i = 0; (i < BLOCK_SIZE) && (false == sounding); i++)
+    {
+      if (0.0f == out[i]) {
+        latency++; }
+      else {
+        sounding = true; }
+    }
+  }
+
+  for (v = 0; v < (MAX_VOICES / 2); v++) {
+    voices[v].stop(); }
+  voice.stop();
+
+  teardown();
+
+  return latency;
+}
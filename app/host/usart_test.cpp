@@ -0,0 +1,306 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "host.h"
+#include "merror.h"
+#include "usart.h"
+
+#include <stdio.h>
+
+
+#define CH              USART_CH_2
+#define DEBUG_BAUD      2000000
+
+#define STREAM_BYTES    (64 * 1024)
+#define CHUNK           64
+
+
+typedef struct
+{
+  uint32_t bytes;             ///< received so far
+  uint32_t errors;            ///< not the byte expected next
+  uint32_t calls;
+  uint64_t last_ns;           ///< simulated time of the last call
+  uint8_t  data[16];
+} probe_t;
+
+
+static probe_t probe;
+
+
+static void reset       (uint32_t baud);
+static void probeCb     (uint8_t const *data, uint16_t length, void *ctx);
+static void thruCb      (uint8_t const *data, uint16_t length, void *ctx);
+static void sinkFn      (uint8_t byte, uint64_t ns, void *ctx);
+static bool stream      (uint32_t baud, uint32_t bytes, double *line_use, double *irq_per_kb);
+static uint64_t latency (uint32_t baud);
+
+
+/* bytes arrive in order, one interrupt per burst, one idle frame late */
+bool HTST_usart(void)
+{
+  uint8_t const note_on[3] = {0x90, 60, 100};
+  uint8_t buf[300];
+  uint8_t out[300];
+  HOST_usart_stats_t stats;
+  uint64_t start, byte_ns;
+  uint32_t i;
+  uint16_t n;
+  double line_use, irq_per_kb;
+
+  byte_ns = 10 * 1000000000ull / USART_MIDI_BAUD;
+
+  /* a note on the wire, the callback runs once, one frame after the last stop bit */
+  reset(USART_MIDI_BAUD);
+  USART_setRxCallback(CH, probeCb, &probe);
+
+  start = HOST_USART_now(CH);
+  HTST_check(USART_write(CH, note_on, sizeof(note_on)));
+  HTST_check(sizeof(note_on) == USART_txPending(CH));
+
+  HOST_USART_run(CH, 3 * byte_ns);
+  HTST_check(0 == USART_txPending(CH));
+  HTST_check(0 == probe.calls);
+
+  HOST_USART_run(CH, byte_ns);
+  HTST_check(1 == probe.calls);
+  HTST_check((sizeof(note_on) == probe.bytes) && (0 == memcmp(probe.data, note_on, sizeof(note_on))));
+  HTST_check((4 * byte_ns) == (probe.last_ns - start));
+
+  HOST_USART_getStats(CH, &stats);
+  HTST_check((1 == stats.rx_irqs) && (1 == stats.tx_dmas));
+
+  HTST_check(byte_ns == latency(USART_MIDI_BAUD));
+
+  /* polled, through the half & full points & round the end of the buffer */
+  reset(USART_MIDI_BAUD);
+
+  for (i = 0; i < sizeof(buf); i++) {
+    buf[i] = (uint8_t)(i * 7); }
+
+  HTST_check(USART_write(CH, buf, sizeof(buf)));
+  HOST_USART_run(CH, 200 * byte_ns);
+
+  /* only what the last event published, the half point */
+  n = USART_read(CH, out, 100);
+  n += USART_read(CH, &out[n], sizeof(out));
+  HTST_check(128 == n);
+
+  HOST_USART_run(CH, (sizeof(buf) - 200 + 1) * byte_ns);
+  n += USART_read(CH, &out[n], sizeof(out) - n);
+  HTST_check((sizeof(buf) == n) && (0 == memcmp(buf, out, sizeof(buf))));
+  HTST_check(0 == USART_read(CH, out, sizeof(out)));
+
+  HOST_USART_getStats(CH, &stats);
+  HTST_check(3 == stats.rx_irqs);
+
+  /* all or nothing when the queue is short */
+  reset(USART_MIDI_BAUD);
+  HOST_MERR_clear();
+
+  n = USART_txFree(CH);
+  HTST_check(USART_write(CH, buf, (uint16_t)(n - 2)));
+  HTST_check(false == USART_write(CH, note_on, sizeof(note_on)));
+  HTST_check(1 == HOST_MERR_count(MERROR_USART_TX_OVERFLOW));
+  HTST_check(2 == USART_txFree(CH));
+
+  /* room comes back a transfer at a time, the next write wraps the queue */
+  HOST_USART_run(CH, byte_ns);
+  HTST_check(2 == USART_txFree(CH));
+  HOST_USART_run(CH, (n / 4) * byte_ns);
+  HTST_check(USART_write(CH, note_on, sizeof(note_on)));
+  HOST_USART_run(CH, (n + 2) * byte_ns);
+  HTST_check(0 == USART_txPending(CH));
+
+  /* four quarters & the wrapped byte */
+  HOST_USART_getStats(CH, &stats);
+  HTST_check((n + 1u) == stats.tx_bytes);
+  HTST_check(5 == stats.tx_dmas);
+
+  /* thru, bytes coming in are written straight back out from the callback */
+  reset(USART_MIDI_BAUD);
+  HOST_USART_setLoopback(CH, false);
+  HOST_USART_attach(CH, sinkFn, &probe);
+  USART_setRxCallback(CH, thruCb, NULL);
+
+  HTST_check(HOST_USART_inject(CH, note_on, sizeof(note_on)));
+  HOST_USART_run(CH, 8 * byte_ns);
+  HTST_check((sizeof(note_on) == probe.bytes) && (0 == memcmp(probe.data, note_on, sizeof(note_on))));
+
+  HOST_USART_attach(CH, NULL, NULL);
+
+  /* debug output keeps the line busy, dma not the cpu moves the bytes */
+  HTST_check(stream(DEBUG_BAUD, STREAM_BYTES / 4, &line_use, &irq_per_kb));
+  HTST_check(line_use > 0.99);
+  HTST_check(irq_per_kb < 20.0);
+
+  USART_deInit(CH);
+
+  return true;
+}
+
+
+/* line use & interrupts at each rate, host cpu per byte through the driver */
+bool HTST_usartBench(void)
+{
+  uint64_t ns;
+  double line_use, irq_per_kb;
+
+  ns = HTST_nowNs();
+  stream(DEBUG_BAUD, STREAM_BYTES, &line_use, &irq_per_kb);
+  ns = HTST_nowNs() - ns;
+
+  HTST_report("usart 2 Mbaud line use", line_use * 100.0, "%");
+  HTST_report("usart 2 Mbaud rx interrupts", irq_per_kb, "per KB");
+  HTST_report("usart 2 Mbaud rx latency after last byte", latency(DEBUG_BAUD) / 1e3, "us");
+  HTST_report("usart write + loopback + rx callback", (double)ns / STREAM_BYTES, "ns/byte");
+
+  stream(USART_MIDI_BAUD, STREAM_BYTES / 16, &line_use, &irq_per_kb);
+
+  HTST_report("usart midi line use", line_use * 100.0, "%");
+  HTST_report("usart midi rx interrupts", irq_per_kb, "per KB");
+  HTST_report("usart midi rx latency after last byte", latency(USART_MIDI_BAUD) / 1e3, "us");
+
+  USART_deInit(CH);
+
+  return true;
+}
+
+
+static void reset(uint32_t baud)
+{
+  USART_cfg_t cfg;
+
+  cfg.baud = baud;
+
+  USART_deInit(CH);
+  USART_init(CH, &cfg);
+  USART_setRxCallback(CH, NULL, NULL);
+  HOST_USART_setLoopback(CH, true);
+  HOST_USART_clearStats(CH);
+
+  memset(&probe, 0, sizeof(probe));
+}
+
+static void probeCb(uint8_t const *data, uint16_t length, void *ctx)
+{
+  probe_t *p = (probe_t*)ctx;
+  uint16_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    if (p->bytes < sizeof(p->data)) {
+      p->data[p->bytes] = data[i]; }
+
+    if (data[i] != (uint8_t)p->bytes) {
+      p->errors++; }
+
+    p->bytes++;
+  }
+
+  p->calls++;
+  p->last_ns = HOST_USART_now(CH);
+}
+
+static void thruCb(uint8_t const *data, uint16_t length, void *ctx)
+{
+  (void)ctx;
+
+  USART_write(CH, data, length);
+}
+
+static void sinkFn(uint8_t byte, uint64_t ns, void *ctx)
+{
+  probe_t *p = (probe_t*)ctx;
+
+  if (p->bytes < sizeof(p->data)) {
+    p->data[p->bytes] = byte; }
+
+  p->bytes++;
+  p->last_ns = ns;
+}
+
+/* counting bytes, topped up a chunk at a time as room frees up */
+static bool stream(uint32_t baud, uint32_t bytes, double *line_use, double *irq_per_kb)
+{
+  uint8_t chunk[CHUNK];
+  HOST_usart_stats_t stats;
+  uint64_t start, byte_ns;
+  uint32_t sent = 0;
+  uint32_t i;
+
+  reset(baud);
+  USART_setRxCallback(CH, probeCb, &probe);
+
+  byte_ns = 10 * 1000000000ull / baud;
+  start = HOST_USART_now(CH);
+
+  while (probe.bytes < bytes)
+  {
+    while ((sent < bytes) && (USART_txFree(CH) >= CHUNK))
+    {
+      for (i = 0; i < CHUNK; i++) {
+        chunk[i] = (uint8_t)(sent + i); }
+
+      USART_write(CH, chunk, CHUNK);
+      sent += CHUNK;
+    }
+
+    /* the main loop comes round every 16 bytes or so */
+    HOST_USART_run(CH, 16 * byte_ns);
+  }
+
+  HOST_USART_getStats(CH, &stats);
+
+  *line_use = (double)(bytes * byte_ns) / (double)(probe.last_ns - start);
+  *irq_per_kb = (double)stats.rx_irqs * 1024.0 / bytes;
+
+  return (0 == probe.errors) && (bytes == probe.bytes);
+}
+
+/* last stop bit on the wire to the rx callback, simulated ns */
+static uint64_t latency(uint32_t baud)
+{
+  uint8_t const msg[3] = {0, 1, 2};
+  probe_t wire;
+
+  reset(baud);
+  memset(&wire, 0, sizeof(wire));
+  USART_setRxCallback(CH, probeCb, &probe);
+  HOST_USART_attach(CH, sinkFn, &wire);
+
+  USART_write(CH, msg, sizeof(msg));
+  HOST_USART_run(CH, 10 * 10 * 1000000000ull / baud);
+
+  HOST_USART_attach(CH, NULL, NULL);
+
+  return probe.last_ns - wire.last_ns;
+}
@@ -0,0 +1,397 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "host.h"
+#include "usb.h"
+
+#include "usb_midi.hpp"
+
+#include <stdio.h>
+
+
+#define MAX_MSGS        64
+#define BURST_CCS       256
+#define BENCH_EVENTS    (1000 * 16)
+
+
+class UsbLog : public MidiParser::Handler
+{
+  public:
+    UsbLog(void) { clear(); }
+
+    void clear(void)
+    {
+      msgs = 0;
+      sysex_bytes = 0;
+      sysex_last = 0;
+    }
+
+    void message(midi_msg_t const &msg)
+    {
+      if (msgs < MAX_MSGS) {
+        msg_log[msgs] = msg; }
+
+      msgs++;
+    }
+
+    void sysex(uint8_t const *data, uint16_t length, bool last)
+    {
+      if ((sysex_bytes + length) <= sizeof(sysex_data)) {
+        memcpy(&sysex_data[sysex_bytes], data, length); }
+
+      sysex_bytes += length;
+      sysex_last += last;
+    }
+
+    midi_msg_t msg_log[MAX_MSGS];
+    uint32_t msgs;
+    uint8_t  sysex_data[64];
+    uint32_t sysex_bytes;
+    uint32_t sysex_last;
+};
+
+/* what the host takes off the bulk in endpoint */
+typedef struct
+{
+  uint8_t  data[1024];
+  uint32_t length;
+  uint32_t packets;
+} usb_host_t;
+
+
+/* usb midi 1.0 spec appendix b, self powered */
+static uint8_t const spec_desc[] =
+{
+  0x09, 0x02, 0x65, 0x00, 0x02, 0x01, 0x00, 0xC0, 0x32,
+  0x09, 0x04, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00,
+  0x09, 0x24, 0x01, 0x00, 0x01, 0x09, 0x00, 0x01, 0x01,
+  0x09, 0x04, 0x01, 0x00, 0x02, 0x01, 0x03, 0x00, 0x00,
+  0x07, 0x24, 0x01, 0x00, 0x01, 0x41, 0x00,
+  0x06, 0x24, 0x02, 0x01, 0x01, 0x00,
+  0x06, 0x24, 0x02, 0x02, 0x02, 0x00,
+  0x09, 0x24, 0x03, 0x01, 0x03, 0x01, 0x02, 0x01, 0x00,
+  0x09, 0x24, 0x03, 0x02, 0x04, 0x01, 0x01, 0x01, 0x00,
+  0x09, 0x05, 0x01, 0x02, 0x40, 0x00, 0x00, 0x00, 0x00,
+  0x05, 0x25, 0x01, 0x01, 0x01,
+  0x09, 0x05, 0x81, 0x02, 0x40, 0x00, 0x00, 0x00, 0x00,
+  0x05, 0x25, 0x01, 0x01, 0x03,
+};
+
+static uint8_t desc[UsbMidi::descriptorLength(USB_MIDI_MAX_CABLES)];
+static uint8_t sysex_buf[8];
+
+
+static bool descriptors   (void);
+static bool packets       (void);
+static bool throughUsb    (void);
+static void hostIn        (uint8_t const *data, uint16_t length, void *ctx);
+static void deviceRx      (uint8_t const *data, uint16_t length, void *ctx);
+
+
+/* descriptor bytes, packing both ways & the bulk endpoints */
+bool HTST_usbMidi(void)
+{
+  HTST_check(descriptors());
+  HTST_check(packets());
+  HTST_check(throughUsb());
+
+  return true;
+}
+
+
+/* unpacking cost & a burst of controllers either way out */
+bool HTST_usbMidiBench(void)
+{
+  static uint8_t stream[BENCH_EVENTS * USB_MIDI_PACKET];
+  UsbLog log;
+  UsbMidi usb(log);
+  usb_host_t host;
+  USB_cfg_t cfg;
+  midi_msg_t msg;
+  uint64_t ns;
+  uint32_t i, frames;
+
+  msg.status = 0xB0;
+  msg.length = 2;
+  for (i = 0; i < BENCH_EVENTS; i++)
+  {
+    msg.data[0] = (uint8_t)(i & 0x7F);
+    msg.data[1] = (uint8_t)((i >> 7) & 0x7F);
+    UsbMidi::pack(msg, 0, &stream[i * USB_MIDI_PACKET]);
+  }
+
+  ns = HTST_nowNs();
+  for (i = 0; i < BENCH_EVENTS; i += 16) {
+    usb.parse(&stream[i * USB_MIDI_PACKET], USB_EP_SIZE, i); }
+  ns = HTST_nowNs() - ns;
+
+  if (log.msgs != BENCH_EVENTS) {
+    return false; }
+
+  HTST_report("usb midi parse", (double)ns / BENCH_EVENTS, "ns/event");
+
+  /* the host takes a packet a frame, the least a driver does */
+  cfg.config_desc = desc;
+  cfg.config_length = UsbMidi::descriptor(desc, sizeof(desc));
+  USB_init(&cfg);
+  HOST_USB_connect(true);
+  host.length = 0;
+  host.packets = 0;
+  HOST_USB_attach(hostIn, &host);
+
+  for (i = 0, frames = 0; host.length < (BURST_CCS * USB_MIDI_PACKET); frames++)
+  {
+    while ((i < BURST_CCS) && (USB_txFree() >= USB_MIDI_PACKET)) {
+      USB_write(&stream[USB_MIDI_PACKET * i++], USB_MIDI_PACKET); }
+
+    if (0 == HOST_USB_poll(1)) {
+      return false; }
+  }
+
+  HTST_report("256 controllers over usb, 1 packet per frame", (double)frames, "ms");
+  HTST_report("256 controllers over din", BURST_CCS * 3 * 0.32, "ms");
+
+  HOST_USB_attach(NULL, NULL);
+  HOST_USB_connect(false);
+
+  return true;
+}
+
+
+static bool descriptors(void)
+{
+  uint16_t length, total, n;
+  uint32_t i, jacks;
+
+  /* one cable, byte for byte */
+  length = UsbMidi::descriptor(desc, sizeof(desc));
+  HTST_check(sizeof(spec_desc) == length);
+  HTST_check(UsbMidi::descriptorLength(1) == length);
+  HTST_check(0 == memcmp(desc, spec_desc, length));
+
+  /* every cable adds 4 jacks, the lengths chain to wTotalLength */
+  for (n = 1; n <= USB_MIDI_MAX_CABLES; n++)
+  {
+    length = UsbMidi::descriptor(desc, sizeof(desc), (uint8_t)n);
+    HTST_check(UsbMidi::descriptorLength((uint8_t)n) == length);
+
+    total = (uint16_t)(desc[2] | (desc[3] << 8));
+    HTST_check(total == length);
+
+    jacks = 0;
+    for (i = 0; i < length; i += desc[i])
+    {
+      HTST_check(desc[i] >= 2);
+      if ((0x24 == desc[i + 1]) && ((0x02 == desc[i + 2]) || (0x03 == desc[i + 2]))) {
+        jacks++; }
+    }
+    HTST_check(i == length);
+    HTST_check((4u * n) == jacks);
+
+    /* each endpoint names the embedded jack of every cable */
+    HTST_check(n == desc[length - 1 - n]);
+    HTST_check(((4 * (n - 1)) + 3) == desc[length - 1]);
+  }
+
+  /* does not fit or makes no sense */
+  HTST_check(0 == UsbMidi::descriptor(desc, UsbMidi::descriptorLength(1) - 1));
+  HTST_check(0 == UsbMidi::descriptor(desc, sizeof(desc), 0));
+  HTST_check(0 == UsbMidi::descriptor(desc, sizeof(desc), USB_MIDI_MAX_CABLES + 1));
+
+  return true;
+}
+
+
+static bool packets(void)
+{
+  uint8_t const payload[5] = {0x7D, 0x01, 0x02, 0x03, 0x04};
+  uint8_t const cin_end[4] = {0x06, 0x07, 0x05, 0x06};
+  UsbLog log;
+  UsbMidi usb(log, sysex_buf, sizeof(sysex_buf));
+  UsbMidi other(log, NULL, 0, 3);
+  midi_msg_t msg;
+  uint8_t p[8 * USB_MIDI_PACKET];
+  uint16_t n, len;
+
+  /* channel message, 2 byte one padded with 0 */
+  msg.status = 0x93;
+  msg.length = 2;
+  msg.data[0] = 60;
+  msg.data[1] = 100;
+  HTST_check(UsbMidi::pack(msg, 0, p));
+  HTST_check((0x09 == p[0]) && (0x93 == p[1]) && (60 == p[2]) && (100 == p[3]));
+
+  msg.status = 0xC1;
+  msg.length = 1;
+  HTST_check(UsbMidi::pack(msg, 2, &p[4]));
+  HTST_check((0x2C == p[4]) && (0xC1 == p[5]) && (60 == p[6]) && (0 == p[7]));
+
+  /* system common & realtime */
+  msg.status = 0xF2;
+  msg.length = 2;
+  HTST_check(UsbMidi::pack(msg, 0, p) && (0x03 == p[0]));
+  msg.status = 0xF6;
+  msg.length = 0;
+  HTST_check(UsbMidi::pack(msg, 0, p) && (0x05 == p[0]) && (0 == p[2]));
+  msg.status = 0xF8;
+  HTST_check(UsbMidi::pack(msg, 1, p) && (0x1F == p[0]) && (0xF8 == p[1]));
+  msg.status = 0xF0;
+  HTST_check(false == UsbMidi::pack(msg, 0, p));
+
+  /* back again, cable 2 is not this one's */
+  msg.status = 0x93;
+  msg.length = 2;
+  UsbMidi::pack(msg, 0, p);
+  usb.parse(p, 2 * USB_MIDI_PACKET, 1234);
+  HTST_check(1 == log.msgs);
+  HTST_check((1234 == log.msg_log[0].time) && (0x93 == log.msg_log[0].status) && (100 == log.msg_log[0].data[1]));
+  HTST_check((1 == usb.events()) && (1 == usb.dropped()));
+
+  /* reserved codes & a short event at the end */
+  p[0] = 0x00;
+  p[4] = 0x01;
+  usb.parse(p, 2 * USB_MIDI_PACKET + 3, 0);
+  HTST_check((1 == log.msgs) && (4 == usb.dropped()));
+
+  p[0] = 0x39;
+  other.parse(p, USB_MIDI_PACKET, 0);
+  HTST_check((2 == log.msgs) && (1 == other.events()));
+
+  /* sysex ends on 1, 2 or 3 bytes */
+  for (len = 0; len < 4; len++)
+  {
+    n = UsbMidi::packSysex(payload, len, 0, p, sizeof(p));
+    HTST_check((((len + 4u) / 3u) * USB_MIDI_PACKET) == n);
+    HTST_check((0xF0 == p[1]) && (cin_end[len] == p[n - USB_MIDI_PACKET]));
+  }
+
+  /* 5 bytes: f0 7d 01 | 02 03 04 | f7 */
+  n = UsbMidi::packSysex(payload, 5, 1, p, sizeof(p));
+  HTST_check((3 * USB_MIDI_PACKET) == n);
+  HTST_check((0x14 == p[0]) && (0x14 == p[4]) && (0x15 == p[8]) && (0xF7 == p[9]) && (0 == p[10]));
+  HTST_check(0 == UsbMidi::packSysex(payload, 5, 1, p, n - 1));
+
+  n = UsbMidi::packSysex(payload, 5, 0, p, sizeof(p));
+  log.clear();
+  usb.parse(p, n, 0);
+  HTST_check((5 == log.sysex_bytes) && (1 == log.sysex_last));
+  HTST_check(0 == memcmp(log.sysex_data, payload, 5));
+
+  return true;
+}
+
+
+static bool throughUsb(void)
+{
+  EventBus bus;
+  MidiToBus to_bus(bus, EVENT_SRC_USB_MIDI);
+  UsbMidi usb(to_bus);
+  usb_host_t host;
+  USB_cfg_t cfg;
+  midi_msg_t msg;
+  event_t e;
+  uint8_t transfer[20 * USB_MIDI_PACKET];
+  uint32_t i, offset, notes;
+  uint16_t length;
+
+  cfg.config_desc = desc;
+  cfg.config_length = UsbMidi::descriptor(desc, sizeof(desc));
+  HTST_check(USB_init(&cfg));
+  HTST_check(HOST_USB_configDesc(&length) == desc);
+  HTST_check(cfg.config_length == length);
+
+  USB_setRxCallback(deviceRx, &usb);
+  host.length = 0;
+  host.packets = 0;
+  HOST_USB_attach(hostIn, &host);
+
+  /* nothing goes until the host has configured it */
+  HTST_check(false == USB_write(transfer, USB_MIDI_PACKET));
+  HTST_check(false == HOST_USB_send(transfer, USB_MIDI_PACKET));
+  HOST_USB_connect(true);
+  HTST_check(USB_isConfigured());
+
+  /* 20 note ons in one transfer, a full packet & a short one */
+  msg.status = 0x90;
+  msg.length = 2;
+  msg.data[1] = 90;
+  for (i = 0; i < 20; i++)
+  {
+    msg.data[0] = (uint8_t)(40 + i);
+    UsbMidi::pack(msg, 0, &transfer[i * USB_MIDI_PACKET]);
+  }
+
+  HOST_USB_clearStats();
+  HTST_check(HOST_USB_send(transfer, sizeof(transfer)));
+
+  bus.beginBlock();
+  for (notes = 0; bus.next(e, offset); notes++) {
+    HTST_check((EVENT_NOTE_ON == e.type) && ((40 + notes) == e.a)); }
+  HTST_check(20 == notes);
+  HTST_check(20 == usb.events());
+
+  /* the other way, the first goes straight out & the rest share
+   * packets while it waits for the host */
+  for (i = 0; i < 20; i++) {
+    HTST_check(USB_write(&transfer[i * USB_MIDI_PACKET], USB_MIDI_PACKET)); }
+
+  HTST_check(3 == HOST_USB_poll(10));
+  HTST_check((3 == host.packets) && (sizeof(transfer) == host.length));
+  HTST_check(0 == memcmp(host.data, transfer, sizeof(transfer)));
+
+  /* unplugged, queued packets go */
+  HTST_check(USB_write(transfer, USB_MIDI_PACKET));
+  HOST_USB_connect(false);
+  HTST_check(0 == HOST_USB_poll(10));
+  HTST_check(false == USB_write(transfer, USB_MIDI_PACKET));
+
+  HOST_USB_attach(NULL, NULL);
+  USB_setRxCallback(NULL, NULL);
+
+  return true;
+}
+
+
+static void hostIn(uint8_t const *data, uint16_t length, void *ctx)
+{
+  usb_host_t *host = (usb_host_t*)ctx;
+
+  if ((host->length + length) <= sizeof(host->data)) {
+    memcpy(&host->data[host->length], data, length); }
+
+  host->length += length;
+  host->packets++;
+}
+
+static void deviceRx(uint8_t const *data, uint16_t length, void *ctx)
+{
+  ((UsbMidi*)ctx)->parse(data, length, 0);
+}
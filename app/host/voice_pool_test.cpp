@@ -0,0 +1,185 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "voice_pool.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define BENCH_NOTES     100000
+#define BENCH_BLOCKS    20000
+
+
+static bool releaseAll(VoicePool &pool, float *block);
+
+
+/* allocation, each steal policy & release back to free */
+bool HTST_voicePool(void)
+{
+  static VoicePool pool;
+  float block[BLOCK_SIZE];
+  uint8_t first, v;
+  uint32_t steals, i;
+  float sum;
+
+  /* distinct voices until full */
+  for (i = 0; i < MAX_VOICES; i++) {
+    HTST_check(i == pool.noteOn(60 + i, 100)); }
+  HTST_check(MAX_VOICES == pool.active());
+  HTST_check(0 == pool.steals());
+
+  pool.render(block, BLOCK_SIZE);
+  for (i = 0, sum = 0.0f; i < BLOCK_SIZE; i++) {
+    sum += fabsf(block[i]); }
+  HTST_check(sum > 0.0f);
+
+  /* oldest, first note on goes */
+  v = pool.noteOn(90, 100);
+  HTST_check(0 == v);
+  HTST_check(90 == pool.noteOf(0));
+  HTST_check(1 == pool.steals());
+  HTST_check(MAX_VOICES == pool.active());
+
+  /* oldest prefers a released note even if it is newer */
+  pool.noteOff(60 + MAX_VOICES - 1);
+  v = pool.noteOn(91, 100);
+  HTST_check((MAX_VOICES - 1) == v);
+
+  /* quietest, one voice part way through its release */
+  HTST_check(releaseAll(pool, block));
+  pool.setStealPolicy(VoicePool::STEAL_QUIETEST);
+  pool.setAttack(0.0f);
+  pool.setRelease(1.0f);
+  for (i = 0; i < MAX_VOICES; i++) {
+    pool.noteOn(60 + i, 100); }
+  pool.render(block, BLOCK_SIZE);
+  pool.noteOff(63);
+  pool.render(block, BLOCK_SIZE);
+  HTST_check(pool.levelOf(3) < pool.levelOf(0));
+  v = pool.noteOn(92, 100);
+  HTST_check(3 == v);
+
+  /* same note, retriggers in place & never doubles up */
+  HTST_check(releaseAll(pool, block));
+  pool.setStealPolicy(VoicePool::STEAL_SAME_NOTE);
+  steals = pool.steals();
+  first = pool.noteOn(64, 100);
+  pool.noteOff(64);
+  HTST_check(first == pool.noteOn(64, 100));
+  HTST_check(1 == pool.active());
+  for (i = 1; i < MAX_VOICES; i++) {
+    pool.noteOn(70 + i, 100); }
+  HTST_check(MAX_VOICES == pool.active());
+  HTST_check(first == pool.noteOn(64, 100));
+  HTST_check(steals == pool.steals());
+
+  /* silent once everything has released */
+  HTST_check(releaseAll(pool, block));
+  pool.render(block, BLOCK_SIZE);
+  for (i = 0; i < BLOCK_SIZE; i++) {
+    HTST_check(0.0f == block[i]); }
+
+  return true;
+}
+
+
+/* worst case note on is a steal with a full pool */
+bool HTST_voicePoolBench(void)
+{
+  static char const *const names[VoicePool::STEAL_NUM_OF] =
+  {
+    "voice steal oldest note on",
+    "voice steal quietest note on",
+    "voice steal same note note on",
+  };
+  static VoicePool pool;
+  float block[BLOCK_SIZE];
+  char name[48];
+  uint64_t ns;
+  uint32_t p, i, n;
+
+  HTST_report("voice pool size", MAX_VOICES, "voices");
+  HTST_report("voice pool state", sizeof(pool), "bytes");
+
+  for (p = 0; p < VoicePool::STEAL_NUM_OF; p++)
+  {
+    pool.allOff();
+    pool.setStealPolicy((VoicePool::steal_e)p);
+    for (i = 0; i < MAX_VOICES; i++) {
+      pool.noteOn(i, 100); }
+
+    ns = HTST_nowNs();
+
+    for (i = 0; i < BENCH_NOTES; i++) {
+      pool.noteOn(MAX_VOICES + (i % 64), 100); }
+
+    ns = HTST_nowNs() - ns;
+
+    HTST_report(names[p], (double)ns / BENCH_NOTES, "ns");
+  }
+
+  for (n = 1; n <= MAX_VOICES; n *= 2)
+  {
+    pool.allOff();
+    for (i = 0; i < n; i++) {
+      pool.noteOn(48 + (i * 7), 100); }
+
+    ns = HTST_nowNs();
+
+    for (i = 0; i < BENCH_BLOCKS; i++) {
+      pool.render(block, BLOCK_SIZE); }
+
+    ns = HTST_nowNs() - ns;
+
+    snprintf(name, sizeof(name), "voice render %u voices per block", (unsigned)n);
+    HTST_report(name, (double)ns / BENCH_BLOCKS, "ns");
+    snprintf(name, sizeof(name), "voice render %u voices load", (unsigned)n);
+    HTST_report(name, ((double)ns * SAMPLE_RATE * 100.0) / ((double)BENCH_BLOCKS * BLOCK_SIZE * 1e9), "%");
+  }
+
+  return true;
+}
+
+
+/* render until every voice has finished its release */
+static bool releaseAll(VoicePool &pool, float *block)
+{
+  uint32_t i;
+
+  for (i = 0; i < 128; i++) {
+    pool.noteOff(i); }
+
+  for (i = 0; (i < 100000) && pool.active(); i++) {
+    pool.render(block, BLOCK_SIZE); }
+
+  return (0 == pool.active());
+}
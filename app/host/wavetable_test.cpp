@@ -0,0 +1,192 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "host_test.h"
+
+#include "wavetable.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+
+#define BENCH_BLOCKS    20000
+
+
+/* what the tables replace, one sinf per sample */
+class NaiveSine : public Generator<>
+{
+  public:
+    void setFrequency(float hz) { _inc = hz / SAMPLE_RATE; }
+
+    void generate(float *out, size_t frames)
+    {
+      size_t i;
+
+      for (i = 0; i < frames; i++)
+      {
+        out[i] = sinf(_phase * 6.2831853f);
+        _phase += _inc;
+        if (_phase >= 1.0f) {
+          _phase -= 1.0f; }
+      }
+    }
+
+  private:
+    float _phase = 0.0f;
+    float _inc = 0.0f;
+};
+
+
+static double harmonic(float const *table, uint32_t h);
+static double bench(Generator<> &gen, float hz);
+
+
+/* contents, level selection & band limit of every table */
+bool HTST_wavetable(void)
+{
+  static float out[SAMPLE_RATE];
+  float const *t, *prev;
+  uint32_t s, l, h, i, inc, limit, crossings;
+
+  t = Wavetable::table(Wavetable::SHAPE_SINE, 0);
+  for (i = 0; i <= Wavetable::LENGTH; i++) {
+    HTST_check(fabsf(t[i] - sinf((6.2831853f * i) / Wavetable::LENGTH)) < 1e-5f); }
+  HTST_check(t == Wavetable::table(Wavetable::SHAPE_SINE, UINT32_MAX));
+
+  for (s = Wavetable::SHAPE_TRIANGLE; s < Wavetable::SHAPE_NUM_OF; s++)
+  {
+    prev = NULL;
+
+    for (l = 0; l < Wavetable::LEVELS; l++)
+    {
+      /* fastest increment for this level, nothing above nyquist */
+      inc = 1u << (l + Wavetable::FRAC_BITS);
+      limit = Wavetable::LENGTH >> (l + 1);
+      t = Wavetable::table((Wavetable::shape_e)s, inc);
+
+      HTST_check(t != prev);
+      HTST_check(t[0] == t[Wavetable::LENGTH]);
+      HTST_check(harmonic(t, 1) > 0.1);
+      for (h = limit + 1; h < (Wavetable::LENGTH / 2); h++) {
+        HTST_check(harmonic(t, h) < 1e-4); }
+      for (i = 0; i < Wavetable::LENGTH; i++) {
+        HTST_check(fabsf(t[i]) <= 1.0f); }
+
+      /* one more goes to the next octave */
+      if ((l + 1) < Wavetable::LEVELS) {
+        HTST_check(t != Wavetable::table((Wavetable::shape_e)s, inc + 1)); }
+
+      prev = t;
+    }
+
+    /* above nyquist stays on the last */
+    HTST_check(prev == Wavetable::table((Wavetable::shape_e)s, UINT32_MAX));
+  }
+
+  /* pitch, one second of 1 kHz */
+  Wavetable osc(Wavetable::SHAPE_SINE);
+  osc.setFrequency(1000.0f);
+  osc.generate(out, SIZEOF(out));
+
+  for (i = 1, crossings = 0; i < SIZEOF(out); i++)
+  {
+    if ((out[i - 1] < 0.0f) && (out[i] >= 0.0f)) {
+      crossings++; }
+  }
+  HTST_check((crossings >= 999) && (crossings <= 1001));
+
+  return true;
+}
+
+
+bool HTST_wavetableBench(void)
+{
+  Wavetable saw(Wavetable::SHAPE_SAW);
+  Wavetable sine(Wavetable::SHAPE_SINE);
+  NaiveSine naive;
+  double t, n;
+
+  HTST_report("wavetable flash",
+              (1 + ((Wavetable::SHAPE_NUM_OF - 1) * Wavetable::LEVELS)) * (Wavetable::LENGTH + 1) * sizeof(float),
+              "bytes");
+
+  n = bench(naive, 440.0f);
+  HTST_report("naive sinf per sample", n, "ns");
+
+  t = bench(sine, 440.0f);
+  HTST_report("wavetable sine per sample", t, "ns");
+  HTST_report("wavetable saw per sample", bench(saw, 440.0f), "ns");
+  HTST_report("wavetable speedup over sinf", n / t, "x");
+
+  return true;
+}
+
+
+/* magnitude of harmonic h, 1.0 for a full scale sine */
+static double harmonic(float const *table, uint32_t h)
+{
+  double re = 0.0;
+  double im = 0.0;
+  double w;
+  uint32_t i;
+
+  for (i = 0; i < Wavetable::LENGTH; i++)
+  {
+    w = (6.283185307179586 * h * i) / Wavetable::LENGTH;
+    re += table[i] * cos(w);
+    im += table[i] * sin(w);
+  }
+
+  return (2.0 * sqrt((re * re) + (im * im))) / Wavetable::LENGTH;
+}
+
+
+/* ns per sample */
+static double bench(Generator<> &gen, float hz)
+{
+  static volatile float sink;
+  float block[BLOCK_SIZE];
+  uint64_t ns;
+  uint32_t i;
+
+  gen.setFrequency(hz);
+
+  ns = HTST_nowNs();
+
+  for (i = 0; i < BENCH_BLOCKS; i++)
+  {
+    gen.generate(block, BLOCK_SIZE);
+    sink = block[i % BLOCK_SIZE];
+  }
+
+  ns = HTST_nowNs() - ns;
+  (void)sink;
+
+  return (double)ns / ((double)BENCH_BLOCKS * BLOCK_SIZE);
+}
@@ -29,15 +29,83 @@ SOFTWARE.
 
 
 #include "board.h"
+#include "config.h"
+#include "config_board.h"
+
+#include "audio.hpp"
+#include "event_bus.hpp"
+#include "midi_out.hpp"
+#include "midi_parser.hpp"
+#include "usb_midi.hpp"
+#include "voice_pool.hpp"
+
+
+/* a din byte in sample clock/ 256, the rx callback comes a byte after the last */
+#define MIDI_BYTE_SPACING   ((256u * 10u * SAMPLE_RATE) / USART_MIDI_BAUD)
+
+
+/* silent until something plays notes */
+static VoicePool voices;
+static EventBus events;
+static AudioEngine engine(voices, &events);
+
+/* din in goes to the bus & back out as thru, merged with anything we send */
+static MidiToBus midi_to_bus(events, EVENT_SRC_UART_MIDI);
+static MidiOut midi_out(MIDI_USART_CH);
+static MidiTee midi_split(midi_to_bus, midi_out);
+static MidiParser midi_in(midi_split);
+
+static MidiToBus usb_to_bus(events, EVENT_SRC_USB_MIDI);
+static UsbMidi usb_in(usb_to_bus);
+static uint8_t usb_desc[UsbMidi::descriptorLength(1)];
+
+
+static void midiRx(uint8_t const *data, uint16_t length, void *ctx)
+{
+  (void)ctx;
+
+  midi_in.parse(data, length, events.now() - ((length * MIDI_BYTE_SPACING) >> 8), MIDI_BYTE_SPACING);
+}
+
+/* up to 16 events, all from the last 1 ms frame */
+static void usbRx(uint8_t const *data, uint16_t length, void *ctx)
+{
+  (void)ctx;
+
+  usb_in.parse(data, length, events.now());
+}
 
 
 int main()
 {
+  USB_cfg_t usb_cfg;
+
   BRD_init();
 
   BTST_W25Q();
   BTST_test_lights();
 
-  while(1);
+  engine.start();
+  BRD_audioStart(SAMPLE_RATE,
+                 engine.txBuffer(),
+                 engine.rxBuffer(),
+                 engine.bufferLength(),
+                 AudioEngine::i2sCallback,
+                 &engine);
+  BRD_midiStart(midiRx, NULL);
+
+  usb_cfg.config_desc = usb_desc;
+  usb_cfg.config_length = UsbMidi::descriptor(usb_desc, sizeof(usb_desc));
+  BRD_usbStart(&usb_cfg, usbRx, NULL);
+
+  /* knobs & cv, read with ADC_read() whenever they are wanted */
+  BRD_controlsStart();
+
+  while(1)
+  {
+    BRD_task();
+    midi_out.service();
+  }
+
   return 0;
 }
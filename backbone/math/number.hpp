@@ -0,0 +1,155 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef NUMBER_HPP
+#define NUMBER_HPP
+
+
+#include "common.h"
+
+#include "arm_math.h"
+
+
+/**
+ * @file number.hpp
+ * @brief sample number policies
+ *
+ * Generator, Processor & Parameter take one of these as a template
+ * argument so each stage can be built as float or fixed point. all three
+ * have the same static interface, fixed point arithmetic saturates rather
+ * than wraps & full scale is +/-1.0 in every format
+ */
+
+
+/* single precision fpu */
+struct Float32
+{
+  typedef float sample_t;
+
+  static constexpr char const *name = "float32";
+
+  static sample_t fromFloat (float x) { return x; }
+  static float    toFloat   (sample_t x) { return x; }
+
+  static sample_t add       (sample_t a, sample_t b) { return a + b; }
+  static sample_t sub       (sample_t a, sample_t b) { return a - b; }
+  static sample_t mul       (sample_t a, sample_t b) { return a * b; }
+
+  /* dst += src */
+  static void accumulate(sample_t *dst, sample_t const *src, size_t frames)
+  {
+    size_t i;
+
+    for (i = 0; i < frames; i++) {
+      dst[i] += src[i]; }
+  }
+};
+
+
+/* 1.31, 32 x 32 multiplies */
+struct Q31
+{
+  typedef int32_t sample_t;
+
+  static constexpr char const *name = "q31";
+
+  static sample_t fromFloat(float x)
+  {
+    if (x >= 1.0f) {
+      return INT32_MAX; }
+    if (x <= -1.0f) {
+      return INT32_MIN; }
+
+    return (sample_t)(x * 2147483648.0f);
+  }
+
+  static float    toFloat   (sample_t x) { return (float)x * (1.0f / 2147483648.0f); }
+
+  static sample_t add       (sample_t a, sample_t b) { return __QADD(a, b); }
+  static sample_t sub       (sample_t a, sample_t b) { return __QSUB(a, b); }
+
+  /* as arm_mult_q31, -1 * -1 saturates */
+  static sample_t mul(sample_t a, sample_t b)
+  {
+    return (sample_t)((uint32_t)__SSAT((int32_t)(((int64_t)a * b) >> 32), 31) << 1);
+  }
+
+  static void accumulate(sample_t *dst, sample_t const *src, size_t frames)
+  {
+    size_t i;
+
+    for (i = 0; i < frames; i++) {
+      dst[i] = __QADD(dst[i], src[i]); }
+  }
+};
+
+
+/* 1.15, half the memory & two samples per simd instruction */
+struct Q15
+{
+  typedef int16_t sample_t;
+
+  static constexpr char const *name = "q15";
+
+  static sample_t fromFloat(float x)
+  {
+    if (x >= 1.0f) {
+      return INT16_MAX; }
+    if (x <= -1.0f) {
+      return INT16_MIN; }
+
+    return (sample_t)(x * 32768.0f);
+  }
+
+  static float    toFloat   (sample_t x) { return (float)x * (1.0f / 32768.0f); }
+
+  static sample_t add       (sample_t a, sample_t b) { return (sample_t)__SSAT((int32_t)a + b, 16); }
+  static sample_t sub       (sample_t a, sample_t b) { return (sample_t)__SSAT((int32_t)a - b, 16); }
+  static sample_t mul       (sample_t a, sample_t b) { return (sample_t)__SSAT(((int32_t)a * b) >> 15, 16); }
+
+  /* pairs through QADD16, memcpy keeps the packing legal for any alignment */
+  static void accumulate(sample_t *dst, sample_t const *src, size_t frames)
+  {
+    uint32_t d, s;
+    size_t i;
+
+    for (i = 0; (i + 1) < frames; i += 2)
+    {
+      memcpy(&d, &dst[i], sizeof(d));
+      memcpy(&s, &src[i], sizeof(s));
+      d = __QADD16(d, s);
+      memcpy(&dst[i], &d, sizeof(d));
+    }
+
+    if (i < frames) {
+      dst[i] = add(dst[i], src[i]); }
+  }
+};
+
+
+#endif
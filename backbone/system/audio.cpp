@@ -0,0 +1,144 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "audio.hpp"
+
+#include "tim.h"
+
+
+static_assert(BLOCK_SIZE > 0, "BLOCK_SIZE must be at least 1 frame");
+static_assert((2 * BLOCK_SIZE * AUDIO_CHANNELS) <= UINT16_MAX,
+              "dma transfer count is 16 bit");
+
+
+/* 1/ average window in blocks */
+#define AVERAGE_COEFF   (1.0f / 64.0f)
+
+
+static inline int16_t toInt16(float x);
+
+
+AudioEngine::AudioEngine(Voice &voice, EventBus *events)
+  : _voice(voice),
+    _events(events)
+{
+  start();
+}
+
+
+void AudioEngine::start(void)
+{
+  memset(_tx, 0, sizeof(_tx));
+  memset(_rx, 0, sizeof(_rx));
+  memset(&_load, 0, sizeof(_load));
+  _input = _rx;
+
+  _load.budget = (uint32_t)(((uint64_t)TIM_cyclesPerSec() * BLOCK_SIZE) / SAMPLE_RATE);
+}
+
+
+void AudioEngine::process(int16_t *tx, int16_t const *rx)
+{
+  uint32_t start = TIM_cycles();
+  uint32_t i;
+  int16_t s;
+
+  _input = rx;
+
+  render();
+
+  for (i = 0; i < BLOCK_SIZE; i++)
+  {
+    s = toInt16(_block[i]);
+    tx[(i * AUDIO_CHANNELS) + 0] = s;
+    tx[(i * AUDIO_CHANNELS) + 1] = s;
+  }
+
+  _load.cycles = TIM_cycles() - start;
+  _load.last = (float)_load.cycles / (float)_load.budget;
+  _load.average += (_load.last - _load.average) * AVERAGE_COEFF;
+  _load.blocks++;
+
+  if (_load.last > _load.peak) {
+    _load.peak = _load.last; }
+
+  /* the other half has already started playing */
+  if (_load.cycles > _load.budget) {
+    _load.overruns++; }
+}
+
+
+/* up to each event, hand it over, on to the next */
+void AudioEngine::render(void)
+{
+  event_t event;
+  uint32_t offset;
+  uint32_t done = 0;
+
+  if (_events)
+  {
+    _events->beginBlock();
+
+    while (_events->next(event, offset))
+    {
+      if (offset > done)
+      {
+        _voice.render(&_block[done], offset - done);
+        done = offset;
+      }
+
+      _voice.handle(event);
+    }
+  }
+
+  if (done < BLOCK_SIZE) {
+    _voice.render(&_block[done], BLOCK_SIZE - done); }
+}
+
+
+void AudioEngine::i2sCallback(int16_t *tx, int16_t const *rx, uint16_t length, void *ctx)
+{
+  AudioEngine *e = (AudioEngine*)ctx;
+
+  if ((BLOCK_SIZE * AUDIO_CHANNELS) == length) {
+    e->process(tx, rx); }
+}
+
+
+static inline int16_t toInt16(float x)
+{
+  x *= 32768.0f;
+
+  if (x >= 32767.0f) {
+    return INT16_MAX; }
+  if (x <= -32768.0f) {
+    return INT16_MIN; }
+
+  return (int16_t)x;
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef AUDIO_HPP
+#define AUDIO_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "event_bus.hpp"
+#include "voice.hpp"
+
+
+/**
+ * @brief block based audio engine
+ *
+ * the codec dma runs circular over the tx & rx buffers, each split in two
+ * halves. while one half is being played the other is rendered in place,
+ * process() is called from the dma interrupt for every half and renders one
+ * block of BLOCK_SIZE frames. with an EventBus the block is split at each
+ * due event's offset, so notes start on their sample & not the block's
+ */
+class AudioEngine
+{
+  public:
+    /* per block cpu usage, 1.0 means all of the time available */
+    typedef struct
+    {
+      uint32_t blocks;
+      uint32_t overruns;
+      uint32_t cycles;        ///< used by the last block
+      uint32_t budget;        ///< available per block
+      float    last;
+      float    average;
+      float    peak;
+    } load_t;
+
+    AudioEngine(Voice &voice, EventBus *events = NULL);
+
+    /* silence & reset the load stats, call before starting the dma */
+    void start(void);
+
+    /* dma circular buffers, interleaved left/ right */
+    int16_t *txBuffer(void) { return _tx; }
+    int16_t *rxBuffer(void) { return _rx; }
+    size_t   bufferLength(void) const { return SIZEOF(_tx); }
+
+    /* render into the tx half just played, rx is the half just recorded */
+    void process(int16_t *tx, int16_t const *rx);
+
+    /* for I2S_start() with this as ctx */
+    static void i2sCallback(int16_t *tx, int16_t const *rx, uint16_t length, void *ctx);
+
+    /* last block recorded, interleaved left/ right */
+    int16_t const *input(void) const { return _input; }
+
+    load_t const &load(void) const { return _load; }
+    void resetPeak(void) { _load.peak = 0.0f; }
+
+  private:
+    void render(void);
+
+    Voice &_voice;
+    EventBus *_events;
+    float _block[BLOCK_SIZE];
+    int16_t _tx[2 * BLOCK_SIZE * AUDIO_CHANNELS];
+    int16_t _rx[2 * BLOCK_SIZE * AUDIO_CHANNELS];
+    int16_t const *_input;
+    load_t _load;
+};
+
+
+#endif
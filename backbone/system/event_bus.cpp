@@ -0,0 +1,150 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "event_bus.hpp"
+
+#include "tim.h"
+
+
+/* wrap safe a < b on the sample clock */
+static inline bool before(uint32_t a, uint32_t b) { return ((int32_t)(a - b) < 0); }
+
+
+EventBus::EventBus(void)
+  : _seq(0),
+    _period(0),
+    _cycles(0),
+    _delivered(0),
+    _late(0),
+    _dropped(0)
+{
+}
+
+
+bool EventBus::post(event_src_e src, event_e type, uint8_t channel, uint8_t a, uint8_t b)
+{
+  event_t e;
+
+  e.time = now();
+  e.type = (uint8_t)type;
+  e.channel = channel;
+  e.a = a;
+  e.b = b;
+
+  return schedule(src, e);
+}
+
+bool EventBus::schedule(event_src_e src, event_t const &event)
+{
+  bool ret = false;
+
+  if (src < EVENT_SRC_NUM_OF) {
+    ret = _queue[src].write(event); }
+
+  /* producers can miss at the same time */
+  if (false == ret) {
+    __atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED); }
+
+  return ret;
+}
+
+
+/* retried if the audio interrupt moved the block on mid read */
+uint32_t EventBus::now(void) const
+{
+  uint32_t seq, period, cycles, into;
+
+  do
+  {
+    seq = _seq;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    period = _period;
+    cycles = _cycles;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((seq & 1) || (seq != _seq));
+
+  into = (uint32_t)(((uint64_t)(TIM_cycles() - cycles) * SAMPLE_RATE) / TIM_cyclesPerSec());
+
+  if (into >= BLOCK_SIZE) {
+    into = BLOCK_SIZE - 1; }
+
+  return period + into;
+}
+
+
+void EventBus::beginBlock(void)
+{
+  _seq = _seq + 1;
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  _period = _period + BLOCK_SIZE;
+  _cycles = TIM_cycles();
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  _seq = _seq + 1;
+}
+
+
+/* earliest due event over all the queues, they're each in time order */
+bool EventBus::next(event_t &event, uint32_t &offset)
+{
+  uint32_t end = _period;
+  uint32_t start = end - BLOCK_SIZE;
+  event_t *e, *first = NULL;
+  uint32_t src, from = 0;
+
+  for (src = 0; src < EVENT_SRC_NUM_OF; src++)
+  {
+    e = _queue[src].tail();
+
+    if ((NULL == e) || (false == before(e->time, end))) {
+      continue; }
+
+    if ((NULL == first) || before(e->time, first->time))
+    {
+      first = e;
+      from = src;
+    }
+  }
+
+  if (NULL == first) {
+    return false; }
+
+  event = *first;
+  _queue[from].pop();
+  _delivered++;
+
+  if (before(event.time, start))
+  {
+    offset = 0;
+    _late++;
+  }
+  else {
+    offset = event.time - start; }
+
+  return true;
+}
@@ -0,0 +1,125 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef EVENT_BUS_HPP
+#define EVENT_BUS_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "spsc_ring.hpp"
+
+
+/* what happened, a & b as in the midi message where there is one */
+typedef enum
+{
+  EVENT_NOTE_ON,              ///< a note, b velocity
+  EVENT_NOTE_OFF,             ///< a note, b velocity
+  EVENT_CONTROL,              ///< a controller, b value
+  EVENT_PITCH_BEND,           ///< a lsb, b msb
+  EVENT_GATE,                 ///< a input, b high
+  EVENT_BUTTON,               ///< a button, b pressed
+  EVENT_STEP,                 ///< a step, b sequencer
+  EVENT_CLOCK,                ///< midi clock pulse
+  EVENT_NUM_OF,
+} event_e;
+
+/* who posted it, each has its own queue */
+typedef enum
+{
+  EVENT_SRC_UART_MIDI,
+  EVENT_SRC_USB_MIDI,
+  EVENT_SRC_GATE,
+  EVENT_SRC_UI,
+  EVENT_SRC_SEQUENCER,
+  EVENT_SRC_NUM_OF,
+} event_src_e;
+
+typedef struct
+{
+  uint32_t time;              ///< sample clock, see EventBus::now()
+  uint8_t  type;              ///< event_e
+  uint8_t  channel;
+  uint8_t  a;
+  uint8_t  b;
+} event_t;
+
+
+/**
+ * @brief timestamped events from midi, gates, ui & sequencer into the audio
+ *
+ * every producer gets its own spsc ring, so interrupts & the main loop post
+ * without locks or masking, one context per source. posts are stamped with
+ * the sample clock, the block count plus how far into the current block
+ * the cycle counter says we are. each block the engine takes what was
+ * stamped during the previous one, merged across sources in time order,
+ * & renders up to each event's offset before handing it to the voice. so
+ * everything lands exactly one block after it arrived, no jitter. late
+ * events (stamped before that window) go at the start of the block &
+ * are counted. schedule() posts with a time of its own, the sequencer
+ * and trace replay in the host tests
+ */
+class EventBus
+{
+  public:
+    /* from arrival to taking effect */
+    static constexpr uint32_t LATENCY = BLOCK_SIZE;
+
+    EventBus(void);
+
+    /* producer side, any context but one per source */
+    bool     post     (event_src_e src, event_e type, uint8_t channel, uint8_t a, uint8_t b);
+    bool     schedule (event_src_e src, event_t const &event);
+
+    /* sample clock, any context */
+    uint32_t now      (void) const;
+
+    /* audio context, once a block then next() until it returns false */
+    void     beginBlock (void);
+    bool     next       (event_t &event, uint32_t &offset);
+
+    uint32_t delivered  (void) const { return _delivered; }
+    uint32_t late       (void) const { return _late; }
+    uint32_t dropped    (void) const { return _dropped; }
+
+  private:
+    SpscRing<event_t, EVENT_QUEUE_LEN> _queue[EVENT_SRC_NUM_OF];
+
+    /* written by beginBlock(), _seq odd while that is going on */
+    volatile uint32_t _seq;
+    volatile uint32_t _period;  ///< sample clock at the start of this block
+    volatile uint32_t _cycles;  ///< TIM_cycles() then
+
+    uint32_t _delivered;
+    uint32_t _late;
+    uint32_t _dropped;
+};
+
+
+#endif
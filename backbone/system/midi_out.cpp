@@ -0,0 +1,189 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#include "midi_out.hpp"
+
+
+MidiOut::MidiOut(USART_ch_e ch, uint8_t depth)
+  : _ch(ch),
+    _depth(depth ? depth : 1)
+{
+  reset();
+}
+
+
+void MidiOut::reset(void)
+{
+  _length = 0;
+  _pos = 0;
+  _running = 0;
+  _turn = 0;
+  _sent = 0;
+  _saved = 0;
+  _dropped = 0;
+}
+
+
+bool MidiOut::send(midi_out_src_e src, midi_msg_t const &msg)
+{
+  bool ret = false;
+
+  if ((src < MIDI_OUT_SRC_NUM_OF) && (msg.status & 0x80) && (msg.status < 0xF8) &&
+      (0xF0 != msg.status) && (0xF7 != msg.status)) {
+    ret = _queue[src].write(msg); }
+
+  if (false == ret) {
+    __atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED); }
+
+  return ret;
+}
+
+bool MidiOut::send(midi_out_src_e src, uint8_t status, uint8_t a, uint8_t b)
+{
+  midi_msg_t msg;
+
+  msg.time = 0;
+  msg.status = status;
+  msg.length = 2;
+  msg.data[0] = a;
+  msg.data[1] = b;
+
+  /* program change & channel pressure are one, system common as they come */
+  if (0xC0 == (status & 0xE0)) {
+    msg.length = 1; }
+  else if (status >= 0xF0) {
+    msg.length = (0xF2 == status) ? 2 : ((0xF1 == status) || (0xF3 == status)) ? 1 : 0; }
+
+  return send(src, msg);
+}
+
+bool MidiOut::realtime(midi_out_src_e src, uint8_t byte)
+{
+  bool ret = false;
+
+  if ((src < MIDI_OUT_SRC_NUM_OF) && (byte >= 0xF8)) {
+    ret = _realtime[src].write(byte); }
+
+  if (false == ret) {
+    __atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED); }
+
+  return ret;
+}
+
+
+void MidiOut::message(midi_msg_t const &msg)
+{
+  if (msg.status >= 0xF8) {
+    realtime(MIDI_OUT_SRC_THRU, msg.status); }
+  else {
+    send(MIDI_OUT_SRC_THRU, msg); }
+}
+
+
+void MidiOut::service(void)
+{
+  uint8_t *rt;
+  uint32_t src;
+
+  /* realtime straight away, past the depth limit & wherever the message
+   * going out has got to */
+  for (src = 0; src < MIDI_OUT_SRC_NUM_OF; src++)
+  {
+    while ((rt = _realtime[src].tail()) && USART_write(_ch, rt, 1))
+    {
+      _realtime[src].pop();
+      _sent++;
+    }
+  }
+
+  while (USART_txPending(_ch) < _depth)
+  {
+    if ((_pos == _length) && (false == next())) {
+      break; }
+
+    if (false == USART_write(_ch, &_bytes[_pos], 1)) {
+      break; }
+
+    _pos++;
+    _sent++;
+  }
+}
+
+
+/* the oldest message of the next source round with one, status if needed */
+bool MidiOut::next(void)
+{
+  midi_msg_t *msg = NULL;
+  uint8_t status, src = 0, i;
+
+  for (i = 0; (i < MIDI_OUT_SRC_NUM_OF) && (NULL == msg); i++)
+  {
+    src = _turn;
+    msg = _queue[src].tail();
+
+    if (++_turn == MIDI_OUT_SRC_NUM_OF) {
+      _turn = 0; }
+  }
+
+  if (NULL == msg) {
+    return false; }
+
+  _pos = 0;
+  _length = 0;
+  status = msg->status;
+
+  if ((0x80 == (status & 0xF0)) && (0x40 == msg->data[1]))
+  {
+    status = 0x90 | (status & 0x0F);
+    _bytes[1] = msg->data[0];
+    _bytes[2] = 0;
+  }
+  else
+  {
+    _bytes[1] = msg->data[0];
+    _bytes[2] = msg->data[1];
+  }
+
+  /* system common ends running status on the receiver too */
+  if (status >= 0xF0) {
+    _running = 0; }
+  else if (status == _running)
+  {
+    _pos = 1;
+    _saved++;
+  }
+  else {
+    _running = status; }
+
+  _bytes[0] = status;
+  _length = 1 + msg->length;
+
+  _queue[src].pop();
+
+  return true;
+}
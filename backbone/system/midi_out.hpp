@@ -0,0 +1,113 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef MIDI_OUT_HPP
+#define MIDI_OUT_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "midi_parser.hpp"
+#include "spsc_ring.hpp"
+#include "usart.h"
+
+
+/* who is sending, each has its own queue */
+typedef enum
+{
+  MIDI_OUT_SRC_SEQUENCER,
+  MIDI_OUT_SRC_THRU,
+  MIDI_OUT_SRC_UI,
+  MIDI_OUT_SRC_NUM_OF,
+} midi_out_src_e;
+
+
+/**
+ * @brief merged, compressed & paced midi out through a usart
+ *
+ * each source queues whole messages here, service() feeds the usart a
+ * byte at a time & never lets more than depth bytes wait in its queue.
+ * so a burst is held back at the wire rate rather than sitting in front
+ * of everything after it & a realtime byte (clock, start, stop) goes
+ * out within depth bytes of being sent, even in the middle of a message.
+ *
+ * sources take turns a message at a time. channel messages are sent with
+ * running status & a note off with the default velocity (64) goes as a
+ * note on with velocity 0 so it runs with the note ons around it.
+ *
+ * as a parser handler it is midi thru. sysex is not sent & send() refuses
+ * its start & end bytes, a lone 0xF0 would hold the receiver in sysex
+ */
+class MidiOut : public MidiParser::Handler
+{
+  public:
+    /* 2 keeps the line busy when service() comes round every byte (320 us) */
+    MidiOut(USART_ch_e ch, uint8_t depth = 2);
+
+    void reset(void);
+
+    /* any context but one per source */
+    bool send     (midi_out_src_e src, midi_msg_t const &msg);
+    bool send     (midi_out_src_e src, uint8_t status, uint8_t a, uint8_t b = 0);
+    bool realtime (midi_out_src_e src, uint8_t byte);
+
+    /* thru, from the input parser */
+    void message  (midi_msg_t const &msg);
+
+    /* one context, often enough to keep depth bytes queued */
+    void service  (void);
+
+    uint32_t sent     (void) const { return _sent; }
+    uint32_t saved    (void) const { return _saved; }      ///< status bytes left out
+    uint32_t dropped  (void) const { return _dropped; }
+
+  private:
+    bool next(void);
+
+    USART_ch_e _ch;
+    uint8_t _depth;
+
+    SpscRing<midi_msg_t, MIDI_OUT_QUEUE_LEN> _queue[MIDI_OUT_SRC_NUM_OF];
+    SpscRing<uint8_t, 16> _realtime[MIDI_OUT_SRC_NUM_OF];
+
+    /* message going out */
+    uint8_t _bytes[3];
+    uint8_t _length;
+    uint8_t _pos;
+
+    uint8_t _running;         ///< status the receiver has, 0 for none
+    uint8_t _turn;            ///< source to look at first
+
+    uint32_t _sent;
+    uint32_t _saved;
+    uint32_t _dropped;
+};
+
+
+#endif
@@ -0,0 +1,213 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#include "midi_parser.hpp"
+
+
+/* data bytes after each status, f0 (sysex) & f7 are handled on their own */
+static uint8_t const channel_length[8] = {2, 2, 2, 2, 1, 1, 2, 0};
+static uint8_t const system_length[8] = {0, 1, 2, 1, 0, 0, 0, 0};
+
+
+MidiParser::MidiParser(Handler &handler, uint8_t *sysex, uint16_t sysex_length)
+  : _handler(handler),
+    _sysex(sysex),
+    _sysex_size(sysex ? sysex_length : 0)
+{
+  reset();
+
+  _messages = 0;
+  _stray = 0;
+}
+
+
+void MidiParser::reset(void)
+{
+  memset(&_msg, 0, sizeof(_msg));
+  _need = 0;
+  _count = 0;
+  _started = false;
+  _in_sysex = false;
+  _sysex_count = 0;
+}
+
+
+void MidiParser::parse(uint8_t byte, uint32_t time)
+{
+  midi_msg_t rt = {};
+
+  /* data, the common case */
+  if (byte < 0x80)
+  {
+    if (_in_sysex)
+    {
+      if (_sysex_size)
+      {
+        _sysex[_sysex_count++] = byte;
+
+        if (_sysex_count == _sysex_size) {
+          sysexFlush(false); }
+      }
+    }
+    else if (0 == _need) {
+      _stray++; }
+    else
+    {
+      /* running status, the message starts here */
+      if (false == _started)
+      {
+        _msg.time = time;
+        _started = true;
+      }
+
+      _msg.data[_count++] = byte;
+
+      if (_count == _need)
+      {
+        _count = 0;
+        _started = false;
+        _messages++;
+        _handler.message(_msg);
+
+        /* only channel messages run */
+        if (_msg.status >= 0xF0) {
+          _need = 0; }
+      }
+    }
+  }
+  /* realtime, in between anything else */
+  else if (byte >= 0xF8)
+  {
+    rt.time = time;
+    rt.status = byte;
+    rt.length = 0;
+    _messages++;
+    _handler.message(rt);
+  }
+  else {
+    status(byte, time); }
+}
+
+void MidiParser::parse(uint8_t const *data, size_t length, uint32_t time, uint32_t spacing)
+{
+  uint32_t offset = 0;
+  size_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    parse(data[i], time + (offset >> 8));
+    offset += spacing;
+  }
+}
+
+
+bool MidiParser::toEvent(midi_msg_t const &msg, event_t &event)
+{
+  event.time = msg.time;
+  event.channel = msg.status & 0x0F;
+  event.a = msg.data[0];
+  event.b = msg.data[1];
+
+  switch (msg.status & 0xF0)
+  {
+  case 0x80:
+    event.type = EVENT_NOTE_OFF;
+    return true;
+
+  case 0x90:
+    event.type = msg.data[1] ? EVENT_NOTE_ON : EVENT_NOTE_OFF;
+    return true;
+
+  case 0xB0:
+    event.type = EVENT_CONTROL;
+    return true;
+
+  case 0xE0:
+    event.type = EVENT_PITCH_BEND;
+    return true;
+
+  default:
+    break;
+  }
+
+  if (0xF8 == msg.status)
+  {
+    event.type = EVENT_CLOCK;
+    event.channel = 0;
+    return true;
+  }
+
+  return false;
+}
+
+
+/* channel & system common status, sysex start & end */
+void MidiParser::status(uint8_t byte, uint32_t time)
+{
+  /* any status ends a sysex, not just f7 */
+  if (_in_sysex)
+  {
+    _in_sysex = false;
+    sysexFlush(true);
+  }
+
+  _count = 0;
+  _started = true;
+  _msg.time = time;
+  _msg.status = byte;
+
+  if (byte < 0xF0) {
+    _need = channel_length[(byte >> 4) & 7]; }
+  else if (0xF0 == byte)
+  {
+    _in_sysex = true;
+    _need = 0;
+  }
+  else
+  {
+    _need = system_length[byte & 7];
+
+    /* tune request is done already, f4 f5 & a lone f7 are nothing */
+    if ((0 == _need) && (0xF6 == byte))
+    {
+      _msg.length = 0;
+      _messages++;
+      _handler.message(_msg);
+    }
+  }
+
+  _msg.length = _need;
+}
+
+void MidiParser::sysexFlush(bool last)
+{
+  if (_sysex_size && (_sysex_count || last)) {
+    _handler.sysex(_sysex, _sysex_count, last); }
+
+  _sysex_count = 0;
+}
@@ -0,0 +1,155 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef MIDI_PARSER_HPP
+#define MIDI_PARSER_HPP
+
+
+#include "common.h"
+
+#include "event_bus.hpp"
+
+
+/* a complete channel, system common or realtime message */
+typedef struct
+{
+  uint32_t time;              ///< arrival of its first byte, caller's clock
+  uint8_t  status;            ///< with the channel in the low nibble
+  uint8_t  length;            ///< data bytes used
+  uint8_t  data[2];
+} midi_msg_t;
+
+
+/**
+ * @brief incremental midi 1.0 byte stream parser, usart or usb
+ *
+ * one byte at a time or a chunk at once, messages are built in place &
+ * handed to the handler by reference as their last byte arrives, nothing
+ * is allocated or queued. running status is kept for channel messages,
+ * realtime bytes are passed on the moment they arrive even mid message
+ * without disturbing it & stray data bytes are dropped.
+ *
+ * sysex payload (without the f0/ f7) goes to the caller's buffer & out to
+ * the handler a buffer full at a time, so a dump of any size gets through
+ * a small one. with no buffer it is skipped
+ */
+class MidiParser
+{
+  public:
+    class Handler
+    {
+      public:
+        virtual void message (midi_msg_t const &msg) = 0;
+        /* last on the chunk the sysex ended with */
+        virtual void sysex   (uint8_t const *data, uint16_t length, bool last) { (void)data; (void)length; (void)last; }
+    };
+
+    MidiParser(Handler &handler, uint8_t *sysex = NULL, uint16_t sysex_length = 0);
+
+    void reset(void);
+
+    void parse(uint8_t byte, uint32_t time);
+
+    /* time is when data[0] arrived, each byte after it spacing/ 256 later.
+     * a dma chunk is stamped when it lands so back date by its length,
+     * at 96 kHz a din byte is 30.72 samples, spacing 7864 */
+    void parse(uint8_t const *data, size_t length, uint32_t time, uint32_t spacing = 0);
+
+    /* the event bus version of the channel voice messages & clock.
+     * note on with velocity 0 is a note off, false for anything else */
+    static bool toEvent(midi_msg_t const &msg, event_t &event);
+
+    uint32_t messages (void) const { return _messages; }
+    uint32_t stray    (void) const { return _stray; }
+
+  private:
+    void status      (uint8_t byte, uint32_t time);
+    void sysexFlush  (bool last);
+
+    Handler &_handler;
+
+    midi_msg_t _msg;          ///< being built
+    uint8_t  _need;           ///< data bytes the running status takes, 0 for none
+    uint8_t  _count;          ///< of those so far
+    bool     _started;        ///< _msg.time is set
+    bool     _in_sysex;
+
+    uint8_t *_sysex;
+    uint16_t _sysex_size;
+    uint16_t _sysex_count;
+
+    uint32_t _messages;
+    uint32_t _stray;
+};
+
+
+/* posts what the bus understands, the rest is dropped */
+class MidiToBus : public MidiParser::Handler
+{
+  public:
+    MidiToBus(EventBus &bus, event_src_e src) : _bus(bus), _src(src) {}
+
+    void message(midi_msg_t const &msg)
+    {
+      event_t event;
+
+      if (MidiParser::toEvent(msg, event)) {
+        _bus.schedule(_src, event); }
+    }
+
+  private:
+    EventBus &_bus;
+    event_src_e _src;
+};
+
+
+/* one parser, two handlers e.g. the bus & midi thru */
+class MidiTee : public MidiParser::Handler
+{
+  public:
+    MidiTee(MidiParser::Handler &a, MidiParser::Handler &b) : _a(a), _b(b) {}
+
+    void message(midi_msg_t const &msg)
+    {
+      _a.message(msg);
+      _b.message(msg);
+    }
+
+    void sysex(uint8_t const *data, uint16_t length, bool last)
+    {
+      _a.sysex(data, length, last);
+      _b.sysex(data, length, last);
+    }
+
+  private:
+    MidiParser::Handler &_a;
+    MidiParser::Handler &_b;
+};
+
+
+#endif
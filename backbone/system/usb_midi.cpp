@@ -0,0 +1,258 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#include "usb_midi.hpp"
+
+#include "usb.h"
+
+
+/* midi bytes in the event for each code index number, 0 for reserved */
+static uint8_t const cin_length[16] = {0, 0, 2, 3, 3, 1, 2, 3, 3, 3, 3, 3, 2, 2, 3, 1};
+
+/* descriptor types & subtypes, usb audio 1.0 & usb midi 1.0 */
+#define DESC_CONFIGURATION    0x02
+#define DESC_INTERFACE        0x04
+#define DESC_ENDPOINT         0x05
+#define DESC_CS_INTERFACE     0x24
+#define DESC_CS_ENDPOINT      0x25
+
+#define CLASS_AUDIO           0x01
+#define SUBCLASS_CONTROL      0x01
+#define SUBCLASS_STREAMING    0x03
+
+#define AC_HEADER             0x01
+#define MS_HEADER             0x01
+#define MS_IN_JACK            0x02
+#define MS_OUT_JACK           0x03
+#define MS_GENERAL            0x01
+
+#define JACK_EMBEDDED         0x01
+#define JACK_EXTERNAL         0x02
+
+/* ids for each cable, embedded in/ out are the ends the host sees */
+#define JACK_IN_EMB(c)        ((uint8_t)((4 * (c)) + 1))
+#define JACK_IN_EXT(c)        ((uint8_t)((4 * (c)) + 2))
+#define JACK_OUT_EMB(c)       ((uint8_t)((4 * (c)) + 3))
+#define JACK_OUT_EXT(c)       ((uint8_t)((4 * (c)) + 4))
+
+
+static uint8_t* bulkEndpoint  (uint8_t *p, uint8_t addr, uint8_t cables, bool out);
+
+
+UsbMidi::UsbMidi(MidiParser::Handler &handler, uint8_t *sysex, uint16_t sysex_length, uint8_t cable)
+  : _parser(handler, sysex, sysex_length),
+    _cable(cable)
+{
+  _events = 0;
+  _dropped = 0;
+}
+
+
+void UsbMidi::reset(void)
+{
+  _parser.reset();
+}
+
+
+void UsbMidi::parse(uint8_t const *data, uint16_t length, uint32_t time)
+{
+  uint16_t i;
+  uint8_t n;
+
+  for (i = 0; (i + USB_MIDI_PACKET) <= length; i += USB_MIDI_PACKET)
+  {
+    n = cin_length[data[i] & 0x0F];
+
+    if (((data[i] >> 4) != _cable) || (0 == n))
+    {
+      _dropped++;
+      continue;
+    }
+
+    _events++;
+    _parser.parse(&data[i + 1], n, time);
+  }
+
+  if (i < length) {
+    _dropped++; }
+}
+
+
+bool UsbMidi::pack(midi_msg_t const &msg, uint8_t cable, uint8_t *packet)
+{
+  uint8_t cin;
+
+  if (msg.status < 0xF0) {
+    cin = msg.status >> 4; }
+  else if (msg.status >= 0xF8) {
+    cin = 0x0F; }
+  else
+  {
+    /* system common by how long it is, f0/ f7 & the undefined ones have no code */
+    switch (msg.status)
+    {
+    case 0xF1:
+    case 0xF3:
+      cin = 0x02;
+      break;
+
+    case 0xF2:
+      cin = 0x03;
+      break;
+
+    case 0xF6:
+      cin = 0x05;
+      break;
+
+    default:
+      return false;
+    }
+  }
+
+  /* unused bytes are 0 */
+  packet[0] = (uint8_t)((cable << 4) | cin);
+  packet[1] = msg.status;
+  packet[2] = (cin_length[cin] > 1) ? msg.data[0] : 0;
+  packet[3] = (cin_length[cin] > 2) ? msg.data[1] : 0;
+
+  return true;
+}
+
+
+uint16_t UsbMidi::packSysex(uint8_t const *data, uint16_t length, uint8_t cable, uint8_t *out, uint16_t size)
+{
+  uint32_t total = (uint32_t)length + 2;
+  uint32_t pos, n, i;
+  uint8_t *p = out;
+  uint8_t byte;
+
+  /* f0, payload, f7 three at a time */
+  if ((((total + 2) / 3) * USB_MIDI_PACKET) > size) {
+    return 0; }
+
+  for (pos = 0; pos < total; pos += n)
+  {
+    n = ((total - pos) > 3) ? 3 : (total - pos);
+
+    /* 4 carries on, 5/ 6/ 7 ends with 1/ 2/ 3 bytes */
+    p[0] = (uint8_t)((cable << 4) | (((pos + n) < total) ? 0x04 : (0x04 + n)));
+
+    for (i = 0; i < 3; i++)
+    {
+      if (i >= n) {
+        byte = 0; }
+      else if (0 == (pos + i)) {
+        byte = 0xF0; }
+      else if ((total - 1) == (pos + i)) {
+        byte = 0xF7; }
+      else {
+        byte = data[pos + i - 1]; }
+
+      p[1 + i] = byte;
+    }
+
+    p += USB_MIDI_PACKET;
+  }
+
+  return (uint16_t)(p - out);
+}
+
+
+uint16_t UsbMidi::descriptor(uint8_t *buf, uint16_t size, uint8_t cables)
+{
+  uint16_t total = descriptorLength(cables);
+  uint16_t ms_total = total - (9 + 9 + 9 + 9);
+  uint8_t *p = buf;
+  uint8_t c;
+
+  if ((0 == cables) || (cables > USB_MIDI_MAX_CABLES) || (size < total)) {
+    return 0; }
+
+  /* configuration, 2 interfaces, self powered as usbd_conf.h */
+  *p++ = 9;   *p++ = DESC_CONFIGURATION;
+  *p++ = (uint8_t)(total & 0xFF);   *p++ = (uint8_t)(total >> 8);
+  *p++ = 2;   *p++ = 1;   *p++ = 0;   *p++ = 0xC0;   *p++ = 50;
+
+  /* audio control, no endpoints & nothing to control */
+  *p++ = 9;   *p++ = DESC_INTERFACE;
+  *p++ = 0;   *p++ = 0;   *p++ = 0;
+  *p++ = CLASS_AUDIO;   *p++ = SUBCLASS_CONTROL;   *p++ = 0;   *p++ = 0;
+
+  *p++ = 9;   *p++ = DESC_CS_INTERFACE;   *p++ = AC_HEADER;
+  *p++ = 0x00;   *p++ = 0x01;   *p++ = 9;   *p++ = 0;   *p++ = 1;   *p++ = 1;
+
+  /* midi streaming, the bulk pair */
+  *p++ = 9;   *p++ = DESC_INTERFACE;
+  *p++ = 1;   *p++ = 0;   *p++ = 2;
+  *p++ = CLASS_AUDIO;   *p++ = SUBCLASS_STREAMING;   *p++ = 0;   *p++ = 0;
+
+  *p++ = 7;   *p++ = DESC_CS_INTERFACE;   *p++ = MS_HEADER;
+  *p++ = 0x00;   *p++ = 0x01;
+  *p++ = (uint8_t)(ms_total & 0xFF);   *p++ = (uint8_t)(ms_total >> 8);
+
+  /* host out -> embedded in -> external out (the synth), & back again */
+  for (c = 0; c < cables; c++)
+  {
+    *p++ = 6;   *p++ = DESC_CS_INTERFACE;   *p++ = MS_IN_JACK;
+    *p++ = JACK_EMBEDDED;   *p++ = JACK_IN_EMB(c);   *p++ = 0;
+
+    *p++ = 6;   *p++ = DESC_CS_INTERFACE;   *p++ = MS_IN_JACK;
+    *p++ = JACK_EXTERNAL;   *p++ = JACK_IN_EXT(c);   *p++ = 0;
+
+    *p++ = 9;   *p++ = DESC_CS_INTERFACE;   *p++ = MS_OUT_JACK;
+    *p++ = JACK_EMBEDDED;   *p++ = JACK_OUT_EMB(c);
+    *p++ = 1;   *p++ = JACK_IN_EXT(c);   *p++ = 1;   *p++ = 0;
+
+    *p++ = 9;   *p++ = DESC_CS_INTERFACE;   *p++ = MS_OUT_JACK;
+    *p++ = JACK_EXTERNAL;   *p++ = JACK_OUT_EXT(c);
+    *p++ = 1;   *p++ = JACK_IN_EMB(c);   *p++ = 1;   *p++ = 0;
+  }
+
+  p = bulkEndpoint(p, USB_EP_OUT, cables, true);
+  p = bulkEndpoint(p, USB_EP_IN, cables, false);
+
+  return (uint16_t)(p - buf);
+}
+
+
+/* standard (audio, 9 byte) then class specific with the jacks it feeds */
+static uint8_t* bulkEndpoint  (uint8_t *p, uint8_t addr, uint8_t cables, bool out)
+{
+  uint8_t c;
+
+  *p++ = 9;   *p++ = DESC_ENDPOINT;   *p++ = addr;   *p++ = 0x02;
+  *p++ = (uint8_t)(USB_EP_SIZE & 0xFF);   *p++ = (uint8_t)(USB_EP_SIZE >> 8);
+  *p++ = 0;   *p++ = 0;   *p++ = 0;
+
+  *p++ = (uint8_t)(4 + cables);   *p++ = DESC_CS_ENDPOINT;   *p++ = MS_GENERAL;   *p++ = cables;
+
+  for (c = 0; c < cables; c++) {
+    *p++ = out ? JACK_IN_EMB(c) : JACK_OUT_EMB(c); }
+
+  return p;
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef USB_MIDI_HPP
+#define USB_MIDI_HPP
+
+
+#include "common.h"
+
+#include "midi_parser.hpp"
+
+
+/* usb midi 1.0 event packet: cable << 4 | code index, then up to 3 midi bytes */
+#define USB_MIDI_PACKET     4
+
+/* cable numbers are 4 bits */
+#define USB_MIDI_MAX_CABLES 16
+
+
+/**
+ * @brief usb midi 1.0 over the usb.h bulk endpoints
+ *
+ * a bulk out packet carries up to 16 events, each is unwrapped into a
+ * MidiParser so running status, realtime, sysex & the bus mapping are the
+ * same as the din port. the whole packet is stamped with one time, it
+ * all came within the same 1 ms frame.
+ *
+ * the other way pack() makes the event for a message, packSysex() a dump.
+ * descriptor() builds the configuration descriptor usb.h needs: an audio
+ * control & a midi streaming interface with an embedded & external jack
+ * each way for every cable
+ */
+class UsbMidi
+{
+  public:
+    UsbMidi(MidiParser::Handler &handler, uint8_t *sysex = NULL, uint16_t sysex_length = 0, uint8_t cable = 0);
+
+    void reset(void);
+
+    /* whole events, a short one at the end is dropped */
+    void parse(uint8_t const *data, uint16_t length, uint32_t time);
+
+    /* the event for msg, false for what usb midi has no code for (sysex) */
+    static bool pack(midi_msg_t const &msg, uint8_t cable, uint8_t *packet);
+
+    /* a sysex payload without f0/ f7 as events, 0 if out is too small */
+    static uint16_t packSysex(uint8_t const *data, uint16_t length, uint8_t cable, uint8_t *out, uint16_t size);
+
+    static constexpr uint16_t descriptorLength(uint8_t cables)
+    {
+      return (uint16_t)(9 + 9 + 9 + 9 + 7 + (cables * (6 + 6 + 9 + 9)) + (2 * (9 + 4 + cables)));
+    }
+
+    /* 0 if it does not fit in size or cables is 0 or over 16 */
+    static uint16_t descriptor(uint8_t *buf, uint16_t size, uint8_t cables = 1);
+
+    uint32_t events   (void) const { return _events; }
+    uint32_t dropped  (void) const { return _dropped; }    ///< other cables, reserved codes & short events
+
+  private:
+    MidiParser _parser;
+    uint8_t _cable;
+
+    uint32_t _events;
+    uint32_t _dropped;
+};
+
+
+#endif
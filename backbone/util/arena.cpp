@@ -0,0 +1,70 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "arena.hpp"
+
+
+Arena::Arena(uint8_t *mem, size_t bytes)
+  : _mem(mem),
+    _capacity(mem ? bytes : 0),
+    _used(0),
+    _high_water(0),
+    _refused(0)
+{
+}
+
+
+void *Arena::allocate(size_t bytes, size_t align)
+{
+  uintptr_t base = (uintptr_t)_mem;
+  size_t start;
+
+  /* align the address rather than the offset, the block may not be */
+  start = (size_t)(((base + _used + (align - 1)) & ~(uintptr_t)(align - 1)) - base);
+
+  if ((0 == bytes) || (start > _capacity) || (bytes > (_capacity - start)))
+  {
+    _refused++;
+    return NULL;
+  }
+
+  _used = start + bytes;
+
+  if (_used > _high_water) {
+    _high_water = _used; }
+
+  return _mem + start;
+}
+
+
+void Arena::rewind(size_t mark)
+{
+  if (mark < _used) {
+    _used = mark; }
+}
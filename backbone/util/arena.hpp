@@ -0,0 +1,155 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+
+#include "common.h"
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * @brief bump allocator over a fixed block, nothing is freed one by one
+ *
+ * everything comes out of static memory so the worst case is known at link
+ * time & nothing can fragment. a request that does not fit gets NULL, is
+ * counted & leaves the arena as it was. the high water mark survives
+ * reset() so it says how close the biggest patch came
+ *
+ * not locked, allocate from one context (main loop, at patch load) & only
+ * use the memory from the audio path
+ */
+class Arena
+{
+  public:
+    /* enough for anything the m4 loads, doubles included */
+    static constexpr size_t DEFAULT_ALIGN = 8;
+
+    Arena(uint8_t *mem, size_t bytes);
+
+    /* align is a power of 2. NULL if it won't fit */
+    void *allocate(size_t bytes, size_t align = DEFAULT_ALIGN);
+
+    /* uninitialised array, for sample buffers & other plain data */
+    template <typename T>
+    T *allocate(size_t count)
+    {
+      if (count > (SIZE_MAX / sizeof(T))) {
+        return (T *)allocate(SIZE_MAX, alignof(T)); }
+
+      return (T *)allocate(count * sizeof(T), alignof(T));
+    }
+
+    /* constructed in place, never destroyed, the arena is just reset */
+    template <typename T, typename... Args>
+    T *create(Args&&... args)
+    {
+      void *p = allocate(sizeof(T), alignof(T));
+
+      return p ? new (p) T(static_cast<Args&&>(args)...) : NULL;
+    }
+
+    /* rewind to a mark, everything allocated since is gone */
+    size_t mark  (void) const { return _used; }
+    void   rewind(size_t mark);
+
+    /* back to empty for a new patch */
+    void   reset (void) { _used = 0; }
+
+    size_t   capacity (void) const { return _capacity; }
+    size_t   used     (void) const { return _used; }
+    size_t   available(void) const { return _capacity - _used; }
+    size_t   highWater(void) const { return _high_water; }
+    uint32_t refused  (void) const { return _refused; }
+
+  private:
+    uint8_t *_mem;
+    size_t   _capacity;
+    size_t   _used;
+    size_t   _high_water;
+    uint32_t _refused;
+};
+
+
+/**
+ * @brief an arena & its memory in one static object
+ *
+ * fits() lets whoever sizes it check a layout at compile time
+ *   static_assert(StaticArena<4096>::fits(sizeof(float) * 1024));
+ */
+template <size_t BYTES>
+class StaticArena : public Arena
+{
+  public:
+    static_assert(BYTES > 0, "empty arena");
+
+    StaticArena(void) : Arena(_storage, BYTES) {}
+
+    static constexpr size_t CAPACITY = BYTES;
+
+    static constexpr bool fits(size_t bytes) { return bytes <= BYTES; }
+
+  private:
+    alignas(Arena::DEFAULT_ALIGN) uint8_t _storage[BYTES];
+};
+
+
+/**
+ * @brief temporary buffers for the length of a scope, eg. fft work space
+ * or a preset being decoded. whatever was taken goes back on the way out
+ *
+ *   {
+ *     ScratchScope scratch(arena);
+ *     float *work = scratch.allocate<float>(512);
+ *     ...
+ *   }
+ */
+class ScratchScope
+{
+  public:
+    explicit ScratchScope(Arena &arena) : _arena(arena), _mark(arena.mark()) {}
+    ~ScratchScope() { _arena.rewind(_mark); }
+
+    ScratchScope(ScratchScope const &) = delete;
+    ScratchScope &operator=(ScratchScope const &) = delete;
+
+    template <typename T>
+    T *allocate(size_t count) { return _arena.allocate<T>(count); }
+
+  private:
+    Arena &_arena;
+    size_t _mark;
+};
+
+
+#endif
@@ -0,0 +1,153 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+
+#include "common.h"
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * @brief N objects of one type in static memory, handed out & taken back
+ *
+ * for things that come & go at run time, eg. voices or modulation slots,
+ * where an arena would never get its memory back. every block is the same
+ * size so there is nothing to fragment. create() & destroy() are O(1)
+ * through a free list of indices
+ *
+ * not locked, create & destroy from the same context
+ */
+template <typename T, size_t N>
+class Pool
+{
+  public:
+    static_assert(N > 0, "empty pool");
+    static_assert(N < UINT16_MAX, "free list is indexed by uint16_t");
+
+    static constexpr size_t CAPACITY = N;
+    static constexpr size_t BYTES = N * sizeof(T);
+
+    Pool(void) : _free(0), _in_use(0), _high_water(0), _refused(0)
+    {
+      size_t i;
+
+      for (i = 0; i < N; i++) {
+        _next[i] = (uint16_t)(i + 1); }
+    }
+
+    /* every object still out is destroyed */
+    ~Pool()
+    {
+      size_t i;
+
+      for (i = 0; i < N; i++)
+      {
+        if (IN_USE == _next[i]) {
+          slot(i)->~T(); }
+      }
+    }
+
+    Pool(Pool const &) = delete;
+    Pool &operator=(Pool const &) = delete;
+
+    /* NULL when all N are out */
+    template <typename... Args>
+    T *create(Args&&... args)
+    {
+      uint16_t i = _free;
+
+      if (N == i)
+      {
+        _refused++;
+        return NULL;
+      }
+
+      _free = _next[i];
+      _next[i] = IN_USE;
+
+      if (++_in_use > _high_water) {
+        _high_water = _in_use; }
+
+      return new (slot(i)) T(static_cast<Args&&>(args)...);
+    }
+
+    /* false for NULL, something from elsewhere or a second destroy */
+    bool destroy(T *p)
+    {
+      size_t i;
+
+      if (false == owns(p)) {
+        return false; }
+
+      i = (size_t)((uint8_t *)p - &_storage[0][0]) / sizeof(T);
+
+      if (IN_USE != _next[i]) {
+        return false; }
+
+      p->~T();
+      _next[i] = _free;
+      _free = (uint16_t)i;
+      _in_use--;
+
+      return true;
+    }
+
+    bool owns(T const *p) const
+    {
+      uint8_t const *b = (uint8_t const *)p;
+
+      return (b >= &_storage[0][0])
+          && (b < &_storage[N][0])
+          && (0 == ((size_t)(b - &_storage[0][0]) % sizeof(T)));
+    }
+
+    size_t   inUse    (void) const { return _in_use; }
+    size_t   highWater(void) const { return _high_water; }
+    uint32_t refused  (void) const { return _refused; }
+
+  private:
+    static constexpr uint16_t IN_USE = UINT16_MAX;
+
+    T *slot(size_t i) { return (T *)&_storage[i][0]; }
+
+    alignas(T) uint8_t _storage[N][sizeof(T)];
+    uint16_t _next[N];            ///< free list, IN_USE while handed out
+    uint16_t _free;               ///< head of the free list, N when empty
+    uint16_t _in_use;
+    uint16_t _high_water;
+    uint32_t _refused;
+};
+
+
+#endif
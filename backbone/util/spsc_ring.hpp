@@ -0,0 +1,82 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+
+#include "common.h"
+#include "ring.h"
+
+#include <type_traits>
+
+
+/**
+ * @brief typed, statically sized front end to the ring in ring.h
+ *
+ * one producer & one consumer, each may be the main loop, an interrupt or
+ * (on the host) a thread. elements are copied in & out, so keep them small
+ * & plain. head()/ push() & tail()/ pop() fill & drain in place instead
+ */
+template <typename T, uint32_t N>
+class SpscRing
+{
+  public:
+    static_assert((N > 0) && (0 == (N & (N - 1))), "capacity has to be a power of 2");
+    static_assert(std::is_trivially_copyable<T>::value, "elements are copied with memcpy");
+
+    static constexpr uint32_t CAPACITY = N;
+
+    SpscRing(void) { RING_init(&_ring, _buf, sizeof(T), N); }
+
+    SpscRing(SpscRing const &) = delete;
+    SpscRing &operator=(SpscRing const &) = delete;
+
+    /* producer */
+    bool write(T const &item) { return RING_write(&_ring, &item); }
+    T   *head (void)          { return (T *)RING_head(&_ring); }
+    void push (void)          { RING_push(&_ring); }
+
+    /* consumer */
+    bool read (T &item)       { return RING_read(&_ring, &item); }
+    T   *tail (void)          { return (T *)RING_tail(&_ring); }
+    void pop  (void)          { RING_pop(&_ring); }
+
+    /* either side, a snapshot that may already be out of date */
+    uint32_t count  (void) const { return RING_count(&_ring); }
+    bool     isEmpty(void) const { return RING_isEmpty(&_ring); }
+    bool     isFull (void) const { return RING_isFull(&_ring); }
+
+  private:
+    RING_t _ring;
+    T      _buf[N];
+};
+
+
+#endif
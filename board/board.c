@@ -32,9 +32,13 @@ SOFTWARE.
 
 #include "chips.h"
 
+#include "adc.h"
+#include "i2s.h"
 #include "io.h"
 #include "mevent.h"
 #include "spi.h"
+#include "usart.h"
+#include "usb.h"
 
 
 bool BRD_init()
@@ -53,6 +57,70 @@ bool BRD_init()
   return ret;
 }
 
+bool BRD_audioStart(uint32_t     sample_rate_hz,
+                    int16_t*     tx_data,
+                    int16_t*     rx_data,
+                    uint16_t     length,
+                    I2S_xfer_cb  cb,
+                    void*        ctx)
+{
+  bool ret = false;
+  I2S_cfg_t i2s_cfg;
+  WM8731_cfg_t codec_cfg;
+
+  i2s_cfg.master          = !WM8731_MASTER;
+  i2s_cfg.sample_rate_hz  = sample_rate_hz;
+
+  codec_cfg.ch              = WM8731_I2C_CH;
+  codec_cfg.addr            = WM8731_ADDR;
+  codec_cfg.sample_rate_hz  = sample_rate_hz;
+  codec_cfg.master          = WM8731_MASTER;
+
+  /* as slave the i2s waits for the codec clocks, so start it first */
+  if ((true == I2S_init(WM8731_I2S_CH, &i2s_cfg)) &&
+      (true == I2S_start(WM8731_I2S_CH, tx_data, rx_data, length, cb, ctx)))
+  {
+    ret = WM8731_init(&codec_cfg, NULL);
+  }
+
+  return ret;
+}
+
+bool BRD_midiStart(USART_rx_cb cb, void *ctx)
+{
+  bool ret = false;
+  USART_cfg_t usart_cfg;
+
+  usart_cfg.baud = USART_MIDI_BAUD;
+
+  if (true == USART_init(MIDI_USART_CH, &usart_cfg))
+  {
+    USART_setRxCallback(MIDI_USART_CH, cb, ctx);
+    ret = true;
+  }
+
+  return ret;
+}
+
+bool BRD_usbStart(USB_cfg_t *cfg, USB_rx_cb cb, void *ctx)
+{
+  bool ret = false;
+
+  /* the host takes far longer than this to enumerate & configure */
+  if (true == USB_init(cfg))
+  {
+    USB_setRxCallback(cb, ctx);
+    ret = true;
+  }
+
+  return ret;
+}
+
+bool BRD_controlsStart(void)
+{
+  return (ADC_init() && ADC_start());
+}
+
 void BRD_task()
 {
   mevent_e event;
@@ -73,6 +141,12 @@ void BRD_task()
     {
     case MEVENT_I2C:
       I2C_task();
+#ifdef PCF8575_NUM_OF
+      PCF8575_task();
+#endif
+#ifdef WM8731_I2C_CH
+      WM8731_task();
+#endif
       break;
 
     default:
@@ -41,10 +41,45 @@ SOFTWARE.
 
 #include "board_test.h"
 
+#include "adc.h"
+#include "i2s.h"
+#include "usart.h"
+#include "usb.h"
+
 
 extern bool BRD_init();
 extern void BRD_task();
 
+/**
+ * @brief start the codec & stream audio through it, see I2S_start()
+ * the codec is configured in the background (BRD_task) & the callbacks
+ * start once it is running
+ */
+extern bool BRD_audioStart(uint32_t     sample_rate_hz,
+                           int16_t*     tx_data,
+                           int16_t*     rx_data,
+                           uint16_t     length,
+                           I2S_xfer_cb  cb,
+                           void*        ctx);
+
+/**
+ * @brief start the din midi port, cb gets bytes as they arrive
+ * see USART_setRxCallback()
+ */
+extern bool BRD_midiStart(USART_rx_cb cb, void *ctx);
+
+/**
+ * @brief connect to the usb host with cfg's descriptor, cb gets each bulk
+ * out packet. see USB_setRxCallback()
+ */
+extern bool BRD_usbStart(USB_cfg_t *cfg, USB_rx_cb cb, void *ctx);
+
+/**
+ * @brief start scanning the knobs & cv inputs, runs from then on with no
+ * cpu involvement. see ADC_read()
+ */
+extern bool BRD_controlsStart(void);
+
 
 #ifdef __cplusplus
 }
@@ -89,6 +89,7 @@ bool BTST_test_lights(void)
     IO_toggle(BUILTIN_LED_PIN);
     PCF8575_rotateRight(0, 1, NULL);
     TIM_delayMs(100);
+    BRD_task();
   }
 
   return true;
@@ -17,6 +17,10 @@
   #include "w25q/w25q.h"
 #endif
 
+#ifdef WM8731_I2C_CH
+  #include "wm8731/wm8731.h"
+#endif
+
 
 #ifdef __cplusplus
 }
@@ -35,22 +35,20 @@ SOFTWARE.
 
 #include "pcf8575.h"
 
+#include "regmap/regmap.h"
+
 
 typedef struct
 {
-  I2C_ch_e ch;
-  uint8_t  addr;
+  REGMAP_t map;
   PCF8575_cb_t cb;
-  bool lock;
-  uint8_t reg[2];
 } pcf8575_t;
 
 
 static pcf8575_t pcf8575[PCF8575_NUM_OF] = {0};
 
 static uint16_t getReg(pcf8575_t *p);
-static void setReg(pcf8575_t *p, uint16_t val);
-static void i2cCb(bool error, void *ctx);
+static void flushCb(bool error, void *ctx);
 
 
 bool PCF8575_init(uint8_t idx, I2C_ch_e ch, uint8_t addr)
@@ -65,10 +63,17 @@ bool PCF8575_init(uint8_t idx, I2C_ch_e ch, uint8_t addr)
   cfg.own_address   = 0;
   cfg.stretch_mode  = I2C_STRETCH_MODE_DISABLE;
 
-  p->ch = ch;
-  p->addr = addr;
+  /* port state unknown until first written */
+  REGMAP_cfg_t map_cfg;
+  map_cfg.ch            = ch;
+  map_cfg.addr          = addr;
+  map_cfg.format        = REGMAP_FORMAT_D16;
+  map_cfg.num_of_regs   = 1;
+  map_cfg.defaults      = NULL;
+  map_cfg.volatile_mask = 0;
+
+  REGMAP_init(&p->map, &map_cfg);
   p->cb = NULL;
-  p->lock = false;
 
   if (true == I2C_init(ch, &cfg))
   {
@@ -79,28 +84,26 @@ bool PCF8575_init(uint8_t idx, I2C_ch_e ch, uint8_t addr)
   return ret;
 }
 
+void PCF8575_task(void)
+{
+  uint8_t idx;
+
+  for (idx = 0; idx < PCF8575_NUM_OF; idx++) {
+    REGMAP_task(&pcf8575[idx].map); }
+}
+
 bool PCF8575_write16(uint8_t idx, uint16_t value, PCF8575_cb_t cb)
 {
-  bool ret = false;
   pcf8575_t *p = &pcf8575[idx];
-  uint16_t tmp = getReg(p);
 
-  if (false == p->lock)
-  {
-    p->lock = true;
-    p->cb = cb;
-    setReg(p, value);
-
-    if (true == I2C_write(p->ch, p->addr, p->reg, 2, i2cCb, p)) {
-      ret = true; }
-    else
-    {
-      setReg(p, tmp);
-      p->lock = false;
-    }
-  }
+  if (REGMAP_isBusy(&p->map)) {
+    return false; }
 
-  return ret;
+  /* nothing goes on the bus if the outputs are already set */
+  p->cb = cb;
+  REGMAP_write(&p->map, 0, value);
+
+  return REGMAP_flush(&p->map, flushCb, p);
 }
 
 bool PCF8575_write(uint8_t idx, uint8_t pin, bool high, PCF8575_cb_t cb)
@@ -160,16 +163,10 @@ bool PCF8575_rotateLeft(uint8_t idx, uint8_t n, PCF8575_cb_t cb)
 
 static uint16_t getReg(pcf8575_t *p)
 {
-  return ((uint16_t)p->reg[1] << 8) + p->reg[0];
-}
-
-static void setReg(pcf8575_t *p, uint16_t val)
-{
-  p->reg[0] = (uint8_t)val;
-  p->reg[1] = (uint8_t)(val >> 8);
+  return REGMAP_read(&p->map, 0);
 }
 
-static void i2cCb(bool error, void *ctx)
+static void flushCb(bool error, void *ctx)
 {
   pcf8575_t *p = (pcf8575_t*)ctx;
 
@@ -177,7 +174,6 @@ static void i2cCb(bool error, void *ctx)
   {
     p->cb(error);
   }
-  p->lock = false;
 }
 
 
@@ -44,6 +44,9 @@ typedef void (*PCF8575_cb_t)(bool error);
 
 extern bool PCF8575_init(uint8_t idx, I2C_ch_e ch, uint8_t addr);
 
+/* sends queued writes, call from the main loop */
+extern void PCF8575_task(void);
+
 extern bool PCF8575_read16(uint8_t idx, uint16_t *value, PCF8575_cb_t cb);
 extern bool PCF8575_write16(uint8_t idx, uint16_t value, PCF8575_cb_t cb);
 extern bool PCF8575_toggle16(uint8_t idx, uint16_t mask, PCF8575_cb_t cb);
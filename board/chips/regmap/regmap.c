@@ -0,0 +1,285 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "regmap.h"
+
+
+static bool send(REGMAP_t *map);
+static void redirty(REGMAP_t *map);
+static void sortFlight(REGMAP_t *map);
+static void i2cCb(bool error, void *ctx);
+
+
+void      REGMAP_init     (REGMAP_t *map, REGMAP_cfg_t const *cfg)
+{
+  uint8_t i;
+
+  memset(map, 0, sizeof(REGMAP_t));
+  memcpy(&map->cfg, cfg, sizeof(REGMAP_cfg_t));
+
+  if (map->cfg.num_of_regs > REGMAP_MAX_REGS) {
+    map->cfg.num_of_regs = REGMAP_MAX_REGS; }
+
+  if (cfg->defaults)
+  {
+    for (i = 0; i < map->cfg.num_of_regs; i++) {
+      map->cache[i] = cfg->defaults[i]; }
+
+    map->valid = (1u << map->cfg.num_of_regs) - 1;
+  }
+}
+
+void      REGMAP_write    (REGMAP_t *map, uint8_t reg, uint16_t value)
+{
+  uint32_t mask;
+
+  if (reg >= map->cfg.num_of_regs) {
+    return; }
+
+  mask = (1u << reg);
+
+  /* already there */
+  if ((map->valid & mask) &&
+      (map->cache[reg] == value) &&
+      (0 == (map->cfg.volatile_mask & mask))) {
+    return; }
+
+  map->cache[reg] = value;
+  map->valid |= mask;
+
+  if (0 == (map->dirty & mask))
+  {
+    map->dirty |= mask;
+    map->order[map->num_dirty++] = reg;
+  }
+}
+
+void      REGMAP_update   (REGMAP_t *map, uint8_t reg, uint16_t mask, uint16_t value)
+{
+  if (reg >= map->cfg.num_of_regs) {
+    return; }
+
+  REGMAP_write(map, reg, (map->cache[reg] & ~mask) | (value & mask));
+}
+
+uint16_t  REGMAP_read     (REGMAP_t *map, uint8_t reg)
+{
+  if (reg >= map->cfg.num_of_regs) {
+    return 0; }
+
+  return map->cache[reg];
+}
+
+bool      REGMAP_isDirty  (REGMAP_t *map)
+{
+  return (map->num_dirty > 0);
+}
+
+bool      REGMAP_isBusy   (REGMAP_t *map)
+{
+  return map->busy;
+}
+
+bool      REGMAP_flush    (REGMAP_t *map, REGMAP_cb_t cb, void *ctx)
+{
+  bool ret = false;
+
+  if (map->busy) {
+    return false; }
+
+  if (0 == map->num_dirty)
+  {
+    if (cb) {
+      cb(false, ctx); }
+
+    return true;
+  }
+
+  map->busy = true;
+  map->xfer_done = false;
+  map->cb = cb;
+  map->ctx = ctx;
+
+  /* anything written from now on is dirty again & goes in the next flush */
+  memcpy(map->flight, map->order, map->num_dirty);
+  map->num_flight = map->num_dirty;
+  map->flight_idx = 0;
+  map->num_dirty = 0;
+  map->dirty = 0;
+
+  if (REGMAP_FORMAT_A8_D8 == map->cfg.format) {
+    sortFlight(map); }
+
+  ret = send(map);
+
+  if (false == ret)
+  {
+    redirty(map);
+    map->busy = false;
+  }
+
+  return ret;
+}
+
+void      REGMAP_task     (REGMAP_t *map)
+{
+  bool error;
+
+  if ((false == map->busy) || (false == map->xfer_done)) {
+    return; }
+
+  map->xfer_done = false;
+  error = map->xfer_error;
+
+  if (false == error)
+  {
+    map->flight_idx += map->flight_run;
+
+    if (map->flight_idx < map->num_flight)
+    {
+      if (true == send(map)) {
+        return; }
+
+      error = true;
+    }
+  }
+
+  if (error) {
+    redirty(map); }
+
+  map->busy = false;
+
+  if (map->cb) {
+    map->cb(error, map->ctx); }
+}
+
+
+/* next transaction, starting from flight_idx */
+static bool send(REGMAP_t *map)
+{
+  uint8_t reg = map->flight[map->flight_idx];
+  uint16_t value = map->cache[reg];
+  uint16_t length = 0;
+  uint8_t end = reg;
+  uint8_t i;
+
+  map->flight_run = 1;
+
+  switch (map->cfg.format)
+  {
+  case REGMAP_FORMAT_A7_D9:
+    map->buf[0] = (uint8_t)((reg << 1) | ((value >> 8) & 1));
+    map->buf[1] = (uint8_t)value;
+    length = 2;
+    break;
+
+  case REGMAP_FORMAT_A8_D8:
+    /* carry on through the following dirty registers, clean ones in
+     * between are sent again as long as their value is known */
+    for (i = map->flight_idx + 1; i < map->num_flight; i++)
+    {
+      while ((end < map->flight[i]) && (map->valid & (1u << (end + 1)))) {
+        ++end; }
+
+      if (end != map->flight[i]) {
+        break; }
+
+      map->flight_run++;
+    }
+
+    end = map->flight[map->flight_idx + map->flight_run - 1];
+
+    map->buf[0] = reg;
+    for (i = reg; i <= end; i++) {
+      map->buf[1 + i - reg] = (uint8_t)map->cache[i]; }
+    length = 2 + end - reg;
+    break;
+
+  case REGMAP_FORMAT_D16:
+    map->buf[0] = (uint8_t)value;
+    map->buf[1] = (uint8_t)(value >> 8);
+    length = 2;
+    break;
+
+  default:
+    break;
+  }
+
+  if (0 == length) {
+    return false; }
+
+  return I2C_write(map->cfg.ch, map->cfg.addr, map->buf, length, i2cCb, map);
+}
+
+/* put everything not sent back in the dirty list */
+static void redirty(REGMAP_t *map)
+{
+  uint8_t reg;
+  uint8_t i;
+
+  for (i = map->flight_idx; i < map->num_flight; i++)
+  {
+    reg = map->flight[i];
+
+    if (0 == (map->dirty & (1u << reg)))
+    {
+      map->dirty |= (1u << reg);
+      map->order[map->num_dirty++] = reg;
+    }
+  }
+
+  map->num_flight = 0;
+}
+
+/* burst writes go out lowest address first */
+static void sortFlight(REGMAP_t *map)
+{
+  uint8_t i;
+  uint8_t j;
+  uint8_t tmp;
+
+  for (i = 1; i < map->num_flight; i++)
+  {
+    tmp = map->flight[i];
+
+    for (j = i; (j > 0) && (map->flight[j - 1] > tmp); j--) {
+      map->flight[j] = map->flight[j - 1]; }
+
+    map->flight[j] = tmp;
+  }
+}
+
+/* runs in the i2c irq on target, where i2c writes must not be queued */
+static void i2cCb(bool error, void *ctx)
+{
+  REGMAP_t *map = (REGMAP_t*)ctx;
+
+  map->xfer_error = error;
+  map->xfer_done = true;
+}
@@ -0,0 +1,145 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef __REGMAP_H
+#define __REGMAP_H
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/**
+ * @file regmap.h
+ * @author Rick Davies (richvies@gmail.com)
+ * @brief
+ * Shadow copy of an i2c device's registers. Writes only update the cache
+ * and mark the register dirty if the value changed, REGMAP_flush() then
+ * sends everything dirty in the background as one operation. For devices
+ * with auto incrementing addresses that is a single i2c transaction
+ * @version 0.1
+ * @date 2022-09-12
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+
+#include "i2c.h"
+
+
+#define REGMAP_MAX_REGS     (16)
+
+
+typedef enum
+{
+  /// 7 bit address + 9 bit value, one register per transaction e.g. wm8731
+  REGMAP_FORMAT_A7_D9,
+  /// 8 bit address then 8 bit values, address auto increments
+  REGMAP_FORMAT_A8_D8,
+  /// no address, one 16 bit register sent lsb first e.g. pcf8575
+  REGMAP_FORMAT_D16,
+  REGMAP_FORMAT_NUM_OF,
+} REGMAP_format_e;
+
+typedef void (*REGMAP_cb_t)(bool error, void *ctx);
+
+typedef struct
+{
+  I2C_ch_e          ch;
+  uint16_t          addr;
+  REGMAP_format_e   format;
+  uint8_t           num_of_regs;
+  /// power on values, NULL if not known (first write always sent)
+  uint16_t const *  defaults;
+  /// registers sent on every write e.g. reset, bit per register
+  uint32_t          volatile_mask;
+} REGMAP_cfg_t;
+
+typedef struct
+{
+  REGMAP_cfg_t cfg;
+
+  uint16_t cache[REGMAP_MAX_REGS];
+  uint32_t valid;
+  uint32_t dirty;
+
+  /* dirty registers in the order they were written */
+  uint8_t order[REGMAP_MAX_REGS];
+  uint8_t num_dirty;
+
+  /* flush in progress */
+  bool volatile busy;
+  uint8_t flight[REGMAP_MAX_REGS];
+  uint8_t num_flight;
+  uint8_t flight_idx;
+  uint8_t flight_run;
+  /* set from the i2c callback, picked up by REGMAP_task */
+  bool volatile xfer_done;
+  bool volatile xfer_error;
+  REGMAP_cb_t cb;
+  void *ctx;
+  uint8_t buf[1 + (REGMAP_MAX_REGS * 2)];
+} REGMAP_t;
+
+
+extern void     REGMAP_init     (REGMAP_t *map, REGMAP_cfg_t const *cfg);
+
+/* cache only, see REGMAP_flush */
+extern void     REGMAP_write    (REGMAP_t *map, uint8_t reg, uint16_t value);
+extern void     REGMAP_update   (REGMAP_t *map, uint8_t reg, uint16_t mask, uint16_t value);
+extern uint16_t REGMAP_read     (REGMAP_t *map, uint8_t reg);
+
+extern bool     REGMAP_isDirty  (REGMAP_t *map);
+extern bool     REGMAP_isBusy   (REGMAP_t *map);
+
+/**
+ * @brief send all dirty registers, cb is called from REGMAP_task when done
+ * or on error (failed registers stay dirty). Called straight away if
+ * nothing is dirty
+ * @attention Do NOT call from an interrupt
+ *
+ * @return false if a flush is already in progress or could not start
+ */
+extern bool     REGMAP_flush    (REGMAP_t *map, REGMAP_cb_t cb, void *ctx);
+
+/**
+ * @brief Call this function periodically while a flush is in progress e.g.
+ * on MEVENT_I2C. Sends the next transaction once the last is done
+ * @attention Do NOT call from an interrupt
+ */
+extern void     REGMAP_task     (REGMAP_t *map);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
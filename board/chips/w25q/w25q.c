@@ -81,7 +81,7 @@ bool W25Q_init(void)
 	/* try to start spi peripheral */
 	cfg.cs_pin = W25Q_CS_PIN;
 	cfg.master_mode = SPI_MASTER_MODE;
-	cfg.clk_speed_hz = 100000;
+	cfg.clk_speed_hz = W25Q_CLK_SPEED_HZ;
 	cfg.bit_order = SPI_BIT_ORDER_MSB_FIRST;
 	cfg.clk_phase = SPI_CLK_PHASE_SAMPLE_FIRST_EDGE;
 	cfg.clk_polarity = SPI_CLK_POLARITY_IDLE_LOW;
@@ -230,6 +230,31 @@ bool W25Q_readSector(uint32_t sector, uint32_t offset, void *data, uint32_t len)
 	return ret;
 }
 
+bool W25Q_read(uint32_t		addr,
+							 uint8_t *	buf,
+							 uint16_t		len,
+							 SPI_xfer_cb cb,
+							 void *			ctx)
+{
+	if (((uint32_t)len + W25Q_READ_HEADER > 0xFFFF)
+	||  ((addr + len) > (w25q.sector_count * W25Q_SECTOR_SIZE))) {
+		return false; }
+
+	buf[0] = CMD_READ;
+	buf[1] = (addr & 0xFF0000) >> 16;
+	buf[2] = (addr & 0xFF00) >> 8;
+	buf[3] = addr & 0xFF;
+
+	/* tx & rx dma share buf, each byte goes out before its reply comes in */
+	return SPI_writeRead(W25Q_SPI_CH,
+											 W25Q_CS_PIN,
+											 buf,
+											 buf,
+											 W25Q_READ_HEADER + len,
+											 cb,
+											 ctx);
+}
+
 
 static bool	writeEnable(void)
 {
@@ -290,7 +315,7 @@ static uint8_t readStatusReg(uint8_t num)
 
 static bool waitForWriteEnd(void)
 {
-	bool ret;
+	bool ret = false;
 
 	TIMEOUT(readStatusReg(1) & STATUS_REG_1_BUSY_FLAG,
 					100,
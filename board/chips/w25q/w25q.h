@@ -16,6 +16,13 @@ extern "C"
 #define W25Q_SECTOR_SIZE		(4096)
 #define W25Q_SECTOR_COUNT		(256*16)
 
+/* command & 24 bit address in front of the data for W25Q_read */
+#define W25Q_READ_HEADER		(4)
+
+#ifndef W25Q_CLK_SPEED_HZ
+	#define W25Q_CLK_SPEED_HZ	(100000)
+#endif
+
 
 typedef enum
 {
@@ -43,6 +50,20 @@ extern bool W25Q_readSector(uint32_t sector,
 														void *data,
 														uint32_t len);
 
+/**
+ * @brief non blocking read, a single dma transfer with chip select held
+ * the whole way. the command goes out of the front of buf & is clocked
+ * back over by the data, which lands at buf + W25Q_READ_HEADER
+ *
+ * @param buf W25Q_READ_HEADER + len bytes, untouched until cb
+ * @return true if the transfer was queued, cb runs when it finishes
+ */
+extern bool W25Q_read(uint32_t		addr,
+											uint8_t *		buf,
+											uint16_t		len,
+											SPI_xfer_cb cb,
+											void *			ctx);
+
 
 #ifdef __cplusplus
 }
@@ -27,9 +27,15 @@ SOFTWARE.
 ****************************************************************************/
 
 
+#include "config_board.h"
+
+
+#ifdef WM8731_I2C_CH
+
+
 #include "wm8731.h"
 
-#include "config_board.h"
+#include "regmap/regmap.h"
 
 
 /* --------WM8731_REG_LEFT_LINE_IN : (Offset: 0x00) Left Line in Control -------- */
@@ -123,3 +129,201 @@ SOFTWARE.
 #define WM8731_REG_RESET_VALUE(value) ((WM8731_REG_RESET_VALUE_MSK & ((value) << WM8731_REG_RESET_VALUE_POS)))
 
 
+#define NUM_OF_REGS         (WM8731_REG_RESET + 1)
+
+
+typedef struct
+{
+  REGMAP_t map;
+  WM8731_cb_t cb;
+  /* setup is out, outputs are next. see WM8731_task */
+  bool volatile power_up;
+} wm8731_t;
+
+typedef struct
+{
+  uint32_t hz;
+  uint8_t  sr;
+} rate_t;
+
+
+static wm8731_t wm8731 = {0};
+
+/* normal mode, 12.288MHz mclk, bosr = 0 (256fs) */
+static rate_t const rates[] =
+{
+  {8000,  0x3},
+  {32000, 0x6},
+  {48000, 0x0},
+  {96000, 0x7},
+};
+
+/* after reset, 0x0A - 0x0E don't exist */
+static uint16_t const defaults[NUM_OF_REGS] =
+{
+  0x097, 0x097, 0x079, 0x079, 0x00A, 0x008, 0x09F, 0x00A,
+  0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+};
+
+
+static bool flush(wm8731_t *w, WM8731_cb_t cb);
+static void powerUpCb(bool error, void *ctx);
+static void flushCb(bool error, void *ctx);
+
+
+bool WM8731_init      (WM8731_cfg_t *cfg, WM8731_cb_t cb)
+{
+  wm8731_t *w = &wm8731;
+  REGMAP_t *map = &w->map;
+  I2C_cfg_t i2c_cfg;
+  REGMAP_cfg_t map_cfg;
+  uint16_t format;
+  uint8_t i;
+
+  i2c_cfg.master_mode   = I2C_MASTER_MODE;
+  i2c_cfg.clk_speed_hz  = 100000;
+  i2c_cfg.address_mode  = I2C_ADDRESS_MODE_7_BIT;
+  i2c_cfg.own_address   = 0;
+  i2c_cfg.stretch_mode  = I2C_STRETCH_MODE_DISABLE;
+
+  for (i = 0; i < SIZEOF(rates); i++)
+  {
+    if (cfg->sample_rate_hz == rates[i].hz) {
+      break; }
+  }
+
+  if ((i >= SIZEOF(rates)) || REGMAP_isBusy(map) || w->power_up) {
+    return false; }
+
+  if (false == I2C_init(cfg->ch, &i2c_cfg)) {
+    return false; }
+
+  /* registers are write only, the cache is all we know about them */
+  map_cfg.ch            = cfg->ch;
+  map_cfg.addr          = cfg->addr;
+  map_cfg.format        = REGMAP_FORMAT_A7_D9;
+  map_cfg.num_of_regs   = NUM_OF_REGS;
+  map_cfg.defaults      = defaults;
+  map_cfg.volatile_mask = (1u << WM8731_REG_RESET);
+  REGMAP_init(map, &map_cfg);
+
+  format = WM8731_REG_DIGITAL_AUDIO_INTERFACE_FORMAT_I2S |
+           WM8731_REG_DIGITAL_AUDIO_INTERFACE_FORMAT_IWL_16_BIT;
+  if (cfg->master) {
+    format |= WM8731_REG_DIGITAL_AUDIO_INTERFACE_FORMAT_MS; }
+
+  /* power up sequence from the datasheet, only registers that differ from
+   * the reset values go on the bus. outputs are enabled after, see WM8731_task */
+  REGMAP_write(map, WM8731_REG_RESET, 0);
+  REGMAP_write(map, WM8731_REG_POWER_DOWN_CONTROL, WM8731_REG_POWER_DOWN_CONTROL_MICPD |
+                                                   WM8731_REG_POWER_DOWN_CONTROL_OUTPD |
+                                                   WM8731_REG_POWER_DOWN_CONTROL_CLKOUTPD);
+  REGMAP_write(map, WM8731_REG_LEFT_LINE_IN, WM8731_REG_LEFT_LINE_IN_LINVOL(0x17));
+  REGMAP_write(map, WM8731_REG_RIGHT_LINE_IN, WM8731_REG_RIGHT_LINE_IN_RINVOL(0x17));
+  REGMAP_write(map, WM8731_REG_LEFT_HEADPHONE_OUT, WM8731_REG_LEFT_HEADPHONE_OUT_LHPVOL(0x79));
+  REGMAP_write(map, WM8731_REG_RIGHT_HEADPHONE_OUT, WM8731_REG_RIGHT_HEADPHONE_OUT_RHPVOL(0x79));
+  REGMAP_write(map, WM8731_REG_ANALOGUE_AUDIO_PATH_CONTROL, WM8731_REG_ANALOGUE_AUDIO_PATH_CONTROL_MUTEMIC |
+                                                            WM8731_REG_ANALOGUE_AUDIO_PATH_CONTROL_DACSEL);
+  REGMAP_write(map, WM8731_REG_DIGITAL_AUDIO_PATH_CONTROL, WM8731_REG_DIGITAL_AUDIO_PATH_CONTROL_DEEMP_DISABLE);
+  REGMAP_write(map, WM8731_REG_DIGITAL_AUDIO_INTERFACE_FORMAT, format);
+  REGMAP_write(map, WM8731_REG_SAMPLING_CONTROL, WM8731_REG_SAMPLING_CONTROL_SR(rates[i].sr));
+  REGMAP_write(map, WM8731_REG_ACTIVE_CONTROL, WM8731_REG_ACTIVE_CONTROL_ACTIVE);
+
+  w->cb = cb;
+
+  return REGMAP_flush(map, powerUpCb, w);
+}
+
+void WM8731_task      (void)
+{
+  wm8731_t *w = &wm8731;
+
+  REGMAP_task(&w->map);
+
+  if (false == w->power_up) {
+    return; }
+
+  w->power_up = false;
+
+  REGMAP_update(&w->map,
+                WM8731_REG_POWER_DOWN_CONTROL,
+                WM8731_REG_POWER_DOWN_CONTROL_OUTPD,
+                0);
+
+  if (false == REGMAP_flush(&w->map, flushCb, w))
+  {
+    if (w->cb) {
+      w->cb(true); }
+  }
+}
+
+bool WM8731_setVolume (uint8_t vol, WM8731_cb_t cb)
+{
+  wm8731_t *w = &wm8731;
+
+  if (REGMAP_isBusy(&w->map) || w->power_up) {
+    return false; }
+
+  REGMAP_write(&w->map, WM8731_REG_LEFT_HEADPHONE_OUT, WM8731_REG_LEFT_HEADPHONE_OUT_LHPVOL(vol));
+  REGMAP_write(&w->map, WM8731_REG_RIGHT_HEADPHONE_OUT, WM8731_REG_RIGHT_HEADPHONE_OUT_RHPVOL(vol));
+
+  return flush(w, cb);
+}
+
+bool WM8731_setInput  (uint8_t vol, WM8731_cb_t cb)
+{
+  wm8731_t *w = &wm8731;
+
+  if (REGMAP_isBusy(&w->map) || w->power_up) {
+    return false; }
+
+  REGMAP_write(&w->map, WM8731_REG_LEFT_LINE_IN, WM8731_REG_LEFT_LINE_IN_LINVOL(vol));
+  REGMAP_write(&w->map, WM8731_REG_RIGHT_LINE_IN, WM8731_REG_RIGHT_LINE_IN_RINVOL(vol));
+
+  return flush(w, cb);
+}
+
+bool WM8731_mute      (bool mute, WM8731_cb_t cb)
+{
+  wm8731_t *w = &wm8731;
+
+  if (REGMAP_isBusy(&w->map) || w->power_up) {
+    return false; }
+
+  REGMAP_update(&w->map,
+                WM8731_REG_DIGITAL_AUDIO_PATH_CONTROL,
+                WM8731_REG_DIGITAL_AUDIO_PATH_CONTROL_DACMU,
+                mute ? WM8731_REG_DIGITAL_AUDIO_PATH_CONTROL_DACMU : 0);
+
+  return flush(w, cb);
+}
+
+
+static bool flush(wm8731_t *w, WM8731_cb_t cb)
+{
+  w->cb = cb;
+
+  return REGMAP_flush(&w->map, flushCb, w);
+}
+
+/* everything configured & active, the outputs go from WM8731_task */
+static void powerUpCb(bool error, void *ctx)
+{
+  wm8731_t *w = (wm8731_t*)ctx;
+
+  if (false == error) {
+    w->power_up = true; }
+  else if (w->cb) {
+    w->cb(error); }
+}
+
+static void flushCb(bool error, void *ctx)
+{
+  wm8731_t *w = (wm8731_t*)ctx;
+
+  if (w->cb) {
+    w->cb(error); }
+}
+
+
+#endif
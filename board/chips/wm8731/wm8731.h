@@ -1,20 +1,68 @@
-#ifndef __WM8731_H
-#define __WM8731_H
-
-
-#ifdef __cplusplus
-extern "C"
-{
-#endif
-
-
-#include "spi.h"
-#include "i2c.h"
-
-
-#ifdef __cplusplus
-}
-#endif
-
-
-#endif
+#ifndef __WM8731_H
+#define __WM8731_H
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#include "i2c.h"
+
+
+/* 7 bit address 0x1A with CSB low, shifted for the i2c driver */
+#define WM8731_ADDR         (0x1A << 1)
+
+
+typedef void (*WM8731_cb_t)(bool error);
+
+typedef struct
+{
+  I2C_ch_e  ch;
+  uint16_t  addr;
+  /// rates available from a 12.288MHz mclk: 8000, 32000, 48000, 96000
+  uint32_t  sample_rate_hz;
+  /// codec generates the i2s clocks, mcu is the slave
+  bool      master;
+} WM8731_cfg_t;
+
+
+/**
+ * @brief reset & configure the codec for 16 bit i2s, line in -> adc,
+ * dac -> headphone/ line out. Writes go out in the background, cb is
+ * called when all are done or one fails
+ *
+ * @return true if started
+ */
+extern bool WM8731_init       (WM8731_cfg_t *cfg, WM8731_cb_t cb);
+
+/**
+ * @brief Call this function periodically, sends queued writes & finishes
+ * the power up started by WM8731_init
+ * @attention Do NOT call from an interrupt
+ */
+extern void WM8731_task       (void);
+
+/**
+ * @brief headphone out volume, both channels
+ * @param vol 0x79 = 0dB, 1dB steps, <= 0x2F mutes
+ */
+extern bool WM8731_setVolume  (uint8_t vol, WM8731_cb_t cb);
+
+/**
+ * @brief line in volume, both channels
+ * @param vol 0x17 = 0dB, 1.5dB steps, 0 - 0x1F
+ */
+extern bool WM8731_setInput   (uint8_t vol, WM8731_cb_t cb);
+
+/* soft mute the dac */
+extern bool WM8731_mute       (bool mute, WM8731_cb_t cb);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -39,6 +39,8 @@ SOFTWARE.
 #define W25Q_NUM_OF        1
 #define W25Q_SPI_CH        SPI_CH_1
 #define W25Q_CS_PIN        IO_portPinToNum(IO_PORT_B, 8)
+/* apb2 / 4, fast enough to stream samples (plain read is good to 50MHz) */
+#define W25Q_CLK_SPEED_HZ  (21000000)
 
 #define STG_0
 #define STG_0_READ_SIZE     W25Q_READ_SIZE
@@ -50,8 +52,16 @@ SOFTWARE.
 #define PCF8575_0_CH        I2C_CH_1
 #define PCF8575_0_ADDR      0
 
+/* codec has its own 12.288MHz crystal & generates the i2s clocks */
+#define WM8731_I2C_CH       I2C_CH_1
+#define WM8731_I2S_CH       I2S_CH_2
+#define WM8731_MASTER       true
+
 #define BUILTIN_LED_PIN     IO_portPinToNum(IO_PORT_C, 13)
 
+/* din in & out through the opto/ buffer */
+#define MIDI_USART_CH       USART_CH_2
+
 
 #ifdef __cplusplus
 }
@@ -38,7 +38,9 @@ SOFTWARE.
 
 #define SPI_1_ENABLED
 #define I2C_1_ENABLED
+#define I2S_2_ENABLED
 #define USART_2_ENABLED
+#define USB_FS_ENABLED
 #define IO_EXT_IRQ_1_ENABLED
 #define ADC_1_ENABLED
 
@@ -49,9 +51,10 @@ SOFTWARE.
   #define SPI_1_MISO_PIN        IO_portPinToNum(IO_PORT_A, 6)
   #define SPI_1_SCK_PIN         IO_portPinToNum(IO_PORT_A, 5)
   #define SPI_1_PRIORITY        PRIORITY_MEDIUM
-  #define SPI_1_RX_DMA_STREAM   DMA_STREAM_NONE
+  /* spi 1 rx is dma 2 stream 0 or 2, stream 0 is the adc's */
+  #define SPI_1_RX_DMA_STREAM   DMA_2_STREAM_2
   #define SPI_1_RX_DMA_CH       DMA_CH_3
-  #define SPI_1_TX_DMA_STREAM   DMA_STREAM_NONE
+  #define SPI_1_TX_DMA_STREAM   DMA_2_STREAM_3
   #define SPI_1_TX_DMA_CH       DMA_CH_3
 #endif
 
@@ -62,10 +65,24 @@ SOFTWARE.
   #define I2C_1_PRIORITY        PRIORITY_MEDIUM
   #define I2C_1_RX_DMA_STREAM   DMA_1_STREAM_0
   #define I2C_1_RX_DMA_CH       DMA_CH_1
-  #define I2C_1_TX_DMA_STREAM   DMA_1_STREAM_6
+  #define I2C_1_TX_DMA_STREAM   DMA_1_STREAM_7
   #define I2C_1_TX_DMA_CH       DMA_CH_1
 #endif
 
+#ifdef  I2S_2_ENABLED
+  #define I2S_2_CK_PIN          IO_portPinToNum(IO_PORT_B, 13)
+  #define I2S_2_WS_PIN          IO_portPinToNum(IO_PORT_B, 12)
+  #define I2S_2_SD_PIN          IO_portPinToNum(IO_PORT_B, 15)
+  #define I2S_2_EXT_SD_PIN      IO_portPinToNum(IO_PORT_B, 14)
+  #define I2S_2_IO_CFG_EXT      {GPIO_AF5_SPI2}
+  #define I2S_2_EXT_IO_CFG_EXT  {GPIO_AF6_I2S2ext}
+  #define I2S_2_PRIORITY        PRIORITY_HIGH
+  #define I2S_2_TX_DMA_STREAM   DMA_1_STREAM_4
+  #define I2S_2_TX_DMA_CH       DMA_CH_0
+  #define I2S_2_RX_DMA_STREAM   DMA_1_STREAM_3
+  #define I2S_2_RX_DMA_CH       DMA_CH_3
+#endif
+
 #ifdef  USART_2_ENABLED
   #define USART_2_TX_PIN        IO_portPinToNum(IO_PORT_A, 2)
   #define USART_2_RX_PIN        IO_portPinToNum(IO_PORT_A, 3)
@@ -73,10 +90,15 @@ SOFTWARE.
   #define USART_2_CTS_PIN       IO_NULL_PIN
   #define USART_2_IO_CFG_EXT    {GPIO_AF7_USART2}
   #define USART_2_PRIORITY      PRIORITY_MEDIUM
-  #define USART_2_RX_DMA_STREAM DMA_STREAM_NONE
-  #define USART_2_RX_DMA_CH     0
-  #define USART_2_TX_DMA_STREAM DMA_STREAM_NONE
-  #define USART_2_TX_DMA_CH     0
+  #define USART_2_RX_DMA_STREAM DMA_1_STREAM_5
+  #define USART_2_RX_DMA_CH     DMA_CH_4
+  #define USART_2_TX_DMA_STREAM DMA_1_STREAM_6
+  #define USART_2_TX_DMA_CH     DMA_CH_4
+#endif
+
+#ifdef  USB_FS_ENABLED
+  /* pa11/ pa12, set up by the cube msp init */
+  #define USB_FS_PRIORITY       PRIORITY_MEDIUM
 #endif
 
 #ifdef  IO_EXT_IRQ_1_ENABLED
@@ -85,7 +107,31 @@ SOFTWARE.
 #endif
 
 #ifdef  ADC_1_ENABLED
-  #define ADC_1_DMA_STREAM      DMA_1_STREAM_0
+  /* pots 1, 3 & 4 are pa2/ pa6/ pa7 in the cube project, those are usart 2
+  tx & spi 1 here so they use the io header pins instead */
+  #define ADC_KNOB_1_PIN        IO_portPinToNum(IO_PORT_C, 4)
+  #define ADC_KNOB_1_CH         ADC_CHANNEL_14
+  #define ADC_KNOB_2_PIN        IO_portPinToNum(IO_PORT_A, 4)
+  #define ADC_KNOB_2_CH         ADC_CHANNEL_4
+  #define ADC_KNOB_3_PIN        IO_portPinToNum(IO_PORT_C, 5)
+  #define ADC_KNOB_3_CH         ADC_CHANNEL_15
+  #define ADC_KNOB_4_PIN        IO_portPinToNum(IO_PORT_B, 0)
+  #define ADC_KNOB_4_CH         ADC_CHANNEL_8
+  #define ADC_CV_1_PIN          IO_portPinToNum(IO_PORT_C, 0)
+  #define ADC_CV_1_CH           ADC_CHANNEL_10
+  #define ADC_CV_2_PIN          IO_portPinToNum(IO_PORT_C, 1)
+  #define ADC_CV_2_CH           ADC_CHANNEL_11
+  #define ADC_CV_3_PIN          IO_portPinToNum(IO_PORT_C, 2)
+  #define ADC_CV_3_CH           ADC_CHANNEL_12
+  #define ADC_CV_4_PIN          IO_portPinToNum(IO_PORT_C, 3)
+  #define ADC_CV_4_CH           ADC_CHANNEL_13
+  #define ADC_1_PRIORITY        PRIORITY_LOW
+  /* adc 1 only has dma 2 stream 0 or 4, channel 0 */
+  #define ADC_1_DMA_STREAM      DMA_2_STREAM_0
+  #define ADC_1_DMA_CH          DMA_CH_0
+  /* snapshots per second, each the sum of 4^n scans for n extra bits */
+  #define ADC_1_RATE_HZ         1000
+  #define ADC_1_OVERSAMPLE_BITS 2
 #endif
 
 
@@ -0,0 +1,188 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __RING_H
+#define __RING_H
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/**
+ * @file ring.h
+ * @brief single producer, single consumer ring of fixed size elements
+ *
+ * head is only written by the producer & tail only by the consumer, both
+ * count up forever & are masked to index, so the capacity has to be a
+ * power of 2. the slot is filled before head is published (release) & read
+ * after head is seen (acquire), likewise for tail, so one side can be the
+ * main loop & the other an interrupt with no locking
+ *
+ * slots are used in place, which suits driver queues where the oldest
+ * entry stays put while the transfer it describes is running
+ *
+ *   xfer_t buf[8];
+ *   RING_t q;
+ *
+ *   RING_INIT(&q, buf);
+ *
+ *   // producer
+ *   if ((x = RING_head(&q))) { x->len = 4; RING_push(&q); }
+ *
+ *   // consumer
+ *   if ((x = RING_tail(&q))) { start(x); ... RING_pop(&q); }
+ *
+ * with more than one producer (eg. a callback queueing the next transfer
+ * from the irq) the producers still have to be kept apart
+ */
+
+
+#include "common.h"
+
+
+typedef struct
+{
+  uint8_t *buf;
+  uint32_t size;              ///< bytes per element
+  uint32_t mask;              ///< capacity - 1
+  uint32_t head;              ///< producer
+  uint32_t tail;              ///< consumer
+} RING_t;
+
+
+#define RING_INIT(r, array)   RING_init((r), (array), sizeof((array)[0]), SIZEOF(array))
+
+
+/* false if capacity is not a power of 2 */
+static inline bool RING_init(RING_t *r, void *buf, uint32_t size, uint32_t capacity)
+{
+  if ((0 == capacity) || (capacity & (capacity - 1))) {
+    return false; }
+
+  r->buf = (uint8_t *)buf;
+  r->size = size;
+  r->mask = capacity - 1;
+  r->head = 0;
+  r->tail = 0;
+
+  return true;
+}
+
+static inline uint32_t RING_capacity(RING_t const *r)
+{
+  return r->mask + 1;
+}
+
+static inline uint32_t RING_count(RING_t const *r)
+{
+  return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline bool RING_isEmpty(RING_t const *r)
+{
+  return (0 == RING_count(r));
+}
+
+static inline bool RING_isFull(RING_t const *r)
+{
+  return (RING_count(r) > r->mask);
+}
+
+
+/* producer, the free slot to fill or NULL if full */
+static inline void *RING_head(RING_t *r)
+{
+  uint32_t head = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+
+  if ((head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) > r->mask) {
+    return NULL; }
+
+  return r->buf + ((head & r->mask) * r->size);
+}
+
+/* producer, hand the slot from RING_head to the consumer */
+static inline void RING_push(RING_t *r)
+{
+  __atomic_store_n(&r->head, __atomic_load_n(&r->head, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+/* consumer, the oldest slot or NULL if empty */
+static inline void *RING_tail(RING_t *r)
+{
+  uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+
+  if (tail == __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)) {
+    return NULL; }
+
+  return r->buf + ((tail & r->mask) * r->size);
+}
+
+/* consumer, done with the slot from RING_tail, the producer may reuse it */
+static inline void RING_pop(RING_t *r)
+{
+  __atomic_store_n(&r->tail, __atomic_load_n(&r->tail, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+
+/* copying versions of the above */
+static inline bool RING_write(RING_t *r, void const *item)
+{
+  void *slot = RING_head(r);
+
+  if (NULL == slot) {
+    return false; }
+
+  memcpy(slot, item, r->size);
+  RING_push(r);
+
+  return true;
+}
+
+static inline bool RING_read(RING_t *r, void *item)
+{
+  void const *slot = RING_tail(r);
+
+  if (NULL == slot) {
+    return false; }
+
+  memcpy(item, slot, r->size);
+  RING_pop(r);
+
+  return true;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,132 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/**
+ * @file snapshot.h
+ * @brief latest value from one writer, readable anywhere without locking
+ *
+ * two copies of the value & a sequence counter. the writer fills the copy
+ * readers are not using then bumps seq (release), which makes it the
+ * latest. a reader copies the latest & retries if seq moved meanwhile, so
+ * it never returns a mix of two values
+ *
+ * readers never wait on the writer, a reader interrupting the writer sees
+ * the previous value. a reader interrupted by the writer retries at most
+ * once per value written, which is never for a reader faster than the
+ * writer's rate
+ *
+ *   uint16_t copies[2][8];
+ *   SNAP_t s;
+ *
+ *   SNAP_INIT(&s, copies);
+ *
+ *   // writer
+ *   fill(SNAP_back(&s)); SNAP_publish(&s);
+ *
+ *   // reader, 0 until the first publish
+ *   if (SNAP_read(&s, vals) != last) { ... }
+ */
+
+
+#include "common.h"
+
+
+typedef struct
+{
+  uint8_t *buf;               ///< 2 copies, the latest is seq & 1
+  uint32_t size;              ///< bytes per copy
+  uint32_t seq;               ///< values published
+} SNAP_t;
+
+
+#define SNAP_INIT(s, array)   SNAP_init((s), (array), sizeof((array)[0]))
+
+
+static inline void SNAP_init(SNAP_t *s, void *buf, uint32_t size)
+{
+  s->buf = (uint8_t *)buf;
+  s->size = size;
+  s->seq = 0;
+
+  memset(buf, 0, 2 * size);
+}
+
+static inline uint32_t SNAP_seq(SNAP_t const *s)
+{
+  return __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+}
+
+
+/* writer, the copy to fill. the last publish is ordered before these writes */
+static inline void *SNAP_back(SNAP_t *s)
+{
+  uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  return s->buf + (((seq + 1) & 1) * s->size);
+}
+
+/* writer, the copy from SNAP_back becomes the latest */
+static inline void SNAP_publish(SNAP_t *s)
+{
+  __atomic_store_n(&s->seq, __atomic_load_n(&s->seq, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+
+/* reader, copy the latest into out & return its seq */
+static inline uint32_t SNAP_read(SNAP_t const *s, void *out)
+{
+  uint32_t seq;
+
+  do
+  {
+    seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    memcpy(out, s->buf + ((seq & 1) * s->size), s->size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while (seq != __atomic_load_n(&s->seq, __ATOMIC_RELAXED));
+
+  return seq;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
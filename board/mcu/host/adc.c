@@ -0,0 +1,126 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#include "adc.h"
+
+#include "host.h"
+
+#include "snapshot.h"
+
+
+/* same double buffer as the target, the dma is a loop over it */
+#define HALF_LEN      (ADC_OVERSAMPLE * ADC_NUM_OF_CH)
+
+
+static bool running = false;
+static uint16_t vals[ADC_NUM_OF_CH] = {0};
+static HOST_adc_fn source = NULL;
+static void *source_ctx = NULL;
+
+static uint16_t raw[2 * HALF_LEN];
+static uint32_t pos = 0;
+static uint16_t snap_vals[2][ADC_NUM_OF_CH];
+static SNAP_t snap;
+
+
+bool ADC_init   (void)
+{
+  SNAP_INIT(&snap, snap_vals);
+  pos = 0;
+  return true;
+}
+
+bool ADC_deInit (void)
+{
+  running = false;
+  return true;
+}
+
+bool ADC_start  (void)
+{
+  running = true;
+  pos = 0;
+  return true;
+}
+
+bool ADC_stop   (void)
+{
+  running = false;
+  return true;
+}
+
+bool ADC_read   (ADC_snapshot_t *s)
+{
+  s->seq = SNAP_read(&snap, s->val);
+
+  return (0 != s->seq);
+}
+
+uint32_t ADC_seq(void)
+{
+  return SNAP_seq(&snap);
+}
+
+
+/* Simulation hooks */
+
+void HOST_ADC_set(ADC_ch_e ch, uint16_t value)
+{
+  if (ch < ADC_NUM_OF_CH) {
+    vals[ch] = value; }
+}
+
+void HOST_ADC_attach(HOST_adc_fn fn, void *ctx)
+{
+  source = fn;
+  source_ctx = ctx;
+}
+
+void HOST_ADC_trigger(uint32_t n)
+{
+  ADC_ch_e ch;
+
+  if (false == running) {
+    return; }
+
+  while (n--)
+  {
+    for (ch = ADC_CH_FIRST; ch < ADC_NUM_OF_CH; ch++) {
+      raw[pos++] = (source ? source(ch, source_ctx) : vals[ch]) & 0xFFF; }
+
+    /* half & full transfer callbacks */
+    if ((HALF_LEN == pos) || ((2 * HALF_LEN) == pos))
+    {
+      ADC_decimate(&raw[pos - HALF_LEN], (uint16_t *)SNAP_back(&snap));
+      SNAP_publish(&snap);
+    }
+
+    if ((2 * HALF_LEN) == pos) {
+      pos = 0; }
+  }
+}
@@ -0,0 +1,200 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __HOST_H
+#define __HOST_H
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/**
+ * @file host.h
+ * @author Rick Davies (richvies@gmail.com)
+ * @brief
+ * Simulation hooks for the host (pc) build of the mcu library.
+ * Lets tests attach device models to the buses, drive inputs and read
+ * back traffic counters. Only available when built with target=host
+ * @version 0.1
+ * @date 2022-09-10
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+
+#include "mcu.h"
+
+#include "i2s.h"
+#include "io.h"
+#include "merror.h"
+#include "usart.h"
+#include "usb.h"
+
+
+/**
+ * @brief device model on a spi bus, called once per transfer
+ * tx or rx can be NULL depending on the direction of the transfer
+ *
+ * @return false to fail the transfer
+ */
+typedef bool (*HOST_spi_dev_fn)(IO_num_e        cs_pin,
+                                uint8_t const * tx,
+                                uint8_t *       rx,
+                                uint16_t        length,
+                                void *          ctx);
+
+/**
+ * @brief device model on an i2c bus, called once per transfer
+ * for memory reads mem_addr/ mem_length hold the register address
+ *
+ * @return false to NACK the transfer
+ */
+typedef bool (*HOST_i2c_dev_fn)(bool      read,
+                                uint16_t  mem_addr,
+                                uint8_t   mem_length,
+                                uint8_t * data,
+                                uint16_t  length,
+                                void *    ctx);
+
+typedef struct
+{
+  uint32_t xfers;
+  uint32_t bytes;
+  uint32_t errors;
+} HOST_bus_stats_t;
+
+typedef struct
+{
+  /// callbacks made
+  uint32_t halves;
+  /// halves the codec got stale because the callback was late
+  uint32_t dropouts;
+  /// slowest callback, ns
+  uint32_t max_cb_ns;
+} HOST_i2s_stats_t;
+
+/**
+ * @brief sees each byte the usart sends
+ *
+ * @param ns simulated time its stop bit finished
+ */
+typedef void (*HOST_usart_tx_fn)(uint8_t byte, uint64_t ns, void *ctx);
+
+typedef struct
+{
+  uint32_t tx_bytes;
+  uint32_t rx_bytes;
+  /// tx dma transfers started
+  uint32_t tx_dmas;
+  /// rx half, full & idle interrupts
+  uint32_t rx_irqs;
+} HOST_usart_stats_t;
+
+/* sees each bulk in packet the host takes */
+typedef void (*HOST_usb_in_fn)(uint8_t const *data, uint16_t length, void *ctx);
+
+/* what one conversion of ch reads, 12 bit, instead of the set value */
+typedef uint16_t (*HOST_adc_fn)(ADC_ch_e ch, void *ctx);
+
+typedef struct
+{
+  uint32_t in_packets;
+  uint32_t in_bytes;
+  uint32_t out_packets;
+  uint32_t out_bytes;
+} HOST_usb_stats_t;
+
+
+extern void HOST_SPI_attach     (SPI_ch_e ch, HOST_spi_dev_fn fn, void *ctx);
+extern void HOST_SPI_getStats   (SPI_ch_e ch, HOST_bus_stats_t *stats);
+extern void HOST_SPI_clearStats (SPI_ch_e ch);
+/* non blocking transfers take len * 8 / clk_hz + gap_ns of simulated time,
+ * queued until HOST_SPI_run advances it. clk_hz 0 (default) is instant */
+extern void HOST_SPI_setTiming  (SPI_ch_e ch, uint32_t clk_hz, uint32_t gap_ns);
+extern void HOST_SPI_run        (SPI_ch_e ch, uint32_t ns);
+extern uint32_t HOST_SPI_pending (SPI_ch_e ch);
+
+extern bool HOST_I2C_attach     (I2C_ch_e ch, uint16_t addr, HOST_i2c_dev_fn fn, void *ctx);
+extern void HOST_I2C_detachAll  (I2C_ch_e ch);
+extern void HOST_I2C_getStats   (I2C_ch_e ch, HOST_bus_stats_t *stats);
+extern void HOST_I2C_clearStats (I2C_ch_e ch);
+
+/* tx is looped back into rx, delayed by latency frames (left + right) */
+extern bool HOST_I2S_setLoopback (I2S_ch_e ch, uint16_t latency);
+/* advance the dma by n halves, the callback runs for each */
+extern void HOST_I2S_run        (I2S_ch_e ch, uint32_t halves);
+/* treat the next callback as late, even if it was not */
+extern void HOST_I2S_dropNext   (I2S_ch_e ch);
+extern void HOST_I2S_getStats   (I2S_ch_e ch, HOST_i2s_stats_t *stats);
+
+/* tx is looped back into rx */
+extern void HOST_USART_setLoopback (USART_ch_e ch, bool on);
+extern void HOST_USART_attach   (USART_ch_e ch, HOST_usart_tx_fn fn, void *ctx);
+/* onto the rx wire, back to back from the current simulated time */
+extern bool HOST_USART_inject   (USART_ch_e ch, uint8_t const *data, uint16_t length);
+/* advance simulated time, bytes move & rx events fire as they fall due */
+extern void HOST_USART_run      (USART_ch_e ch, uint64_t ns);
+extern uint64_t HOST_USART_now  (USART_ch_e ch);
+extern void HOST_USART_getStats (USART_ch_e ch, HOST_usart_stats_t *stats);
+extern void HOST_USART_clearStats (USART_ch_e ch);
+
+/* plug in & configure, or unplug. tx queued before unplugging is dropped */
+extern void HOST_USB_connect    (bool on);
+extern void HOST_USB_attach     (HOST_usb_in_fn fn, void *ctx);
+/* what the host gets for GET_DESCRIPTOR (configuration) */
+extern uint8_t const* HOST_USB_configDesc (uint16_t *length);
+/* a bulk out transfer, the rx callback gets it a packet at a time */
+extern bool HOST_USB_send       (uint8_t const *data, uint16_t length);
+/* up to n bulk in packets, as many as are queued */
+extern uint32_t HOST_USB_poll   (uint32_t packets);
+extern void HOST_USB_getStats   (HOST_usb_stats_t *stats);
+extern void HOST_USB_clearStats (void);
+
+/* drive an input pin, calls the external irq callback on an edge */
+extern void HOST_IO_drive       (IO_num_e num, bool high);
+
+/* 12 bit level each conversion of ch reads */
+extern void HOST_ADC_set        (ADC_ch_e ch, uint16_t value);
+extern void HOST_ADC_attach     (HOST_adc_fn fn, void *ctx);
+/* n timer triggers while started, each scans every channel into the dma */
+extern void HOST_ADC_trigger    (uint32_t n);
+
+extern uint32_t HOST_MERR_count (merror_e err);
+extern void     HOST_MERR_clear (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
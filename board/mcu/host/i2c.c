@@ -0,0 +1,292 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "i2c.h"
+
+
+#ifdef I2C_ENABLED
+
+
+#include "host.h"
+
+#include "merror.h"
+#include "mevent.h"
+
+
+/* transfers complete as soon as they are started, so every callback runs
+ * before I2C_write/ I2C_read returns (on target it runs from the irq) */
+
+
+#define DEVICES_NUM_OF  (8)
+
+
+typedef struct
+{
+  bool            used;
+  uint16_t        addr;
+  HOST_i2c_dev_fn fn;
+  void*           ctx;
+} device_t;
+
+typedef struct
+{
+  bool init;
+  device_t devices[DEVICES_NUM_OF];
+  HOST_bus_stats_t stats;
+} handle_t;
+
+
+static handle_t handles[I2C_NUM_OF_CH] = {0};
+
+
+static bool xfer(I2C_ch_e    ch,
+                 bool        read,
+                 uint16_t    addr,
+                 uint16_t    mem_addr,
+                 uint8_t     mem_length,
+                 uint8_t*    data,
+                 uint16_t    length);
+static bool xferNonblocking(I2C_ch_e    ch,
+                            bool        read,
+                            uint16_t    addr,
+                            uint16_t    mem_addr,
+                            uint8_t     mem_length,
+                            uint8_t*    data,
+                            uint16_t    length,
+                            I2C_xfer_cb cb,
+                            void*       ctx);
+static device_t* findDevice(handle_t *h, uint16_t addr);
+
+
+bool I2C_init       (I2C_ch_e ch, I2C_cfg_t *cfg)
+{
+  (void)cfg;
+
+  if (ch >= I2C_NUM_OF_CH) {
+    return false; }
+
+  handles[ch].init = true;
+
+  return true;
+}
+
+bool I2C_deInit     (I2C_ch_e ch)
+{
+  if (ch >= I2C_NUM_OF_CH) {
+    return false; }
+
+  handles[ch].init = false;
+
+  return true;
+}
+
+void I2C_task       (void)
+{
+}
+
+
+bool I2C_write      (I2C_ch_e    ch,
+                     uint16_t    addr,
+                     uint8_t*    tx_data,
+                     uint16_t    length,
+                     I2C_xfer_cb cb,
+                     void*       ctx)
+{
+  return xferNonblocking(ch, false, addr, 0, 0, tx_data, length, cb, ctx);
+}
+
+bool I2C_read       (I2C_ch_e    ch,
+                     uint16_t    addr,
+                     uint8_t*    rx_data,
+                     uint16_t    length,
+                     I2C_xfer_cb cb,
+                     void*       ctx)
+{
+  return xferNonblocking(ch, true, addr, 0, 0, rx_data, length, cb, ctx);
+}
+
+bool I2C_readMem    (I2C_ch_e     ch,
+                     uint16_t     addr,
+                     uint16_t     mem_addr,
+                     uint8_t      mem_length,
+                     uint8_t*     rx_data,
+                     uint16_t     length,
+                     I2C_xfer_cb  cb,
+                     void*        ctx)
+{
+  return xferNonblocking(ch, true, addr, mem_addr, mem_length, rx_data, length, cb, ctx);
+}
+
+bool I2C_writeBlocking    (I2C_ch_e    ch,
+                           uint16_t    addr,
+                           uint8_t*    tx_data,
+                           uint16_t    length)
+{
+  return (ch < I2C_NUM_OF_CH) && xfer(ch, false, addr, 0, 0, tx_data, length);
+}
+
+bool I2C_readBlocking     (I2C_ch_e    ch,
+                           uint16_t    addr,
+                           uint8_t*    rx_data,
+                           uint16_t    length)
+{
+  return (ch < I2C_NUM_OF_CH) && xfer(ch, true, addr, 0, 0, rx_data, length);
+}
+
+bool I2C_readMemBlocking  (I2C_ch_e     ch,
+                           uint16_t     addr,
+                           uint16_t     mem_addr,
+                           uint8_t      mem_length,
+                           uint8_t*     rx_data,
+                           uint16_t     length)
+{
+  return (ch < I2C_NUM_OF_CH) && xfer(ch, true, addr, mem_addr, mem_length, rx_data, length);
+}
+
+
+/* Simulation hooks */
+
+bool HOST_I2C_attach     (I2C_ch_e ch, uint16_t addr, HOST_i2c_dev_fn fn, void *ctx)
+{
+  uint8_t i;
+  handle_t *h = &handles[ch];
+  device_t *d = findDevice(h, addr);
+
+  for (i = 0; (NULL == d) && (i < DEVICES_NUM_OF); i++)
+  {
+    if (false == h->devices[i].used) {
+      d = &h->devices[i]; }
+  }
+
+  if (NULL == d) {
+    return false; }
+
+  d->used = true;
+  d->addr = addr;
+  d->fn = fn;
+  d->ctx = ctx;
+
+  return true;
+}
+
+void HOST_I2C_detachAll  (I2C_ch_e ch)
+{
+  memset(handles[ch].devices, 0, sizeof(handles[ch].devices));
+}
+
+void HOST_I2C_getStats   (I2C_ch_e ch, HOST_bus_stats_t *stats)
+{
+  *stats = handles[ch].stats;
+}
+
+void HOST_I2C_clearStats (I2C_ch_e ch)
+{
+  memset(&handles[ch].stats, 0, sizeof(HOST_bus_stats_t));
+}
+
+
+/* Transfer functions */
+
+static bool xfer(I2C_ch_e    ch,
+                 bool        read,
+                 uint16_t    addr,
+                 uint16_t    mem_addr,
+                 uint8_t     mem_length,
+                 uint8_t*    data,
+                 uint16_t    length)
+{
+  bool ret = false;
+  handle_t *h = &handles[ch];
+  device_t *d = findDevice(h, addr);
+
+  if (false == h->init)
+  {
+    MERR_error(MERROR_I2C_XFER_START, ch);
+    return false;
+  }
+
+  /* bytes on the wire: address, register address + repeated start
+   * address for memory reads, then the data */
+  h->stats.xfers++;
+  h->stats.bytes += 1 + length;
+  if (mem_length) {
+    h->stats.bytes += mem_length + 1; }
+
+  if (d && d->fn) {
+    ret = d->fn(read, mem_addr, mem_length, data, length, d->ctx); }
+
+  if (false == ret)
+  {
+    h->stats.errors++;
+    MERR_error(MERROR_I2C_XFER_ERROR, ch);
+  }
+
+  return ret;
+}
+
+static bool xferNonblocking(I2C_ch_e    ch,
+                            bool        read,
+                            uint16_t    addr,
+                            uint16_t    mem_addr,
+                            uint8_t     mem_length,
+                            uint8_t*    data,
+                            uint16_t    length,
+                            I2C_xfer_cb cb,
+                            void*       ctx)
+{
+  bool ok;
+
+  if (ch >= I2C_NUM_OF_CH) {
+    return false; }
+
+  ok = xfer(ch, read, addr, mem_addr, mem_length, data, length);
+
+  if (cb) {
+    cb(!ok, ctx); }
+
+  MEVE_setEvent(MEVENT_I2C);
+
+  return true;
+}
+
+static device_t* findDevice(handle_t *h, uint16_t addr)
+{
+  uint8_t i;
+
+  for (i = 0; i < DEVICES_NUM_OF; i++)
+  {
+    if (h->devices[i].used && (addr == h->devices[i].addr)) {
+      return &h->devices[i]; }
+  }
+
+  return NULL;
+}
+
+
+#endif
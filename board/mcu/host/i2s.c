@@ -0,0 +1,254 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "i2s.h"
+
+
+#ifdef I2S_ENABLED
+
+
+#include "host.h"
+
+#include "merror.h"
+#include "tim.h"
+
+
+/* there is no real time dma on host, HOST_I2S_run() steps it one half at a
+ * time instead. each step the half is "sent" into a loopback delay line &
+ * the same half of rx is filled from it, then the callback runs as it would
+ * from the dma interrupt.
+ *
+ * a callback that takes longer than a half period (or after HOST_I2S_dropNext)
+ * is late, the dma would already be sending that half again so the codec gets
+ * the previous contents instead of the new ones */
+
+
+#define MAX_HALF        (4096)
+#define MAX_LATENCY     (4096)
+
+
+typedef struct
+{
+  bool init;
+  bool running;
+  I2S_cfg_t cfg;
+
+  /* circular buffers, two halves each */
+  int16_t *tx_data;
+  int16_t *rx_data;
+  uint16_t length;
+  I2S_xfer_cb cb;
+  void *ctx;
+  uint8_t half;
+
+  /* loopback delay line */
+  int16_t wire[MAX_LATENCY * 2];
+  uint32_t wire_length;
+  uint32_t wire_pos;
+
+  /* contents of each half before the callback, sent again if it is late */
+  int16_t stale[2][MAX_HALF];
+  bool is_stale[2];
+  bool drop_next;
+
+  HOST_i2s_stats_t stats;
+} handle_t;
+
+
+static handle_t handles[I2S_NUM_OF_CH] = {0};
+
+
+static void step(handle_t *h);
+
+
+bool I2S_init   (I2S_ch_e ch, I2S_cfg_t *cfg)
+{
+  handle_t *h;
+
+  if (ch >= I2S_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (h->init) {
+    return true; }
+
+  memcpy(&h->cfg, cfg, sizeof(I2S_cfg_t));
+  h->init = true;
+
+  return true;
+}
+
+bool I2S_deInit (I2S_ch_e ch)
+{
+  if (ch >= I2S_NUM_OF_CH) {
+    return false; }
+
+  I2S_stop(ch);
+  handles[ch].init = false;
+
+  return true;
+}
+
+bool I2S_start  (I2S_ch_e    ch,
+                 int16_t*    tx_data,
+                 int16_t*    rx_data,
+                 uint16_t    length,
+                 I2S_xfer_cb cb,
+                 void*       ctx)
+{
+  handle_t *h;
+
+  if ((ch >= I2S_NUM_OF_CH) || (length & 1) || ((length / 2) > MAX_HALF)) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (false == h->init)
+  {
+    MERR_error(MERROR_I2S_XFER_START, ch);
+    return false;
+  }
+
+  h->tx_data = tx_data;
+  h->rx_data = rx_data;
+  h->length = length;
+  h->cb = cb;
+  h->ctx = ctx;
+  h->half = 0;
+  h->is_stale[0] = false;
+  h->is_stale[1] = false;
+  h->drop_next = false;
+  h->running = true;
+
+  return true;
+}
+
+bool I2S_stop   (I2S_ch_e ch)
+{
+  if (ch >= I2S_NUM_OF_CH) {
+    return false; }
+
+  handles[ch].running = false;
+
+  return true;
+}
+
+
+bool HOST_I2S_setLoopback (I2S_ch_e ch, uint16_t latency)
+{
+  handle_t *h = &handles[ch];
+
+  if (latency > MAX_LATENCY) {
+    return false; }
+
+  memset(h->wire, 0, sizeof(h->wire));
+  h->wire_length = (uint32_t)latency * 2;
+  h->wire_pos = 0;
+
+  return true;
+}
+
+void HOST_I2S_run         (I2S_ch_e ch, uint32_t halves)
+{
+  handle_t *h = &handles[ch];
+
+  while (halves-- && h->running) {
+    step(h); }
+}
+
+void HOST_I2S_dropNext    (I2S_ch_e ch)
+{
+  handles[ch].drop_next = true;
+}
+
+void HOST_I2S_getStats    (I2S_ch_e ch, HOST_i2s_stats_t *stats)
+{
+  memcpy(stats, &handles[ch].stats, sizeof(HOST_i2s_stats_t));
+}
+
+
+static void step(handle_t *h)
+{
+  uint16_t half_length = h->length / 2;
+  uint16_t offset = h->half * half_length;
+  int16_t const *tx;
+  int16_t *rx = &h->rx_data[offset];
+  uint32_t period = 0;
+  uint32_t start;
+  uint32_t took;
+  uint16_t i;
+
+  /* send & receive this half */
+  tx = h->is_stale[h->half] ? h->stale[h->half] : &h->tx_data[offset];
+  h->is_stale[h->half] = false;
+
+  for (i = 0; i < half_length; i++)
+  {
+    if (0 == h->wire_length) {
+      rx[i] = tx[i]; }
+    else
+    {
+      rx[i] = h->wire[h->wire_pos];
+      h->wire[h->wire_pos] = tx[i];
+      if (++h->wire_pos >= h->wire_length) {
+        h->wire_pos = 0; }
+    }
+  }
+
+  /* hand it to the cpu */
+  memcpy(h->stale[h->half], &h->tx_data[offset], half_length * sizeof(int16_t));
+
+  start = TIM_cycles();
+
+  if (h->cb) {
+    h->cb(&h->tx_data[offset], rx, half_length, h->ctx); }
+
+  took = TIM_cycles() - start;
+
+  /* always stereo */
+  if (h->cfg.sample_rate_hz) {
+    period = (uint32_t)(((uint64_t)(half_length / 2) * TIM_cyclesPerSec()) / h->cfg.sample_rate_hz); }
+
+  if (h->drop_next || (period && (took > period)))
+  {
+    h->drop_next = false;
+    h->is_stale[h->half] = true;
+    h->stats.dropouts++;
+  }
+
+  if (took > h->stats.max_cb_ns) {
+    h->stats.max_cb_ns = took; }
+
+  h->stats.halves++;
+  h->half ^= 1;
+}
+
+
+#endif
@@ -0,0 +1,180 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "io.h"
+
+#include "host.h"
+
+
+#define IO_numToPort(num)     ((IO_port_e)(num >> 8))
+#define IO_numToPin(num)      ((uint8_t)num)
+
+#define IO_PINS_PER_PORT      (16)
+
+
+typedef struct
+{
+  IO_mode_e     mode;
+  bool          high;
+  bool          irq_enabled;
+  IO_ext_irq_cb cb;
+} pin_t;
+
+
+static pin_t pins[IO_NUM_OF_PORT][IO_PINS_PER_PORT];
+
+
+static pin_t* getPin(IO_num_e num);
+
+
+void IO_init(void)
+{
+  memset(pins, 0, sizeof(pins));
+}
+
+void IO_configure(IO_num_e num, IO_cfg_t *cfg)
+{
+  pin_t *p = getPin(num);
+
+  if (p) {
+    p->mode = cfg->mode; }
+}
+
+void IO_deinit(IO_num_e num)
+{
+  pin_t *p = getPin(num);
+
+  if (p) {
+    memset(p, 0, sizeof(pin_t)); }
+}
+
+
+void IO_set(IO_num_e num)
+{
+  pin_t *p = getPin(num);
+
+  if (p) {
+    p->high = true; }
+}
+
+void IO_clear(IO_num_e num)
+{
+  pin_t *p = getPin(num);
+
+  if (p) {
+    p->high = false; }
+}
+
+void IO_toggle(IO_num_e num)
+{
+  pin_t *p = getPin(num);
+
+  if (p) {
+    p->high = !p->high; }
+}
+
+bool IO_isHigh(IO_num_e num)
+{
+  pin_t *p = getPin(num);
+
+  return p ? p->high : false;
+}
+
+
+/* External interrupt, any pin can be used on host */
+
+bool IO_enableExtIrq(IO_num_e num)
+{
+  pin_t *p = getPin(num);
+
+  if (p) {
+    p->irq_enabled = true; }
+
+  return (NULL != p);
+}
+
+bool IO_disableExtIrq(IO_num_e num)
+{
+  pin_t *p = getPin(num);
+
+  if (p) {
+    p->irq_enabled = false; }
+
+  return (NULL != p);
+}
+
+bool IO_setExtIrqCallback(IO_num_e num, IO_ext_irq_cb fn)
+{
+  pin_t *p = getPin(num);
+
+  if (p) {
+    p->cb = fn; }
+
+  return (NULL != p);
+}
+
+
+/* Simulation hooks */
+
+void HOST_IO_drive(IO_num_e num, bool high)
+{
+  pin_t *p = getPin(num);
+  bool edge;
+
+  if (NULL == p) {
+    return; }
+
+  edge = (p->high != high);
+  p->high = high;
+
+  if (!edge || !p->irq_enabled || !p->cb) {
+    return; }
+
+  if ((IO_MODE_IRQ_BOTH == p->mode)
+  ||  ((IO_MODE_IRQ_POS == p->mode) && high)
+  ||  ((IO_MODE_IRQ_NEG == p->mode) && !high))
+  {
+    p->cb(high ? IO_IRQ_EDGE_POS : IO_IRQ_EDGE_NEG);
+  }
+}
+
+
+/* Util */
+
+static pin_t* getPin(IO_num_e num)
+{
+  if ((IO_NULL_PIN == num)
+  ||  (IO_numToPort(num) >= IO_NUM_OF_PORT)
+  ||  (IO_numToPin(num) >= IO_PINS_PER_PORT))
+  {
+    return NULL;
+  }
+
+  return &pins[IO_numToPort(num)][IO_numToPin(num)];
+}
@@ -0,0 +1,62 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "merror.h"
+
+#include "host.h"
+
+
+static uint32_t counts[MERROR_NUM_OF] = {0};
+
+
+void  MERR_error     (merror_e err, uint32_t arg)
+{
+  (void)arg;
+
+  if (err < MERROR_NUM_OF) {
+    counts[err]++; }
+}
+
+void  MERR_errorExt  (merror_e err, uint32_t* arg, uint8_t n_arg)
+{
+  MERR_error(err, n_arg ? arg[0] : 0);
+}
+
+
+/* Simulation hooks */
+
+uint32_t HOST_MERR_count (merror_e err)
+{
+  return (err < MERROR_NUM_OF) ? counts[err] : 0;
+}
+
+void     HOST_MERR_clear (void)
+{
+  memset(counts, 0, sizeof(counts));
+}
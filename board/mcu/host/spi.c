@@ -0,0 +1,385 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "spi.h"
+
+
+#ifdef SPI_ENABLED
+
+
+#include "host.h"
+
+#include "io.h"
+#include "merror.h"
+#include "mevent.h"
+#include "ring.h"
+
+
+/* transfers complete as soon as they are started, so every callback runs
+ * before SPI_write/ SPI_read returns (on target it runs from the irq).
+ * HOST_SPI_setTiming switches a channel to simulated time instead, where
+ * non blocking transfers queue up & HOST_SPI_run completes them.
+ * like the dma half transfer irq, callbacks see done false first, before
+ * the data has landed */
+
+
+/* power of 2 */
+#define QUEUE_LEN   16
+
+
+typedef struct
+{
+  IO_num_e cs_pin;
+  uint8_t *tx_data;
+  uint8_t *rx_data;
+  uint16_t len;
+  SPI_xfer_cb cb;
+  void *ctx;
+  bool half;
+} xfer_t;
+
+typedef struct
+{
+  bool init;
+  HOST_spi_dev_fn fn;
+  void *ctx;
+  HOST_bus_stats_t stats;
+
+  /* simulated time, clk_hz 0 for instant */
+  uint32_t clk_hz;
+  uint32_t gap_ns;
+  uint64_t credit_ns;
+  RING_t queue;
+  xfer_t queue_buf[QUEUE_LEN];
+} handle_t;
+
+
+static handle_t handles[SPI_NUM_OF_CH] = {0};
+
+
+static bool xfer(SPI_ch_e ch,
+                 IO_num_e cs_pin,
+                 uint8_t *tx_data,
+                 uint8_t *rx_data,
+                 uint16_t len);
+static bool xferNonblocking(SPI_ch_e ch,
+                            IO_num_e cs_pin,
+                            uint8_t *tx_data,
+                            uint8_t *rx_data,
+                            uint16_t len,
+                            SPI_xfer_cb cb,
+                            void *ctx);
+static void xferNext(SPI_ch_e ch);
+
+
+bool SPI_init       (SPI_ch_e ch, SPI_cfg_t *cfg)
+{
+  IO_cfg_t io_cfg;
+
+  if (ch >= SPI_NUM_OF_CH) {
+    return false; }
+
+  if (cfg->cs_pin)
+  {
+    io_cfg.mode = IO_MODE_GPIO_OUT_PP;
+    io_cfg.pullup = IO_PULL_NONE;
+    io_cfg.speed = IO_SPEED_FAST;
+    io_cfg.extend = NULL;
+    IO_configure(cfg->cs_pin, &io_cfg);
+    IO_set(cfg->cs_pin);
+  }
+
+  /* once, transfers may still be queued from before a re-init */
+  if (NULL == handles[ch].queue.buf) {
+    RING_INIT(&handles[ch].queue, handles[ch].queue_buf); }
+
+  handles[ch].init = true;
+
+  return true;
+}
+
+bool SPI_deInit     (SPI_ch_e ch)
+{
+  if (ch >= SPI_NUM_OF_CH) {
+    return false; }
+
+  handles[ch].init = false;
+
+  return true;
+}
+
+bool SPI_write      (SPI_ch_e    ch,
+                     IO_num_e    cs_pin,
+                     uint8_t*    tx_data,
+                     uint16_t    length,
+                     SPI_xfer_cb cb,
+                     void*       ctx)
+{
+  return xferNonblocking(ch, cs_pin, tx_data, NULL, length, cb, ctx);
+}
+
+bool SPI_read       (SPI_ch_e    ch,
+                     IO_num_e    cs_pin,
+                     uint8_t*    rx_data,
+                     uint16_t    length,
+                     SPI_xfer_cb cb,
+                     void*       ctx)
+{
+  return xferNonblocking(ch, cs_pin, NULL, rx_data, length, cb, ctx);
+}
+
+bool SPI_writeRead  (SPI_ch_e    ch,
+                     IO_num_e    cs_pin,
+                     uint8_t*    tx_data,
+                     uint8_t*    rx_data,
+                     uint16_t    length,
+                     SPI_xfer_cb cb,
+                     void*       ctx)
+{
+  return xferNonblocking(ch, cs_pin, tx_data, rx_data, length, cb, ctx);
+}
+
+bool SPI_writeBlocking (SPI_ch_e    ch,
+                        IO_num_e    cs_pin,
+                        uint8_t*    tx_data,
+                        uint16_t    length)
+{
+  return (ch < SPI_NUM_OF_CH) && xfer(ch, cs_pin, tx_data, NULL, length);
+}
+
+bool SPI_readBlocking (SPI_ch_e    ch,
+                       IO_num_e    cs_pin,
+                       uint8_t*    rx_data,
+                       uint16_t    length)
+{
+  return (ch < SPI_NUM_OF_CH) && xfer(ch, cs_pin, NULL, rx_data, length);
+}
+
+bool SPI_writeReadBlocking  (SPI_ch_e    ch,
+                             IO_num_e    cs_pin,
+                             uint8_t*    tx_data,
+                             uint8_t*    rx_data,
+                             uint16_t    length)
+{
+  return (ch < SPI_NUM_OF_CH) && xfer(ch, cs_pin, tx_data, rx_data, length);
+}
+
+
+/* Simulation hooks */
+
+void HOST_SPI_attach     (SPI_ch_e ch, HOST_spi_dev_fn fn, void *ctx)
+{
+  handles[ch].fn = fn;
+  handles[ch].ctx = ctx;
+}
+
+void HOST_SPI_getStats   (SPI_ch_e ch, HOST_bus_stats_t *stats)
+{
+  *stats = handles[ch].stats;
+}
+
+void HOST_SPI_clearStats (SPI_ch_e ch)
+{
+  memset(&handles[ch].stats, 0, sizeof(HOST_bus_stats_t));
+}
+
+void HOST_SPI_setTiming  (SPI_ch_e ch, uint32_t clk_hz, uint32_t gap_ns)
+{
+  handle_t *h = &handles[ch];
+
+  /* anything still queued finishes now, as if the old clock were instant */
+  h->clk_hz = 0;
+  while (false == RING_isEmpty(&h->queue)) {
+    xferNext(ch); }
+
+  h->clk_hz = clk_hz;
+  h->gap_ns = gap_ns;
+  h->credit_ns = 0;
+}
+
+void HOST_SPI_run        (SPI_ch_e ch, uint32_t ns)
+{
+  handle_t *h = &handles[ch];
+  xfer_t *x;
+  uint64_t cost;
+
+  if (0 == h->clk_hz) {
+    return; }
+
+  h->credit_ns += ns;
+
+  while ((x = RING_tail(&h->queue)))
+  {
+    cost = h->gap_ns + (((uint64_t)x->len * 8 * 1000000000ull) / h->clk_hz);
+
+    /* half way through the bytes, the transfer is still on the bus */
+    if ((false == x->half) && ((cost / 2) <= h->credit_ns))
+    {
+      x->half = true;
+
+      if (x->cb) {
+        x->cb(false, false, x->ctx); }
+    }
+
+    if (cost > h->credit_ns) {
+      break; }
+
+    h->credit_ns -= cost;
+    xferNext(ch);
+  }
+
+  /* an idle bus does not bank time */
+  if (RING_isEmpty(&h->queue)) {
+    h->credit_ns = 0; }
+}
+
+uint32_t HOST_SPI_pending (SPI_ch_e ch)
+{
+  return RING_count(&handles[ch].queue);
+}
+
+
+/* Transfer functions */
+
+static bool xfer(SPI_ch_e ch,
+                 IO_num_e cs_pin,
+                 uint8_t *tx_data,
+                 uint8_t *rx_data,
+                 uint16_t len)
+{
+  bool ret = false;
+  handle_t *h = &handles[ch];
+
+  if (false == h->init)
+  {
+    MERR_error(MERROR_SPI_XFER_START, ch);
+    return false;
+  }
+
+  /* with no device on the bus miso floats high. in place transfers keep
+   * tx for the device model, each byte goes out before its reply lands */
+  if (rx_data && (rx_data != tx_data)) {
+    memset(rx_data, 0xFF, len); }
+
+  if (cs_pin) {
+    IO_clear(cs_pin); }
+
+  h->stats.xfers++;
+  h->stats.bytes += len;
+
+  if (h->fn) {
+    ret = h->fn(cs_pin, tx_data, rx_data, len, h->ctx); }
+  else {
+    ret = true; }
+
+  if (cs_pin) {
+    IO_set(cs_pin); }
+
+  if (false == ret)
+  {
+    h->stats.errors++;
+    MERR_error(MERROR_SPI_XFER_ERROR, ch);
+  }
+
+  return ret;
+}
+
+static bool xferNonblocking(SPI_ch_e ch,
+                            IO_num_e cs_pin,
+                            uint8_t *tx_data,
+                            uint8_t *rx_data,
+                            uint16_t len,
+                            SPI_xfer_cb cb,
+                            void *ctx)
+{
+  handle_t *h;
+  xfer_t *x;
+  bool ok;
+
+  if (ch >= SPI_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (h->clk_hz)
+  {
+    x = RING_head(&h->queue);
+
+    if (NULL == x)
+    {
+      MERR_error(MERROR_SPI_XFER_Q_OVERFLOW, ch);
+      return false;
+    }
+    x->cs_pin = cs_pin;
+    x->tx_data = tx_data;
+    x->rx_data = rx_data;
+    x->len = len;
+    x->cb = cb;
+    x->ctx = ctx;
+    x->half = false;
+    RING_push(&h->queue);
+
+    return true;
+  }
+
+  if (cb) {
+    cb(false, false, ctx); }
+
+  ok = xfer(ch, cs_pin, tx_data, rx_data, len);
+
+  if (cb) {
+    cb(true, !ok, ctx); }
+
+  MEVE_setEvent(MEVENT_SPI);
+
+  return true;
+}
+
+static void xferNext(SPI_ch_e ch)
+{
+  handle_t *h = &handles[ch];
+  xfer_t x;
+  bool ok;
+
+  RING_read(&h->queue, &x);
+
+  if ((false == x.half) && x.cb) {
+    x.cb(false, false, x.ctx); }
+
+  /* the callback may queue the next transfer straight away */
+  ok = xfer(ch, x.cs_pin, x.tx_data, x.rx_data, x.len);
+
+  if (x.cb) {
+    x.cb(true, !ok, x.ctx); }
+
+  MEVE_setEvent(MEVENT_SPI);
+}
+
+
+#endif
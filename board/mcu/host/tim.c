@@ -0,0 +1,192 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+/* clock_gettime/ nanosleep are posix, not c99 */
+#define _POSIX_C_SOURCE 200809L
+
+
+#include "tim.h"
+
+#include "host.h"
+
+#include <time.h>
+
+
+typedef struct
+{
+  uint32_t count;
+  ALARM_cfg_t cfg;
+} alarm_handle_t;
+
+
+static alarm_handle_t alarms[ALARM_NUM_OF_CH] = {0};
+
+static uint64_t start_ns = 0;
+static uint32_t millis = 0;
+
+
+static uint64_t nowNs(void);
+static void     systick(void);
+static void     decrementAlarms(void);
+
+
+void TIM_initSystemTimer(void)
+{
+  start_ns = nowNs();
+  millis = 0;
+}
+
+
+bool TIM_init(TIM_ch_e ch, TIM_cfg_t *cfg)
+{
+  (void)ch;
+  (void)cfg;
+  return true;
+}
+
+bool TIM_start(TIM_ch_e ch)
+{
+  (void)ch;
+  return true;
+}
+
+bool TIM_stop(TIM_ch_e ch)
+{
+  (void)ch;
+  return true;
+}
+
+
+void      TIM_delayUs(uint32_t delay)
+{
+  struct timespec ts;
+
+  ts.tv_sec = delay / 1000000;
+  ts.tv_nsec = (long)(delay % 1000000) * 1000;
+
+  nanosleep(&ts, NULL);
+
+  systick();
+}
+
+void      TIM_delayMs(uint32_t delay)
+{
+  TIM_delayUs(delay * 1000);
+}
+
+uint32_t  TIM_millis(void)
+{
+  systick();
+
+  return millis;
+}
+
+/* no cycle counter on host, count nanoseconds instead */
+uint32_t  TIM_cycles(void)
+{
+  if (0 == start_ns) {
+    TIM_initSystemTimer(); }
+
+  return (uint32_t)(nowNs() - start_ns);
+}
+
+uint32_t  TIM_cyclesPerSec(void)
+{
+  return 1000000000ul;
+}
+
+
+bool ALARM_start(ALARM_ch_e ch, ALARM_cfg_t *cfg)
+{
+  bool ret = false;
+
+  if (0 == alarms[ch].count)
+  {
+    alarms[ch].count = cfg->period_ms;
+    memcpy(&alarms[ch].cfg, cfg, sizeof(ALARM_cfg_t));
+    ret = true;
+  }
+
+  return ret;
+}
+
+void ALARM_stop(ALARM_ch_e ch)
+{
+  alarms[ch].count = 0;
+}
+
+
+static uint64_t nowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/* there is no systick interrupt on host, instead catch up on the
+ * elapsed milliseconds whenever the timer is used */
+static void systick(void)
+{
+  uint32_t now;
+
+  if (0 == start_ns) {
+    TIM_initSystemTimer(); }
+
+  now = (uint32_t)((nowNs() - start_ns) / 1000000ull);
+
+  while (millis != now)
+  {
+    ++millis;
+    decrementAlarms();
+  }
+}
+
+static void decrementAlarms(void)
+{
+  ALARM_ch_e i;
+
+  for (i = 0; i < ALARM_NUM_OF_CH; i++)
+  {
+    if (alarms[i].count)
+    {
+      --alarms[i].count;
+      if (0 == alarms[i].count)
+      {
+        alarms[i].cfg.cb();
+
+        if (alarms[i].cfg.repeat)
+        {
+          alarms[i].count = alarms[i].cfg.period_ms;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,445 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#include "usart.h"
+
+
+#ifdef USART_ENABLED
+
+
+#include "host.h"
+
+#include "merror.h"
+#include "mevent.h"
+#include "ring.h"
+
+
+/* no real time on host, HOST_USART_run() moves a simulated clock on &
+ * shifts bytes out/ in at 10 bits per baud. the buffers, dma runs & rx
+ * events (half, full & one idle frame after the last byte) follow the
+ * target driver so tests see the same callbacks at the same times.
+ *
+ * tx bytes go to the attached sink & with loopback on land in rx when
+ * their stop bit is done, HOST_USART_inject puts bytes on the rx wire */
+
+
+/* power of 2, same as target */
+#define RX_BUF_LEN    256
+#define TX_BUF_LEN    512
+#define TX_RUN_MAX    (TX_BUF_LEN / 4)
+#define WIRE_LEN      1024
+
+
+typedef struct
+{
+  bool init;
+  uint64_t byte_ns;
+  uint64_t now;
+
+  USART_rx_cb rx_cb;
+  void *rx_ctx;
+  uint16_t rx_pos;
+  uint16_t dma_pos;           ///< where the simulated dma writes next
+  uint32_t rx_in;
+  uint32_t rx_out;
+  uint8_t rx_buf[RX_BUF_LEN];
+
+  /* idle detection */
+  bool armed;
+  uint64_t last_ns;
+
+  uint32_t tx_head;
+  uint32_t tx_tail;
+  uint16_t tx_run;
+  uint16_t tx_sent;           ///< of the current run
+  uint64_t tx_next_ns;        ///< when the next byte finishes
+  uint8_t tx_buf[TX_BUF_LEN];
+
+  /* rx wire */
+  bool loopback;
+  RING_t wire;
+  uint8_t wire_buf[WIRE_LEN];
+  uint64_t wire_next_ns;
+
+  HOST_usart_tx_fn sink;
+  void *sink_ctx;
+  HOST_usart_stats_t stats;
+} handle_t;
+
+
+static handle_t handles[USART_NUM_OF_CH] = {0};
+
+
+static void rxLand        (handle_t *h, uint8_t byte);
+static void rxEvent       (handle_t *h, uint16_t pos);
+static void rxDeliver     (handle_t *h, uint16_t start, uint16_t len);
+static void txStartNext   (handle_t *h);
+static void txByte        (handle_t *h);
+
+
+bool USART_init           (USART_ch_e ch, USART_cfg_t *cfg)
+{
+  handle_t *h;
+
+  if ((ch >= USART_NUM_OF_CH) || (0 == cfg->baud)) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (h->init) {
+    return true; }
+
+  h->byte_ns = (10 * 1000000000ull) / cfg->baud;
+  h->rx_pos = 0;
+  h->dma_pos = 0;
+  h->rx_in = 0;
+  h->rx_out = 0;
+  h->armed = false;
+  h->tx_head = 0;
+  h->tx_tail = 0;
+  h->tx_run = 0;
+  RING_INIT(&h->wire, h->wire_buf);
+
+  h->init = true;
+
+  return true;
+}
+
+bool USART_deInit         (USART_ch_e ch)
+{
+  if (ch >= USART_NUM_OF_CH) {
+    return false; }
+
+  handles[ch].init = false;
+
+  return true;
+}
+
+void USART_setRxCallback  (USART_ch_e ch, USART_rx_cb cb, void *ctx)
+{
+  handle_t *h;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return; }
+
+  h = &handles[ch];
+
+  h->rx_cb = cb;
+  h->rx_ctx = ctx;
+  h->rx_out = h->rx_in;
+}
+
+bool USART_write          (USART_ch_e ch, uint8_t const *data, uint16_t length)
+{
+  handle_t *h;
+  uint32_t off, first;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (false == h->init) {
+    return false; }
+
+  if (length > (TX_BUF_LEN - (h->tx_head - h->tx_tail)))
+  {
+    MERR_error(MERROR_USART_TX_OVERFLOW, ch);
+    return false;
+  }
+
+  off = h->tx_head & (TX_BUF_LEN - 1);
+  first = TX_BUF_LEN - off;
+
+  if (length <= first) {
+    memcpy(&h->tx_buf[off], data, length); }
+  else
+  {
+    memcpy(&h->tx_buf[off], data, first);
+    memcpy(h->tx_buf, &data[first], length - first);
+  }
+
+  h->tx_head += length;
+
+  if (0 == h->tx_run) {
+    txStartNext(h); }
+
+  return true;
+}
+
+uint16_t USART_read       (USART_ch_e ch, uint8_t *data, uint16_t length)
+{
+  handle_t *h;
+  uint32_t avail, off, first;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return 0; }
+
+  h = &handles[ch];
+
+  if ((false == h->init) || h->rx_cb) {
+    return 0; }
+
+  avail = h->rx_in - h->rx_out;
+
+  if (avail > RX_BUF_LEN)
+  {
+    MERR_error(MERROR_USART_RX_OVERRUN, ch);
+    h->rx_out += avail;
+    return 0;
+  }
+
+  if (length > avail) {
+    length = (uint16_t)avail; }
+
+  off = h->rx_out & (RX_BUF_LEN - 1);
+  first = RX_BUF_LEN - off;
+
+  if (length <= first) {
+    memcpy(data, &h->rx_buf[off], length); }
+  else
+  {
+    memcpy(data, &h->rx_buf[off], first);
+    memcpy(&data[first], h->rx_buf, length - first);
+  }
+
+  h->rx_out += length;
+
+  return length;
+}
+
+uint16_t USART_txFree     (USART_ch_e ch)
+{
+  if (ch >= USART_NUM_OF_CH) {
+    return 0; }
+
+  return TX_BUF_LEN - USART_txPending(ch);
+}
+
+uint16_t USART_txPending  (USART_ch_e ch)
+{
+  if (ch >= USART_NUM_OF_CH) {
+    return 0; }
+
+  return (uint16_t)(handles[ch].tx_head - handles[ch].tx_tail);
+}
+
+
+/* Simulation hooks */
+
+void HOST_USART_setLoopback (USART_ch_e ch, bool on)
+{
+  handles[ch].loopback = on;
+}
+
+void HOST_USART_attach    (USART_ch_e ch, HOST_usart_tx_fn fn, void *ctx)
+{
+  handles[ch].sink = fn;
+  handles[ch].sink_ctx = ctx;
+}
+
+bool HOST_USART_inject    (USART_ch_e ch, uint8_t const *data, uint16_t length)
+{
+  handle_t *h = &handles[ch];
+  uint16_t i;
+
+  if (length > (RING_capacity(&h->wire) - RING_count(&h->wire))) {
+    return false; }
+
+  /* the first byte starts now, the rest follow back to back */
+  if (RING_isEmpty(&h->wire)) {
+    h->wire_next_ns = h->now + h->byte_ns; }
+
+  for (i = 0; i < length; i++) {
+    RING_write(&h->wire, &data[i]); }
+
+  return true;
+}
+
+void HOST_USART_run       (USART_ch_e ch, uint64_t ns)
+{
+  handle_t *h = &handles[ch];
+  uint64_t end = h->now + ns;
+  uint64_t idle_ns;
+  uint8_t byte;
+
+  if (false == h->init)
+  {
+    h->now = end;
+    return;
+  }
+
+  for (;;)
+  {
+    idle_ns = h->last_ns + h->byte_ns;
+
+    /* bytes before idle at the same time, a back to back byte is not a gap */
+    if (h->tx_run && (h->tx_next_ns <= end) &&
+        ((false == h->armed) || (h->tx_next_ns <= idle_ns)) &&
+        (RING_isEmpty(&h->wire) || (h->tx_next_ns <= h->wire_next_ns)))
+    {
+      h->now = h->tx_next_ns;
+      txByte(h);
+    }
+    else if ((false == RING_isEmpty(&h->wire)) && (h->wire_next_ns <= end) &&
+             ((false == h->armed) || (h->wire_next_ns <= idle_ns)))
+    {
+      h->now = h->wire_next_ns;
+      RING_read(&h->wire, &byte);
+      h->wire_next_ns += h->byte_ns;
+      rxLand(h, byte);
+    }
+    else if (h->armed && (idle_ns <= end))
+    {
+      h->now = idle_ns;
+      h->armed = false;
+      h->stats.rx_irqs++;
+      rxEvent(h, h->dma_pos);
+    }
+    else {
+      break; }
+  }
+
+  h->now = end;
+}
+
+uint64_t HOST_USART_now   (USART_ch_e ch)
+{
+  return handles[ch].now;
+}
+
+void HOST_USART_getStats  (USART_ch_e ch, HOST_usart_stats_t *stats)
+{
+  *stats = handles[ch].stats;
+}
+
+void HOST_USART_clearStats (USART_ch_e ch)
+{
+  memset(&handles[ch].stats, 0, sizeof(HOST_usart_stats_t));
+}
+
+
+/* Transfer functions */
+
+/* what the circular rx dma does with each byte */
+static void rxLand        (handle_t *h, uint8_t byte)
+{
+  h->rx_buf[h->dma_pos++] = byte;
+  h->stats.rx_bytes++;
+  h->armed = true;
+  h->last_ns = h->now;
+
+  if (((RX_BUF_LEN / 2) == h->dma_pos) || (RX_BUF_LEN == h->dma_pos))
+  {
+    h->stats.rx_irqs++;
+    rxEvent(h, h->dma_pos);
+    h->dma_pos &= (RX_BUF_LEN - 1);
+  }
+}
+
+static void rxEvent       (handle_t *h, uint16_t pos)
+{
+  if (pos == h->rx_pos) {
+    return; }
+
+  if (pos > h->rx_pos) {
+    rxDeliver(h, h->rx_pos, pos - h->rx_pos); }
+  else
+  {
+    rxDeliver(h, h->rx_pos, RX_BUF_LEN - h->rx_pos);
+    rxDeliver(h, 0, pos);
+  }
+
+  h->rx_pos = pos & (RX_BUF_LEN - 1);
+
+  MEVE_setEvent(MEVENT_USART);
+}
+
+static void rxDeliver     (handle_t *h, uint16_t start, uint16_t len)
+{
+  if (0 == len) {
+    return; }
+
+  h->rx_in += len;
+
+  if (h->rx_cb)
+  {
+    h->rx_cb(&h->rx_buf[start], len, h->rx_ctx);
+    h->rx_out = h->rx_in;
+  }
+}
+
+static void txStartNext   (handle_t *h)
+{
+  uint32_t off, run;
+
+  run = h->tx_head - h->tx_tail;
+
+  if ((0 == run) || h->tx_run) {
+    return; }
+
+  off = h->tx_tail & (TX_BUF_LEN - 1);
+
+  if (run > (TX_BUF_LEN - off)) {
+    run = TX_BUF_LEN - off; }
+
+  if (run > TX_RUN_MAX) {
+    run = TX_RUN_MAX; }
+
+  h->tx_run = (uint16_t)run;
+  h->tx_sent = 0;
+  h->tx_next_ns = h->now + h->byte_ns;
+  h->stats.tx_dmas++;
+}
+
+/* stop bit of the next byte of the run is done */
+static void txByte        (handle_t *h)
+{
+  uint8_t byte = h->tx_buf[(h->tx_tail + h->tx_sent) & (TX_BUF_LEN - 1)];
+
+  h->tx_sent++;
+  h->tx_next_ns += h->byte_ns;
+  h->stats.tx_bytes++;
+
+  if (h->sink) {
+    h->sink(byte, h->now, h->sink_ctx); }
+
+  if (h->loopback) {
+    rxLand(h, byte); }
+
+  /* tx complete irq, the next run starts straight after */
+  if (h->tx_sent == h->tx_run)
+  {
+    h->tx_tail += h->tx_run;
+    h->tx_run = 0;
+    txStartNext(h);
+  }
+}
+
+
+#endif
@@ -0,0 +1,278 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#include "usb.h"
+
+
+#ifdef USB_ENABLED
+
+
+#include "host.h"
+
+#include "merror.h"
+
+
+/* nothing is plugged in until HOST_USB_connect(), then the simulated host
+ * sends bulk out transfers with HOST_USB_send & takes bulk in packets with
+ * HOST_USB_poll. the tx queue & one packet in flight follow the target
+ * driver so tests see the same packet boundaries */
+
+
+/* power of 2, same as target */
+#define TX_BUF_LEN    512
+
+
+typedef struct
+{
+  bool init;
+  bool configured;
+  USB_cfg_t cfg;
+
+  USB_rx_cb rx_cb;
+  void *rx_ctx;
+
+  uint32_t tx_head;
+  uint32_t tx_tail;
+  bool tx_busy;
+  uint16_t tx_length;
+  uint8_t tx_buf[TX_BUF_LEN];
+  uint8_t tx_packet[USB_EP_SIZE];
+
+  HOST_usb_in_fn sink;
+  void *sink_ctx;
+  HOST_usb_stats_t stats;
+} handle_t;
+
+
+static handle_t handle = {0};
+
+
+static void txStartNext   (handle_t *h);
+
+
+bool USB_init             (USB_cfg_t *cfg)
+{
+  handle_t *h = &handle;
+
+  if (h->init) {
+    return true; }
+
+  if ((NULL == cfg) || (NULL == cfg->config_desc) || (cfg->config_length < 9))
+  {
+    MERR_error(MERROR_USB_INIT, PERIPH_USB_OTG_FS);
+    return false;
+  }
+
+  h->cfg = *cfg;
+  h->configured = false;
+  h->tx_head = 0;
+  h->tx_tail = 0;
+  h->tx_busy = false;
+
+  h->init = true;
+
+  return true;
+}
+
+bool USB_deInit           (void)
+{
+  handle.init = false;
+  handle.configured = false;
+
+  return true;
+}
+
+void USB_setRxCallback    (USB_rx_cb cb, void *ctx)
+{
+  handle.rx_cb = cb;
+  handle.rx_ctx = ctx;
+}
+
+bool USB_isConfigured     (void)
+{
+  return handle.configured;
+}
+
+bool USB_write            (uint8_t const *data, uint16_t length)
+{
+  handle_t *h = &handle;
+  uint32_t off, first;
+
+  if ((false == h->init) || (false == h->configured)) {
+    return false; }
+
+  if (length > (TX_BUF_LEN - (h->tx_head - h->tx_tail)))
+  {
+    MERR_error(MERROR_USB_TX_OVERFLOW, PERIPH_USB_OTG_FS);
+    return false;
+  }
+
+  off = h->tx_head & (TX_BUF_LEN - 1);
+  first = TX_BUF_LEN - off;
+
+  if (length <= first) {
+    memcpy(&h->tx_buf[off], data, length); }
+  else
+  {
+    memcpy(&h->tx_buf[off], data, first);
+    memcpy(h->tx_buf, &data[first], length - first);
+  }
+
+  h->tx_head += length;
+
+  if (false == h->tx_busy) {
+    txStartNext(h); }
+
+  return true;
+}
+
+uint16_t USB_txFree       (void)
+{
+  return (uint16_t)(TX_BUF_LEN - (handle.tx_head - handle.tx_tail));
+}
+
+
+/* Host simulation */
+
+void HOST_USB_connect     (bool on)
+{
+  handle_t *h = &handle;
+
+  if (false == h->init) {
+    return; }
+
+  /* set configuration or a reset, as the class init & deinit */
+  h->configured = on;
+  h->tx_tail = h->tx_head;
+  h->tx_busy = false;
+}
+
+void HOST_USB_attach      (HOST_usb_in_fn fn, void *ctx)
+{
+  handle.sink = fn;
+  handle.sink_ctx = ctx;
+}
+
+uint8_t const* HOST_USB_configDesc (uint16_t *length)
+{
+  *length = handle.cfg.config_length;
+
+  return handle.cfg.config_desc;
+}
+
+bool HOST_USB_send        (uint8_t const *data, uint16_t length)
+{
+  handle_t *h = &handle;
+  uint16_t n;
+
+  if (false == h->configured) {
+    return false; }
+
+  /* a packet per callback, as the endpoint fills */
+  while (length)
+  {
+    n = (length > USB_EP_SIZE) ? USB_EP_SIZE : length;
+
+    h->stats.out_packets++;
+    h->stats.out_bytes += n;
+
+    if (h->rx_cb) {
+      h->rx_cb(data, n, h->rx_ctx); }
+
+    data += n;
+    length -= n;
+  }
+
+  return true;
+}
+
+uint32_t HOST_USB_poll    (uint32_t packets)
+{
+  handle_t *h = &handle;
+  uint32_t taken = 0;
+
+  while ((taken < packets) && h->tx_busy)
+  {
+    h->stats.in_packets++;
+    h->stats.in_bytes += h->tx_length;
+
+    if (h->sink) {
+      h->sink(h->tx_packet, h->tx_length, h->sink_ctx); }
+
+    taken++;
+
+    h->tx_busy = false;
+    txStartNext(h);
+  }
+
+  return taken;
+}
+
+void HOST_USB_getStats    (HOST_usb_stats_t *stats)
+{
+  *stats = handle.stats;
+}
+
+void HOST_USB_clearStats  (void)
+{
+  memset(&handle.stats, 0, sizeof(HOST_usb_stats_t));
+}
+
+
+/* Transfer functions */
+
+static void txStartNext   (handle_t *h)
+{
+  uint32_t off, run, first;
+
+  run = h->tx_head - h->tx_tail;
+
+  if ((0 == run) || h->tx_busy || (false == h->configured)) {
+    return; }
+
+  if (run > USB_EP_SIZE) {
+    run = USB_EP_SIZE; }
+
+  off = h->tx_tail & (TX_BUF_LEN - 1);
+  first = TX_BUF_LEN - off;
+
+  if (run <= first) {
+    memcpy(h->tx_packet, &h->tx_buf[off], run); }
+  else
+  {
+    memcpy(h->tx_packet, &h->tx_buf[off], first);
+    memcpy(&h->tx_packet[first], h->tx_buf, run - first);
+  }
+
+  h->tx_tail += run;
+  h->tx_length = (uint16_t)run;
+  h->tx_busy = true;
+}
+
+
+#endif
@@ -36,14 +36,79 @@ SOFTWARE.
 #endif
 
 
+/**
+ * @file adc.h
+ * @author Rick Davies (richvies@gmail.com)
+ * @brief knobs & cv inputs, scanned in the background
+ * A timer triggers a scan of every channel at a fixed rate so the sample
+ * points do not move with cpu load. The dma writes the scans round a
+ * buffer of two halves, each half is ADC_OVERSAMPLE scans & is summed
+ * into one value per channel while the other fills. That is published as
+ * a snapshot readable from anywhere, the main loop or the audio irq
+ * @version 0.1
+ * @date 2022-09-26
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+
 #include "mcu.h"
 
 
+#if (ADC_1_OVERSAMPLE_BITS > 4)
+  #error "values are 16 bit, 4 extra bits at most"
+#endif
+
+/* scans summed per value, 4 per extra bit */
+#define ADC_OVERSAMPLE    (1u << (2 * ADC_1_OVERSAMPLE_BITS))
+#define ADC_TRIGGER_HZ    (ADC_1_RATE_HZ * ADC_OVERSAMPLE)
+
+/* converter is 12 bit, values are full scale at ADC_MAX */
+#define ADC_BITS          (12 + ADC_1_OVERSAMPLE_BITS)
+#define ADC_MAX           (4095u << ADC_1_OVERSAMPLE_BITS)
+
+
+typedef struct
+{
+  uint32_t seq;                     ///< values so far, 0 before the first
+  uint16_t val[ADC_NUM_OF_CH];      ///< 0 - ADC_MAX
+} ADC_snapshot_t;
+
+
 extern bool  ADC_init   (void);
 extern bool  ADC_deInit (void);
 extern bool  ADC_start  (void);
 extern bool  ADC_stop   (void);
 
+/* latest values, false until the first are ready. never blocks */
+extern bool     ADC_read  (ADC_snapshot_t *snap);
+/* changes when new values are ready, cheaper than reading them */
+extern uint32_t ADC_seq   (void);
+
+
+/**
+ * @brief ADC_OVERSAMPLE scans down to one value per channel, the sum
+ * scaled to ADC_BITS & rounded. With a little noise on the input the
+ * average lands between the converter's steps, which is where the extra
+ * bits come from & the noise drops by the square root of the scans
+ * @param raw scans as the dma writes them, channel after channel
+ */
+static inline void ADC_decimate(uint16_t const *raw, uint16_t *out)
+{
+  uint32_t sum[ADC_NUM_OF_CH] = {0};
+  uint32_t scan, ch;
+
+  for (scan = 0; scan < ADC_OVERSAMPLE; scan++)
+  {
+    for (ch = 0; ch < ADC_NUM_OF_CH; ch++) {
+      sum[ch] += *raw++; }
+  }
+
+  for (ch = 0; ch < ADC_NUM_OF_CH; ch++) {
+    out[ch] = (uint16_t)((sum[ch] + ((1u << ADC_1_OVERSAMPLE_BITS) >> 1)) >> ADC_1_OVERSAMPLE_BITS); }
+}
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,111 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef __I2S_H
+#define __I2S_H
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/**
+ * @file i2s.h
+ * @author Rick Davies (richvies@gmail.com)
+ * @brief I2S audio streaming interface
+ * Full duplex, 16 bit stereo, runs continuously on circular dma. The
+ * tx & rx buffers are split in two halves, each time one half has been
+ * sent/ received the callback is given pointers to it so the cpu can
+ * work on it in place while the dma carries on with the other half
+ * @version 0.1
+ * @date 2022-09-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+
+#include "mcu.h"
+
+
+typedef struct
+{
+  /// generate the bit & word clocks, otherwise the codec does
+  bool      master;
+  /// only used by the master
+  uint32_t  sample_rate_hz;
+} I2S_cfg_t;
+
+/**
+ * @brief called from the dma interrupt with the halves now owned by the cpu
+ * @attention must return before the other half completes
+ *
+ * @param tx fill with the next samples to send, interleaved left/ right
+ * @param rx samples just received, interleaved left/ right
+ * @param length number of samples in each half
+ */
+typedef void (*I2S_xfer_cb)(int16_t *tx, int16_t const *rx, uint16_t length, void *ctx);
+
+
+/**
+ * @brief configures peripheral, clocks, io & dma
+ *
+ * @return true if channel is started or was previously started
+ */
+extern bool I2S_init    (I2S_ch_e ch, I2S_cfg_t *cfg);
+
+/**
+ * @brief stops streaming, peripheral, clocks, io & dma
+ *
+ * @return true if channel stoped or previously stopped
+ */
+extern bool I2S_deInit  (I2S_ch_e ch);
+
+/**
+ * @brief start streaming, runs until I2S_stop()
+ *
+ * @param length number of samples in each buffer (both halves), even
+ * @return true if started
+ */
+extern bool I2S_start   (I2S_ch_e    ch,
+                         int16_t*    tx_data,
+                         int16_t*    rx_data,
+                         uint16_t    length,
+                         I2S_xfer_cb cb,
+                         void*       ctx);
+
+extern bool I2S_stop    (I2S_ch_e ch);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
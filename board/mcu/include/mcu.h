@@ -68,6 +68,7 @@ typedef enum
   PERIPH_GPIO_H,
   PERIPH_DMA_1,
   PERIPH_DMA_2,
+  PERIPH_TIM_3,
   PERIPH_TIM_5,
   PERIPH_WWDG,
   PERIPH_SPI_2,
@@ -83,6 +84,7 @@ typedef enum
   PERIPH_SYSCFG,
   PERIPH_TIM_9,
   PERIPH_TIM_11,
+  PERIPH_USB_OTG_FS,
 } PERIPH_e;
 
 
@@ -125,6 +127,11 @@ typedef enum
   USART_CH_FIRST = 0,
 } USART_ch_e;
 
+/* USB */
+#if (defined USB_FS_ENABLED)
+  #define USB_ENABLED
+#endif
+
 /* I2C */
 #if (defined I2C_1_ENABLED)
   #define I2C_ENABLED
@@ -163,13 +170,33 @@ typedef enum
   SPI_CH_FIRST = 0,
 } SPI_ch_e;
 
+/* I2S */
+#if (defined I2S_2_ENABLED)
+  #define I2S_ENABLED
+#endif
+
+typedef enum
+{
+#ifdef I2S_2_ENABLED
+  I2S_CH_2,
+#endif
+
+  I2S_NUM_OF_CH,
+  I2S_CH_FIRST = 0,
+} I2S_ch_e;
+
 /* DMA */
 typedef enum
 {
   DMA_STREAM_NONE  = 0,
   DMA_1_STREAM_0,
+  DMA_1_STREAM_3,
+  DMA_1_STREAM_4,
+  DMA_1_STREAM_5,
   DMA_1_STREAM_6,
+  DMA_1_STREAM_7,
   DMA_2_STREAM_0,
+  DMA_2_STREAM_2,
   DMA_2_STREAM_3,
 
   DMA_NUM_OF_STREAM,
@@ -219,13 +246,26 @@ typedef enum
   ALARM_CH_FIRST,
 } ALARM_ch_e;
 
-/* ADC */
+/* ADC, scanned in this order on every trigger */
+#if (defined ADC_1_ENABLED)
+  #define ADC_ENABLED
+#endif
+
 typedef enum
 {
-  ADC_1_CH_1,
+#ifdef ADC_1_ENABLED
+  ADC_CH_KNOB_1,
+  ADC_CH_KNOB_2,
+  ADC_CH_KNOB_3,
+  ADC_CH_KNOB_4,
+  ADC_CH_CV_1,
+  ADC_CH_CV_2,
+  ADC_CH_CV_3,
+  ADC_CH_CV_4,
+#endif
 
   ADC_NUM_OF_CH,
-  ADC_CH_FIRST,
+  ADC_CH_FIRST = 0,
 } ADC_ch_e;
 
 
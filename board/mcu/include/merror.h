@@ -53,6 +53,22 @@ typedef enum
   MERROR_I2C_XFER_Q_OVERFLOW,
   MERROR_I2C_XFER_ERROR,
 
+  MERROR_I2S_INIT,
+  MERROR_I2S_XFER_START,
+  MERROR_I2S_XFER_ERROR,
+
+  MERROR_USART_INIT,
+  MERROR_USART_TX_OVERFLOW,
+  MERROR_USART_RX_OVERRUN,
+  MERROR_USART_XFER_ERROR,
+
+  MERROR_USB_INIT,
+  MERROR_USB_TX_OVERFLOW,
+  MERROR_USB_XFER_ERROR,
+
+  MERROR_ADC_INIT,
+  MERROR_ADC_OVERRUN,
+
   MERROR_STG_MOUNT_FAIL,
   MERROR_STG_UNMOUNT_FAIL,
   MERROR_STG_FORMAT_FAIL,
@@ -62,6 +78,8 @@ typedef enum
   MERROR_STG_APPEND_FILE,
   MERROR_STG_READ_FILE,
   MERROR_STG_CLOSE_FILE,
+
+  MERROR_NUM_OF,
 } merror_e;
 
 
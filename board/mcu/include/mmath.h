@@ -26,8 +26,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ****************************************************************************/
 
-#ifndef MATH_H
-#define MATH_H
+#ifndef __MMATH_H
+#define __MMATH_H
 
 #ifdef __cplusplus
  extern "C" {
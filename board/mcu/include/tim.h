@@ -133,6 +133,11 @@ extern void     TIM_delayUs(uint32_t delay);
 extern void     TIM_delayMs(uint32_t delay);
 extern uint32_t TIM_millis(void);
 
+/* free running cpu cycle counter for profiling, wraps so only use
+ * differences e.g. (TIM_cycles() - start) */
+extern uint32_t TIM_cycles(void);
+extern uint32_t TIM_cyclesPerSec(void);
+
 extern bool     ALARM_start(ALARM_ch_e ch, ALARM_cfg_t *cfg);
 extern void     ALARM_stop(ALARM_ch_e ch);
 
@@ -0,0 +1,122 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef __USART_H
+#define __USART_H
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/**
+ * @file usart.h
+ * @author Rick Davies (richvies@gmail.com)
+ * @brief USART byte stream interface
+ * 8N1, no flow control. Receive runs continuously on circular dma, the
+ * cpu only hears about it when the line goes idle for a frame or the
+ * buffer is half/ fully filled, so a burst costs one interrupt rather
+ * than one per byte. Writes are copied into a tx queue & sent by dma in
+ * as few transfers as the queue wraps into
+ * @version 0.1
+ * @date 2022-09-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+
+#include "mcu.h"
+
+
+/* midi din, 1 + 8 + 1 bits, 320 us per byte */
+#define USART_MIDI_BAUD     31250
+
+
+typedef struct
+{
+  uint32_t baud;
+} USART_cfg_t;
+
+/**
+ * @brief called from the interrupt with the bytes received since the last call
+ * the data is read in place from the rx buffer, so is only valid until
+ * the callback returns. a wrap in the buffer gives two calls
+ */
+typedef void (*USART_rx_cb)(uint8_t const *data, uint16_t length, void *ctx);
+
+
+/**
+ * @brief configures peripheral, clocks, io & dma then starts receiving
+ *
+ * @return true if channel is started or was previously started
+ */
+extern bool USART_init          (USART_ch_e ch, USART_cfg_t *cfg);
+
+/**
+ * @brief stops the channel, anything still queued to send is dropped
+ *
+ * @return true if channel stopped or previously stopped
+ */
+extern bool USART_deInit        (USART_ch_e ch);
+
+/**
+ * @brief received bytes go to cb as they arrive instead of waiting for
+ * USART_read. NULL to go back to polling
+ */
+extern void USART_setRxCallback (USART_ch_e ch, USART_rx_cb cb, void *ctx);
+
+/**
+ * @brief copy into the tx queue, sending starts straight away if idle
+ * safe from the rx callback, eg. for midi thru
+ *
+ * @return false if the queue does not have room for all of it, nothing is queued
+ */
+extern bool USART_write         (USART_ch_e ch, uint8_t const *data, uint16_t length);
+
+/**
+ * @brief take received bytes, only when there is no rx callback
+ *
+ * @return number of bytes copied to data
+ */
+extern uint16_t USART_read      (USART_ch_e ch, uint8_t *data, uint16_t length);
+
+/* bytes USART_write would accept right now */
+extern uint16_t USART_txFree    (USART_ch_e ch);
+
+/* bytes queued or in flight, 0 once the last one has left */
+extern uint16_t USART_txPending (USART_ch_e ch);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
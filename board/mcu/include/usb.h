@@ -0,0 +1,120 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef __USB_H
+#define __USB_H
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/**
+ * @file usb.h
+ * @author Rick Davies (richvies@gmail.com)
+ * @brief USB full speed device, one pair of bulk endpoints
+ * The class does not know what it carries, the caller hands over the
+ * configuration descriptor (eg. usb midi) & gets each bulk out packet
+ * through a callback from the interrupt. Writes are copied into a tx
+ * queue & go to the host a packet (64 bytes) at a time, so small writes
+ * made close together share a transfer
+ * @version 0.1
+ * @date 2022-09-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+
+#include "mcu.h"
+
+
+/* endpoints the configuration descriptor has to describe */
+#define USB_EP_OUT          0x01
+#define USB_EP_IN           0x81
+#define USB_EP_SIZE         64
+
+/* interfaces the descriptor can have, ep0 requests beyond this are stalled */
+#define USB_MAX_INTERFACES  2
+
+
+typedef struct
+{
+  /// whole configuration descriptor, used in place so must stay valid
+  uint8_t const *config_desc;
+  uint16_t config_length;
+} USB_cfg_t;
+
+/**
+ * @brief called from the interrupt with each bulk out packet
+ * only valid until the callback returns, the endpoint is naked till then
+ */
+typedef void (*USB_rx_cb)(uint8_t const *data, uint16_t length, void *ctx);
+
+
+/**
+ * @brief configures the otg core & connects, the host enumerates it
+ * in the background
+ *
+ * @return true if started or previously started
+ */
+extern bool USB_init          (USB_cfg_t *cfg);
+
+/**
+ * @brief disconnects, anything still queued to send is dropped
+ *
+ * @return true if stopped or previously stopped
+ */
+extern bool USB_deInit        (void);
+
+/* NULL to drop received packets */
+extern void USB_setRxCallback (USB_rx_cb cb, void *ctx);
+
+/* the host has picked the configuration, before that writes are refused */
+extern bool USB_isConfigured  (void);
+
+/**
+ * @brief copy into the tx queue, sending starts straight away if idle
+ * safe from the rx callback
+ *
+ * @return false if not configured or the queue does not have room for
+ * all of it, nothing is queued
+ */
+extern bool USB_write         (uint8_t const *data, uint16_t length);
+
+/* bytes USB_write would accept right now */
+extern uint16_t USB_txFree    (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -6,7 +6,7 @@ include mal.inc
 
 SOURCE_DIR = \
   $(MAL_MAKE_DIR)USB_DEVICE/App/ \
-  $(MAL_MAKE_DIR)USB_DEVICE/Tardget/ \
+  $(MAL_MAKE_DIR)USB_DEVICE/Target/ \
   $(MAL_MAKE_DIR)STM32F4xx_HAL_Driver/Src/ \
   $(MAL_MAKE_DIR)Middlewares/ST/STM32_USB_Device_Library/Core/Src/ \
   $(MAL_MAKE_DIR)Middlewares/ST/STM32_USB_Device_Library/Class/CustomHID/Src/ \
@@ -4,11 +4,8 @@ include mcu.inc
 # sources + flags
 #############################################################
 
-SOURCE_DIR = \
-  $(MCU_MAKE_DIR)src
-
 C_SOURCES = \
-  $(sort $(foreach dir, $(SOURCE_DIR), $(wildcard $(dir)/*.c)))
+  $(MCU_SOURCES)
 
 C_OBJS := \
   $(subst .o,_$(config).o,$(addprefix $(BUILD_DIR), $(C_SOURCES:.c=.o)))
@@ -16,12 +13,10 @@ C_OBJS := \
 
 C_INCLUDES =  \
   $(MCU_INCLUDES) \
-  $(MAL_INCLUDES) \
   -I$(MCU_MAKE_DIR)src \
 	-I$(MCU_MAKE_DIR)../config
 
 C_FLAGS = \
-  $(MAL_C_FLAGS) \
   $(MCU_C_FLAGS)
 
 #############################################################
@@ -63,6 +63,23 @@ SOFTWARE.
   .dma_rx_ch      = I2C_1_RX_DMA_CH, \
 }
 
+#define I2S_2_HW_INFO \
+{ \
+  .periph         = PERIPH_SPI_2, \
+  .inst           = SPI2, \
+  .ck_pin         = I2S_2_CK_PIN, \
+  .ws_pin         = I2S_2_WS_PIN, \
+  .sd_pin         = I2S_2_SD_PIN, \
+  .ext_sd_pin     = I2S_2_EXT_SD_PIN, \
+  .io_cfg_ext     = I2S_2_IO_CFG_EXT, \
+  .ext_io_cfg_ext = I2S_2_EXT_IO_CFG_EXT, \
+  .irq_priority   = I2S_2_PRIORITY, \
+  .dma_tx_stream  = I2S_2_TX_DMA_STREAM, \
+  .dma_tx_ch      = I2S_2_TX_DMA_CH, \
+  .dma_rx_stream  = I2S_2_RX_DMA_STREAM, \
+  .dma_rx_ch      = I2S_2_RX_DMA_CH, \
+}
+
 #define USART_2_HW_INFO \
 { \
   .periph         = PERIPH_USART_2, \
@@ -80,6 +97,19 @@ SOFTWARE.
   .dma_rx_ch      = USART_2_RX_DMA_CH, \
 }
 
+#define ADC_1_HW_INFO \
+{ \
+  .periph         = PERIPH_ADC_1, \
+  .inst           = ADC1, \
+  .irq_num        = ADC_IRQn, \
+  .irq_priority   = ADC_1_PRIORITY, \
+  .dma_stream     = ADC_1_DMA_STREAM, \
+  .dma_ch         = ADC_1_DMA_CH, \
+  .trig_periph    = PERIPH_TIM_3, \
+  .trig_inst      = TIM3, \
+  .trig_conv      = ADC_EXTERNALTRIGCONV_T3_TRGO, \
+}
+
 #define IO_EXT_IRQ_1_HW_INFO \
 { \
   .io_num   = IO_EXT_IRQ_1_PIN, \
@@ -114,6 +144,37 @@ spi_hw_info_t const spi_hw_info[SPI_NUM_OF_CH] =
 #endif
 };
 
+/* I2S */
+i2s_hw_info_t const i2s_hw_info[I2S_NUM_OF_CH] =
+{
+#ifdef I2S_2_ENABLED
+  I2S_2_HW_INFO,
+#endif
+};
+
+/* ADC */
+adc_hw_info_t const adc_hw_info[ADC_PERIPH_NUM_OF] =
+{
+#ifdef ADC_1_ENABLED
+  ADC_1_HW_INFO,
+#endif
+};
+
+adc_ch_info_t const adc_ch_info[ADC_NUM_OF_CH] =
+{
+#ifdef ADC_1_ENABLED
+  /* io_pin         channel */
+  {ADC_KNOB_1_PIN,  ADC_KNOB_1_CH},
+  {ADC_KNOB_2_PIN,  ADC_KNOB_2_CH},
+  {ADC_KNOB_3_PIN,  ADC_KNOB_3_CH},
+  {ADC_KNOB_4_PIN,  ADC_KNOB_4_CH},
+  {ADC_CV_1_PIN,    ADC_CV_1_CH},
+  {ADC_CV_2_PIN,    ADC_CV_2_CH},
+  {ADC_CV_3_PIN,    ADC_CV_3_CH},
+  {ADC_CV_4_PIN,    ADC_CV_4_CH},
+#endif
+};
+
 /* IO External interrupt */
 io_ext_irq_hw_info_t const io_ext_irq_hw_info[IO_NUM_OF_EXT_IRQ] =
 {
@@ -147,7 +208,12 @@ dma_hw_info_t const dma_hw_info[DMA_NUM_OF_STREAM] =
   {0,             NULL,         0},
 
   {PERIPH_DMA_1,  DMA1_Stream0, DMA1_Stream0_IRQn},
+  {PERIPH_DMA_1,  DMA1_Stream3, DMA1_Stream3_IRQn},
+  {PERIPH_DMA_1,  DMA1_Stream4, DMA1_Stream4_IRQn},
+  {PERIPH_DMA_1,  DMA1_Stream5, DMA1_Stream5_IRQn},
   {PERIPH_DMA_1,  DMA1_Stream6, DMA1_Stream6_IRQn},
+  {PERIPH_DMA_1,  DMA1_Stream7, DMA1_Stream7_IRQn},
   {PERIPH_DMA_2,  DMA2_Stream0, DMA2_Stream0_IRQn},
+  {PERIPH_DMA_2,  DMA2_Stream2, DMA2_Stream2_IRQn},
   {PERIPH_DMA_2,  DMA2_Stream3, DMA2_Stream3_IRQn},
 };
@@ -138,6 +138,24 @@ typedef struct
   DMA_ch_e              const dma_rx_ch;
 } spi_hw_info_t;
 
+/* I2S, full duplex using the extension block for rx */
+typedef struct
+{
+  PERIPH_e              const periph;
+  SPI_TypeDef *         const inst;
+  IO_num_e              const ck_pin;
+  IO_num_e              const ws_pin;
+  IO_num_e              const sd_pin;
+  IO_num_e              const ext_sd_pin;
+  io_cfg_extend_t       const io_cfg_ext;
+  io_cfg_extend_t       const ext_io_cfg_ext;
+  IRQ_priority_e        const irq_priority;
+  DMA_stream_e          const dma_tx_stream;
+  DMA_ch_e              const dma_tx_ch;
+  DMA_stream_e          const dma_rx_stream;
+  DMA_ch_e              const dma_rx_ch;
+} i2s_hw_info_t;
+
 /* Timer */
 typedef struct
 {
@@ -155,6 +173,9 @@ typedef struct
   IRQ_priority_e  const irq_priority;
   DMA_stream_e    const dma_stream;
   DMA_ch_e        const dma_ch;
+  PERIPH_e        const trig_periph;    ///< timer pacing the scans
+  TIM_TypeDef *   const trig_inst;
+  uint32_t        const trig_conv;      ///< its trgo as an adc trigger
 } adc_hw_info_t;
 
 typedef struct
@@ -169,6 +190,8 @@ extern io_ext_irq_hw_info_t const io_ext_irq_hw_info[IO_NUM_OF_EXT_IRQ];
 extern dma_hw_info_t        const dma_hw_info[DMA_NUM_OF_STREAM];
 extern i2c_hw_info_t        const i2c_hw_info[I2C_NUM_OF_CH];
 extern spi_hw_info_t        const spi_hw_info[SPI_NUM_OF_CH];
+extern i2s_hw_info_t        const i2s_hw_info[I2S_NUM_OF_CH];
+extern usart_hw_info_t      const usart_hw_info[USART_NUM_OF_CH];
 extern tim_hw_info_t        const tim_hw_info[TIM_NUM_OF_CH];
 extern adc_hw_info_t        const adc_hw_info[ADC_PERIPH_NUM_OF];
 extern adc_ch_info_t        const adc_ch_info[ADC_NUM_OF_CH];
@@ -69,20 +69,20 @@ void TIM1_CC_IRQHandler               (void) WEAK_REF_ATTRIBUTE;
 void TIM2_IRQHandler                  (void) WEAK_REF_ATTRIBUTE;
 void TIM3_IRQHandler                  (void) WEAK_REF_ATTRIBUTE;
 void TIM4_IRQHandler                  (void) WEAK_REF_ATTRIBUTE;
-void USART1_IRQHandler                (void) WEAK_REF_ATTRIBUTE;
-void USART2_IRQHandler                (void) WEAK_REF_ATTRIBUTE;
 void RTC_Alarm_IRQHandler             (void) WEAK_REF_ATTRIBUTE;
 void OTG_FS_WKUP_IRQHandler           (void) WEAK_REF_ATTRIBUTE;
 void SDIO_IRQHandler                  (void) WEAK_REF_ATTRIBUTE;
 void TIM5_IRQHandler                  (void) WEAK_REF_ATTRIBUTE;
 void OTG_FS_IRQHandler                (void) WEAK_REF_ATTRIBUTE;
-void USART6_IRQHandler                (void) WEAK_REF_ATTRIBUTE;
 void FPU_IRQHandler                   (void) WEAK_REF_ATTRIBUTE;
 
 
 void i2c_event_irq_handler            (void) WEAK_REF_ATTRIBUTE;
 void i2c_error_irq_handler            (void) WEAK_REF_ATTRIBUTE;
 void spi_irq_handler                  (void) WEAK_REF_ATTRIBUTE;
+void usart_irq_handler                (void) WEAK_REF_ATTRIBUTE;
+void usb_irq_handler                  (void) WEAK_REF_ATTRIBUTE;
+void adc_irq_handler                  (void) WEAK_REF_ATTRIBUTE;
 void io_ext_irq_handler               (void) WEAK_REF_ATTRIBUTE;
 void dma_irq_hanlder                  (void) WEAK_REF_ATTRIBUTE;
 
@@ -123,7 +123,7 @@ irq_vector_t _vectors[] __attribute__ ((section(".irq_vectors"),used)) =
   dma_irq_hanlder,                /* DMA1 Stream 4                  */
   dma_irq_hanlder,                /* DMA1 Stream 5                  */
   dma_irq_hanlder,                /* DMA1 Stream 6                  */
-  ADC_IRQHandler,                 /* ADC1                           */
+  adc_irq_handler,                /* ADC1                           */
   0,                              /* Reserved                       */
   0,              	              /* Reserved                       */
   0,                              /* Reserved                       */
@@ -142,8 +142,8 @@ irq_vector_t _vectors[] __attribute__ ((section(".irq_vectors"),used)) =
   i2c_error_irq_handler,          /* I2C2 Error                   */
   spi_irq_handler,                /* SPI1                         */
   spi_irq_handler,                /* SPI2                         */
-  USART1_IRQHandler,              /* USART1                       */
-  USART2_IRQHandler,              /* USART2                       */
+  usart_irq_handler,              /* USART1                       */
+  usart_irq_handler,              /* USART2                       */
   0,                              /* Reserved                     */
   io_ext_irq_handler,             /* External Line[15:10]s        */
   RTC_Alarm_IRQHandler,           /* RTC Alarm (A and B) through EXTI Line */
@@ -172,11 +172,11 @@ irq_vector_t _vectors[] __attribute__ ((section(".irq_vectors"),used)) =
   0,             					        /* Reserved                     */
   0,              					      /* Reserved                     */
   0,              					      /* Reserved                     */
-  OTG_FS_IRQHandler,              /* USB OTG FS                   */
+  usb_irq_handler,                /* USB OTG FS                   */
   dma_irq_hanlder,                /* DMA2 Stream 5                */
   dma_irq_hanlder,                /* DMA2 Stream 6                */
   dma_irq_hanlder,                /* DMA2 Stream 7                */
-  USART6_IRQHandler,              /* USART6                       */
+  usart_irq_handler,              /* USART6                       */
   i2c_event_irq_handler,          /* I2C3 event                   */
   i2c_error_irq_handler,          /* I2C3 error                   */
   0,                              /* Reserved                     */
@@ -26,31 +26,49 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ****************************************************************************/
 
-
 #include "adc.h"
 
+
+#ifdef ADC_ENABLED
+
+
 #include "_hw_info.h"
 
+#include "common.h"
+#include "snapshot.h"
+
 #include "clk.h"
 #include "dma.h"
 #include "io.h"
 #include "irq.h"
+#include "merror.h"
 
 
-#define ADC_MAX_VAL   (1 << 12)
+/* conversions per dma half, one set of scans to decimate */
+#define HALF_LEN      (ADC_OVERSAMPLE * ADC_NUM_OF_CH)
 
 
 typedef struct
 {
   bool init;
   ADC_HandleTypeDef hal;
+  TIM_HandleTypeDef tim;
   const adc_hw_info_t *hw;
+
+  /* the dma fills one half while the other is summed */
+  uint16_t raw[2 * HALF_LEN];
+  uint16_t vals[2][ADC_NUM_OF_CH];
+  SNAP_t snap;
 } handle_t;
 
-handle_t handles[ADC_PERIPH_NUM_OF] = {0};
-static uint16_t vals[ADC_NUM_OF_CH] = {0};
 
-static bool initDma(handle_t *h);
+static handle_t handles[ADC_PERIPH_NUM_OF] = {0};
+
+
+static void decimate    (handle_t *h, uint16_t const *raw);
+
+static bool initTrigger (handle_t *h);
+static bool initDma     (handle_t *h);
 
 
 bool ADC_init   (void)
@@ -61,35 +79,45 @@ bool ADC_init   (void)
   ADC_ChannelConfTypeDef cfg;
   handle_t *h = &handles[0];
 
-  h->hw                               = &adc_hw_info[0];
+  if (h->init) {
+    return true; }
+
+  h->hw = &adc_hw_info[0];
+
+  SNAP_INIT(&h->snap, h->vals);
+
+  /* 21 MHz, a scan of every channel is 8 x 96 cycles = 37 us */
   h->hal.Instance                     = h->hw->inst;
-  h->hal.Init.ClockPrescaler          = ADC_CLOCK_SYNC_PCLK_DIV8;
-  h->hal.Init.ContinuousConvMode      = ENABLE;
+  h->hal.Init.ClockPrescaler          = ADC_CLOCK_SYNC_PCLK_DIV4;
+  h->hal.Init.ContinuousConvMode      = DISABLE;
   h->hal.Init.DataAlign               = ADC_DATAALIGN_RIGHT;
   h->hal.Init.DiscontinuousConvMode   = DISABLE;
   h->hal.Init.DMAContinuousRequests   = ENABLE;
   h->hal.Init.EOCSelection            = ADC_EOC_SEQ_CONV;
-  h->hal.Init.ExternalTrigConv        = ADC_EXTERNALTRIGCONV_T1_CC1;
-  h->hal.Init.ExternalTrigConvEdge    = ADC_EXTERNALTRIGCONVEDGE_NONE;
+  h->hal.Init.ExternalTrigConv        = h->hw->trig_conv;
+  h->hal.Init.ExternalTrigConvEdge    = ADC_EXTERNALTRIGCONVEDGE_RISING;
   h->hal.Init.NbrOfConversion         = ADC_NUM_OF_CH;
   h->hal.Init.NbrOfDiscConversion     = 1;
   h->hal.Init.Resolution              = ADC_RESOLUTION_12B;
   h->hal.Init.ScanConvMode            = ENABLE;
 
-  if(HAL_OK == HAL_ADC_Init(&h->hal))
+  if ((HAL_OK == HAL_ADC_Init(&h->hal)) && (true == initTrigger(h)))
   {
+    ret = true;
+
     for (ch = ADC_CH_FIRST; ch < ADC_NUM_OF_CH; ch++)
     {
       cfg.Channel       = adc_ch_info[ch].channel;
       cfg.Offset        = 0;
       cfg.Rank          = rank++;
-      cfg.SamplingTime  = ADC_SAMPLETIME_480CYCLES;
-      HAL_ADC_ConfigChannel(&h->hal, &cfg);
+      cfg.SamplingTime  = ADC_SAMPLETIME_84CYCLES;
+      ret &= (HAL_OK == HAL_ADC_ConfigChannel(&h->hal, &cfg));
     }
-
-    ret = true;
   }
 
+  if (false == ret) {
+    MERR_error(MERROR_ADC_INIT, h->hw->periph); }
+
   h->init = ret;
 
   return ret;
@@ -100,15 +128,20 @@ bool ADC_deInit (void)
   bool ret = false;
   handle_t *h = &handles[0];
 
+  if (false == h->init) {
+    return true; }
+
+  ADC_stop();
+
   if (HAL_OK == HAL_ADC_DeInit(&h->hal))
   {
     h->init = false;
     ret = true;
 
-    if (h->hw->dma_stream)
-    {
-      dma_deinit(h->hw->dma_stream);
-    }
+    HAL_TIM_Base_DeInit(&h->tim);
+    clk_periphReset(h->hw->trig_periph);
+
+    dma_deinit(h->hw->dma_stream);
   }
 
   return ret;
@@ -116,16 +149,17 @@ bool ADC_deInit (void)
 
 bool ADC_start  (void)
 {
-  bool ret;
+  bool ret = false;
   handle_t *h = &handles[0];
 
-  if (h->hw->dma_stream)
-  {
-    ret = HAL_ADC_Start_DMA(&h->hal, (uint32_t*)vals, ADC_NUM_OF_CH);
-  }
-  else
+  if (false == h->init) {
+    return false; }
+
+  /* dma first, the scans start with the timer */
+  if ((HAL_OK == HAL_ADC_Start_DMA(&h->hal, (uint32_t*)h->raw, SIZEOF(h->raw))) &&
+      (HAL_OK == HAL_TIM_Base_Start(&h->tim)))
   {
-    ret = HAL_ADC_Start_IT(&h->hal);
+    ret = true;
   }
 
   return ret;
@@ -133,25 +167,79 @@ bool ADC_start  (void)
 
 bool ADC_stop   (void)
 {
-  bool ret;
+  bool ret = false;
   handle_t *h = &handles[0];
 
-  if (h->hw->dma_stream)
-  {
-    ret = HAL_ADC_Stop_DMA(&h->hal);
-  }
-  else
+  if (false == h->init) {
+    return false; }
+
+  HAL_TIM_Base_Stop(&h->tim);
+
+  if (HAL_OK == HAL_ADC_Stop_DMA(&h->hal)) {
+    ret = true; }
+
+  return ret;
+}
+
+bool ADC_read   (ADC_snapshot_t *snap)
+{
+  snap->seq = SNAP_read(&handles[0].snap, snap->val);
+
+  return (0 != snap->seq);
+}
+
+uint32_t ADC_seq(void)
+{
+  return SNAP_seq(&handles[0].snap);
+}
+
+
+static void decimate(handle_t *h, uint16_t const *raw)
+{
+  ADC_decimate(raw, (uint16_t *)SNAP_back(&h->snap));
+  SNAP_publish(&h->snap);
+}
+
+
+/* the timer's update event is its trgo, one scan per period */
+static bool initTrigger(handle_t *h)
+{
+  bool ret = false;
+  uint32_t ticks, psc;
+  TIM_MasterConfigTypeDef master;
+
+  clk_periphEnable(h->hw->trig_periph);
+
+  /* apb1 timers run at twice the bus clock when it is divided */
+  ticks = clk_getPeriphBaseClkHz(h->hw->trig_periph);
+  if (RCC->CFGR & RCC_CFGR_PPRE1_2) {
+    ticks *= 2; }
+
+  ticks /= ADC_TRIGGER_HZ;
+  psc = (ticks - 1) / 0x10000;
+
+  h->tim.Instance                 = h->hw->trig_inst;
+  h->tim.Init.Prescaler           = psc;
+  h->tim.Init.CounterMode         = TIM_COUNTERMODE_UP;
+  h->tim.Init.Period              = (ticks / (psc + 1)) - 1;
+  h->tim.Init.ClockDivision       = TIM_CLOCKDIVISION_DIV1;
+  h->tim.Init.AutoReloadPreload   = TIM_AUTORELOAD_PRELOAD_ENABLE;
+
+  master.MasterOutputTrigger      = TIM_TRGO_UPDATE;
+  master.MasterSlaveMode          = TIM_MASTERSLAVEMODE_DISABLE;
+
+  if ((HAL_OK == HAL_TIM_Base_Init(&h->tim)) &&
+      (HAL_OK == HAL_TIMEx_MasterConfigSynchronization(&h->tim, &master)))
   {
-    ret = HAL_ADC_Stop_IT(&h->hal);
+    ret = true;
   }
 
   return ret;
 }
 
-
 static bool initDma(handle_t *h)
 {
-  bool ret = true;
+  bool ret = false;
   dma_cfg_t dma_cfg;
 
   dma_cfg.priority          = h->hw->irq_priority;
@@ -161,19 +249,55 @@ static bool initDma(handle_t *h)
   dma_cfg.inc_mem_addr      = true;
   dma_cfg.inc_periph_addr   = false;
   dma_cfg.circular_mode     = true;
+  dma_cfg.dir               = DMA_DIR_PERIPH_TO_MEM;
+  dma_cfg.channel           = h->hw->dma_ch;
 
-  if (h->hw->dma_stream)
+  if (true == dma_init(h->hw->dma_stream, &dma_cfg))
   {
-    dma_cfg.dir = DMA_DIR_PERIPH_TO_MEM;
-    dma_cfg.channel = h->hw->dma_ch;
-    ret &= dma_init(h->hw->dma_stream, &dma_cfg);
     h->hal.DMA_Handle = dma_getHandle(h->hw->dma_stream);
+    ret = true;
   }
 
   return ret;
 }
 
 
+void adc_irq_handler(void)
+{
+  handle_t *h = (handle_t*)irq_get_context(irq_get_current());
+
+  if (h) {
+    HAL_ADC_IRQHandler(&h->hal); }
+}
+
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  handle_t *h = &handles[0];
+
+  decimate(h, &h->raw[0]);
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  handle_t *h = &handles[0];
+
+  decimate(h, &h->raw[HALF_LEN]);
+}
+
+/* overrun or dma error, the adc stops requesting so start it over */
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc)
+{
+  handle_t *h = &handles[0];
+
+  MERR_error(MERROR_ADC_OVERRUN, h->hw->periph);
+
+  HAL_ADC_Stop_DMA(&h->hal);
+
+  if (HAL_OK != HAL_ADC_Start_DMA(&h->hal, (uint32_t*)h->raw, SIZEOF(h->raw))) {
+    MERR_error(MERROR_ADC_INIT, h->hw->periph); }
+}
+
+
 void HAL_ADC_MspInit(ADC_HandleTypeDef *hadc)
 {
   ADC_ch_e ch;
@@ -194,6 +318,7 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef *hadc)
   initDma(h);
 
   irq_config(h->hw->irq_num, h->hw->irq_priority);
+  irq_set_context(h->hw->irq_num, h);
   irq_enable(h->hw->irq_num);
 }
 
@@ -211,3 +336,6 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef *hadc)
 
   clk_periphReset(h->hw->periph);
 }
+
+
+#endif
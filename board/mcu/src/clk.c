@@ -135,6 +135,10 @@ void clk_periphEnable(PERIPH_e periph)
       __HAL_RCC_DMA2_CLK_ENABLE();
       break;
 
+    case PERIPH_TIM_3:
+      __HAL_RCC_TIM3_CLK_ENABLE();
+      break;
+
     case PERIPH_TIM_5:
       __HAL_RCC_TIM5_CLK_ENABLE();
       break;
@@ -195,6 +199,10 @@ void clk_periphEnable(PERIPH_e periph)
       __HAL_RCC_TIM11_CLK_ENABLE();
       break;
 
+    case PERIPH_USB_OTG_FS:
+      __HAL_RCC_USB_OTG_FS_CLK_ENABLE();
+      break;
+
     default:
       PRINTF_WARN("%u unknown", periph);
       break;
@@ -243,6 +251,12 @@ void clk_periphReset(PERIPH_e periph)
       __HAL_RCC_DMA2_RELEASE_RESET();
       break;
 
+    case PERIPH_TIM_3:
+      __HAL_RCC_TIM3_FORCE_RESET();
+      TIM_delayMs(10);
+      __HAL_RCC_TIM3_RELEASE_RESET();
+      break;
+
     case PERIPH_TIM_5:
       __HAL_RCC_TIM5_FORCE_RESET();
       TIM_delayMs(10);
@@ -333,6 +347,12 @@ void clk_periphReset(PERIPH_e periph)
       __HAL_RCC_TIM11_RELEASE_RESET();
       break;
 
+    case PERIPH_USB_OTG_FS:
+      __HAL_RCC_USB_OTG_FS_FORCE_RESET();
+      TIM_delayMs(10);
+      __HAL_RCC_USB_OTG_FS_RELEASE_RESET();
+      break;
+
     default:
       PRINTF_WARN("%u unknown", periph);
       break;
@@ -356,9 +376,11 @@ uint32_t clk_getPeriphBaseClkHz(PERIPH_e periph)
     case PERIPH_GPIO_H:
     case PERIPH_DMA_1:
     case PERIPH_DMA_2:
+    case PERIPH_USB_OTG_FS:
       ret = getAhbFreqHz();
       break;
 
+    case PERIPH_TIM_3:
     case PERIPH_TIM_5:
     case PERIPH_WWDG:
     case PERIPH_SPI_2:
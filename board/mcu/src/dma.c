@@ -175,7 +175,7 @@ static void configureHal(handle_t *h, dma_cfg_t *cfg)
 }
 
 
-static void dma_irq_hanlder(void)
+void dma_irq_hanlder(void)
 {
   handle_t *h = (handle_t*)irq_get_context(irq_get_current());
 
@@ -36,6 +36,7 @@ SOFTWARE.
 #include "_hw_info.h"
 
 #include "common.h"
+#include "ring.h"
 
 #include "clk.h"
 #include "dma.h"
@@ -46,6 +47,10 @@ SOFTWARE.
 #include "tim.h"
 
 
+/* power of 2 */
+#define XFER_Q_LEN    8
+
+
 typedef enum
 {
   DIR_WRITE,
@@ -74,13 +79,6 @@ typedef struct
   void*       ctx;
 } xfer_info_t;
 
-typedef struct
-{
-  xfer_info_t buf[5];
-  uint8_t count;
-  uint8_t tail;
-} xfer_queue_t;
-
 typedef struct
 {
   bool init;
@@ -94,7 +92,8 @@ typedef struct
   bool volatile error;
 
   /* xfer queue*/
-  xfer_queue_t queue;
+  RING_t queue;
+  xfer_info_t queue_buf[XFER_Q_LEN];
 } handle_t;
 
 
@@ -133,6 +132,9 @@ static bool xferNonblocking   (dir_e        dir,
 static void xferHandleQ       (handle_t *h);
 static bool xferStartNext     (handle_t *h);
 
+static void lock              (handle_t *h);
+static void unlock            (handle_t *h);
+
 static bool writeBlocking   (handle_t *h, uint16_t addr, uint8_t *data, uint16_t len);
 static bool readBlocking    (handle_t *h, uint16_t addr, uint8_t *data, uint16_t len);
 static bool readMemBlocking (handle_t *h, uint16_t addr, uint16_t mem_addr, uint16_t mem_addr_length, uint8_t *data, uint16_t length);
@@ -169,6 +171,8 @@ bool I2C_init       (I2C_ch_e ch, I2C_cfg_t *cfg)
   /* link to hw information */
   h->hw = &i2c_hw_info[ch];
 
+  RING_INIT(&h->queue, h->queue_buf);
+
   /* set config params */
   configureHal(h, cfg);
 
@@ -382,16 +386,21 @@ static bool xferNonblocking (dir_e        dir,
   handle_t *h = &handles[ch];
   xfer_info_t *info;
 
-  /* add to q and try start next xfer */
+  /* add to q and try start next xfer. a callback may queue from the irq,
+   * keep it apart from the task */
+  lock(h);
+
+  info = RING_head(&h->queue);
 
-  if (Q_isFull(h->queue)) {
-    MERR_error(MERROR_I2C_XFER_Q_OVERFLOW, h->hw->periph); }
+  if (NULL == info)
+  {
+    unlock(h);
+    MERR_error(MERROR_I2C_XFER_Q_OVERFLOW, h->hw->periph);
+  }
   else
   {
     ret = true;
 
-    info = &Q_getHead(h->queue);
-
     info->dir = dir;
     info->addr = addr;
     info->mem_addr = mem_addr;
@@ -401,7 +410,8 @@ static bool xferNonblocking (dir_e        dir,
     info->cb = cb;
     info->ctx = ctx;
 
-    Q_incHead(h->queue);
+    RING_push(&h->queue);
+    unlock(h);
 
     xferHandleQ(h);
   }
@@ -411,6 +421,11 @@ static bool xferNonblocking (dir_e        dir,
 
 static void xferHandleQ   (handle_t *h)
 {
+  I2C_xfer_cb cb;
+  void *ctx;
+
+  lock(h);
+
   /* if current xfer done -
   * record error, update queue, reset for next xfer */
   if (h->done)
@@ -418,7 +433,7 @@ static void xferHandleQ   (handle_t *h)
     if (h->error) {
       MERR_error(MERROR_I2C_XFER_ERROR, h->hw->periph); }
 
-    Q_incTail(h->queue);
+    RING_pop(&h->queue);
 
     h->busy = false;
     h->done = false;
@@ -428,21 +443,31 @@ static void xferHandleQ   (handle_t *h)
   /* try start next xfer, if fails - callback with error and try next... */
   if (false == h->busy)
   {
-    while ((true == Q_pending(h->queue)) && (false == xferStartNext(h)))
+    while ((false == RING_isEmpty(&h->queue)) && (false == xferStartNext(h)))
     {
-      if (h->xfer->cb) {
-        h->xfer->cb(true, h->xfer->ctx); }
-
-      Q_incTail(h->queue);
+      cb = h->xfer->cb;
+      ctx = h->xfer->ctx;
+
+      RING_pop(&h->queue);
+
+      /* the callback may queue again */
+      if (cb)
+      {
+        unlock(h);
+        cb(true, ctx);
+        lock(h);
+      }
     }
   }
+
+  unlock(h);
 }
 
 static bool xferStartNext   (handle_t *h)
 {
   bool ret = false;
 
-  h->xfer = &Q_getTail(h->queue);
+  h->xfer = RING_tail(&h->queue);
 
   switch (h->xfer->dir)
   {
@@ -483,6 +508,32 @@ static bool xferStartNext   (handle_t *h)
 }
 
 
+/* completions come from the event & error irqs, or the dma irqs when streams are set */
+static void lock              (handle_t *h)
+{
+  irq_disable(h->hw->event_irq_num);
+  irq_disable(h->hw->error_irq_num);
+
+  if (h->hw->dma_rx_stream) {
+    irq_disable(dma_hw_info[h->hw->dma_rx_stream].irq_num); }
+
+  if (h->hw->dma_tx_stream) {
+    irq_disable(dma_hw_info[h->hw->dma_tx_stream].irq_num); }
+}
+
+static void unlock            (handle_t *h)
+{
+  if (h->hw->dma_tx_stream) {
+    irq_enable(dma_hw_info[h->hw->dma_tx_stream].irq_num); }
+
+  if (h->hw->dma_rx_stream) {
+    irq_enable(dma_hw_info[h->hw->dma_rx_stream].irq_num); }
+
+  irq_enable(h->hw->error_irq_num);
+  irq_enable(h->hw->event_irq_num);
+}
+
+
 /* Blocking low level */
 
 static bool writeBlocking   (handle_t *h, uint16_t addr, uint8_t *data, uint16_t len)
@@ -0,0 +1,325 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "i2s.h"
+
+
+#ifdef I2S_ENABLED
+
+
+#include "_hw_info.h"
+
+#include "common.h"
+
+#include "clk.h"
+#include "dma.h"
+#include "io.h"
+#include "irq.h"
+#include "merror.h"
+
+
+typedef struct
+{
+  bool init;
+  I2S_HandleTypeDef hal;
+  i2s_hw_info_t const *hw;
+
+  /* circular buffers, two halves each */
+  int16_t *tx_data;
+  int16_t *rx_data;
+  uint16_t length;
+  I2S_xfer_cb cb;
+  void *ctx;
+} handle_t;
+
+
+static handle_t handles[I2S_NUM_OF_CH] = {0};
+
+
+static bool channelFromHal(I2S_HandleTypeDef *hi2s, I2S_ch_e *ch);
+static void configureHal(handle_t *h, I2S_cfg_t *cfg);
+static bool initDma(handle_t *h);
+static void halfDone(I2S_HandleTypeDef *hi2s, bool second_half);
+
+
+bool I2S_init   (I2S_ch_e ch, I2S_cfg_t *cfg)
+{
+  bool ret = false;
+  handle_t *h;
+
+  if (ch >= I2S_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (h->init) {
+    return true; }
+
+  /* link to hw information */
+  h->hw = &i2s_hw_info[ch];
+
+  /* set config params */
+  configureHal(h, cfg);
+
+  if (HAL_OK == HAL_I2S_Init(&h->hal)) {
+    ret = true; }
+  else {
+    MERR_error(MERROR_I2S_INIT, h->hw->periph); }
+
+  h->init = ret;
+
+  return ret;
+}
+
+bool I2S_deInit (I2S_ch_e ch)
+{
+  bool ret = false;
+  handle_t *h;
+
+  if (ch >= I2S_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (false == h->init) {
+    return true; }
+
+  I2S_stop(ch);
+
+  if (HAL_OK == HAL_I2S_DeInit(&h->hal))
+  {
+    h->init = false;
+    ret = true;
+
+    dma_deinit(h->hw->dma_rx_stream);
+    dma_deinit(h->hw->dma_tx_stream);
+  }
+
+  return ret;
+}
+
+bool I2S_start  (I2S_ch_e    ch,
+                 int16_t*    tx_data,
+                 int16_t*    rx_data,
+                 uint16_t    length,
+                 I2S_xfer_cb cb,
+                 void*       ctx)
+{
+  bool ret = false;
+  handle_t *h;
+
+  if ((ch >= I2S_NUM_OF_CH) || (length & 1)) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (false == h->init) {
+    return false; }
+
+  h->tx_data = tx_data;
+  h->rx_data = rx_data;
+  h->length = length;
+  h->cb = cb;
+  h->ctx = ctx;
+
+  /* length is in 16 bit samples for 16 bit data */
+  if (HAL_OK == HAL_I2SEx_TransmitReceive_DMA(&h->hal,
+                                              (uint16_t*)tx_data,
+                                              (uint16_t*)rx_data,
+                                              length)) {
+    ret = true; }
+  else {
+    MERR_error(MERROR_I2S_XFER_START, h->hw->periph); }
+
+  return ret;
+}
+
+bool I2S_stop   (I2S_ch_e ch)
+{
+  handle_t *h;
+
+  if (ch >= I2S_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (false == h->init) {
+    return true; }
+
+  return (HAL_OK == HAL_I2S_DMAStop(&h->hal));
+}
+
+
+/* Util functions */
+
+static bool channelFromHal(I2S_HandleTypeDef *hi2s, I2S_ch_e *ch)
+{
+  bool ret = false;
+  I2S_ch_e i;
+
+  for (i = I2S_CH_FIRST; i < I2S_NUM_OF_CH; i++)
+  {
+    if (hi2s == &handles[i].hal)
+    {
+      *ch = i;
+      ret = true;
+      break;
+    }
+  }
+
+  return ret;
+}
+
+static void configureHal(handle_t *h, I2S_cfg_t *cfg)
+{
+  h->hal.Instance             = h->hw->inst;
+  h->hal.Init.Mode            = cfg->master ? I2S_MODE_MASTER_TX : I2S_MODE_SLAVE_TX;
+  h->hal.Init.Standard        = I2S_STANDARD_PHILIPS;
+  h->hal.Init.DataFormat      = I2S_DATAFORMAT_16B;
+  h->hal.Init.MCLKOutput      = I2S_MCLKOUTPUT_DISABLE;
+  h->hal.Init.AudioFreq       = cfg->master ? cfg->sample_rate_hz : I2S_AUDIOFREQ_DEFAULT;
+  h->hal.Init.CPOL            = I2S_CPOL_LOW;
+  h->hal.Init.ClockSource     = I2S_CLOCK_PLL;
+  h->hal.Init.FullDuplexMode  = I2S_FULLDUPLEXMODE_ENABLE;
+}
+
+static bool initDma(handle_t *h)
+{
+  bool ret = true;
+  dma_cfg_t dma_cfg;
+
+  dma_cfg.priority          = h->hw->irq_priority;
+  dma_cfg.parent_handle     = &h->hal;
+  dma_cfg.periph_data_size  = DMA_DATA_SIZE_16BIT;
+  dma_cfg.mem_data_size     = DMA_DATA_SIZE_16BIT;
+  dma_cfg.inc_mem_addr      = true;
+  dma_cfg.inc_periph_addr   = false;
+  dma_cfg.circular_mode     = true;
+
+  /* rx (extension block) drives the half/ full callbacks */
+  dma_cfg.dir = DMA_DIR_PERIPH_TO_MEM;
+  dma_cfg.channel = h->hw->dma_rx_ch;
+  ret &= dma_init(h->hw->dma_rx_stream, &dma_cfg);
+  h->hal.hdmarx = dma_getHandle(h->hw->dma_rx_stream);
+
+  dma_cfg.dir = DMA_DIR_MEM_TO_PERIPH;
+  dma_cfg.channel = h->hw->dma_tx_ch;
+  ret &= dma_init(h->hw->dma_tx_stream, &dma_cfg);
+  h->hal.hdmatx = dma_getHandle(h->hw->dma_tx_stream);
+
+  return ret;
+}
+
+static void halfDone(I2S_HandleTypeDef *hi2s, bool second_half)
+{
+  I2S_ch_e ch;
+  handle_t *h;
+  uint16_t offset;
+
+  if (false == channelFromHal(hi2s, &ch)) {
+    return; }
+
+  h = &handles[ch];
+  offset = second_half ? (h->length / 2) : 0;
+
+  if (h->cb) {
+    h->cb(&h->tx_data[offset], &h->rx_data[offset], h->length / 2, h->ctx); }
+}
+
+
+/* STM32 Library functions */
+
+void HAL_I2S_MspInit(I2S_HandleTypeDef *hi2s)
+{
+  I2S_ch_e ch;
+  handle_t *h;
+  IO_cfg_t io_cfg;
+
+  if (false == channelFromHal(hi2s, &ch)) {
+    return; }
+
+  h = &handles[ch];
+
+  io_cfg.mode    = IO_MODE_PERIPH_OUT_PP;
+  io_cfg.pullup  = IO_PULL_NONE;
+  io_cfg.speed   = IO_SPEED_FAST;
+  io_cfg.extend  = &h->hw->io_cfg_ext;
+  IO_configure(h->hw->ck_pin, &io_cfg);
+  IO_configure(h->hw->ws_pin, &io_cfg);
+  IO_configure(h->hw->sd_pin, &io_cfg);
+
+  io_cfg.extend  = &h->hw->ext_io_cfg_ext;
+  IO_configure(h->hw->ext_sd_pin, &io_cfg);
+
+  clk_periphEnable(h->hw->periph);
+
+  initDma(h);
+}
+
+void HAL_I2S_MspDeInit(I2S_HandleTypeDef *hi2s)
+{
+  I2S_ch_e ch;
+  handle_t *h;
+
+  if (false == channelFromHal(hi2s, &ch)) {
+    return; }
+
+  h = &handles[ch];
+
+  IO_deinit(h->hw->ck_pin);
+  IO_deinit(h->hw->ws_pin);
+  IO_deinit(h->hw->sd_pin);
+  IO_deinit(h->hw->ext_sd_pin);
+
+  clk_periphReset(h->hw->periph);
+}
+
+
+/* Interrupt handling, from the rx dma */
+
+void HAL_I2SEx_TxRxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
+{
+  halfDone(hi2s, false);
+}
+
+void HAL_I2SEx_TxRxCpltCallback(I2S_HandleTypeDef *hi2s)
+{
+  halfDone(hi2s, true);
+}
+
+void HAL_I2S_ErrorCallback(I2S_HandleTypeDef *hi2s)
+{
+  I2S_ch_e ch;
+
+  if (channelFromHal(hi2s, &ch)) {
+    MERR_error(MERROR_I2S_XFER_ERROR, handles[ch].hw->periph); }
+}
+
+
+#endif
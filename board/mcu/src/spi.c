@@ -36,6 +36,7 @@ SOFTWARE.
 #include "_hw_info.h"
 
 #include "common.h"
+#include "ring.h"
 
 #include "clk.h"
 #include "dma.h"
@@ -46,6 +47,10 @@ SOFTWARE.
 #include "mevent.h"
 
 
+/* power of 2 */
+#define XFER_Q_LEN    8
+
+
 typedef enum
 {
   DIR_WRITE,
@@ -73,13 +78,6 @@ typedef struct
 
 } xfer_info_t;
 
-typedef struct
-{
-  xfer_info_t buf[5];
-  uint8_t count;
-  uint8_t tail;
-} xfer_queue_t;
-
 typedef struct
 {
   bool init;
@@ -92,7 +90,8 @@ typedef struct
   bool volatile blocking;
 
   /* xfer queue*/
-  xfer_queue_t queue;
+  RING_t queue;
+  xfer_info_t queue_buf[XFER_Q_LEN];
 } handle_t;
 
 typedef struct
@@ -155,6 +154,9 @@ static bool xferNonblocking   (dir_e dir,
 static void xferHandleQ       (handle_t *h);
 static bool xferStartNext     (handle_t *h);
 
+static void lock              (handle_t *h);
+static void unlock            (handle_t *h);
+
 static bool writeBlocking     (handle_t *h, uint8_t *data, uint16_t len);
 static bool readBlocking      (handle_t *h, uint8_t *data, uint16_t len);
 static bool writeReadBlocking (handle_t *h, uint8_t *tx, uint8_t *rx, uint16_t len);
@@ -199,6 +201,8 @@ bool SPI_init       (SPI_ch_e ch, SPI_cfg_t *cfg)
   /* link to hw information */
   h->hw = &spi_hw_info[ch];
 
+  RING_INIT(&h->queue, h->queue_buf);
+
   /* set config params */
   configureHal(h, cfg);
 
@@ -369,7 +373,7 @@ static bool xferNonblocking (dir_e dir,
   handle_t *h = &handles[ch];
   xfer_info_t *info;
 
-  TIMEOUT(Q_isFull(h->queue),
+  TIMEOUT(RING_isFull(&h->queue),
         10,
         EMPTY,
         EMPTY,
@@ -380,7 +384,18 @@ static bool xferNonblocking (dir_e dir,
 
   ret = true;
 
-  info = &Q_getHead(h->queue);
+  /* callbacks queue from the irq too, keep the two producers apart */
+  lock(h);
+
+  info = RING_head(&h->queue);
+
+  /* the irq took the last slot since the check above */
+  if (NULL == info)
+  {
+    unlock(h);
+    MERR_error(MERROR_SPI_XFER_Q_OVERFLOW, h->hw->periph);
+    return false;
+  }
 
   info->dir = dir;
   info->cs_pin = cs_pin;
@@ -390,9 +405,8 @@ static bool xferNonblocking (dir_e dir,
   info->ctx = ctx;
   info->length = len;
 
-  irq_disable(h->hw->irq_num);
-  Q_incHead(h->queue);
-  irq_enable(h->hw->irq_num);
+  RING_push(&h->queue);
+  unlock(h);
 
   xferHandleQ(h);
 
@@ -403,7 +417,7 @@ static void xferHandleQ   (handle_t *h)
 {
   if (!h->busy && !h->blocking)
   {
-    while ((true == Q_pending(h->queue)) && (false == xferStartNext(h)));
+    while ((false == RING_isEmpty(&h->queue)) && (false == xferStartNext(h)));
   }
 }
 
@@ -413,7 +427,7 @@ static bool xferStartNext   (handle_t *h)
 
   h->busy = true;
 
-  h->xfer = &Q_getTail(h->queue);
+  h->xfer = RING_tail(&h->queue);
 
   if (h->xfer->cs_pin) {
     IO_clear(h->xfer->cs_pin); }
@@ -456,13 +470,37 @@ static bool xferStartNext   (handle_t *h)
     MERR_error(MERROR_SPI_XFER_START, h->hw->periph);
 
     h->busy = false;
-    Q_incTail(h->queue);
+    RING_pop(&h->queue);
   }
 
   return ret;
 }
 
 
+/* completions come from the dma irqs when streams are set, else the spi irq */
+static void lock              (handle_t *h)
+{
+  irq_disable(h->hw->irq_num);
+
+  if (h->hw->dma_rx_stream) {
+    irq_disable(dma_hw_info[h->hw->dma_rx_stream].irq_num); }
+
+  if (h->hw->dma_tx_stream) {
+    irq_disable(dma_hw_info[h->hw->dma_tx_stream].irq_num); }
+}
+
+static void unlock            (handle_t *h)
+{
+  if (h->hw->dma_tx_stream) {
+    irq_enable(dma_hw_info[h->hw->dma_tx_stream].irq_num); }
+
+  if (h->hw->dma_rx_stream) {
+    irq_enable(dma_hw_info[h->hw->dma_rx_stream].irq_num); }
+
+  irq_enable(h->hw->irq_num);
+}
+
+
 /* Blocking low level */
 
 static bool writeBlocking     (handle_t *h, uint8_t *data, uint16_t len)
@@ -692,18 +730,25 @@ static void irq_end_callback(bool error, bool done)
 
   if (h)
   {
-    if (done) {
-      if (h->xfer->cs_pin) {
-        IO_set(h->xfer->cs_pin); }}
+    /* half way, the dma is still running so keep cs & the queue as they are */
+    if ((false == done) && (false == error))
+    {
+      if (h->xfer->cb) {
+        h->xfer->cb(false, false, h->xfer->ctx); }
+      return;
+    }
+
+    if (h->xfer->cs_pin) {
+      IO_set(h->xfer->cs_pin); }
 
     if (error) {
       MERR_error(MERROR_SPI_XFER_ERROR, h->hw->periph); }
 
     if (h->xfer->cb) {
-      h->xfer->cb(done, error, h->xfer->ctx); }
+      h->xfer->cb(true, error, h->xfer->ctx); }
 
     h->busy = false;
-    Q_incTail(h->queue);
+    RING_pop(&h->queue);
     xferHandleQ(h);
   }
 }
@@ -68,6 +68,11 @@ void TIM_initSystemTimer(void)
   SysTick_Config(SystemCoreClock / 1000);
   irq_config(SysTick_IRQn, PRIORITY_VERY_LOW);
   irq_enable(SysTick_IRQn);
+
+  /* dwt cycle counter */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 
@@ -117,6 +122,16 @@ uint32_t  TIM_millis(void)
   return millis;
 }
 
+uint32_t  TIM_cycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+uint32_t  TIM_cyclesPerSec(void)
+{
+  return SystemCoreClock;
+}
+
 
 bool ALARM_start(ALARM_ch_e ch, ALARM_cfg_t *cfg)
 {
@@ -0,0 +1,544 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#include "usart.h"
+
+
+#ifdef USART_ENABLED
+
+
+#include "_hw_info.h"
+
+#include "common.h"
+
+#include "clk.h"
+#include "dma.h"
+#include "io.h"
+#include "irq.h"
+#include "merror.h"
+#include "mevent.h"
+
+
+/* power of 2. rx interrupts at least every half, 1.3 ms at 1 Mbaud */
+#define RX_BUF_LEN    256
+#define TX_BUF_LEN    512
+
+/* room only comes back as each transfer ends, so keep them short */
+#define TX_RUN_MAX    (TX_BUF_LEN / 4)
+
+
+typedef struct
+{
+  bool init;
+  UART_HandleTypeDef hal;
+  usart_hw_info_t const *hw;
+
+  /* rx, the dma writes round rx_buf & each event says how far it got */
+  USART_rx_cb rx_cb;
+  void *rx_ctx;
+  uint16_t rx_pos;            ///< where the last event left off
+  uint32_t rx_in;             ///< bytes received, written from the irq
+  uint32_t rx_out;            ///< bytes taken by USART_read
+  uint8_t rx_buf[RX_BUF_LEN];
+
+  /* tx, bytes from tx_tail are in flight while tx_run is non zero */
+  uint32_t tx_head;
+  uint32_t tx_tail;
+  uint16_t volatile tx_run;
+  uint8_t tx_buf[TX_BUF_LEN];
+} handle_t;
+
+
+static handle_t handles[USART_NUM_OF_CH] = {0};
+
+
+static bool rxStart       (handle_t *h);
+static void rxEvent       (handle_t *h, uint16_t pos);
+static void rxDeliver     (handle_t *h, uint16_t start, uint16_t len);
+static void txStartNext   (handle_t *h);
+
+static void lock          (handle_t *h);
+static void unlock        (handle_t *h);
+
+static bool channelFromHal(UART_HandleTypeDef *huart, USART_ch_e *ch);
+static void configureHal  (handle_t *h, USART_cfg_t *cfg);
+static bool initDma       (handle_t *h);
+
+
+bool USART_init           (USART_ch_e ch, USART_cfg_t *cfg)
+{
+  bool ret = false;
+  handle_t *h;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (h->init) {
+    return true; }
+
+  /* link to hw information */
+  h->hw = &usart_hw_info[ch];
+
+  /* no per byte fallback, that is what this driver is for */
+  if ((DMA_STREAM_NONE == h->hw->dma_rx_stream) || (DMA_STREAM_NONE == h->hw->dma_tx_stream))
+  {
+    MERR_error(MERROR_USART_INIT, h->hw->periph);
+    return false;
+  }
+
+  h->rx_in = 0;
+  h->rx_out = 0;
+  h->tx_head = 0;
+  h->tx_tail = 0;
+  h->tx_run = 0;
+
+  /* set config params */
+  configureHal(h, cfg);
+
+  if (HAL_OK == HAL_UART_Init(&h->hal))
+  {
+    /* point irq to this handle (h) for use in interrupt handler */
+    irq_set_context(h->hw->irq_num, h);
+
+    ret = rxStart(h);
+  }
+
+  if (false == ret) {
+    MERR_error(MERROR_USART_INIT, h->hw->periph); }
+
+  h->init = ret;
+
+  return ret;
+}
+
+bool USART_deInit         (USART_ch_e ch)
+{
+  bool ret = false;
+  handle_t *h;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (false == h->init) {
+    return true; }
+
+  HAL_UART_Abort(&h->hal);
+
+  if (HAL_OK == HAL_UART_DeInit(&h->hal))
+  {
+    h->init = false;
+    ret = true;
+
+    dma_deinit(h->hw->dma_rx_stream);
+    dma_deinit(h->hw->dma_tx_stream);
+  }
+
+  return ret;
+}
+
+void USART_setRxCallback  (USART_ch_e ch, USART_rx_cb cb, void *ctx)
+{
+  handle_t *h;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return; }
+
+  h = &handles[ch];
+
+  lock(h);
+  h->rx_cb = cb;
+  h->rx_ctx = ctx;
+  h->rx_out = h->rx_in;
+  unlock(h);
+}
+
+bool USART_write          (USART_ch_e ch, uint8_t const *data, uint16_t length)
+{
+  handle_t *h;
+  uint32_t off, first;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return false; }
+
+  h = &handles[ch];
+
+  if (false == h->init) {
+    return false; }
+
+  /* the rx callback writes too (thru), keep the two producers apart */
+  lock(h);
+
+  if (length > (TX_BUF_LEN - (h->tx_head - h->tx_tail)))
+  {
+    unlock(h);
+    MERR_error(MERROR_USART_TX_OVERFLOW, h->hw->periph);
+    return false;
+  }
+
+  off = h->tx_head & (TX_BUF_LEN - 1);
+  first = TX_BUF_LEN - off;
+
+  if (length <= first) {
+    memcpy(&h->tx_buf[off], data, length); }
+  else
+  {
+    memcpy(&h->tx_buf[off], data, first);
+    memcpy(h->tx_buf, &data[first], length - first);
+  }
+
+  h->tx_head += length;
+
+  if (0 == h->tx_run) {
+    txStartNext(h); }
+
+  unlock(h);
+
+  return true;
+}
+
+uint16_t USART_read       (USART_ch_e ch, uint8_t *data, uint16_t length)
+{
+  handle_t *h;
+  uint32_t avail, off, first;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return 0; }
+
+  h = &handles[ch];
+
+  if ((false == h->init) || h->rx_cb) {
+    return 0; }
+
+  avail = __atomic_load_n(&h->rx_in, __ATOMIC_ACQUIRE) - h->rx_out;
+
+  /* the dma has lapped the reader, what is left is a mix of old & new */
+  if (avail > RX_BUF_LEN)
+  {
+    MERR_error(MERROR_USART_RX_OVERRUN, h->hw->periph);
+    h->rx_out += avail;
+    return 0;
+  }
+
+  if (length > avail) {
+    length = (uint16_t)avail; }
+
+  off = h->rx_out & (RX_BUF_LEN - 1);
+  first = RX_BUF_LEN - off;
+
+  if (length <= first) {
+    memcpy(data, &h->rx_buf[off], length); }
+  else
+  {
+    memcpy(data, &h->rx_buf[off], first);
+    memcpy(&data[first], h->rx_buf, length - first);
+  }
+
+  h->rx_out += length;
+
+  return length;
+}
+
+uint16_t USART_txFree     (USART_ch_e ch)
+{
+  if (ch >= USART_NUM_OF_CH) {
+    return 0; }
+
+  return TX_BUF_LEN - USART_txPending(ch);
+}
+
+uint16_t USART_txPending  (USART_ch_e ch)
+{
+  handle_t *h;
+
+  if (ch >= USART_NUM_OF_CH) {
+    return 0; }
+
+  h = &handles[ch];
+
+  return (uint16_t)(h->tx_head - __atomic_load_n(&h->tx_tail, __ATOMIC_ACQUIRE));
+}
+
+
+/* Transfer functions */
+
+static bool rxStart       (handle_t *h)
+{
+  h->rx_pos = 0;
+
+  /* circular, so this never completes. the hal reports half, full & idle
+   * through HAL_UARTEx_RxEventCallback with the position reached */
+  return (HAL_OK == HAL_UARTEx_ReceiveToIdle_DMA(&h->hal, h->rx_buf, RX_BUF_LEN));
+}
+
+static void rxEvent       (handle_t *h, uint16_t pos)
+{
+  if (pos == h->rx_pos) {
+    return; }
+
+  if (pos > h->rx_pos) {
+    rxDeliver(h, h->rx_pos, pos - h->rx_pos); }
+  else
+  {
+    rxDeliver(h, h->rx_pos, RX_BUF_LEN - h->rx_pos);
+    rxDeliver(h, 0, pos);
+  }
+
+  h->rx_pos = pos & (RX_BUF_LEN - 1);
+
+  MEVE_setEvent(MEVENT_USART);
+}
+
+static void rxDeliver     (handle_t *h, uint16_t start, uint16_t len)
+{
+  if (0 == len) {
+    return; }
+
+  __atomic_store_n(&h->rx_in, h->rx_in + len, __ATOMIC_RELEASE);
+
+  if (h->rx_cb)
+  {
+    h->rx_cb(&h->rx_buf[start], len, h->rx_ctx);
+    h->rx_out = h->rx_in;
+  }
+}
+
+static void txStartNext   (handle_t *h)
+{
+  uint32_t off, run;
+
+  run = h->tx_head - h->tx_tail;
+
+  if ((0 == run) || h->tx_run) {
+    return; }
+
+  /* up to the end of the buffer, the rest goes in the next transfer */
+  off = h->tx_tail & (TX_BUF_LEN - 1);
+
+  if (run > (TX_BUF_LEN - off)) {
+    run = TX_BUF_LEN - off; }
+
+  if (run > TX_RUN_MAX) {
+    run = TX_RUN_MAX; }
+
+  h->tx_run = (uint16_t)run;
+
+  if (HAL_OK != HAL_UART_Transmit_DMA(&h->hal, &h->tx_buf[off], (uint16_t)run))
+  {
+    MERR_error(MERROR_USART_XFER_ERROR, h->hw->periph);
+
+    /* drop it rather than retry forever */
+    __atomic_store_n(&h->tx_tail, h->tx_tail + run, __ATOMIC_RELEASE);
+    h->tx_run = 0;
+  }
+}
+
+
+/* Util functions */
+
+/* every callback comes from the usart or rx dma irq, both at the same priority */
+static void lock          (handle_t *h)
+{
+  irq_disable(h->hw->irq_num);
+  irq_disable(dma_hw_info[h->hw->dma_rx_stream].irq_num);
+}
+
+static void unlock        (handle_t *h)
+{
+  irq_enable(dma_hw_info[h->hw->dma_rx_stream].irq_num);
+  irq_enable(h->hw->irq_num);
+}
+
+static bool channelFromHal(UART_HandleTypeDef *huart, USART_ch_e *ch)
+{
+  bool ret = false;
+  USART_ch_e i;
+
+  for (i = USART_CH_FIRST; i < USART_NUM_OF_CH; i++)
+  {
+    if (huart == &handles[i].hal)
+    {
+      *ch = i;
+      ret = true;
+      break;
+    }
+  }
+
+  return ret;
+}
+
+static void configureHal  (handle_t *h, USART_cfg_t *cfg)
+{
+  h->hal.Instance           = h->hw->inst;
+  h->hal.Init.BaudRate      = cfg->baud;
+  h->hal.Init.WordLength    = UART_WORDLENGTH_8B;
+  h->hal.Init.StopBits      = UART_STOPBITS_1;
+  h->hal.Init.Parity        = UART_PARITY_NONE;
+  h->hal.Init.Mode          = UART_MODE_TX_RX;
+  h->hal.Init.HwFlowCtl     = UART_HWCONTROL_NONE;
+  h->hal.Init.OverSampling  = UART_OVERSAMPLING_16;
+}
+
+static bool initDma       (handle_t *h)
+{
+  bool ret = true;
+  dma_cfg_t dma_cfg;
+
+  dma_cfg.priority          = h->hw->irq_priority;
+  dma_cfg.parent_handle     = &h->hal;
+  dma_cfg.periph_data_size  = DMA_DATA_SIZE_8BIT;
+  dma_cfg.mem_data_size     = DMA_DATA_SIZE_8BIT;
+  dma_cfg.inc_mem_addr      = true;
+  dma_cfg.inc_periph_addr   = false;
+
+  /* rx never stops */
+  dma_cfg.dir = DMA_DIR_PERIPH_TO_MEM;
+  dma_cfg.channel = h->hw->dma_rx_ch;
+  dma_cfg.circular_mode = true;
+  ret &= dma_init(h->hw->dma_rx_stream, &dma_cfg);
+  h->hal.hdmarx = dma_getHandle(h->hw->dma_rx_stream);
+
+  dma_cfg.dir = DMA_DIR_MEM_TO_PERIPH;
+  dma_cfg.channel = h->hw->dma_tx_ch;
+  dma_cfg.circular_mode = false;
+  ret &= dma_init(h->hw->dma_tx_stream, &dma_cfg);
+  h->hal.hdmatx = dma_getHandle(h->hw->dma_tx_stream);
+
+  return ret;
+}
+
+
+/* STM32 Library functions */
+
+void HAL_UART_MspInit(UART_HandleTypeDef *huart)
+{
+  USART_ch_e ch;
+  handle_t *h;
+  IO_cfg_t io_cfg;
+
+  if (false == channelFromHal(huart, &ch)) {
+    return; }
+
+  h = &handles[ch];
+
+  io_cfg.mode    = IO_MODE_PERIPH_OUT_PP;
+  io_cfg.pullup  = IO_PULL_NONE;
+  io_cfg.speed   = IO_SPEED_FAST;
+  io_cfg.extend  = &h->hw->io_cfg_ext;
+  IO_configure(h->hw->tx_pin, &io_cfg);
+
+  /* idle high, a floating input would read as breaks */
+  io_cfg.mode    = IO_MODE_PERIPH_IN;
+  io_cfg.pullup  = IO_PULL_UP;
+  IO_configure(h->hw->rx_pin, &io_cfg);
+
+  clk_periphEnable(h->hw->periph);
+
+  initDma(h);
+
+  irq_config(h->hw->irq_num, h->hw->irq_priority);
+  irq_enable(h->hw->irq_num);
+}
+
+void HAL_UART_MspDeInit(UART_HandleTypeDef *huart)
+{
+  USART_ch_e ch;
+  handle_t *h;
+
+  if (false == channelFromHal(huart, &ch)) {
+    return; }
+
+  h = &handles[ch];
+
+  irq_disable(h->hw->irq_num);
+
+  IO_deinit(h->hw->tx_pin);
+  IO_deinit(h->hw->rx_pin);
+
+  clk_periphReset(h->hw->periph);
+}
+
+
+/* Interrupt handling */
+
+void usart_irq_handler(void)
+{
+  handle_t *h = (handle_t*)irq_get_context(irq_get_current());
+
+  if (h) {
+    HAL_UART_IRQHandler(&h->hal); }
+}
+
+/* half, full or idle line, from the rx dma or usart irq */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t pos)
+{
+  USART_ch_e ch;
+
+  if (channelFromHal(huart, &ch)) {
+    rxEvent(&handles[ch], pos); }
+}
+
+/* after the last stop bit of a dma transfer */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  USART_ch_e ch;
+  handle_t *h;
+
+  if (false == channelFromHal(huart, &ch)) {
+    return; }
+
+  h = &handles[ch];
+
+  __atomic_store_n(&h->tx_tail, h->tx_tail + h->tx_run, __ATOMIC_RELEASE);
+  h->tx_run = 0;
+
+  txStartNext(h);
+}
+
+/* overrun, framing or noise. the hal stops the rx dma for these */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  USART_ch_e ch;
+  handle_t *h;
+
+  if (false == channelFromHal(huart, &ch)) {
+    return; }
+
+  h = &handles[ch];
+
+  MERR_error(MERROR_USART_XFER_ERROR, h->hw->periph);
+
+  if ((HAL_UART_STATE_READY == huart->RxState) && (false == rxStart(h))) {
+    MERR_error(MERROR_USART_INIT, h->hw->periph); }
+}
+
+
+#endif
@@ -0,0 +1,427 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#include "usb.h"
+
+
+#ifdef USB_ENABLED
+
+
+#include "common.h"
+
+#include "irq.h"
+#include "merror.h"
+
+#include "usbd_core.h"
+#include "usbd_ctlreq.h"
+#include "usbd_desc.h"
+#include "usbd_ioreq.h"
+
+
+#if (USB_MAX_INTERFACES > USBD_MAX_NUM_INTERFACES)
+  #error usbd_conf.h has to pass on requests for every interface
+#endif
+
+
+/* power of 2 */
+#define TX_BUF_LEN    512
+
+
+typedef struct
+{
+  bool init;
+  bool volatile configured;
+  USBD_HandleTypeDef dev;
+  USB_cfg_t cfg;
+
+  USB_rx_cb rx_cb;
+  void *rx_ctx;
+  uint8_t rx_packet[USB_EP_SIZE];
+
+  /* tx, each packet is copied out of tx_buf as it is loaded so the
+   * room comes straight back, tx_busy until the host has taken it */
+  uint32_t tx_head;
+  uint32_t tx_tail;
+  bool volatile tx_busy;
+  uint8_t tx_buf[TX_BUF_LEN];
+  uint8_t tx_packet[USB_EP_SIZE];
+
+  uint8_t alt_setting;
+} handle_t;
+
+
+static handle_t handle = {0};
+
+
+static uint8_t  classInit       (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+static uint8_t  classDeInit     (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+static uint8_t  classSetup      (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+static uint8_t  classDataIn     (USBD_HandleTypeDef *pdev, uint8_t epnum);
+static uint8_t  classDataOut    (USBD_HandleTypeDef *pdev, uint8_t epnum);
+static uint8_t* classConfigDesc (uint16_t *length);
+
+static void txStartNext   (handle_t *h);
+
+static void lock          (void);
+static void unlock        (void);
+
+
+/* full speed only, so no qualifier or other speed descriptors */
+static USBD_ClassTypeDef usb_class =
+{
+  classInit,
+  classDeInit,
+  classSetup,
+  NULL,                       /* EP0_TxSent */
+  NULL,                       /* EP0_RxReady */
+  classDataIn,
+  classDataOut,
+  NULL,                       /* SOF */
+  NULL,                       /* IsoINIncomplete */
+  NULL,                       /* IsoOUTIncomplete */
+  classConfigDesc,
+  classConfigDesc,
+  NULL,
+  NULL,
+};
+
+
+bool USB_init             (USB_cfg_t *cfg)
+{
+  bool ret = false;
+  handle_t *h = &handle;
+
+  if (h->init) {
+    return true; }
+
+  if ((NULL == cfg) || (NULL == cfg->config_desc) || (cfg->config_length < USB_LEN_CFG_DESC))
+  {
+    MERR_error(MERROR_USB_INIT, PERIPH_USB_OTG_FS);
+    return false;
+  }
+
+  h->cfg = *cfg;
+  h->configured = false;
+  h->tx_head = 0;
+  h->tx_tail = 0;
+  h->tx_busy = false;
+
+  if ((USBD_OK == USBD_Init(&h->dev, &FS_Desc, DEVICE_FS)) &&
+      (USBD_OK == USBD_RegisterClass(&h->dev, &usb_class)))
+  {
+    /* the cube msp init puts it at the top, above the audio */
+    irq_config(OTG_FS_IRQn, USB_FS_PRIORITY);
+
+    ret = (USBD_OK == USBD_Start(&h->dev));
+  }
+
+  if (false == ret) {
+    MERR_error(MERROR_USB_INIT, PERIPH_USB_OTG_FS); }
+
+  h->init = ret;
+
+  return ret;
+}
+
+bool USB_deInit           (void)
+{
+  bool ret = false;
+  handle_t *h = &handle;
+
+  if (false == h->init) {
+    return true; }
+
+  USBD_Stop(&h->dev);
+
+  if (USBD_OK == USBD_DeInit(&h->dev))
+  {
+    h->init = false;
+    h->configured = false;
+    ret = true;
+  }
+
+  return ret;
+}
+
+void USB_setRxCallback    (USB_rx_cb cb, void *ctx)
+{
+  handle_t *h = &handle;
+
+  lock();
+  h->rx_cb = cb;
+  h->rx_ctx = ctx;
+  unlock();
+}
+
+bool USB_isConfigured     (void)
+{
+  return handle.configured;
+}
+
+bool USB_write            (uint8_t const *data, uint16_t length)
+{
+  handle_t *h = &handle;
+  uint32_t off, first;
+
+  /* unplugged is normal, not an error */
+  if ((false == h->init) || (false == h->configured)) {
+    return false; }
+
+  /* the rx callback writes too, keep the two producers apart */
+  lock();
+
+  if (length > (TX_BUF_LEN - (h->tx_head - h->tx_tail)))
+  {
+    unlock();
+    MERR_error(MERROR_USB_TX_OVERFLOW, PERIPH_USB_OTG_FS);
+    return false;
+  }
+
+  off = h->tx_head & (TX_BUF_LEN - 1);
+  first = TX_BUF_LEN - off;
+
+  if (length <= first) {
+    memcpy(&h->tx_buf[off], data, length); }
+  else
+  {
+    memcpy(&h->tx_buf[off], data, first);
+    memcpy(h->tx_buf, &data[first], length - first);
+  }
+
+  h->tx_head += length;
+
+  if (false == h->tx_busy) {
+    txStartNext(h); }
+
+  unlock();
+
+  return true;
+}
+
+uint16_t USB_txFree       (void)
+{
+  handle_t *h = &handle;
+
+  return (uint16_t)(TX_BUF_LEN - (h->tx_head - __atomic_load_n(&h->tx_tail, __ATOMIC_ACQUIRE)));
+}
+
+
+/* Transfer functions */
+
+static void txStartNext   (handle_t *h)
+{
+  uint32_t off, run, first;
+
+  run = h->tx_head - h->tx_tail;
+
+  if ((0 == run) || h->tx_busy || (false == h->configured)) {
+    return; }
+
+  /* one packet per transfer, so never a zero length packet to follow */
+  if (run > USB_EP_SIZE) {
+    run = USB_EP_SIZE; }
+
+  off = h->tx_tail & (TX_BUF_LEN - 1);
+  first = TX_BUF_LEN - off;
+
+  if (run <= first) {
+    memcpy(h->tx_packet, &h->tx_buf[off], run); }
+  else
+  {
+    memcpy(h->tx_packet, &h->tx_buf[off], first);
+    memcpy(&h->tx_packet[first], h->tx_buf, run - first);
+  }
+
+  __atomic_store_n(&h->tx_tail, h->tx_tail + run, __ATOMIC_RELEASE);
+
+  h->tx_busy = true;
+
+  /* dropped rather than retried forever */
+  if (USBD_OK != USBD_LL_Transmit(&h->dev, USB_EP_IN, h->tx_packet, run))
+  {
+    MERR_error(MERROR_USB_XFER_ERROR, PERIPH_USB_OTG_FS);
+    h->tx_busy = false;
+  }
+}
+
+
+/* Util functions */
+
+/* every class callback comes from the otg irq */
+static void lock          (void)
+{
+  irq_disable(OTG_FS_IRQn);
+}
+
+static void unlock        (void)
+{
+  irq_enable(OTG_FS_IRQn);
+}
+
+
+/* STM32 usb library class, all from the interrupt */
+
+/* set configuration */
+static uint8_t  classInit       (USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  handle_t *h = &handle;
+
+  (void)cfgidx;
+
+  USBD_LL_OpenEP(pdev, USB_EP_OUT, USBD_EP_TYPE_BULK, USB_EP_SIZE);
+  pdev->ep_out[USB_EP_OUT & 0xFU].is_used = 1U;
+
+  USBD_LL_OpenEP(pdev, USB_EP_IN, USBD_EP_TYPE_BULK, USB_EP_SIZE);
+  pdev->ep_in[USB_EP_IN & 0xFU].is_used = 1U;
+
+  h->alt_setting = 0;
+  h->tx_busy = false;
+  h->configured = true;
+
+  USBD_LL_PrepareReceive(pdev, USB_EP_OUT, h->rx_packet, USB_EP_SIZE);
+
+  return (uint8_t)USBD_OK;
+}
+
+/* unplugged, reset or configuration 0, queued tx is stale by the next time */
+static uint8_t  classDeInit     (USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  handle_t *h = &handle;
+
+  (void)cfgidx;
+
+  h->configured = false;
+
+  USBD_LL_CloseEP(pdev, USB_EP_OUT);
+  pdev->ep_out[USB_EP_OUT & 0xFU].is_used = 0U;
+
+  USBD_LL_CloseEP(pdev, USB_EP_IN);
+  pdev->ep_in[USB_EP_IN & 0xFU].is_used = 0U;
+
+  __atomic_store_n(&h->tx_tail, h->tx_head, __ATOMIC_RELEASE);
+  h->tx_busy = false;
+
+  return (uint8_t)USBD_OK;
+}
+
+/* interface requests, usb midi has no class requests of its own */
+static uint8_t  classSetup      (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+  static uint8_t status[2] = {0, 0};
+  handle_t *h = &handle;
+  uint8_t ret = (uint8_t)USBD_OK;
+
+  if (USB_REQ_TYPE_STANDARD != (req->bmRequest & USB_REQ_TYPE_MASK))
+  {
+    USBD_CtlError(pdev, req);
+    return (uint8_t)USBD_FAIL;
+  }
+
+  switch (req->bRequest)
+  {
+    case USB_REQ_GET_STATUS:
+      USBD_CtlSendData(pdev, status, 2U);
+      break;
+
+    case USB_REQ_GET_INTERFACE:
+      USBD_CtlSendData(pdev, &h->alt_setting, 1U);
+      break;
+
+    case USB_REQ_SET_INTERFACE:
+      h->alt_setting = (uint8_t)req->wValue;
+      break;
+
+    case USB_REQ_CLEAR_FEATURE:
+      break;
+
+    default:
+      USBD_CtlError(pdev, req);
+      ret = (uint8_t)USBD_FAIL;
+      break;
+  }
+
+  return ret;
+}
+
+/* the host has the packet */
+static uint8_t  classDataIn     (USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  handle_t *h = &handle;
+
+  (void)pdev;
+  (void)epnum;
+
+  h->tx_busy = false;
+  txStartNext(h);
+
+  return (uint8_t)USBD_OK;
+}
+
+/* the endpoint naks until it is rearmed, so the callback can take its time */
+static uint8_t  classDataOut    (USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  handle_t *h = &handle;
+  uint32_t length;
+
+  length = USBD_LL_GetRxDataSize(pdev, epnum);
+
+  if (h->rx_cb && length) {
+    h->rx_cb(h->rx_packet, (uint16_t)length, h->rx_ctx); }
+
+  USBD_LL_PrepareReceive(pdev, USB_EP_OUT, h->rx_packet, USB_EP_SIZE);
+
+  return (uint8_t)USBD_OK;
+}
+
+static uint8_t* classConfigDesc (uint16_t *length)
+{
+  *length = handle.cfg.config_length;
+
+  return (uint8_t*)handle.cfg.config_desc;
+}
+
+
+/* STM32 Library functions */
+
+/* usbd_conf.c calls this if the pcd will not start */
+void Error_Handler(void)
+{
+  MERR_error(MERROR_USB_INIT, PERIPH_USB_OTG_FS);
+}
+
+
+/* Interrupt handling */
+
+void usb_irq_handler(void)
+{
+  if (handle.dev.pData) {
+    HAL_PCD_IRQHandler((PCD_HandleTypeDef*)handle.dev.pData); }
+}
+
+
+#endif
@@ -35,6 +35,66 @@ SOFTWARE.
 #endif
 
 
+/* audio, normally passed in from the Makefile (sampleRate/ blockSize) */
+#ifndef SAMPLE_RATE
+  #define SAMPLE_RATE       96000
+#endif
+
+/* frames rendered per dma half transfer, latency is 2 blocks */
+#ifndef BLOCK_SIZE
+  #define BLOCK_SIZE        32
+#endif
+
+/* default glide for knob & midi changes, long enough to hide the steps */
+#ifndef PARAMETER_RAMP_MS
+  #define PARAMETER_RAMP_MS   5
+#endif
+
+/* mod matrix size, routes are what it costs per block */
+#ifndef MOD_SOURCES
+  #define MOD_SOURCES         16
+#endif
+#ifndef MOD_DESTINATIONS
+  #define MOD_DESTINATIONS    32
+#endif
+#ifndef MOD_ROUTES
+  #define MOD_ROUTES          32
+#endif
+
+/* events each producer can have waiting for the next block */
+#ifndef EVENT_QUEUE_LEN
+  #define EVENT_QUEUE_LEN     64
+#endif
+
+/* midi messages each output source can have waiting for the wire */
+#ifndef MIDI_OUT_QUEUE_LEN
+  #define MIDI_OUT_QUEUE_LEN  64
+#endif
+
+/* interleaved left/ right to the codec */
+#define AUDIO_CHANNELS      2
+
+/* polyphony, all voice state is static so this sets ram use */
+#ifndef MAX_VOICES
+  #define MAX_VOICES        8
+#endif
+
+/* ram kept for the start of flash samples, so note on does not wait on spi */
+#ifndef SAMPLE_CACHE_BYTES
+  #define SAMPLE_CACHE_BYTES    8192
+#endif
+
+/* how much of each sample that is, rounded up to whole stream chunks */
+#ifndef SAMPLE_CACHE_ATTACK_MS
+  #define SAMPLE_CACHE_ATTACK_MS  5
+#endif
+
+/* static memory shared by every resonator's delay lines */
+#ifndef RESONATOR_ARENA_BYTES
+  #define RESONATOR_ARENA_BYTES   16384
+#endif
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,100 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include <stddef.h>
+
+
+/**
+ * @brief song position in beats for tempo synced modifiers
+ *
+ * advanced a block at a time by the audio engine. tempo is either set
+ * directly or follows midi clock pulses, measured over a whole beat so
+ * the block granularity of the sample count averages out. everything is
+ * called from the audio context, pulses included
+ */
+class Clock
+{
+  public:
+    static constexpr uint32_t PPQN = 24;
+
+    Clock(float bpm = 120.0f) : _pos(0), _since(0), _pulses(0) { setTempo(bpm); }
+
+    void setTempo(float bpm)
+    {
+      _bpm = bpm;
+      _inc = (uint32_t)((bpm / (60.0f * SAMPLE_RATE)) * 4294967296.0f);
+    }
+
+    /* midi start, back to the first beat */
+    void reset(void)
+    {
+      _pos = 0;
+      _since = 0;
+      _pulses = 0;
+    }
+
+    /* midi clock, PPQN a beat */
+    void pulse(void)
+    {
+      if (++_pulses < PPQN) {
+        return; }
+
+      if (_since) {
+        setTempo((60.0f * SAMPLE_RATE) / (float)_since); }
+
+      _pulses = 0;
+      _since = 0;
+    }
+
+    void advance(size_t frames)
+    {
+      _pos += (uint64_t)_inc * frames;
+      _since += frames;
+    }
+
+    /* beats, 32.32 */
+    uint64_t position (void) const { return _pos; }
+    float    tempo    (void) const { return _bpm; }
+
+  private:
+    uint64_t _pos;
+    uint32_t _inc;            ///< beats per sample, 0.32
+    uint32_t _since;          ///< samples since the last whole beat of pulses
+    uint32_t _pulses;
+    float    _bpm;
+};
+
+
+#endif
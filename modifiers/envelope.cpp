@@ -0,0 +1,242 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "envelope.hpp"
+
+#include <cmath>
+
+
+Envelope::Envelope(float attack, float decay, float sustain, float release)
+  : _y(0.0f),
+    _k(1.0f),
+    _kb(1.0f),
+    _target(0.0f),
+    _end(0.0f),
+    _left(0.0f),
+    _d(0.0f),
+    _sustain(sustain),
+    _stage(STAGE_IDLE)
+{
+  setAttack(attack);
+  setDecay(decay);
+  setRelease(release);
+}
+
+
+void Envelope::setAttack(float seconds)
+{
+  _attack_k = coefficient(seconds, ATTACK_RATIO);
+}
+
+void Envelope::setDecay(float seconds)
+{
+  _decay_k = coefficient(seconds, DECAY_RATIO);
+}
+
+void Envelope::setRelease(float seconds)
+{
+  _release_k = coefficient(seconds, DECAY_RATIO);
+}
+
+void Envelope::setSustain(float level)
+{
+  _sustain = (level < 0.0f) ? 0.0f : (level > 1.0f) ? 1.0f : level;
+
+  if ((STAGE_DECAY == _stage) || (STAGE_SUSTAIN == _stage)) {
+    enter(STAGE_DECAY); }
+}
+
+
+void Envelope::gate(bool on)
+{
+  if (on) {
+    enter(STAGE_ATTACK); }
+  else if (STAGE_IDLE != _stage) {
+    enter(STAGE_RELEASE); }
+}
+
+void Envelope::reset(void)
+{
+  _y = 0.0f;
+  _d = 0.0f;
+  _value = 0.0f;
+  _stage = STAGE_IDLE;
+}
+
+
+void Envelope::generate(float *out, size_t frames)
+{
+  run(out, frames);
+}
+
+/* a whole block in one multiply unless a segment ends inside it */
+float Envelope::update(size_t frames)
+{
+  float d = _d * _kb;
+
+  if ((BLOCK_SIZE == frames) && (_k < 1.0f) && (fabsf(d) > _left))
+  {
+    _d = d;
+    _y = _target + d;
+    _value = _y;
+  }
+  else {
+    run(NULL, frames); }
+
+  return _value;
+}
+
+
+/* span/ratio of the way shrinks to 1 + 1/ratio in samples, the only expf */
+float Envelope::coefficient(float seconds, float ratio)
+{
+  float samples = seconds * SAMPLE_RATE;
+
+  if (samples < 1.0f) {
+    return 0.0f; }
+
+  return expf(-logf((1.0f + ratio) / ratio) / samples);
+}
+
+
+/* target & the distance left at the end, worked out once per segment */
+void Envelope::enter(stage_e stage)
+{
+  uint32_t i;
+
+  _stage = stage;
+
+  switch (stage)
+  {
+    case STAGE_ATTACK:
+      _k = _attack_k;
+      _end = 1.0f;
+      _target = 1.0f + ATTACK_RATIO;
+    break;
+
+    case STAGE_DECAY:
+      _k = _decay_k;
+      _end = _sustain;
+      _target = _sustain - (DECAY_RATIO * (1.0f - _sustain));
+
+      /* sustain moved above where decay had got to */
+      if (_y <= _end)
+      {
+        _y = _end;
+        _target = _end;
+        _stage = STAGE_SUSTAIN;
+      }
+    break;
+
+    case STAGE_RELEASE:
+      _k = _release_k;
+      _end = 0.0f;
+      _target = -DECAY_RATIO;
+    break;
+
+    default:
+      _y = (STAGE_SUSTAIN == stage) ? _sustain : 0.0f;
+      _k = 1.0f;
+      _end = _y;
+      _target = _y;
+    break;
+  }
+
+  _left = fabsf(_end - _target);
+  _d = _y - _target;
+
+  for (i = 0, _kb = 1.0f; i < BLOCK_SIZE; i++) {
+    _kb *= _k; }
+}
+
+
+/* out may be NULL for the block rate path, the sums are the same */
+void Envelope::run(float *out, size_t frames)
+{
+  float d = _d;
+  float k = _k;
+  float target = _target;
+  float left = _left;
+  size_t i = 0;
+
+  while (i < frames)
+  {
+    if ((STAGE_IDLE == _stage) || (STAGE_SUSTAIN == _stage))
+    {
+      if (out)
+      {
+        for (; i < frames; i++) {
+          out[i] = _y; }
+      }
+      break;
+    }
+
+    if (out)
+    {
+      for (; i < frames; i++)
+      {
+        d *= k;
+        if (fabsf(d) <= left) {
+          break; }
+        out[i] = target + d;
+      }
+    }
+    else
+    {
+      for (; i < frames; i++)
+      {
+        d *= k;
+        if (fabsf(d) <= left) {
+          break; }
+      }
+    }
+
+    if (i == frames)
+    {
+      _d = d;
+      _y = target + d;
+      break;
+    }
+
+    /* segment done on sample i, land exactly on its end */
+    _y = _end;
+    if (out) {
+      out[i] = _y; }
+    i++;
+
+    enter((STAGE_ATTACK == _stage) ? STAGE_DECAY :
+          (STAGE_DECAY == _stage) ? STAGE_SUSTAIN : STAGE_IDLE);
+    d = _d;
+    k = _k;
+    target = _target;
+    left = _left;
+  }
+
+  _value = _y;
+}
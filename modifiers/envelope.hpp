@@ -0,0 +1,113 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef ENVELOPE_HPP
+#define ENVELOPE_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "modifier.hpp"
+
+
+/**
+ * @brief exponential adsr, 0 to 1
+ *
+ * each segment heads for a target just past its end level, so it arrives
+ * in the set time rather than creeping up on it forever. the distance to
+ * the target shrinks by k each sample & the output is target + distance,
+ * one multiply & one add with no expf. k comes from the segment time when
+ * that is set, the target when the segment starts. keeping the distance
+ * rather than the level means long segments don't stall a few ulp short
+ * of their end. attack overshoots a little for the usual analog curve,
+ * decay & release aim 80 dB past their end
+ *
+ * generate() for audio rate amplitude, update() as a block rate Modifier,
+ * one multiply a block when no segment ends inside it. isIdle() once
+ * released to silence so the voice can skip rendering
+ */
+class Envelope : public Modifier
+{
+  public:
+    typedef enum
+    {
+      STAGE_IDLE,
+      STAGE_ATTACK,
+      STAGE_DECAY,
+      STAGE_SUSTAIN,
+      STAGE_RELEASE,
+    } stage_e;
+
+    /* how far past the end level each segment aims, relative to its span */
+    static constexpr float ATTACK_RATIO = 0.3f;
+    static constexpr float DECAY_RATIO  = 0.0001f;
+
+    Envelope(float attack = 0.005f, float decay = 0.1f, float sustain = 0.7f, float release = 0.2f);
+
+    /* seconds, take effect from the next segment */
+    void setAttack  (float seconds);
+    void setDecay   (float seconds);
+    void setRelease (float seconds);
+
+    /* 0 - 1, a sustaining envelope moves straight there */
+    void setSustain (float level);
+
+    /* from the current level, no click on a retrigger */
+    void gate       (bool on);
+
+    void reset      (void);
+
+    void  generate  (float *out, size_t frames);
+    float update    (size_t frames);
+
+    stage_e stage   (void) const { return _stage; }
+    bool    isIdle  (void) const { return (STAGE_IDLE == _stage); }
+
+  private:
+    static float coefficient(float seconds, float ratio);
+
+    void enter  (stage_e stage);
+    void run    (float *out, size_t frames);
+
+    float   _y;
+    float   _k;                 ///< current segment
+    float   _kb;                ///< k^BLOCK_SIZE, a block at a time for update()
+    float   _target;
+    float   _end;
+    float   _left;              ///< distance to target once at the end
+    float   _d;                 ///< distance to target now, kept so it never rounds through _y
+    float   _attack_k;
+    float   _decay_k;
+    float   _release_k;
+    float   _sustain;
+    stage_e _stage;
+};
+
+
+#endif
@@ -0,0 +1,157 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "lfo.hpp"
+
+#include "wavetable.hpp"
+
+
+/* piecewise linear shapes are exact with a few points & interpolation */
+typedef struct
+{
+  float const *table;         ///< (1 << bits) + 1 points, the last wraps
+  uint32_t     bits;
+} shape_t;
+
+static float const triangle[] = {0.0f, 1.0f, 0.0f, -1.0f, 0.0f};
+static float const saw[] = {-1.0f, 0.0f, 1.0f};
+
+static shape_t const sine = {Wavetable::table(Wavetable::SHAPE_SINE, 0), Wavetable::LENGTH_BITS};
+static shape_t const shapes[] = {sine, {triangle, 2}, {saw, 1}};
+
+
+static float lookup(shape_t const &s, uint32_t phase);
+
+
+Lfo::Lfo(shape_e shape, float hz, uint32_t seed)
+  : _clock(NULL),
+    _cycle(0),
+    _offset(0),
+    _phase(0),
+    _start(0),
+    _seed(seed ? seed : 1),
+    _shape(shape)
+{
+  setFrequency(hz);
+  _from = (float)(int32_t)random() * (1.0f / 2147483648.0f);
+  _to = (float)(int32_t)random() * (1.0f / 2147483648.0f);
+}
+
+
+void Lfo::setFrequency(float hz)
+{
+  _inc = Wavetable::increment(hz);
+}
+
+void Lfo::setSync(Clock const *clock, float beats)
+{
+  _clock = clock;
+  _cycle = (beats > 0.0f) ? (uint32_t)(65536.0f / beats) : 0;
+  _offset = 0;
+}
+
+void Lfo::setStart(float phase)
+{
+  _start = (uint32_t)(int64_t)(phase * 4294967296.0f);
+}
+
+
+void Lfo::trigger(void)
+{
+  uint32_t beat;
+
+  if (_clock)
+  {
+    beat = (uint32_t)((_clock->position() >> 16) * _cycle);
+    _offset = beat - _start;
+  }
+
+  _phase = _start;
+  _from = _to;
+  _to = (float)(int32_t)random() * (1.0f / 2147483648.0f);
+}
+
+
+float Lfo::update(size_t frames)
+{
+  uint32_t last = _phase;
+  uint32_t ease;
+
+  /* 16.16 beats x 16.16 cycles a beat, the low 32 bits are the phase */
+  if (_clock) {
+    _phase = (uint32_t)((_clock->position() >> 16) * _cycle) - _offset; }
+  else {
+    _phase += _inc * (uint32_t)frames; }
+
+  /* wrapped, next random target */
+  if (_phase < last)
+  {
+    _from = _to;
+    _to = (float)(int32_t)random() * (1.0f / 2147483648.0f);
+  }
+
+  switch (_shape)
+  {
+    case SHAPE_SAMPLE_HOLD:
+      _value = _to;
+    break;
+
+    /* raised cosine, 0.5 - 0.5 cos(pi x) from a quarter cycle into the sine */
+    case SHAPE_SMOOTH_RANDOM:
+      ease = (_phase >> 1) + (3u << 30);
+      _value = _from + ((_to - _from) * (0.5f + (0.5f * lookup(sine, ease))));
+    break;
+
+    default:
+      _value = lookup(shapes[_shape], _phase);
+    break;
+  }
+
+  return _value;
+}
+
+
+/* xorshift32 */
+uint32_t Lfo::random(void)
+{
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+
+  return _seed;
+}
+
+
+static float lookup(shape_t const &s, uint32_t phase)
+{
+  uint32_t i = phase >> (32 - s.bits);
+  float frac = (float)(phase << s.bits) * (1.0f / 4294967296.0f);
+
+  return s.table[i] + ((s.table[i + 1] - s.table[i]) * frac);
+}
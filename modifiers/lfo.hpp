@@ -0,0 +1,94 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef LFO_HPP
+#define LFO_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "clock.hpp"
+#include "modifier.hpp"
+
+
+/**
+ * @brief low frequency oscillator, stepped once per block
+ *
+ * a 32 bit phase accumulator moved a whole block at a time & a table
+ * lookup for the shape, so eight voices cost eight lookups a block rather
+ * than a sinf per sample each. the parameter it is routed to ramps between
+ * block values. free running in hz or locked to a Clock's beat position,
+ * trigger() restarts the cycle at note on
+ */
+class Lfo : public Modifier
+{
+  public:
+    typedef enum
+    {
+      SHAPE_SINE,
+      SHAPE_TRIANGLE,
+      SHAPE_SAW,
+      SHAPE_SAMPLE_HOLD,      ///< new random value each cycle
+      SHAPE_SMOOTH_RANDOM,    ///< eases from one random value to the next
+      SHAPE_NUM_OF,
+    } shape_e;
+
+    Lfo(shape_e shape = SHAPE_SINE, float hz = 1.0f, uint32_t seed = 1);
+
+    void setShape     (shape_e shape) { _shape = shape; }
+    void setFrequency (float hz);
+
+    /* one cycle every beats, NULL to run free again */
+    void setSync      (Clock const *clock, float beats);
+
+    /* where trigger() restarts, 0 - 1 of a cycle */
+    void setStart     (float phase);
+
+    void trigger      (void);
+
+    /* -1 to 1 at the end of the block */
+    float update(size_t frames);
+
+  private:
+    uint32_t random(void);
+
+    Clock const *_clock;
+    uint32_t     _cycle;      ///< synced, cycles per beat 16.16
+    uint32_t     _offset;     ///< synced, subtracted so trigger() lands on _start
+    uint32_t     _phase;
+    uint32_t     _inc;        ///< per sample, 2^32 per cycle
+    uint32_t     _start;
+    uint32_t     _seed;
+    float        _from;       ///< random shapes, last & next values
+    float        _to;
+    shape_e      _shape;
+};
+
+
+#endif
@@ -0,0 +1,280 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "mod_matrix.hpp"
+
+
+static_assert(MOD_DESTINATIONS <= 32, "destinations are a 32 bit mask");
+
+
+ModMatrix::ModMatrix(void)
+  : _routes(0),
+    _voice_srcs(0),
+    _global_srcs(0),
+    _used_dsts(0),
+    _routed(0),
+    _sources(0),
+    _dests(0),
+    _stale()
+{
+}
+
+
+uint8_t ModMatrix::addSource(Modifier *const voices[MAX_VOICES])
+{
+  uint8_t v;
+
+  if (_sources >= MOD_SOURCES) {
+    return NONE; }
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    _src[_sources][v] = voices[v]; }
+  _global[_sources] = false;
+
+  return _sources++;
+}
+
+uint8_t ModMatrix::addSource(Modifier *global)
+{
+  uint8_t v;
+
+  if ((_sources >= MOD_SOURCES) || (NULL == global)) {
+    return NONE; }
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    _src[_sources][v] = global; }
+  _global[_sources] = true;
+
+  return _sources++;
+}
+
+uint8_t ModMatrix::addDestination(ParameterTarget *const voices[MAX_VOICES], float base)
+{
+  uint8_t v;
+
+  if (_dests >= MOD_DESTINATIONS) {
+    return NONE; }
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    _dst[_dests][v] = voices[v]; }
+  _base[_dests] = base;
+
+  return _dests++;
+}
+
+
+bool ModMatrix::connect(uint8_t source, uint8_t dest, float depth)
+{
+  uint8_t r;
+
+  if ((source >= _sources) || (dest >= _dests)) {
+    return false; }
+
+  for (r = 0; r < _routes; r++)
+  {
+    if ((_route[r].src == source) && (_route[r].dst == dest))
+    {
+      _route[r].depth = depth;
+      return true;
+    }
+  }
+
+  if (_routes >= MOD_ROUTES) {
+    return false; }
+
+  _route[_routes].src = source;
+  _route[_routes].dst = dest;
+  _route[_routes].depth = depth;
+  _routes++;
+
+  rebuild();
+
+  return true;
+}
+
+/* last route fills the gap, order doesn't matter to the sum */
+bool ModMatrix::disconnect(uint8_t source, uint8_t dest)
+{
+  uint8_t r;
+
+  for (r = 0; r < _routes; r++)
+  {
+    if ((_route[r].src == source) && (_route[r].dst == dest))
+    {
+      _route[r] = _route[--_routes];
+      rebuild();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ModMatrix::clear(void)
+{
+  _routes = 0;
+  rebuild();
+}
+
+
+/* routed destinations pick the base up in their sum, process() passes it
+ * on to the rest */
+void ModMatrix::setBase(uint8_t dest, float base)
+{
+  uint8_t v;
+
+  if (dest >= _dests) {
+    return; }
+
+  __atomic_store(&_base[dest], &base, __ATOMIC_RELAXED);
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    __atomic_fetch_or(&_stale[v], 1u << dest, __ATOMIC_RELEASE); }
+}
+
+
+void ModMatrix::tick(size_t frames)
+{
+  uint8_t i;
+
+  for (i = 0; i < _global_srcs; i++) {
+    _src[_global_src[i]][0]->update(frames); }
+}
+
+
+void ModMatrix::process(uint8_t voice, size_t frames)
+{
+  float value[MOD_SOURCES];
+  float sum[MOD_DESTINATIONS];
+  route_t const *r;
+  ParameterTarget *p;
+  Modifier *m;
+  uint32_t stale;
+  float base;
+  uint8_t i, s, d;
+
+  /* new bases for destinations nothing is routed to */
+  if (__atomic_load_n(&_stale[voice], __ATOMIC_RELAXED))
+  {
+    stale = __atomic_exchange_n(&_stale[voice], 0, __ATOMIC_ACQUIRE) & ~_routed;
+
+    while (stale)
+    {
+      d = (uint8_t)__builtin_ctz(stale);
+      stale &= stale - 1;
+
+      __atomic_load(&_base[d], &base, __ATOMIC_RELAXED);
+      if ((p = _dst[d][voice])) {
+        p->set(base); }
+    }
+  }
+
+  for (i = 0; i < _global_srcs; i++)
+  {
+    s = _global_src[i];
+    value[s] = _src[s][voice]->value();
+  }
+
+  for (i = 0; i < _voice_srcs; i++)
+  {
+    s = _voice_src[i];
+    m = _src[s][voice];
+    value[s] = m ? m->update(frames) : 0.0f;
+  }
+
+  for (i = 0; i < _used_dsts; i++)
+  {
+    d = _used_dst[i];
+    __atomic_load(&_base[d], &sum[d], __ATOMIC_RELAXED);
+  }
+
+  for (i = 0, r = _route; i < _routes; i++, r++) {
+    sum[r->dst] += r->depth * value[r->src]; }
+
+  for (i = 0; i < _used_dsts; i++)
+  {
+    d = _used_dst[i];
+    if ((p = _dst[d][voice])) {
+      p->set(sum[d]); }
+  }
+}
+
+
+/* a destination that lost its last route goes back to its base */
+void ModMatrix::rebuild(void)
+{
+  bool src[MOD_SOURCES] = {false};
+  bool dst[MOD_DESTINATIONS] = {false};
+  ParameterTarget *p;
+  uint8_t i, d, v;
+
+  for (i = 0; i < _routes; i++)
+  {
+    src[_route[i].src] = true;
+    dst[_route[i].dst] = true;
+  }
+
+  for (i = 0; i < _used_dsts; i++)
+  {
+    d = _used_dst[i];
+    if (dst[d]) {
+      continue; }
+
+    for (v = 0; v < MAX_VOICES; v++)
+    {
+      if ((p = _dst[d][v])) {
+        p->set(_base[d]); }
+    }
+  }
+
+  _voice_srcs = 0;
+  _global_srcs = 0;
+  _used_dsts = 0;
+  _routed = 0;
+
+  for (i = 0; i < _sources; i++)
+  {
+    if (false == src[i]) {
+      continue; }
+
+    if (_global[i]) {
+      _global_src[_global_srcs++] = i; }
+    else {
+      _voice_src[_voice_srcs++] = i; }
+  }
+
+  for (i = 0; i < _dests; i++)
+  {
+    if (dst[i])
+    {
+      _used_dst[_used_dsts++] = i;
+      _routed |= (1u << i);
+    }
+  }
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef MOD_MATRIX_HPP
+#define MOD_MATRIX_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "modifier.hpp"
+#include "parameter.hpp"
+
+
+/**
+ * @brief routes modifiers to parameters, depth per route, at control rate
+ *
+ * routes are a packed list of source, destination & depth, so a block costs
+ * the routes in use plus the sources & destinations they touch, never the
+ * whole sources x destinations grid. each block every routed destination
+ * gets base + sum(depth * source) through Parameter::set(), whose ramp
+ * smooths it across the block, keep modulated parameters' ramps short
+ *
+ * sources & destinations are registered per voice. a global source (mod
+ * wheel, cv) is stepped once per block in tick(), per voice ones once per
+ * voice in process(). routing changes belong in the same context as
+ * process(). setBase() is safe from anywhere & only stores the value, a
+ * destination with no routes gets it in the voice's next process()
+ */
+class ModMatrix
+{
+  public:
+    static constexpr uint8_t NONE = 0xFF;
+
+    ModMatrix(void);
+
+    /* setup, return the index to route with or NONE when full */
+    uint8_t addSource       (Modifier *const voices[MAX_VOICES]);
+    uint8_t addSource       (Modifier *global);
+    uint8_t addDestination  (ParameterTarget *const voices[MAX_VOICES], float base);
+
+    /* connecting an existing pair just changes its depth */
+    bool    connect         (uint8_t source, uint8_t dest, float depth);
+    bool    disconnect      (uint8_t source, uint8_t dest);
+    void    clear           (void);
+
+    /* unmodulated value, any context */
+    void    setBase         (uint8_t dest, float base);
+
+    /* once per block, tick() then process() for each sounding voice */
+    void    tick            (size_t frames);
+    void    process         (uint8_t voice, size_t frames);
+
+    uint8_t routes          (void) const { return _routes; }
+
+  private:
+    typedef struct
+    {
+      uint8_t src;
+      uint8_t dst;
+      float   depth;
+    } route_t;
+
+    void rebuild(void);
+
+    route_t          _route[MOD_ROUTES];      ///< packed, _routes long
+    uint8_t          _routes;
+
+    /* what the routes touch, rebuilt when they change */
+    uint8_t          _voice_src[MOD_SOURCES];
+    uint8_t          _voice_srcs;
+    uint8_t          _global_src[MOD_SOURCES];
+    uint8_t          _global_srcs;
+    uint8_t          _used_dst[MOD_DESTINATIONS];
+    uint8_t          _used_dsts;
+    uint32_t         _routed;                 ///< bit per destination
+
+    Modifier        *_src[MOD_SOURCES][MAX_VOICES];
+    bool             _global[MOD_SOURCES];
+    uint8_t          _sources;
+
+    ParameterTarget *_dst[MOD_DESTINATIONS][MAX_VOICES];
+    float            _base[MOD_DESTINATIONS];
+    uint8_t          _dests;
+
+    /* bases set since the voice's last process(), bit per destination */
+    uint32_t         _stale[MAX_VOICES];
+};
+
+
+#endif
@@ -32,5 +32,53 @@ SOFTWARE.
 
 #include "common.h"
 
+#include <stddef.h>
+
+
+/**
+ * @brief control rate modulation source, lfo, envelope, midi, cv
+ *
+ * stepped once per block by whoever owns it, the mod matrix for anything
+ * routed through it. output is nominally -1 to 1 for bipolar sources and
+ * 0 to 1 for unipolar ones, depth on the route scales it to the destination
+ */
+class Modifier
+{
+  public:
+    Modifier(void) : _value(0.0f) {}
+    virtual ~Modifier() {}
+
+    /* advance by a block, returns & holds the new output */
+    virtual float update(size_t frames) = 0;
+
+    float value(void) const { return _value; }
+
+  protected:
+    float _value;
+};
+
+
+/**
+ * @brief value set from outside the audio path, mod wheel, cc, cv. set()
+ * is a single word store so any context can call it
+ */
+class ModValue : public Modifier
+{
+  public:
+    ModValue(float value = 0.0f) : _pending(value) { _value = value; }
+
+    void set(float value) { __atomic_store(&_pending, &value, __ATOMIC_RELEASE); }
+
+    float update(size_t frames)
+    {
+      (void)frames;
+      __atomic_load(&_pending, &_value, __ATOMIC_ACQUIRE);
+      return _value;
+    }
+
+  private:
+    float _pending;
+};
+
 
 #endif
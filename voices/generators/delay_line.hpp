@@ -0,0 +1,120 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef DELAY_LINE_HPP
+#define DELAY_LINE_HPP
+
+
+#include "common.h"
+
+#include "arena.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * @brief power of 2 circular buffer, read back with linear interpolation
+ * between samples so the delay does not have to be a whole number
+ */
+class DelayLine
+{
+  public:
+    DelayLine(void) : _buf(NULL), _mask(0), _write(0) {}
+
+    /* rounds up to a power of 2, false if the arena is out of room */
+    bool init(Arena &arena, uint32_t min_samples)
+    {
+      uint32_t len = lengthFor(min_samples);
+
+      return init(arena.allocate<float>(len), len);
+    }
+
+    /* a slice of a bigger allocation, len has to be a power of 2 */
+    bool init(float *buf, uint32_t len)
+    {
+      _buf = buf;
+      _mask = buf ? (len - 1) : 0;
+      clear();
+
+      return (NULL != _buf);
+    }
+
+    /* stops at 2^31, too big for any arena so init refuses it */
+    static uint32_t lengthFor(uint32_t min_samples)
+    {
+      uint32_t len = 1;
+
+      while ((len < min_samples) && (len < 0x80000000u)) {
+        len <<= 1; }
+
+      return len;
+    }
+
+    bool     ready (void) const { return (NULL != _buf); }
+    uint32_t length(void) const { return _buf ? (_mask + 1) : 0; }
+
+    void clear(void)
+    {
+      uint32_t i;
+
+      if (_buf)
+      {
+        for (i = 0; i <= _mask; i++) {
+          _buf[i] = 0.0f; }
+      }
+
+      _write = 0;
+    }
+
+    void write(float x)
+    {
+      _buf[_write & _mask] = x;
+      _write++;
+    }
+
+    /* 1.0 is the last sample written, up to length() - 1 */
+    float read(float delay) const
+    {
+      uint32_t i = (uint32_t)delay;
+      float frac = delay - (float)i;
+      float a = _buf[(_write - i) & _mask];
+      float b = _buf[(_write - i - 1) & _mask];
+
+      return a + ((b - a) * frac);
+    }
+
+  private:
+    float   *_buf;
+    uint32_t _mask;
+    uint32_t _write;
+};
+
+
+#endif
@@ -31,6 +31,31 @@ SOFTWARE.
 
 
 #include "common.h"
+#include "number.hpp"
+
+#include <stddef.h>
+
+
+/**
+ * @brief periodic signal source, the raw material of a voice
+ * @tparam N number policy from number.hpp
+ */
+template <typename N = Float32>
+class Generator
+{
+  public:
+    typedef typename N::sample_t sample_t;
+
+    virtual ~Generator() {}
+
+    virtual void setFrequency(float hz) = 0;
+
+    /**
+     * @brief next frames, nominal range +/-1.0
+     * @param out overwritten, not accumulated
+     */
+    virtual void generate(sample_t *out, size_t frames) = 0;
+};
 
 
 #endif
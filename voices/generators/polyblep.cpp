@@ -0,0 +1,238 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "polyblep.hpp"
+
+#include "arm_math.h"
+
+
+#define Q15_TO_FLOAT      (1.0f / 32768.0f)
+#define PHASE_TO_FLOAT    (1.0f / 4294967296.0f)
+
+/* pulls the triangle back to zero so it can't drift after a pitch change */
+#define TRI_LEAK          0.0005f
+
+
+static void  triangle (PolyBlep::state_t &state, float *out, size_t frames);
+static float blep     (float t, float dt);
+static void  edges    (float *out, size_t frames, uint32_t phase, uint32_t inc, float sign);
+
+
+PolyBlep::PolyBlep(shape_e shape)
+  : _shape(shape)
+{
+  reset();
+}
+
+
+void PolyBlep::setFrequency(float hz)
+{
+  float inc = hz * (4294967296.0f / SAMPLE_RATE);
+
+  _state.inc = (inc >= (float)MAX_INC) ? MAX_INC : (inc > 0.0f) ? (uint32_t)inc : 0;
+}
+
+
+void PolyBlep::reset(void)
+{
+  _state.phase = 0;
+  _state.tri = -1.0f;
+}
+
+
+void PolyBlep::generate(float *out, size_t frames)
+{
+#if POLYBLEP_BLOCK_KERNEL
+  renderBlock(_state, _shape, out, frames);
+#else
+  renderScalar(_state, _shape, out, frames);
+#endif
+}
+
+
+void PolyBlep::renderScalar(state_t &state, shape_e shape, float *out, size_t frames)
+{
+  float dt = (float)state.inc * PHASE_TO_FLOAT;
+  uint32_t phase = state.phase;
+  float t, t2;
+  size_t i;
+
+  for (i = 0; i < frames; i++)
+  {
+    t = (float)phase * PHASE_TO_FLOAT;
+
+    if (SHAPE_SAW == shape)
+    {
+      out[i] = ((2.0f * t) - 1.0f) - blep(t, dt);
+    }
+    else
+    {
+      t2 = (float)(phase + 0x80000000u) * PHASE_TO_FLOAT;
+      out[i] = ((phase < 0x80000000u) ? 1.0f : -1.0f) + blep(t, dt) - blep(t2, dt);
+    }
+
+    phase += state.inc;
+  }
+
+  state.phase = phase;
+
+  if (SHAPE_TRIANGLE == shape) {
+    triangle(state, out, frames); }
+}
+
+
+/* two samples a pass, the top halves of both phases packed into one word
+ * for the m4 simd instructions. 16 bits is all the codec takes, the edges
+ * are still placed from the full 32 bit phase */
+void PolyBlep::renderBlock(state_t &state, shape_e shape, float *out, size_t frames)
+{
+  uint32_t phase = state.phase;
+  uint32_t inc = state.inc;
+  uint32_t pair;
+  size_t i;
+
+  if (SHAPE_SAW == shape)
+  {
+    for (i = 0; (i + 1) < frames; i += 2)
+    {
+      pair = (uint32_t)__PKHTB(phase + inc, phase, 16) ^ 0x80008000u;
+      out[i]     = (float)(int16_t)pair * Q15_TO_FLOAT;
+      out[i + 1] = (float)((int32_t)pair >> 16) * Q15_TO_FLOAT;
+      phase += inc + inc;
+    }
+
+    if (i < frames)
+    {
+      out[i] = (float)(int16_t)((phase >> 16) ^ 0x8000u) * Q15_TO_FLOAT;
+      phase += inc;
+    }
+
+    edges(out, frames, state.phase, inc, 1.0f);
+  }
+  else
+  {
+    /* saw half a cycle ahead minus saw, halved so each lane is exactly
+     * +/-0.5 rather than saturating one side short of 1 */
+    for (i = 0; (i + 1) < frames; i += 2)
+    {
+      pair = (uint32_t)__PKHTB(phase + inc, phase, 16);
+      pair = __SHSUB16(pair, pair ^ 0x80008000u);
+      out[i]     = (float)(int16_t)pair * (2.0f * Q15_TO_FLOAT);
+      out[i + 1] = (float)((int32_t)pair >> 16) * (2.0f * Q15_TO_FLOAT);
+      phase += inc + inc;
+    }
+
+    if (i < frames)
+    {
+      out[i] = (phase < 0x80000000u) ? 1.0f : -1.0f;
+      phase += inc;
+    }
+
+    edges(out, frames, state.phase + 0x80000000u, inc, 1.0f);
+    edges(out, frames, state.phase, inc, -1.0f);
+  }
+
+  state.phase = phase;
+
+  if (SHAPE_TRIANGLE == shape) {
+    triangle(state, out, frames); }
+}
+
+
+/* serial by nature, shared by both kernels */
+static void triangle(PolyBlep::state_t &state, float *out, size_t frames)
+{
+  float gain = 4.0f * (float)state.inc * PHASE_TO_FLOAT;
+  float y = state.tri;
+  size_t i;
+
+  for (i = 0; i < frames; i++)
+  {
+    y += (gain * out[i]) - (TRI_LEAK * y);
+    out[i] = y;
+  }
+
+  state.tri = y;
+}
+
+
+/* correction to subtract from a rising saw, t is phase 0-1 */
+static float blep(float t, float dt)
+{
+  if (t < dt)
+  {
+    t /= dt;
+    return (t + t) - (t * t) - 1.0f;
+  }
+
+  if (t > (1.0f - dt))
+  {
+    t = (t - 1.0f) / dt;
+    return (t * t) + (t + t) + 1.0f;
+  }
+
+  return 0.0f;
+}
+
+
+/**
+ * @brief add the step correction for every wrap of a saw ramp
+ *
+ * sample n is the first after a wrap when its phase < inc, r = phase/ inc
+ * is how far past the edge it landed. n gets +(1 - r)^2 and n - 1 gets -r^2,
+ * n == frames is the first sample of the next block so only n - 1 is done
+ */
+static void edges(float *out, size_t frames, uint32_t phase, uint32_t inc, float sign)
+{
+  float inv, r;
+  uint32_t p;
+  size_t n;
+
+  if (0 == inc) {
+    return; }
+
+  inv = 1.0f / (float)inc;
+
+  /* steps to the first wrap, 0 if sample 0 is already past one */
+  n = (phase < inc) ? 0 : ((((0u - phase) - 1) / inc) + 1);
+
+  while (n <= frames)
+  {
+    p = phase + ((uint32_t)n * inc);
+    r = (float)p * inv;
+
+    if (n < frames) {
+      out[n] += sign * ((1.0f - r) * (1.0f - r)); }
+
+    if (n > 0) {
+      out[n - 1] -= sign * (r * r); }
+
+    n += (((0u - p) - 1) / inc) + 1;
+  }
+}
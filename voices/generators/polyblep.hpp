@@ -0,0 +1,99 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef POLYBLEP_HPP
+#define POLYBLEP_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "generator.hpp"
+
+
+/* the block kernel leans on the m4 simd instructions, the host
+ * defaults to the scalar reference. -DPOLYBLEP_BLOCK_KERNEL=0/1 to force */
+#ifndef POLYBLEP_BLOCK_KERNEL
+  #ifdef HOST
+    #define POLYBLEP_BLOCK_KERNEL   0
+  #else
+    #define POLYBLEP_BLOCK_KERNEL   1
+  #endif
+#endif
+
+
+/**
+ * @brief virtual analog oscillator, naive waveform with a polynomial band
+ * limited step at every discontinuity
+ *
+ * two kernels render the same thing. the scalar one tests every sample for
+ * a nearby edge & is the reference. the block one writes the naive ramp
+ * two samples at a time in packed 16 bit with no branches then works out
+ * where the phase wraps & corrects just the two samples either side of
+ * each edge
+ */
+class PolyBlep : public Generator<>
+{
+  public:
+    typedef enum
+    {
+      SHAPE_SAW,
+      SHAPE_SQUARE,
+      SHAPE_TRIANGLE,         ///< leaky integral of the square
+      SHAPE_NUM_OF,
+    } shape_e;
+
+    typedef struct
+    {
+      uint32_t phase;         ///< 2^32 per cycle
+      uint32_t inc;
+      float    tri;           ///< integrator
+    } state_t;
+
+    /* a step needs a couple of samples to resolve, fs/4 at most */
+    static constexpr uint32_t MAX_INC = (1u << 30);
+
+    PolyBlep(shape_e shape = SHAPE_SAW);
+
+    void setShape(shape_e shape) { _shape = shape; }
+    void setFrequency(float hz);
+    void reset(void);
+
+    void generate(float *out, size_t frames);
+
+    /* generate() uses whichever POLYBLEP_BLOCK_KERNEL picks */
+    static void renderScalar(state_t &state, shape_e shape, float *out, size_t frames);
+    static void renderBlock (state_t &state, shape_e shape, float *out, size_t frames);
+
+  private:
+    state_t _state;
+    shape_e _shape;
+};
+
+
+#endif
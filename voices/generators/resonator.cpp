@@ -0,0 +1,234 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "resonator.hpp"
+
+#include <cmath>
+
+
+#define TWO_PI            6.2831853f
+#define NOISE_TO_FLOAT    (1.0f / 2147483648.0f)
+
+/* a click rather than a burst, so the modes ring at their own pitch */
+#define STRIKE_SAMPLES    4
+
+/* the modes together peak around the level of one string */
+#define MODAL_GAIN        0.5f
+
+
+/* free bar, rigidly these are (2n + 1)^2 / 9 apart */
+static float const mode_ratio[Resonator::MODES] = {1.0f, 2.756f, 5.404f, 8.933f};
+static float const mode_mix[Resonator::MODES]   = {1.0f, 0.6f, 0.4f, 0.3f};
+
+
+Resonator::Resonator(void)
+  : _coeff(0.5f),
+    _lines(0),
+    _mode(MODE_STRING),
+    _hz(220.0f),
+    _decay(2.0f),
+    _brightness(0.5f),
+    _changed(true),
+    _burst(0),
+    _level(0.0f),
+    _noise(22222)
+{
+  uint32_t m;
+
+  for (m = 0; m < MODES; m++)
+  {
+    _delay[m] = 1.0f;
+    _feedback[m] = 0.0f;
+    _lp[m] = 0.0f;
+  }
+}
+
+
+bool Resonator::init(Arena &arena, mode_e mode, float lowest_hz)
+{
+  uint32_t len[MODES];
+  uint32_t total = 0;
+  float *mem;
+  uint32_t m;
+
+  _mode = mode;
+  _lines = (MODE_MODAL == mode) ? MODES : 1;
+
+  if (lowest_hz < 1.0f) {
+    lowest_hz = 1.0f; }
+
+  /* room for the longest loop plus the interpolation tap */
+  for (m = 0; m < _lines; m++)
+  {
+    len[m] = DelayLine::lengthFor((uint32_t)((float)SAMPLE_RATE / (lowest_hz * mode_ratio[m])) + 2);
+    total += len[m];
+  }
+
+  /* one allocation, so a resonator either fits whole or takes nothing */
+  mem = arena.allocate<float>(total);
+
+  for (m = 0; m < MODES; m++)
+  {
+    if (mem && (m < _lines))
+    {
+      _line[m].init(mem, len[m]);
+      mem += len[m];
+    }
+    else
+    {
+      _line[m].init(NULL, 0);
+    }
+  }
+
+  if (false == ready()) {
+    _lines = 0; }
+
+  _changed = true;
+
+  return ready();
+}
+
+
+void Resonator::setFrequency(float hz)
+{
+  _hz = hz;
+  _changed = true;
+}
+
+
+void Resonator::setDecay(float seconds)
+{
+  _decay = seconds;
+  _changed = true;
+}
+
+
+void Resonator::setBrightness(float brightness)
+{
+  _brightness = (brightness < 0.0f) ? 0.0f : (brightness > 1.0f) ? 1.0f : brightness;
+  _changed = true;
+}
+
+
+void Resonator::excite(float level)
+{
+  _level = level;
+  _burst = (MODE_MODAL == _mode) ? STRIKE_SAMPLES : (uint32_t)(_delay[0] + 1.0f);
+}
+
+
+void Resonator::generate(float *out, size_t frames)
+{
+  float exc[BLOCK_SIZE];
+  float mix, y, lp, delay, feedback;
+  DelayLine *line;
+  size_t n, i;
+  uint32_t m;
+
+  if (false == ready())
+  {
+    for (i = 0; i < frames; i++) {
+      out[i] = 0.0f; }
+    return;
+  }
+
+  if (_changed) {
+    tune(); }
+
+  while (frames)
+  {
+    n = (frames > BLOCK_SIZE) ? BLOCK_SIZE : frames;
+
+    for (i = 0; i < n; i++)
+    {
+      exc[i] = 0.0f;
+      out[i] = 0.0f;
+
+      if (_burst)
+      {
+        _noise = (_noise * 1664525u) + 1013904223u;
+        exc[i] = (MODE_MODAL == _mode) ? _level : ((float)(int32_t)_noise * NOISE_TO_FLOAT * _level);
+        _burst--;
+      }
+    }
+
+    /* a loop at a time, its state stays in registers across the block */
+    for (m = 0; m < _lines; m++)
+    {
+      line = &_line[m];
+      delay = _delay[m];
+      feedback = _feedback[m];
+      lp = _lp[m];
+      mix = (MODE_MODAL == _mode) ? (mode_mix[m] * MODAL_GAIN) : 1.0f;
+
+      for (i = 0; i < n; i++)
+      {
+        y = line->read(delay);
+        lp += (y - lp) * _coeff;
+        line->write((lp * feedback) + exc[i]);
+        out[i] += y * mix;
+      }
+
+      _lp[m] = lp;
+    }
+
+    out += n;
+    frames -= n;
+  }
+}
+
+
+void Resonator::tune(void)
+{
+  float period, w, phase, max;
+  float a;
+  uint32_t m;
+
+  _changed = false;
+
+  /* fully dark still lets the fundamental through */
+  _coeff = 0.1f + (0.9f * _brightness);
+  a = 1.0f - _coeff;
+
+  for (m = 0; m < _lines; m++)
+  {
+    period = (float)SAMPLE_RATE / (_hz * mode_ratio[m]);
+
+    /* the loop filter delays the fundamental too, take it off the line */
+    w = TWO_PI / period;
+    phase = atan2f(a * sinf(w), 1.0f - (a * cosf(w)));
+    _delay[m] = period - (phase / w);
+
+    max = (float)(_line[m].length() - 2);
+    _delay[m] = (_delay[m] < 1.0f) ? 1.0f : (_delay[m] > max) ? max : _delay[m];
+
+    /* higher modes die away sooner */
+    _feedback[m] = powf(10.0f, (-3.0f * period) / ((_decay / sqrtf(mode_ratio[m])) * SAMPLE_RATE));
+  }
+}
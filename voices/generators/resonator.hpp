@@ -0,0 +1,99 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef RESONATOR_HPP
+#define RESONATOR_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "delay_line.hpp"
+#include "generator.hpp"
+
+
+/**
+ * @brief struck & plucked physical models built from tuned delay loops
+ *
+ * string mode is karplus strong, a noise burst circulating round one loop
+ * with a lowpass in it. modal mode runs a loop per mode of a free bar at
+ * its inharmonic ratio, each decaying faster the higher it is, & strikes
+ * them all with a click. the loops come from an Arena sized for the
+ * lowest note, a resonator that does not fit stays silent
+ */
+class Resonator : public Generator<>
+{
+  public:
+    typedef enum
+    {
+      MODE_STRING,
+      MODE_MODAL,
+      MODE_NUM_OF,
+    } mode_e;
+
+    static constexpr uint32_t MODES = 4;
+
+    Resonator(void);
+
+    /* false if the arena is out of room, generate() then outputs silence */
+    bool init(Arena &arena, mode_e mode, float lowest_hz);
+    bool ready(void) const { return _line[0].ready(); }
+
+    /* take effect from the next generate() */
+    void setFrequency (float hz);
+    void setDecay     (float seconds);        ///< -60 dB, fundamental
+    void setBrightness(float brightness);     ///< 0 - 1, loop lowpass
+
+    void excite(float level);
+
+    void generate(float *out, size_t frames);
+
+  private:
+    void tune(void);
+
+    DelayLine _line[MODES];
+    float    _delay[MODES];             ///< read point, samples
+    float    _feedback[MODES];
+    float    _lp[MODES];                ///< loop filter state
+    float    _coeff;                    ///< loop filter
+    uint32_t _lines;
+
+    mode_e   _mode;
+    float    _hz;
+    float    _decay;
+    float    _brightness;
+    bool     _changed;
+
+    uint32_t _burst;                    ///< excitation samples still to go
+    float    _level;
+    uint32_t _noise;
+};
+
+
+#endif
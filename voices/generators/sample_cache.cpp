@@ -0,0 +1,158 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "sample_cache.hpp"
+
+#include <string.h>
+
+
+static_assert(SampleCache::SLOTS > 0, "SAMPLE_CACHE_BYTES too small for one attack");
+static_assert(SampleCache::SLOTS <= 32, "pinned slots are a 32 bit mask");
+static_assert(0 == (SampleCache::SLOT_BYTES & 3), "cached frames have to stay aligned");
+
+
+SampleCache::SampleCache(void)
+{
+  clear();
+}
+
+
+int16_t const *SampleCache::find(Sampler::region_t const &region, uint32_t *frames)
+{
+  uint32_t i;
+
+  for (i = 0; i < SLOTS; i++)
+  {
+    if ((SLOT_READY == _state[i]) && (region.addr == _addr[i]))
+    {
+      _stamp[i] = ++_clock;
+      _hits++;
+      *frames = _frames[i];
+      return framesOf(i);
+    }
+  }
+
+  _misses++;
+  *frames = 0;
+
+  return NULL;
+}
+
+
+void SampleCache::clear(void)
+{
+  memset(_addr, 0, sizeof(_addr));
+  memset(_frames, 0, sizeof(_frames));
+  memset(_stamp, 0, sizeof(_stamp));
+  memset((void *)_state, SLOT_EMPTY, sizeof(_state));
+  _clock = 0;
+  _hits = 0;
+  _misses = 0;
+  _evictions = 0;
+}
+
+
+uint32_t SampleCache::resident(void) const
+{
+  uint32_t count = 0;
+  uint32_t i;
+
+  for (i = 0; i < SLOTS; i++)
+  {
+    if (SLOT_READY == _state[i]) {
+      count++; }
+  }
+
+  return count;
+}
+
+
+int32_t SampleCache::claim(Sampler::region_t const &region, uint32_t pinned)
+{
+  int32_t victim = -1;
+  uint32_t i;
+
+  for (i = 0; i < SLOTS; i++)
+  {
+    /* already here or on its way */
+    if ((SLOT_EMPTY != _state[i]) && (region.addr == _addr[i])) {
+      return (int32_t)i; }
+
+    if ((SLOT_LOADING == _state[i]) || (pinned & (1u << i))) {
+      continue; }
+
+    /* empty slots first, then least recently played */
+    if ((-1 == victim)
+    ||  ((SLOT_EMPTY != _state[victim]) && ((SLOT_EMPTY == _state[i]) || (_stamp[i] < _stamp[victim]))))
+    {
+      victim = (int32_t)i;
+    }
+  }
+
+  if (-1 == victim) {
+    return -1; }
+
+  if (SLOT_READY == _state[victim]) {
+    _evictions++; }
+
+  _addr[victim] = region.addr;
+  _frames[victim] = (region.frames < ATTACK_FRAMES) ? region.frames : ATTACK_FRAMES;
+  _stamp[victim] = ++_clock;
+  _state[victim] = SLOT_QUEUED;
+
+  return victim;
+}
+
+
+int32_t SampleCache::queued(void) const
+{
+  uint32_t i;
+
+  for (i = 0; i < SLOTS; i++)
+  {
+    if (SLOT_QUEUED == _state[i]) {
+      return (int32_t)i; }
+  }
+
+  return -1;
+}
+
+
+int32_t SampleCache::slotOf(int16_t const *frames) const
+{
+  uint32_t i;
+
+  for (i = 0; i < SLOTS; i++)
+  {
+    if (frames == framesOf(i)) {
+      return (int32_t)i; }
+  }
+
+  return -1;
+}
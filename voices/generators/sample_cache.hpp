@@ -0,0 +1,117 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef SAMPLE_CACHE_HPP
+#define SAMPLE_CACHE_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "sampler.hpp"
+
+
+/**
+ * @brief first few ms of flash samples kept in ram
+ *
+ * a voice plays the cached attack straight away while its ring fills
+ * behind it. the library can be bigger than the cache, the least recently
+ * played sample is dropped to make room. slots are loaded by the
+ * SampleStreamer when the bus has nothing more urgent to do, never while a
+ * voice is still playing out of them
+ */
+class SampleCache
+{
+  public:
+    static constexpr uint32_t ATTACK_FRAMES =
+      ((((SAMPLE_CACHE_ATTACK_MS * SAMPLE_RATE) / 1000) + Sampler::CHUNK_FRAMES - 1) / Sampler::CHUNK_FRAMES) * Sampler::CHUNK_FRAMES;
+    static constexpr uint32_t SLOT_BYTES = W25Q_READ_HEADER + (ATTACK_FRAMES * 2);
+    static constexpr uint32_t SLOTS = SAMPLE_CACHE_BYTES / SLOT_BYTES;
+
+    SampleCache(void);
+
+    /**
+     * @brief a hit touches the slot for the lru
+     * @param frames set to how many frames are in ram
+     * @return the cached frames, NULL on a miss or while still loading
+     */
+    int16_t const *find(Sampler::region_t const &region, uint32_t *frames);
+
+    /* drop everything, eg. a new library was written to flash */
+    void clear(void);
+
+    uint32_t hits     (void) const { return _hits; }
+    uint32_t misses   (void) const { return _misses; }
+    uint32_t evictions(void) const { return _evictions; }
+    uint32_t resident (void) const;
+
+  private:
+    friend class SampleStreamer;
+
+    typedef enum
+    {
+      SLOT_EMPTY,
+      SLOT_QUEUED,              ///< claimed, waiting for the bus
+      SLOT_LOADING,             ///< read in flight
+      SLOT_READY,
+    } slot_e;
+
+    /**
+     * @brief slot for a region, queued for loading if it isn't already
+     * @param pinned slots voices are playing out of, bit per slot
+     * @return slot index, -1 if every slot is pinned or loading
+     */
+    int32_t claim(Sampler::region_t const &region, uint32_t pinned);
+
+    /* next slot waiting for the bus, -1 for none */
+    int32_t queued(void) const;
+
+    /* which slot a pointer from find() came from, -1 for none */
+    int32_t slotOf(int16_t const *frames) const;
+
+    int16_t const *framesOf(uint32_t slot) const
+    {
+      return (int16_t const *)&_data[slot][W25Q_READ_HEADER];
+    }
+
+    uint32_t _addr[SLOTS];
+    uint32_t _frames[SLOTS];
+    uint32_t _stamp[SLOTS];             ///< _clock when last played
+    volatile uint8_t _state[SLOTS];
+
+    uint32_t _clock;
+    uint32_t _hits;
+    uint32_t _misses;
+    uint32_t _evictions;
+
+    alignas(4) uint8_t _data[SLOTS][SLOT_BYTES];
+};
+
+
+#endif
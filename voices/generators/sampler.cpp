@@ -0,0 +1,385 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "sampler.hpp"
+#include "sample_cache.hpp"
+
+#include <string.h>
+
+
+#define PCM_TO_FLOAT      (1.0f / 32768.0f)
+#define FRAC_TO_FLOAT     (1.0f / 65536.0f)
+
+
+static_assert(0 == (Sampler::CHUNKS & (Sampler::CHUNKS - 1)), "chunk ring is indexed by mask");
+static_assert(0 == (SampleCache::ATTACK_FRAMES % Sampler::CHUNK_FRAMES), "the ring picks up where the attack ends");
+static_assert((Sampler::MAX_RATE * BLOCK_SIZE) <= ((Sampler::CHUNKS - 1) * Sampler::CHUNK_FRAMES * Sampler::RATE_ONE),
+              "a block at full rate has to fit in the ring with a chunk still being read");
+
+
+Sampler::Sampler(void)
+  : _attack(NULL),
+    _attack_frames(0),
+    _base(0),
+    _pos(0),
+    _frac(0),
+    _rate(RATE_ONE),
+    _underruns(0),
+    _playing(false),
+    _started(false),
+    _head(0),
+    _done(0),
+    _tail(0),
+    _gen(0)
+{
+  memset(&_region, 0, sizeof(_region));
+}
+
+
+void Sampler::play(region_t const &region,
+                   int16_t const *attack,
+                   uint32_t attack_frames)
+{
+  /* generate leaves a stopped voice alone while it is reset */
+  _playing = false;
+
+  _gen++;
+  _region = region;
+  _attack = attack;
+  _attack_frames = attack ? attack_frames : 0;
+  _base = (_attack_frames + CHUNK_FRAMES - 1) >> CHUNK_BITS;
+  _pos = 0;
+  _frac = 0;
+  _head = _base;
+  _done = _base;
+  _tail = 0;
+  _started = false;
+
+  _playing = (region.frames > 0);
+}
+
+
+void Sampler::stop(void)
+{
+  _playing = false;
+}
+
+
+void Sampler::setFrequency(float hz)
+{
+  float rate = RATE_ONE;
+
+  if (_region.root_hz > 0.0f) {
+    rate = (hz / _region.root_hz) * (float)RATE_ONE; }
+
+  _rate = (rate >= (float)MAX_RATE) ? MAX_RATE : (rate >= 1.0f) ? (uint32_t)rate : 1;
+}
+
+
+void Sampler::generate(float *out, size_t frames)
+{
+  uint32_t total = _region.frames;
+  uint32_t pos = _pos;
+  uint32_t frac = _frac;
+  uint32_t avail;
+  uint32_t next;
+  float a, b;
+  size_t i = 0;
+
+  if (_playing)
+  {
+    /* landed frames, fixed for the block even if another read finishes */
+    avail = _done * CHUNK_FRAMES;
+    if (avail > total) {
+      avail = total; }
+
+    /* waiting on the very first read is start up latency, not an underrun */
+    if (avail) {
+      _started = true; }
+
+    for (; i < frames; i++)
+    {
+      if (pos >= total)
+      {
+        _playing = false;
+        break;
+      }
+
+      next = pos + 1;
+
+      if ((next >= avail) && (avail != total))
+      {
+        if (_started) {
+          _underruns++; }
+        break;
+      }
+
+      a = (float)frameAt(pos);
+      b = (next < total) ? (float)frameAt(next) : 0.0f;
+
+      out[i] = (a + ((b - a) * ((float)frac * FRAC_TO_FLOAT))) * PCM_TO_FLOAT;
+
+      frac += _rate;
+      pos += frac >> 16;
+      frac &= 0xFFFF;
+    }
+
+    _pos = pos;
+    _frac = frac;
+
+    /* chunks wholly behind the playhead can be read over */
+    _tail = pos >> CHUNK_BITS;
+  }
+
+  for (; i < frames; i++) {
+    out[i] = 0.0f; }
+}
+
+
+uint32_t Sampler::runway(void) const
+{
+  uint32_t avail = _done * CHUNK_FRAMES;
+
+  if (avail > _region.frames) {
+    avail = _region.frames; }
+
+  if (avail <= _pos) {
+    return 0; }
+
+  return (uint32_t)(((uint64_t)(avail - _pos) << 16) / _rate);
+}
+
+
+bool Sampler::wantsChunk(void) const
+{
+  uint32_t tail = _tail;
+
+  /* chunks under the attack never use the ring */
+  if (tail < _base) {
+    tail = _base; }
+
+  return _playing
+      && ((_head - tail) < CHUNKS)
+      && ((_head * CHUNK_FRAMES) < _region.frames);
+}
+
+
+SampleStreamer::SampleStreamer(void)
+  : _count(0),
+    _cache(NULL),
+    _inflight(NULL),
+    _fill(-1),
+    _gen(0),
+    _busy(false),
+    _reads(0),
+    _errors(0)
+{
+}
+
+
+bool SampleStreamer::attach(Sampler &voice)
+{
+  if (_count >= MAX_VOICES) {
+    return false; }
+
+  _voices[_count++] = &voice;
+
+  return true;
+}
+
+
+void SampleStreamer::play(Sampler &voice, Sampler::region_t const &region)
+{
+  int16_t const *attack = NULL;
+  uint32_t frames = 0;
+
+  if (_cache)
+  {
+    attack = _cache->find(region, &frames);
+
+    if (NULL == attack) {
+      preload(region); }
+  }
+
+  voice.play(region, attack, frames);
+}
+
+
+bool SampleStreamer::preload(Sampler::region_t const &region)
+{
+  if (NULL == _cache) {
+    return false; }
+
+  return (_cache->claim(region, pinned()) >= 0);
+}
+
+
+void SampleStreamer::service(void)
+{
+  if (false == _busy) {
+    startNext(); }
+}
+
+
+void SampleStreamer::startNext(void)
+{
+  Sampler *voice = NULL;
+  uint32_t best = UINT32_MAX;
+  uint32_t runway;
+  uint32_t seq;
+  uint32_t first;
+  uint32_t frames;
+  int32_t slot;
+  uint8_t i;
+
+  /* earliest deadline first */
+  for (i = 0; i < _count; i++)
+  {
+    if (false == _voices[i]->wantsChunk()) {
+      continue; }
+
+    runway = _voices[i]->runway();
+
+    if ((NULL == voice) || (runway < best))
+    {
+      voice = _voices[i];
+      best = runway;
+    }
+  }
+
+  if (NULL == voice)
+  {
+    if (_cache && ((slot = _cache->queued()) >= 0)) {
+      startFill(slot); }
+    return;
+  }
+
+  seq = voice->_head;
+  first = seq * Sampler::CHUNK_FRAMES;
+  frames = voice->_region.frames - first;
+  if (frames > Sampler::CHUNK_FRAMES) {
+    frames = Sampler::CHUNK_FRAMES; }
+
+  _busy = true;
+  _inflight = voice;
+  _gen = voice->_gen;
+  voice->_head = seq + 1;
+  _reads++;
+
+  if (false == W25Q_read(voice->_region.addr + (first * 2),
+                         voice->_chunk[seq & (Sampler::CHUNKS - 1)],
+                         (uint16_t)(frames * 2),
+                         readDone,
+                         this))
+  {
+    voice->_head = seq;
+    _reads--;
+    _errors++;
+    _busy = false;
+  }
+}
+
+
+void SampleStreamer::startFill(int32_t slot)
+{
+  _busy = true;
+  _inflight = NULL;
+  _fill = slot;
+  _cache->_state[slot] = SampleCache::SLOT_LOADING;
+  _reads++;
+
+  if (false == W25Q_read(_cache->_addr[slot],
+                         _cache->_data[slot],
+                         (uint16_t)(_cache->_frames[slot] * 2),
+                         readDone,
+                         this))
+  {
+    _cache->_state[slot] = SampleCache::SLOT_QUEUED;
+    _reads--;
+    _errors++;
+    _busy = false;
+  }
+}
+
+
+uint32_t SampleStreamer::pinned(void) const
+{
+  uint32_t mask = 0;
+  int32_t slot;
+  uint8_t i;
+
+  for (i = 0; i < _count; i++)
+  {
+    if ((false == _voices[i]->_playing)
+    ||  (_voices[i]->_pos >= _voices[i]->_attack_frames)) {
+      continue; }
+
+    slot = _cache->slotOf(_voices[i]->_attack);
+
+    if (slot >= 0) {
+      mask |= (1u << slot); }
+  }
+
+  return mask;
+}
+
+
+void SampleStreamer::readDone(bool done, bool error, void *ctx)
+{
+  SampleStreamer *s = (SampleStreamer *)ctx;
+  Sampler *voice = s->_inflight;
+
+  /* half of the chunk is no use, wait for the rest */
+  if ((false == done) && (false == error)) {
+    return; }
+
+  if (NULL == voice)
+  {
+    s->_cache->_state[s->_fill] = error ? SampleCache::SLOT_QUEUED : SampleCache::SLOT_READY;
+  }
+  /* the voice was retriggered while this was in flight, throw it away */
+  else if (voice->_gen == s->_gen)
+  {
+    if (error) {
+      voice->_head = voice->_head - 1; }
+    else {
+      voice->_done = voice->_done + 1; }
+  }
+
+  s->_busy = false;
+
+  /* leave a failing bus to the next service() rather than spin in the irq */
+  if (error)
+  {
+    s->_errors++;
+    return;
+  }
+
+  s->startNext();
+}
@@ -0,0 +1,181 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "generator.hpp"
+#include "chips.h"
+
+
+class SampleCache;
+
+
+/**
+ * @brief plays a 16 bit mono sample streamed out of the w25q flash
+ *
+ * each voice owns a small ring of chunks that the SampleStreamer keeps
+ * topped up ahead of the playhead with dma reads. generate() only ever
+ * reads chunks that have already landed, so rendering never waits on the
+ * bus. if the playhead catches up with the reads the voice holds where it
+ * is, outputs silence for the rest of the block & counts an underrun.
+ * frames already in ram (see SampleCache) are played from there while the
+ * ring fills with what comes after them
+ */
+class Sampler : public Generator<>
+{
+  public:
+    /* where a sample lives in flash */
+    typedef struct
+    {
+      uint32_t addr;            ///< byte address of the first frame
+      uint32_t frames;
+      float    root_hz;         ///< pitch it was recorded at
+    } region_t;
+
+    static constexpr uint32_t CHUNK_BITS = 7;
+    static constexpr uint32_t CHUNK_FRAMES = (1u << CHUNK_BITS);
+    static constexpr uint32_t CHUNKS = 4;           ///< power of 2
+
+    /* playback rate, 16.16 fixed point. 2 octaves up at most */
+    static constexpr uint32_t RATE_ONE = (1u << 16);
+    static constexpr uint32_t MAX_RATE = (4u * RATE_ONE);
+
+    Sampler(void);
+
+    /* main loop only, same context as SampleStreamer::service
+     * attack is the first attack_frames of the region if they are in ram */
+    void play(region_t const &region,
+              int16_t const *attack = NULL,
+              uint32_t attack_frames = 0);
+    void stop(void);
+
+    bool     playing(void) const { return _playing; }
+    uint32_t underruns(void) const { return _underruns; }
+
+    /* relative to region.root_hz */
+    void setFrequency(float hz);
+
+    void generate(float *out, size_t frames);
+
+  private:
+    friend class SampleStreamer;
+
+    /* frames of output left before the playhead runs out of data */
+    uint32_t runway(void) const;
+    bool     wantsChunk(void) const;
+
+    int16_t  frameAt(uint32_t frame) const
+    {
+      if (frame < _attack_frames) {
+        return _attack[frame]; }
+
+      return ((int16_t const *)&_chunk[(frame >> CHUNK_BITS) & (CHUNKS - 1)][W25Q_READ_HEADER])[frame & (CHUNK_FRAMES - 1)];
+    }
+
+    region_t _region;
+    int16_t const *_attack;
+    uint32_t _attack_frames;
+    uint32_t _base;                     ///< first chunk not covered by the attack
+    uint32_t _pos;                      ///< playhead, whole frames
+    uint32_t _frac;                     ///< & 16 bit fraction
+    uint32_t _rate;
+    uint32_t _underruns;
+    bool     _playing;
+    bool     _started;                  ///< first chunk landed
+
+    /* chunk sequence numbers, chunk n holds frames n * CHUNK_FRAMES on */
+    volatile uint32_t _head;            ///< requested, by the streamer
+    volatile uint32_t _done;            ///< landed, by the spi callback
+    volatile uint32_t _tail;            ///< finished with, by generate
+    uint32_t _gen;                      ///< bumped by play, drops stale reads
+
+    alignas(4) uint8_t _chunk[CHUNKS][W25Q_READ_HEADER + (CHUNK_FRAMES * 2)];
+};
+
+
+/**
+ * @brief shares the flash bus between sampler voices
+ *
+ * one read is in flight at a time, always for the voice closest to running
+ * dry, cache loads when no voice needs anything. each read chains the next
+ * from its completion callback, service() only has to restart the chain
+ * once the rings are full & the bus goes idle
+ */
+class SampleStreamer
+{
+  public:
+    SampleStreamer(void);
+
+    bool attach(Sampler &voice);
+    void setCache(SampleCache &cache) { _cache = &cache; }
+
+    /**
+     * @brief note on through the cache. a hit starts from ram, a miss
+     * streams from the first chunk & queues the attack for next time
+     */
+    void play(Sampler &voice, Sampler::region_t const &region);
+
+    /* queue a sample's attack into the cache, eg. for every mapped sample at
+     * start up. false if every slot is in use */
+    bool preload(Sampler::region_t const &region);
+
+    /* main loop, starts a read if the bus is idle & a voice has room */
+    void service(void);
+
+    uint32_t reads (void) const { return _reads; }
+    uint32_t errors(void) const { return _errors; }
+
+  private:
+    static void readDone(bool done, bool error, void *ctx);
+
+    void startNext(void);
+    void startFill(int32_t slot);
+    uint32_t pinned(void) const;
+
+    Sampler *_voices[MAX_VOICES];
+    uint8_t  _count;
+    SampleCache *_cache;
+
+    /* the read in flight, a cache slot when there is no voice */
+    Sampler * volatile _inflight;
+    int32_t  _fill;
+    uint32_t _gen;
+    volatile bool _busy;
+
+    uint32_t _reads;
+    uint32_t _errors;
+};
+
+
+#endif
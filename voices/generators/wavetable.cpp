@@ -0,0 +1,203 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "wavetable.hpp"
+
+
+/* arm_math.h has a float PI */
+#define PI_F64    3.14159265358979323846
+
+
+typedef struct
+{
+  float sine[Wavetable::LENGTH + 1];
+  float shapes[Wavetable::SHAPE_NUM_OF - 1][Wavetable::LEVELS][Wavetable::LENGTH + 1];
+} tables_t;
+
+
+/* only ever evaluated by the compiler, precision is free */
+static constexpr double sine(double x)
+{
+  double term = 0.0;
+  double sum = 0.0;
+  int n = 0;
+
+  while (x > PI_F64) {
+    x -= 2.0 * PI_F64; }
+
+  term = x;
+  sum = x;
+
+  for (n = 1; n < 20; n++)
+  {
+    term *= -(x * x) / (double)((2 * n) * ((2 * n) + 1));
+    sum += term;
+  }
+
+  return sum;
+}
+
+
+/* fourier series up to the level's harmonic limit, scaled to +/-1 */
+static constexpr void fill(float *out, double const *sin, Wavetable::shape_e shape, uint32_t harmonics)
+{
+  double x[Wavetable::LENGTH] = {};
+  double peak = 0.0;
+  double amp = 0.0;
+  uint32_t h = 0;
+  uint32_t i = 0;
+
+  for (h = 1; h <= harmonics; h++)
+  {
+    switch (shape)
+    {
+      case Wavetable::SHAPE_SINE:
+        amp = (1 == h) ? 1.0 : 0.0;
+      break;
+
+      case Wavetable::SHAPE_TRIANGLE:
+        amp = (h & 1) ? (((h & 2) ? -1.0 : 1.0) / (double)(h * h)) : 0.0;
+      break;
+
+      case Wavetable::SHAPE_SQUARE:
+        amp = (h & 1) ? (1.0 / (double)h) : 0.0;
+      break;
+
+      /* falling harmonics give a rising ramp */
+      default:
+        amp = -1.0 / (double)h;
+      break;
+    }
+
+    if (0.0 == amp) {
+      continue; }
+
+    for (i = 0; i < Wavetable::LENGTH; i++) {
+      x[i] += amp * sin[(h * i) & (Wavetable::LENGTH - 1)]; }
+  }
+
+  for (i = 0; i < Wavetable::LENGTH; i++)
+  {
+    if (x[i] > peak) {
+      peak = x[i]; }
+    if (-x[i] > peak) {
+      peak = -x[i]; }
+  }
+
+  for (i = 0; i < Wavetable::LENGTH; i++) {
+    out[i] = (float)(x[i] / peak); }
+
+  out[Wavetable::LENGTH] = out[0];
+}
+
+
+static constexpr tables_t makeTables(void)
+{
+  tables_t t = {};
+  double sin[Wavetable::LENGTH] = {};
+  uint32_t s = 0;
+  uint32_t l = 0;
+  uint32_t i = 0;
+
+  for (i = 0; i < Wavetable::LENGTH; i++) {
+    sin[i] = sine((2.0 * PI_F64 * (double)i) / (double)Wavetable::LENGTH); }
+
+  fill(t.sine, sin, Wavetable::SHAPE_SINE, 1);
+
+  for (s = 1; s < Wavetable::SHAPE_NUM_OF; s++)
+  {
+    for (l = 0; l < Wavetable::LEVELS; l++) {
+      fill(t.shapes[s - 1][l], sin, (Wavetable::shape_e)s, Wavetable::LENGTH >> (l + 1)); }
+  }
+
+  return t;
+}
+
+
+/* const & constant initialised, ends up in flash */
+static constexpr tables_t tables = makeTables();
+
+
+float const *Wavetable::table(shape_e shape, uint32_t inc)
+{
+  uint32_t level = 0;
+
+  if (SHAPE_SINE == shape) {
+    return tables.sine; }
+
+  /* level n covers increments up to 2^(n + FRAC_BITS), one octave each */
+  if (inc > (1u << FRAC_BITS)) {
+    level = 32 - __builtin_clz((inc - 1) >> FRAC_BITS); }
+
+  if (level >= LEVELS) {
+    level = LEVELS - 1; }
+
+  return tables.shapes[shape - 1][level];
+}
+
+
+Wavetable::Wavetable(shape_e shape)
+  : _table(tables.sine),
+    _shape(shape),
+    _phase(0),
+    _inc(0)
+{
+  setShape(shape);
+}
+
+
+void Wavetable::setShape(shape_e shape)
+{
+  _shape = shape;
+  _table = table(_shape, _inc);
+}
+
+
+void Wavetable::setFrequency(float hz)
+{
+  _inc = increment(hz);
+  _table = table(_shape, _inc);
+}
+
+
+void Wavetable::generate(float *out, size_t frames)
+{
+  float const *t = _table;
+  uint32_t phase = _phase;
+  uint32_t inc = _inc;
+  size_t i;
+
+  for (i = 0; i < frames; i++)
+  {
+    out[i] = lookup(t, phase);
+    phase += inc;
+  }
+
+  _phase = phase;
+}
@@ -0,0 +1,100 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef WAVETABLE_HPP
+#define WAVETABLE_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "generator.hpp"
+
+
+/**
+ * @brief band limited wavetable oscillator
+ *
+ * every shape is stored once per octave, each level holding only the
+ * harmonics that stay below nyquist for the fastest phase increment it
+ * covers. the tables are built by the compiler and live in flash, picking
+ * one is a shift & clz when the frequency changes so the per sample loop
+ * is just a 32 bit phase accumulator & linear interpolation
+ */
+class Wavetable : public Generator<>
+{
+  public:
+    typedef enum
+    {
+      SHAPE_SINE,
+      SHAPE_TRIANGLE,
+      SHAPE_SAW,
+      SHAPE_SQUARE,
+      SHAPE_NUM_OF,
+    } shape_e;
+
+    static constexpr uint32_t LENGTH_BITS = 9;
+    static constexpr uint32_t LENGTH      = (1u << LENGTH_BITS);
+    static constexpr uint32_t FRAC_BITS   = (32 - LENGTH_BITS);
+
+    /* level n has LENGTH >> (n + 1) harmonics, the last just the fundamental */
+    static constexpr uint32_t LEVELS      = LENGTH_BITS;
+
+    /* full cycle is 2^32 */
+    static uint32_t increment(float hz)
+    {
+      return (uint32_t)(int64_t)(hz * (4294967296.0f / SAMPLE_RATE));
+    }
+
+    /* LENGTH + 1 samples, the last repeats the first for interpolation */
+    static float const *table(shape_e shape, uint32_t inc);
+
+    static float lookup(float const *table, uint32_t phase)
+    {
+      uint32_t i = phase >> FRAC_BITS;
+      float frac = (float)(phase & ((1u << FRAC_BITS) - 1)) * (1.0f / (float)(1u << FRAC_BITS));
+
+      return table[i] + ((table[i + 1] - table[i]) * frac);
+    }
+
+    Wavetable(shape_e shape = SHAPE_SAW);
+
+    void setShape(shape_e shape);
+    void setFrequency(float hz);
+    void reset(void) { _phase = 0; }
+
+    void generate(float *out, size_t frames);
+
+  private:
+    float const *_table;
+    shape_e      _shape;
+    uint32_t     _phase;
+    uint32_t     _inc;
+};
+
+
+#endif
@@ -26,11 +26,181 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ****************************************************************************/
 
+
 #ifndef PARAMETER_HPP
 #define PARAMETER_HPP
 
 
 #include "common.h"
+#include "config.h"
+#include "number.hpp"
+
+#include <cmath>
+
+
+/**
+ * @brief control side of a Parameter, the same for every number format so
+ * the mod matrix can hold any of them
+ */
+class ParameterTarget
+{
+  public:
+    /* any context */
+    void set(float value)
+    {
+      uint32_t bits;
+
+      memcpy(&bits, &value, sizeof(bits));
+      __atomic_store_n(&_pending, bits, __ATOMIC_RELEASE);
+    }
+
+  protected:
+    uint32_t _pending;            ///< written by set(), bits of a float
+};
+
+
+/**
+ * @brief control value in the same format as the stage it feeds, smoothed
+ * so knob & midi changes don't zipper
+ *
+ * set() is the control side, any context, lock free: the target goes in
+ * as one 32 bit word & the latest write wins. tick() is the audio side,
+ * once per block, it picks up a new target & works out where this block
+ * ends. the stage then runs value() + step() per sample, an add rather
+ * than a divide, or takes its constant path when isStatic()
+ *
+ * linear ramps cover the distance in a fixed number of blocks, exponential
+ * ones close a fixed fraction of it each block (-60 dB after the ramp
+ * time) which suits cutoff & level. the first tick jumps straight to the
+ * target, nothing has been rendered yet so there is nothing to smooth
+ *
+ * @tparam N number policy from number.hpp, fixed point can't reach 1.0
+ */
+template <typename N = Float32>
+class Parameter : public ParameterTarget
+{
+  public:
+    typedef typename N::sample_t sample_t;
+
+    typedef enum
+    {
+      RAMP_LINEAR,
+      RAMP_EXPONENTIAL,
+    } ramp_e;
+
+    Parameter(float value = 0.0f, ramp_e ramp = RAMP_LINEAR, float ms = PARAMETER_RAMP_MS)
+      : _now(value),
+        _target(value),
+        _step(0.0f),
+        _left(0),
+        _frames(0),
+        _inv(0.0f),
+        _fresh(true)
+    {
+      setRamp(ramp, ms);
+      set(value);
+      _seen = _pending;
+      _value = N::fromFloat(value);
+      _delta = N::fromFloat(0.0f);
+    }
+
+    /* audio context or before it starts, applies from the next change */
+    void setRamp(ramp_e ramp, float ms)
+    {
+      float blocks = (ms * (float)SAMPLE_RATE) / (1000.0f * BLOCK_SIZE);
+
+      _ramp = ramp;
+      _blocks = (blocks < 1.0f) ? 1 : (uint32_t)(blocks + 0.5f);
+
+      /* 1/1000 of the distance left after ms */
+      _decay = (blocks < 1.0f) ? 0.0f : expf(-6.9077553f / blocks);
+    }
+
+    /* audio context, once per block before the stage runs */
+    void tick(size_t frames)
+    {
+      uint32_t bits = __atomic_load_n(&_pending, __ATOMIC_ACQUIRE);
+      float end;
+
+      if (bits != _seen)
+      {
+        _seen = bits;
+        memcpy(&_target, &bits, sizeof(_target));
+        _left = _blocks;
+
+        if (_fresh)
+        {
+          _now = _target;
+          _left = 0;
+        }
+      }
+
+      _fresh = false;
+      _value = N::fromFloat(_now);
+
+      if ((0 == _left) || (0 == frames))
+      {
+        _step = 0.0f;
+        _delta = N::fromFloat(0.0f);
+        return;
+      }
+
+      if (RAMP_LINEAR == _ramp)
+      {
+        end = _now + ((_target - _now) / (float)_left);
+        _left--;
+      }
+      else
+      {
+        end = _target + ((_now - _target) * _decay);
+
+        if (fabsf(end - _target) < SNAP) {
+          _left = 0; }
+      }
+
+      if (0 == _left) {
+        end = _target; }
+
+      /* per block, only changes when the caller's block size does */
+      if (frames != _frames)
+      {
+        _frames = frames;
+        _inv = 1.0f / (float)frames;
+      }
+
+      _step = (end - _now) * _inv;
+      _delta = N::fromFloat(_step);
+      _now = end;
+    }
+
+    /* nothing moving this block, the stage can hoist value() */
+    bool     isStatic (void) const { return (0.0f == _step); }
+
+    /* where this block starts & the per sample increment, sample i is
+       value + (i + 1) * step so the last one lands on the block's end */
+    sample_t value    (void) const { return _value; }
+    sample_t step     (void) const { return _delta; }
+
+    float    toFloat  (void) const { return _now; }
+    float    target   (void) const { return _target; }
+
+  private:
+    static constexpr float SNAP = 1.0e-6f;
+
+    uint32_t  _seen;              ///< last _pending picked up by tick()
+    float     _now;               ///< where this block ends
+    float     _target;
+    float     _step;
+    sample_t  _value;
+    sample_t  _delta;
+    ramp_e    _ramp;
+    uint32_t  _blocks;            ///< linear ramp length
+    float     _decay;             ///< exponential, remaining distance kept per block
+    uint32_t  _left;              ///< blocks to go, 0 when settled
+    size_t    _frames;
+    float     _inv;
+    bool      _fresh;
+};
 
 
 #endif
@@ -0,0 +1,147 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "biquad.hpp"
+
+#include <cmath>
+
+
+#define TWO_PI        6.28318531f
+
+/* shelf slope of 1, the steepest without overshoot */
+#define SHELF_ALPHA(sin_w0)   ((sin_w0) * 0.70710678f)
+
+
+static biquad_t normalise(float b0, float b1, float b2, float a0, float a1, float a2);
+
+
+biquad_t BiquadDesign::bypass(void)
+{
+  return normalise(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+}
+
+
+biquad_t BiquadDesign::lowpass(float hz, float q)
+{
+  float w0 = (TWO_PI * hz) / SAMPLE_RATE;
+  float c = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * q);
+
+  return normalise((1.0f - c) * 0.5f, 1.0f - c, (1.0f - c) * 0.5f,
+                   1.0f + alpha, -2.0f * c, 1.0f - alpha);
+}
+
+
+biquad_t BiquadDesign::highpass(float hz, float q)
+{
+  float w0 = (TWO_PI * hz) / SAMPLE_RATE;
+  float c = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * q);
+
+  return normalise((1.0f + c) * 0.5f, -(1.0f + c), (1.0f + c) * 0.5f,
+                   1.0f + alpha, -2.0f * c, 1.0f - alpha);
+}
+
+
+biquad_t BiquadDesign::bandpass(float hz, float q)
+{
+  float w0 = (TWO_PI * hz) / SAMPLE_RATE;
+  float c = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * q);
+
+  return normalise(alpha, 0.0f, -alpha,
+                   1.0f + alpha, -2.0f * c, 1.0f - alpha);
+}
+
+
+biquad_t BiquadDesign::peak(float hz, float q, float db)
+{
+  float A = powf(10.0f, db / 40.0f);
+  float w0 = (TWO_PI * hz) / SAMPLE_RATE;
+  float c = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * q);
+
+  return normalise(1.0f + (alpha * A), -2.0f * c, 1.0f - (alpha * A),
+                   1.0f + (alpha / A), -2.0f * c, 1.0f - (alpha / A));
+}
+
+
+biquad_t BiquadDesign::lowShelf(float hz, float db)
+{
+  float A = powf(10.0f, db / 40.0f);
+  float w0 = (TWO_PI * hz) / SAMPLE_RATE;
+  float c = cosf(w0);
+  float k = 2.0f * sqrtf(A) * SHELF_ALPHA(sinf(w0));
+
+  return normalise(A * ((A + 1.0f) - ((A - 1.0f) * c) + k),
+                   2.0f * A * ((A - 1.0f) - ((A + 1.0f) * c)),
+                   A * ((A + 1.0f) - ((A - 1.0f) * c) - k),
+                   (A + 1.0f) + ((A - 1.0f) * c) + k,
+                   -2.0f * ((A - 1.0f) + ((A + 1.0f) * c)),
+                   (A + 1.0f) + ((A - 1.0f) * c) - k);
+}
+
+
+biquad_t BiquadDesign::highShelf(float hz, float db)
+{
+  float A = powf(10.0f, db / 40.0f);
+  float w0 = (TWO_PI * hz) / SAMPLE_RATE;
+  float c = cosf(w0);
+  float k = 2.0f * sqrtf(A) * SHELF_ALPHA(sinf(w0));
+
+  return normalise(A * ((A + 1.0f) + ((A - 1.0f) * c) + k),
+                   -2.0f * A * ((A - 1.0f) + ((A + 1.0f) * c)),
+                   A * ((A + 1.0f) + ((A - 1.0f) * c) - k),
+                   (A + 1.0f) - ((A - 1.0f) * c) + k,
+                   2.0f * ((A - 1.0f) - ((A + 1.0f) * c)),
+                   (A + 1.0f) - ((A - 1.0f) * c) - k);
+}
+
+
+/* y = x - x1 + R.y1 */
+biquad_t BiquadDesign::dcBlock(float hz)
+{
+  float R = 1.0f - ((TWO_PI * hz) / SAMPLE_RATE);
+
+  return normalise(1.0f, -1.0f, 0.0f, 1.0f, -R, 0.0f);
+}
+
+
+static biquad_t normalise(float b0, float b1, float b2, float a0, float a1, float a2)
+{
+  biquad_t c;
+
+  c.b0 = b0 / a0;
+  c.b1 = b1 / a0;
+  c.b2 = b2 / a0;
+  c.a1 = a1 / a0;
+  c.a2 = a2 / a0;
+
+  return c;
+}
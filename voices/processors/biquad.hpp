@@ -0,0 +1,258 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef BIQUAD_HPP
+#define BIQUAD_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "number.hpp"
+#include "processor.hpp"
+
+
+/* one second order section, y = b0.x + b1.x1 + b2.x2 - a1.y1 - a2.y2 */
+typedef struct
+{
+  float b0, b1, b2;
+  float a1, a2;
+} biquad_t;
+
+
+/**
+ * @brief section designs, rbj audio eq cookbook
+ */
+class BiquadDesign
+{
+  public:
+    static biquad_t bypass    (void);
+    static biquad_t lowpass   (float hz, float q);
+    static biquad_t highpass  (float hz, float q);
+    static biquad_t bandpass  (float hz, float q);    ///< 0 dB at the centre
+    static biquad_t peak      (float hz, float q, float db);
+    static biquad_t lowShelf  (float hz, float db);
+    static biquad_t highShelf (float hz, float db);
+    static biquad_t dcBlock   (float hz);             ///< first order, for the adc & feedback paths
+};
+
+
+/* the cmsis-dsp cascade behind each number policy */
+template <typename N> struct BiquadKernel;
+
+template <>
+struct BiquadKernel<Float32>
+{
+  typedef arm_biquad_cascade_df2T_instance_f32 instance_t;
+
+  static constexpr uint32_t STATE_PER_STAGE = 2;
+
+  static void init(instance_t *s, uint8_t stages, float const *coeffs, float *state)
+  {
+    arm_biquad_cascade_df2T_init_f32(s, stages, coeffs, state);
+  }
+
+  static void run(instance_t const *s, float *buf, size_t frames)
+  {
+    arm_biquad_cascade_df2T_f32(s, buf, buf, frames);
+  }
+
+  /* cmsis adds the feedback terms */
+  static void store(float *dst, biquad_t const &c)
+  {
+    dst[0] = c.b0;
+    dst[1] = c.b1;
+    dst[2] = c.b2;
+    dst[3] = -c.a1;
+    dst[4] = -c.a2;
+  }
+};
+
+/* direct form 1 is the only q31 cascade, coefficients are stored /4 so
+ * they must stay under 4, about +/-12 dB of shelf or peak */
+template <>
+struct BiquadKernel<Q31>
+{
+  typedef arm_biquad_casd_df1_inst_q31 instance_t;
+
+  static constexpr uint32_t STATE_PER_STAGE = 4;
+  static constexpr int8_t   POST_SHIFT      = 2;
+
+  static void init(instance_t *s, uint8_t stages, int32_t const *coeffs, int32_t *state)
+  {
+    arm_biquad_cascade_df1_init_q31(s, stages, coeffs, state, POST_SHIFT);
+  }
+
+  static void run(instance_t const *s, int32_t *buf, size_t frames)
+  {
+    arm_biquad_cascade_df1_q31(s, buf, buf, frames);
+  }
+
+  static void store(int32_t *dst, biquad_t const &c)
+  {
+    dst[0] = Q31::fromFloat(c.b0 * 0.25f);
+    dst[1] = Q31::fromFloat(c.b1 * 0.25f);
+    dst[2] = Q31::fromFloat(c.b2 * 0.25f);
+    dst[3] = Q31::fromFloat(-c.a1 * 0.25f);
+    dst[4] = Q31::fromFloat(-c.a2 * 0.25f);
+  }
+};
+
+
+/**
+ * @brief cascade of up to MAX_STAGES sections on CHANNELS independent
+ * channels that share one set of coefficients, e.g. an eq on every voice
+ *
+ * each channel is a single cmsis call per block so the states stay in
+ * registers across the block. coefficients are double buffered, new ones
+ * are written to the spare set with setStage() & published by commit(),
+ * the next process() swaps the pointer before it starts. the filter state
+ * carries straight over so a change never resets or clicks
+ */
+template <typename N = Float32, uint32_t CHANNELS = 1>
+class Biquad : public Processor<N>
+{
+  public:
+    typedef typename N::sample_t sample_t;
+    typedef BiquadKernel<N>      kernel_t;
+
+    static constexpr uint8_t  MAX_STAGES = 4;
+    static constexpr uint32_t COEFFS     = 5;
+
+    static_assert(CHANNELS <= 32, "channels are selected by a 32 bit mask");
+
+    Biquad(uint8_t stages = 1)
+      : _stages((stages < 1) ? 1 : (stages > MAX_STAGES) ? MAX_STAGES : stages),
+        _active(0),
+        _pending(false),
+        _dirty(false),
+        _stale(false)
+    {
+      uint8_t s;
+
+      for (s = 0; s < MAX_STAGES; s++)
+      {
+        kernel_t::store(&_coeffs[0][s * COEFFS], BiquadDesign::bypass());
+        kernel_t::store(&_coeffs[1][s * COEFFS], BiquadDesign::bypass());
+      }
+
+      reset();
+    }
+
+    uint8_t stages(void) const { return _stages; }
+
+    /* false while the last commit is still waiting for process() */
+    bool setStage(uint8_t stage, biquad_t const &c)
+    {
+      bool ret = false;
+
+      /* acquire, so _stale is seen as process() left it */
+      if ((false == __atomic_load_n(&_pending, __ATOMIC_ACQUIRE)) && (stage < _stages))
+      {
+        if (_stale)
+        {
+          memcpy(_coeffs[_active ^ 1], _coeffs[_active], sizeof(_coeffs[0]));
+          _stale = false;
+        }
+
+        kernel_t::store(&_coeffs[_active ^ 1][stage * COEFFS], c);
+        _dirty = true;
+        ret = true;
+      }
+
+      return ret;
+    }
+
+    void commit(void)
+    {
+      if (_dirty)
+      {
+        _dirty = false;
+        __atomic_store_n(&_pending, true, __ATOMIC_RELEASE);
+      }
+    }
+
+    bool pending(void) const { return __atomic_load_n(&_pending, __ATOMIC_ACQUIRE); }
+
+    /* clear every channel's history */
+    void reset(void)
+    {
+      uint32_t ch;
+
+      for (ch = 0; ch < CHANNELS; ch++) {
+        kernel_t::init(&_inst[ch], _stages, _coeffs[_active], _state[ch]); }
+    }
+
+    /* channel 0 */
+    void process(sample_t *buf, size_t frames)
+    {
+      processChannels(buf, frames, 1, frames);
+    }
+
+    /* channel n is at buf + (n * stride), only those set in active */
+    void processChannels(sample_t *buf, size_t stride, uint32_t active, size_t frames)
+    {
+      uint32_t ch;
+
+      if (__atomic_load_n(&_pending, __ATOMIC_ACQUIRE)) {
+        swap(); }
+
+      for (ch = 0; ch < CHANNELS; ch++)
+      {
+        if (active & (1u << ch)) {
+          kernel_t::run(&_inst[ch], &buf[ch * stride], frames); }
+      }
+    }
+
+  private:
+    void swap(void)
+    {
+      uint32_t ch;
+
+      _active ^= 1;
+
+      for (ch = 0; ch < CHANNELS; ch++) {
+        _inst[ch].pCoeffs = _coeffs[_active]; }
+
+      /* release, the control side may write the spare set once this lands */
+      _stale = true;
+      __atomic_store_n(&_pending, false, __ATOMIC_RELEASE);
+    }
+
+    typename kernel_t::instance_t _inst[CHANNELS];
+    sample_t      _state[CHANNELS][MAX_STAGES * kernel_t::STATE_PER_STAGE];
+    sample_t      _coeffs[2][MAX_STAGES * COEFFS];
+    uint8_t       _stages;
+    uint8_t       _active;
+    bool          _pending;   ///< set outside, cleared by process()
+    bool          _dirty;
+    bool          _stale;     ///< spare set is behind the active one
+};
+
+
+#endif
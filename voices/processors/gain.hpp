@@ -0,0 +1,83 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef GAIN_HPP
+#define GAIN_HPP
+
+
+#include "common.h"
+
+#include "parameter.hpp"
+#include "processor.hpp"
+
+
+/**
+ * @brief level, attenuation only in the fixed point formats. changes ramp
+ * exponentially so they don't click
+ */
+template <typename N = Float32>
+class Gain : public Processor<N>
+{
+  public:
+    typedef typename N::sample_t sample_t;
+
+    Gain(float level = 1.0f) : _level(level, Parameter<N>::RAMP_EXPONENTIAL) {}
+
+    void setLevel(float level) { _level.set(level); }
+
+    void process(sample_t *buf, size_t frames)
+    {
+      sample_t g, dg;
+      size_t i;
+
+      _level.tick(frames);
+      g = _level.value();
+
+      if (_level.isStatic())
+      {
+        for (i = 0; i < frames; i++) {
+          buf[i] = N::mul(buf[i], g); }
+      }
+      else
+      {
+        dg = _level.step();
+
+        for (i = 0; i < frames; i++)
+        {
+          g = N::add(g, dg);
+          buf[i] = N::mul(buf[i], g);
+        }
+      }
+    }
+
+  private:
+    Parameter<N> _level;
+};
+
+
+#endif
@@ -0,0 +1,133 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "ladder.hpp"
+
+#include <cmath>
+
+
+#define MIN_HZ        10.0f
+#define MAX_HZ        (0.49f * SAMPLE_RATE)
+
+/* a linear ladder sits on the edge of stability at 4 */
+#define MAX_K         3.96f
+
+
+Ladder::Ladder(void)
+  : _hz(1000.0f),
+    _res(0.0f)
+{
+  target(_now);
+  reset();
+}
+
+
+void Ladder::setCutoff(float hz)
+{
+  _hz = (hz < MIN_HZ) ? MIN_HZ : (hz > MAX_HZ) ? MAX_HZ : hz;
+  _changed = true;
+}
+
+void Ladder::setResonance(float res)
+{
+  _res = (res < 0.0f) ? 0.0f : (res > 1.0f) ? 1.0f : res;
+  _changed = true;
+}
+
+
+void Ladder::reset(void)
+{
+  memset(_s, 0, sizeof(_s));
+  _changed = false;
+}
+
+
+void Ladder::process(float *buf, size_t frames)
+{
+  coeffs_t c = _now;
+  coeffs_t step = {0.0f, 0.0f, 0.0f};
+  coeffs_t end;
+  float s1 = _s[0];
+  float s2 = _s[1];
+  float s3 = _s[2];
+  float s4 = _s[3];
+  float G, B, G2, y4, u, v, inv;
+  size_t i;
+
+  if (_changed && frames)
+  {
+    target(end);
+    inv = 1.0f / (float)frames;
+    step.G = (end.G - c.G) * inv;
+    step.k = (end.k - c.k) * inv;
+    step.h = (end.h - c.h) * inv;
+    _now = end;
+    _changed = false;
+  }
+
+  for (i = 0; i < frames; i++)
+  {
+    c.G += step.G;
+    c.k += step.k;
+    c.h += step.h;
+
+    G = c.G;
+    B = 1.0f - G;
+    G2 = G * G;
+
+    /* y4 = (G^4.x + B.(G^3.s1 + G^2.s2 + G.s3 + s4))/ (1 + k.G^4) */
+    y4 = ((G2 * G2 * buf[i]) + (B * ((G2 * G * s1) + (G2 * s2) + (G * s3) + s4))) * c.h;
+    u = buf[i] - (c.k * y4);
+
+    v = (u - s1) * G;  u = v + s1;  s1 = u + v;
+    v = (u - s2) * G;  u = v + s2;  s2 = u + v;
+    v = (u - s3) * G;  u = v + s3;  s3 = u + v;
+    v = (u - s4) * G;  u = v + s4;  s4 = u + v;
+
+    buf[i] = u;
+  }
+
+  _s[0] = s1;
+  _s[1] = s2;
+  _s[2] = s3;
+  _s[3] = s4;
+}
+
+
+void Ladder::target(coeffs_t &c) const
+{
+  float g = tanf((3.14159265f * _hz) / SAMPLE_RATE);
+  float G4;
+
+  c.G = g / (1.0f + g);
+  c.k = MAX_K * _res;
+
+  G4 = c.G * c.G * c.G * c.G;
+  c.h = 1.0f / (1.0f + (c.k * G4));
+}
@@ -0,0 +1,77 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef LADDER_HPP
+#define LADDER_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "processor.hpp"
+
+
+/**
+ * @brief zero delay feedback 4 pole ladder lowpass, 24 dB/ octave
+ *
+ * four trapezoidal one poles with the global feedback solved exactly each
+ * sample rather than delayed by one. like Svf the tan() prewarp & the
+ * feedback solution are computed per block & ramped across it
+ */
+class Ladder : public Processor<>
+{
+  public:
+    Ladder(void);
+
+    /* take effect over the next block */
+    void setCutoff    (float hz);
+    void setResonance (float res);      ///< 0 - 1, just short of self oscillation
+
+    void reset(void);
+
+    void process(float *buf, size_t frames);
+
+  private:
+    typedef struct
+    {
+      float G;                ///< one pole gain g/ (1 + g)
+      float k;                ///< feedback
+      float h;                ///< 1/ (1 + k.G^4)
+    } coeffs_t;
+
+    void target(coeffs_t &c) const;
+
+    coeffs_t _now;
+    float    _hz;
+    float    _res;
+    bool     _changed;
+    float    _s[4];
+};
+
+
+#endif
@@ -0,0 +1,97 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef ONE_POLE_HPP
+#define ONE_POLE_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "parameter.hpp"
+#include "processor.hpp"
+
+#include <cmath>
+
+
+/**
+ * @brief 6 dB/ octave lowpass, y += a * (x - y)
+ */
+template <typename N = Float32>
+class OnePole : public Processor<N>
+{
+  public:
+    typedef typename N::sample_t sample_t;
+
+    OnePole(float hz = 1000.0f) : _y(N::fromFloat(0.0f)) { setCutoff(hz); }
+
+    void setCutoff(float hz)
+    {
+      _coeff.set(1.0f - expf((-6.2831853f * hz) / SAMPLE_RATE));
+    }
+
+    void reset(void) { _y = N::fromFloat(0.0f); }
+
+    void process(sample_t *buf, size_t frames)
+    {
+      sample_t a, da;
+      sample_t y = _y;
+      size_t i;
+
+      _coeff.tick(frames);
+      a = _coeff.value();
+      da = _coeff.step();
+
+      if (_coeff.isStatic())
+      {
+        for (i = 0; i < frames; i++)
+        {
+          y = N::add(y, N::mul(a, N::sub(buf[i], y)));
+          buf[i] = y;
+        }
+      }
+      else
+      {
+        for (i = 0; i < frames; i++)
+        {
+          a = N::add(a, da);
+          y = N::add(y, N::mul(a, N::sub(buf[i], y)));
+          buf[i] = y;
+        }
+      }
+
+      _y = y;
+    }
+
+  private:
+    Parameter<N> _coeff;
+    sample_t     _y;
+};
+
+
+#endif
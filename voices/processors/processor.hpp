@@ -31,6 +31,25 @@ SOFTWARE.
 
 
 #include "common.h"
+#include "number.hpp"
+
+#include <stddef.h>
+
+
+/**
+ * @brief in place block effect, filters, gain, shapers
+ * @tparam N number policy from number.hpp
+ */
+template <typename N = Float32>
+class Processor
+{
+  public:
+    typedef typename N::sample_t sample_t;
+
+    virtual ~Processor() {}
+
+    virtual void process(sample_t *buf, size_t frames) = 0;
+};
 
 
 #endif
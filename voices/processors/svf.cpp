@@ -0,0 +1,155 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "svf.hpp"
+
+#include <cmath>
+
+
+#define MIN_HZ        10.0f
+#define MAX_HZ        (0.49f * SAMPLE_RATE)
+
+/* damping at full resonance, Q of 50 */
+#define MIN_K         0.02f
+
+
+Svf::Svf(mode_e mode)
+  : _mode(mode),
+    _hz(1000.0f),
+    _res(0.0f)
+{
+  target(_now);
+  reset();
+}
+
+
+void Svf::setMode(mode_e mode)
+{
+  _mode = mode;
+  _changed = true;
+}
+
+void Svf::setCutoff(float hz)
+{
+  _hz = (hz < MIN_HZ) ? MIN_HZ : (hz > MAX_HZ) ? MAX_HZ : hz;
+  _changed = true;
+}
+
+void Svf::setResonance(float res)
+{
+  _res = (res < 0.0f) ? 0.0f : (res > 1.0f) ? 1.0f : res;
+  _changed = true;
+}
+
+
+void Svf::reset(void)
+{
+  _ic1 = 0.0f;
+  _ic2 = 0.0f;
+  _changed = false;
+}
+
+
+void Svf::process(float *buf, size_t frames)
+{
+  coeffs_t c = _now;
+  coeffs_t step = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  coeffs_t end;
+  float ic1 = _ic1;
+  float ic2 = _ic2;
+  float v0, v1, v2, v3, inv;
+  size_t i;
+
+  if (_changed && frames)
+  {
+    target(end);
+    inv = 1.0f / (float)frames;
+    step.a1 = (end.a1 - c.a1) * inv;
+    step.a2 = (end.a2 - c.a2) * inv;
+    step.a3 = (end.a3 - c.a3) * inv;
+    step.m0 = (end.m0 - c.m0) * inv;
+    step.m1 = (end.m1 - c.m1) * inv;
+    step.m2 = (end.m2 - c.m2) * inv;
+    _now = end;
+    _changed = false;
+  }
+
+  for (i = 0; i < frames; i++)
+  {
+    c.a1 += step.a1;
+    c.a2 += step.a2;
+    c.a3 += step.a3;
+    c.m0 += step.m0;
+    c.m1 += step.m1;
+    c.m2 += step.m2;
+
+    v0 = buf[i];
+    v3 = v0 - ic2;
+    v1 = (c.a1 * ic1) + (c.a2 * v3);
+    v2 = ic2 + (c.a2 * ic1) + (c.a3 * v3);
+    ic1 = (2.0f * v1) - ic1;
+    ic2 = (2.0f * v2) - ic2;
+
+    buf[i] = (c.m0 * v0) + (c.m1 * v1) + (c.m2 * v2);
+  }
+
+  _ic1 = ic1;
+  _ic2 = ic2;
+}
+
+
+/* the only transcendental, once per block at most */
+void Svf::target(coeffs_t &c) const
+{
+  float g = tanf((3.14159265f * _hz) / SAMPLE_RATE);
+  float k = MIN_K + ((2.0f - MIN_K) * (1.0f - _res));
+
+  c.a1 = 1.0f / (1.0f + (g * (g + k)));
+  c.a2 = g * c.a1;
+  c.a3 = g * c.a2;
+
+  switch (_mode)
+  {
+    case MODE_BANDPASS:
+      c.m0 = 0.0f; c.m1 = 1.0f; c.m2 = 0.0f;
+    break;
+
+    case MODE_HIGHPASS:
+      c.m0 = 1.0f; c.m1 = -k; c.m2 = -1.0f;
+    break;
+
+    case MODE_NOTCH:
+      c.m0 = 1.0f; c.m1 = -k; c.m2 = 0.0f;
+    break;
+
+    default:
+      c.m0 = 0.0f; c.m1 = 0.0f; c.m2 = 1.0f;
+    break;
+  }
+}
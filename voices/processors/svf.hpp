@@ -0,0 +1,89 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef SVF_HPP
+#define SVF_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "processor.hpp"
+
+
+/**
+ * @brief zero delay feedback state variable filter, 12 dB/ octave
+ *
+ * trapezoidal integrators with the cutoff prewarped through tan(), so the
+ * response holds up to nyquist. coefficients are worked out once per block
+ * from the latest cutoff & resonance then ramped linearly across the block,
+ * modulation costs a tan() per block rather than per sample
+ */
+class Svf : public Processor<>
+{
+  public:
+    typedef enum
+    {
+      MODE_LOWPASS,
+      MODE_BANDPASS,
+      MODE_HIGHPASS,
+      MODE_NOTCH,
+      MODE_NUM_OF,
+    } mode_e;
+
+    Svf(mode_e mode = MODE_LOWPASS);
+
+    /* take effect over the next block */
+    void setMode      (mode_e mode);
+    void setCutoff    (float hz);
+    void setResonance (float res);      ///< 0 - 1, self oscillates near 1
+
+    void reset(void);
+
+    void process(float *buf, size_t frames);
+
+  private:
+    typedef struct
+    {
+      float a1, a2, a3;       ///< integrator solution
+      float m0, m1, m2;       ///< output mix of input, band & low
+    } coeffs_t;
+
+    void target(coeffs_t &c) const;
+
+    coeffs_t _now;            ///< where the last block ended
+    mode_e   _mode;
+    float    _hz;
+    float    _res;
+    bool     _changed;
+    float    _ic1;            ///< integrator states
+    float    _ic2;
+};
+
+
+#endif
@@ -26,11 +26,39 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ****************************************************************************/
 
-#ifndef MODIFIER_HPP
-#define MODIFIER_HPP
+#ifndef VOICE_HPP
+#define VOICE_HPP
 
 
 #include "common.h"
 
+#include "event_bus.hpp"
+
+#include <stddef.h>
+
+
+/**
+ * @brief anything that produces audio, rendered a block at a time from
+ * the audio engine so the per sample cost is just the inner loop
+ */
+class Voice
+{
+  public:
+    virtual ~Voice() {}
+
+    /**
+     * @brief render the next frames of mono audio, nominal range +/-1.0
+     * @param out overwritten, not accumulated
+     * @param frames normally BLOCK_SIZE but may be less
+     */
+    virtual void render(float *out, size_t frames) = 0;
+
+    /**
+     * @brief an event from the bus, between the renders either side of it
+     * so it takes effect on the exact sample. ignored unless overridden
+     */
+    virtual void handle(event_t const &event) { (void)event; }
+};
+
 
 #endif
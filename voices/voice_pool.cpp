@@ -0,0 +1,313 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+
+#include "voice_pool.hpp"
+
+#include <cmath>
+
+
+static_assert(MAX_VOICES > 0 && MAX_VOICES <= UINT8_MAX, "voices are indexed by uint8_t");
+
+
+#define NUM_OF_NOTES      128
+
+/* leaves room for a full pool before the engine saturates */
+#define VOICE_GAIN        (1.0f / 4.0f)
+
+/* fixed until there is a real filter, ~2 kHz at 96 kHz */
+#define LP_COEFF          0.12f
+
+
+/* phase increment per midi note, shared by all pools */
+static uint32_t note_inc[NUM_OF_NOTES];
+
+
+VoicePool::VoicePool(void)
+  : _policy(STEAL_OLDEST)
+{
+  uint32_t i;
+
+  if (0 == note_inc[NUM_OF_NOTES - 1])
+  {
+    for (i = 0; i < NUM_OF_NOTES; i++) {
+      note_inc[i] = Wavetable::increment(440.0f * powf(2.0f, ((float)i - 69.0f) / 12.0f)); }
+  }
+
+  setAttack(0.005f);
+  setRelease(0.2f);
+  allOff();
+}
+
+
+void VoicePool::setAttack(float seconds)
+{
+  _attack = (seconds > 0.0f) ? (1.0f / (seconds * SAMPLE_RATE)) : 1.0f;
+}
+
+void VoicePool::setRelease(float seconds)
+{
+  _release = (seconds > 0.0f) ? (1.0f / (seconds * SAMPLE_RATE)) : 1.0f;
+}
+
+
+uint8_t VoicePool::noteOn(uint8_t note, uint8_t velocity)
+{
+  uint8_t v;
+
+  note &= (NUM_OF_NOTES - 1);
+  v = allocate(note);
+
+  /* a stolen voice ramps up from wherever it was, no click */
+  if (STAGE_OFF == _stage[v])
+  {
+    _phase[v] = 0;
+    _lp[v] = 0.0f;
+    _env[v] = 0.0f;
+  }
+
+  _inc[v] = note_inc[note];
+  _table[v] = Wavetable::table(Wavetable::SHAPE_SAW, _inc[v]);
+  _gain[v] = ((float)velocity / 127.0f) * VOICE_GAIN;
+  _note[v] = note;
+  _age[v] = _clock++;
+  _stage[v] = STAGE_ATTACK;
+
+  return v;
+}
+
+
+void VoicePool::noteOff(uint8_t note)
+{
+  uint8_t v;
+
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    if ((note == _note[v]) && (STAGE_ATTACK == _stage[v] || STAGE_SUSTAIN == _stage[v])) {
+      _stage[v] = STAGE_RELEASE; }
+  }
+}
+
+
+void VoicePool::allOff(void)
+{
+  uint8_t v;
+
+  for (v = 0; v < MAX_VOICES; v++) {
+    _table[v] = Wavetable::table(Wavetable::SHAPE_SAW, 0); }
+
+  memset(_phase, 0, sizeof(_phase));
+  memset(_inc, 0, sizeof(_inc));
+  memset(_env, 0, sizeof(_env));
+  memset(_gain, 0, sizeof(_gain));
+  memset(_lp, 0, sizeof(_lp));
+  memset(_age, 0, sizeof(_age));
+  memset(_note, 0, sizeof(_note));
+  memset(_stage, STAGE_OFF, sizeof(_stage));
+
+  _clock = 0;
+  _steals = 0;
+}
+
+
+uint8_t VoicePool::active(void) const
+{
+  uint8_t count = 0;
+  uint8_t v;
+
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    if (STAGE_OFF != _stage[v]) {
+      count++; }
+  }
+
+  return count;
+}
+
+
+void VoicePool::render(float *out, size_t frames)
+{
+  float env_end[MAX_VOICES];
+  float const *table;
+  uint32_t phase, inc;
+  float lp, level, step;
+  uint8_t v;
+  size_t i;
+
+  memset(out, 0, frames * sizeof(float));
+
+  /* envelopes at block rate, ramped linearly across the block below */
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    switch (_stage[v])
+    {
+      case STAGE_ATTACK:
+        env_end[v] = _env[v] + (_attack * frames);
+        if (env_end[v] >= 1.0f)
+        {
+          env_end[v] = 1.0f;
+          _stage[v] = STAGE_SUSTAIN;
+        }
+      break;
+
+      case STAGE_SUSTAIN:
+        env_end[v] = 1.0f;
+      break;
+
+      case STAGE_RELEASE:
+        env_end[v] = _env[v] - (_release * frames);
+        if (env_end[v] <= 0.0f)
+        {
+          env_end[v] = 0.0f;
+          _stage[v] = STAGE_OFF;
+        }
+      break;
+
+      default:
+        env_end[v] = 0.0f;
+      break;
+    }
+  }
+
+  /* one voice at a time over the whole block */
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    if ((0.0f == _env[v]) && (0.0f == env_end[v])) {
+      continue; }
+
+    table = _table[v];
+    phase = _phase[v];
+    inc = _inc[v];
+    lp = _lp[v];
+    level = _env[v] * _gain[v];
+    step = ((env_end[v] - _env[v]) * _gain[v]) / (float)frames;
+
+    for (i = 0; i < frames; i++)
+    {
+      lp += LP_COEFF * (Wavetable::lookup(table, phase) - lp);
+      out[i] += lp * level;
+      level += step;
+      phase += inc;
+    }
+
+    _phase[v] = phase;
+    _lp[v] = lp;
+    _env[v] = env_end[v];
+  }
+}
+
+
+void VoicePool::handle(event_t const &event)
+{
+  switch (event.type)
+  {
+    case EVENT_NOTE_ON:
+      if (event.b) {
+        noteOn(event.a, event.b); }
+      else {
+        noteOff(event.a); }
+    break;
+
+    case EVENT_NOTE_OFF:
+      noteOff(event.a);
+    break;
+
+    default:
+    break;
+  }
+}
+
+
+uint8_t VoicePool::allocate(uint8_t note)
+{
+  uint8_t v;
+
+  if (STEAL_SAME_NOTE == _policy)
+  {
+    for (v = 0; v < MAX_VOICES; v++)
+    {
+      if ((STAGE_OFF != _stage[v]) && (note == _note[v])) {
+        return v; }
+    }
+  }
+
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    if (STAGE_OFF == _stage[v]) {
+      return v; }
+  }
+
+  _steals++;
+
+  if (STEAL_QUIETEST == _policy) {
+    return quietest(); }
+
+  return oldest();
+}
+
+
+uint8_t VoicePool::oldest(void) const
+{
+  uint8_t best = 0;
+  bool releasing = false;
+  uint8_t v;
+
+  /* released notes go before held ones, then by age */
+  for (v = 0; v < MAX_VOICES; v++)
+  {
+    if (STAGE_RELEASE == _stage[v])
+    {
+      if ((false == releasing) || ((_clock - _age[v]) > (_clock - _age[best])))
+      {
+        best = v;
+        releasing = true;
+      }
+    }
+    else if ((false == releasing) && ((_clock - _age[v]) > (_clock - _age[best])))
+    {
+      best = v;
+    }
+  }
+
+  return best;
+}
+
+
+uint8_t VoicePool::quietest(void) const
+{
+  uint8_t best = 0;
+  uint8_t v;
+
+  for (v = 1; v < MAX_VOICES; v++)
+  {
+    if (_env[v] < _env[best]) {
+      best = v; }
+  }
+
+  return best;
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+
+RickSynth
+----------
+
+MIT License
+
+Copyright (c) [2021] [Richard Davies]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+****************************************************************************/
+
+#ifndef VOICE_POOL_HPP
+#define VOICE_POOL_HPP
+
+
+#include "common.h"
+#include "config.h"
+
+#include "voice.hpp"
+#include "wavetable.hpp"
+
+
+/**
+ * @brief fixed set of MAX_VOICES voices, all statically allocated
+ *
+ * state is kept as one array per field rather than one struct per voice so
+ * the block rate passes (envelopes, steal search) walk contiguous memory and
+ * the per sample loop keeps a single voice's state in registers
+ */
+class VoicePool : public Voice
+{
+  public:
+    /* which voice to take when a note arrives and none are free */
+    typedef enum
+    {
+      STEAL_OLDEST,           ///< longest since note on, releasing voices first
+      STEAL_QUIETEST,         ///< lowest envelope level
+      STEAL_SAME_NOTE,        ///< retrigger the voice already on this note, else oldest
+      STEAL_NUM_OF,
+    } steal_e;
+
+    VoicePool(void);
+
+    void    setStealPolicy  (steal_e policy) { _policy = policy; }
+    steal_e stealPolicy     (void) const { return _policy; }
+
+    /* linear ramps, full scale in this many seconds */
+    void    setAttack       (float seconds);
+    void    setRelease      (float seconds);
+
+    /* returns the voice index used */
+    uint8_t noteOn          (uint8_t note, uint8_t velocity);
+    void    noteOff         (uint8_t note);
+    void    allOff          (void);
+
+    /* sounding, including those still releasing */
+    uint8_t  active         (void) const;
+    uint32_t steals         (void) const { return _steals; }
+    uint8_t  noteOf         (uint8_t voice) const { return _note[voice]; }
+    float    levelOf        (uint8_t voice) const { return _env[voice]; }
+
+    void render(float *out, size_t frames);
+
+    /* note on & off, a note on with velocity 0 is a note off */
+    void handle(event_t const &event);
+
+  private:
+    typedef enum
+    {
+      STAGE_OFF,
+      STAGE_ATTACK,
+      STAGE_SUSTAIN,
+      STAGE_RELEASE,
+    } stage_e;
+
+    uint8_t allocate(uint8_t note);
+    uint8_t oldest(void) const;
+    uint8_t quietest(void) const;
+
+    /* per voice state, indexed by voice */
+    float const *_table[MAX_VOICES];  ///< band limited for the note, picked at note on
+    uint32_t _phase[MAX_VOICES];
+    uint32_t _inc[MAX_VOICES];      ///< phase per sample, 2^32 per cycle
+    float    _env[MAX_VOICES];
+    float    _gain[MAX_VOICES];     ///< velocity
+    float    _lp[MAX_VOICES];       ///< one pole filter state
+    uint32_t _age[MAX_VOICES];      ///< _clock at note on
+    uint8_t  _note[MAX_VOICES];
+    uint8_t  _stage[MAX_VOICES];
+
+    steal_e  _policy;
+    uint32_t _clock;
+    uint32_t _steals;
+    float    _attack;               ///< per sample
+    float    _release;
+};
+
+
+#endif